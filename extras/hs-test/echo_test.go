@@ -9,7 +9,7 @@ import (
 
 func init() {
 	RegisterVethTests(EchoBuiltinTest, EchoBuiltinBandwidthTest, EchoBuiltinEchobytesTest, EchoBuiltinRoundtripTest)
-	RegisterSoloVethTests(TcpWithLossTest)
+	RegisterSoloVethTests(TcpWithLossTest, TcpWithLossBbrTest)
 	RegisterVeth6Tests(TcpWithLoss6Test)
 }
 
@@ -121,6 +121,29 @@ func TcpWithLossTest(s *VethsSuite) {
 	s.AssertNotContains(output, "failed", output)
 }
 
+func TcpWithLossBbrTest(s *VethsSuite) {
+	serverVpp := s.Containers.ServerVpp.VppInstance
+
+	serverVpp.Vppctl("test echo server uri tcp://%s/"+s.Ports.Port1,
+		s.Interfaces.Server.Ip4AddressString())
+
+	clientVpp := s.Containers.ClientVpp.VppInstance
+	s.AssertContains(clientVpp.Vppctl("show tcp config"), "algorithm: bbr")
+
+	// Add delay and 1% loss with Network Delay Simulator
+	clientVpp.Vppctl("set nsim poll-main-thread delay 10 ms bandwidth 1 gbit" +
+		" packet-size 1400 packets-per-drop 100")
+
+	clientVpp.Vppctl("nsim output-feature enable-disable host-" + s.Interfaces.Server.Name())
+
+	// Do echo test from client-vpp container
+	output := clientVpp.Vppctl("test echo client uri tcp://%s/%s verbose echo-bytes bytes 50m",
+		s.Interfaces.Server.Ip4AddressString(), s.Ports.Port1)
+	s.Log(output)
+	s.AssertNotEqual(len(output), 0)
+	s.AssertNotContains(output, "failed", output)
+}
+
 func TcpWithLoss6Test(s *Veths6Suite) {
 	serverVpp := s.Containers.ServerVpp.VppInstance
 
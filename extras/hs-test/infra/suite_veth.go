@@ -73,13 +73,18 @@ func (s *VethsSuite) SetupTest() {
 	// For http/2 continuation frame test between http tps and http client
 	var httpConfig Stanza
 	httpConfig.NewStanza("http").NewStanza("http2").Append("max-header-list-size 65536")
+	// For congestion control tests
+	var tcpConfig Stanza
+	if strings.Contains(CurrentSpecReport().LeafNodeText, "Bbr") {
+		tcpConfig.NewStanza("tcp").Append("cc-algo bbr").Close()
+	}
 
 	// ... For server
 	serverVpp, err := s.Containers.ServerVpp.newVppInstance(s.Containers.ServerVpp.AllocatedCpus, sessionConfig)
 	s.AssertNotNil(serverVpp, fmt.Sprint(err))
 
 	// ... For client
-	clientVpp, err := s.Containers.ClientVpp.newVppInstance(s.Containers.ClientVpp.AllocatedCpus, sessionConfig, httpConfig)
+	clientVpp, err := s.Containers.ClientVpp.newVppInstance(s.Containers.ClientVpp.AllocatedCpus, sessionConfig, httpConfig, tcpConfig)
 	s.AssertNotNil(clientVpp, fmt.Sprint(err))
 
 	s.SetupServerVpp()
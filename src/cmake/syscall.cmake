@@ -20,3 +20,17 @@ check_c_source_compiles("
 if (HAVE_FCNTL64)
     add_definitions(-DHAVE_FCNTL64)
 endif()
+
+# io_uring ring with EXT_ARG waits (5.11) and multishot poll (5.13)
+check_c_source_compiles("
+  #include <linux/io_uring.h>
+  int main() {
+    struct io_uring_getevents_arg arg = { 0 };
+    return IORING_FEAT_EXT_ARG | IORING_ENTER_EXT_ARG |
+      IORING_POLL_ADD_MULTI | IORING_CQE_F_MORE | IORING_OP_SEND | arg.ts;
+  }
+" HAVE_IO_URING)
+
+if (HAVE_IO_URING)
+    add_definitions(-DHAVE_IO_URING)
+endif()
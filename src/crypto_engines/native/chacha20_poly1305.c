@@ -0,0 +1,195 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/crypto/crypto.h>
+#include <native/crypto_native.h>
+#include <vppinfra/crypto/chacha20_poly1305.h>
+
+#if __GNUC__ > 4 && !__clang__ && CLIB_DEBUG == 0
+#pragma GCC optimize("O3")
+#endif
+
+/* ops handed to the multi-buffer kernel at once */
+#define CHACHA20_POLY1305_BATCH_SIZE 32
+
+static_always_inline u32
+chacha20_poly1305_ops (vnet_crypto_op_t *ops[], u32 n_ops,
+		       clib_chacha20_poly1305_op_t op_type, u32 fixed,
+		       u32 aad_len)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  clib_chacha20_poly1305_msg_t msgs[CHACHA20_POLY1305_BATCH_SIZE];
+  u32 n_fail = 0;
+
+  for (u32 i = 0; i < n_ops; i += CHACHA20_POLY1305_BATCH_SIZE)
+    {
+      u32 n = clib_min (n_ops - i, CHACHA20_POLY1305_BATCH_SIZE);
+
+      for (u32 j = 0; j < n; j++)
+	{
+	  vnet_crypto_op_t *op = ops[i + j];
+	  msgs[j] = (clib_chacha20_poly1305_msg_t){
+	    .key = cm->key_data[op->key_index],
+	    .nonce = op->iv,
+	    .aad = op->aad,
+	    .src = op->src,
+	    .dst = op->dst,
+	    .tag = op->tag,
+	    .len = op->len,
+	    .aad_len = fixed ? aad_len : op->aad_len,
+	    .tag_len = fixed ? 16 : clib_min (op->tag_len, 16),
+	  };
+	}
+
+      clib_chacha20_poly1305_mb (msgs, n, op_type);
+
+      for (u32 j = 0; j < n; j++)
+	{
+	  if (msgs[j].bad_tag)
+	    {
+	      ops[i + j]->status = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+	      n_fail++;
+	    }
+	  else
+	    ops[i + j]->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+	}
+    }
+
+  return n_ops - n_fail;
+}
+
+static_always_inline u32
+chacha20_poly1305_chained_ops (vnet_crypto_op_t *ops[],
+			       vnet_crypto_op_chunk_t *chunks, u32 n_ops,
+			       clib_chacha20_poly1305_op_t op_type, u32 fixed,
+			       u32 aad_len)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  clib_chacha20_poly1305_ctx_t ctx;
+  u32 n_fail = 0;
+  u8 tag[16];
+
+  for (u32 i = 0; i < n_ops; i++)
+    {
+      vnet_crypto_op_t *op = ops[i];
+      vnet_crypto_op_chunk_t *chp = chunks + op->chunk_index;
+      u32 tag_len = fixed ? 16 : clib_min (op->tag_len, 16);
+
+      clib_chacha20_poly1305_init (&ctx, cm->key_data[op->key_index], op->iv,
+				   op->aad, fixed ? aad_len : op->aad_len);
+      for (int j = 0; j < op->n_chunks; j++, chp++)
+	clib_chacha20_poly1305_update (&ctx, chp->src, chp->dst, chp->len,
+				       op_type);
+      clib_chacha20_poly1305_final (&ctx, tag);
+
+      if (op_type == CLIB_CHACHA20_POLY1305_OP_ENCRYPT)
+	clib_memcpy_fast (op->tag, tag, tag_len);
+      else if (_clib_chacha20_poly1305_tag_cmp (op->tag, tag, tag_len))
+	{
+	  op->status = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+	  n_fail++;
+	  continue;
+	}
+
+      op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+    }
+
+  return n_ops - n_fail;
+}
+
+static void *
+chacha20_poly1305_key_exp (vnet_crypto_key_t *key)
+{
+  u8 *kd;
+
+  kd = clib_mem_alloc_aligned (CLIB_CHACHA20_KEY_LEN, CLIB_CACHE_LINE_BYTES);
+  clib_memcpy_fast (kd, key->data, CLIB_CHACHA20_KEY_LEN);
+
+  return kd;
+}
+
+/* function suffix, op id suffix, fixed, aad length */
+#define foreach_chacha20_poly1305_handler_type                                \
+  _ (, , 0, 0)                                                                \
+  _ (_tag16_aad0, _TAG16_AAD0, 1, 0)                                          \
+  _ (_tag16_aad8, _TAG16_AAD8, 1, 8)                                          \
+  _ (_tag16_aad12, _TAG16_AAD12, 1, 12)
+
+#define _(x, X, f, a)                                                         \
+  static u32 chacha20_poly1305_enc##x (vlib_main_t *vm,                       \
+				       vnet_crypto_op_t *ops[], u32 n_ops)    \
+  {                                                                           \
+    return chacha20_poly1305_ops (ops, n_ops,                                 \
+				  CLIB_CHACHA20_POLY1305_OP_ENCRYPT, f, a);   \
+  }                                                                           \
+  static u32 chacha20_poly1305_dec##x (vlib_main_t *vm,                       \
+				       vnet_crypto_op_t *ops[], u32 n_ops)    \
+  {                                                                           \
+    return chacha20_poly1305_ops (ops, n_ops,                                 \
+				  CLIB_CHACHA20_POLY1305_OP_DECRYPT, f, a);   \
+  }                                                                           \
+  static u32 chacha20_poly1305_enc##x##_chained (                             \
+    vlib_main_t *vm, vnet_crypto_op_t *ops[], vnet_crypto_op_chunk_t *chunks, \
+    u32 n_ops)                                                                \
+  {                                                                           \
+    return chacha20_poly1305_chained_ops (                                    \
+      ops, chunks, n_ops, CLIB_CHACHA20_POLY1305_OP_ENCRYPT, f, a);           \
+  }                                                                           \
+  static u32 chacha20_poly1305_dec##x##_chained (                             \
+    vlib_main_t *vm, vnet_crypto_op_t *ops[], vnet_crypto_op_chunk_t *chunks, \
+    u32 n_ops)                                                                \
+  {                                                                           \
+    return chacha20_poly1305_chained_ops (                                    \
+      ops, chunks, n_ops, CLIB_CHACHA20_POLY1305_OP_DECRYPT, f, a);           \
+  }
+
+foreach_chacha20_poly1305_handler_type;
+#undef _
+
+static int
+probe ()
+{
+#if defined(__AVX512F__) && defined(CLIB_HAVE_VEC512)
+  if (clib_cpu_supports_avx512f ())
+    return 50;
+#elif defined(__AVX512F__)
+  if (clib_cpu_supports_avx512f ())
+    return 30;
+#elif defined(__AVX2__)
+  if (clib_cpu_supports_avx2 ())
+    return 20;
+#elif defined(__SSE4_2__)
+  if (clib_cpu_supports_sse42 ())
+    return 10;
+#elif __aarch64__
+  return 10;
+#endif
+  return -1;
+}
+
+#define _(x, X, f, a)                                                         \
+  CRYPTO_NATIVE_OP_HANDLER (chacha20_poly1305_enc##x) = {                     \
+    .op_id = VNET_CRYPTO_OP_CHACHA20_POLY1305##X##_ENC,                       \
+    .fn = chacha20_poly1305_enc##x,                                           \
+    .cfn = chacha20_poly1305_enc##x##_chained,                                \
+    .probe = probe,                                                           \
+  };                                                                          \
+                                                                              \
+  CRYPTO_NATIVE_OP_HANDLER (chacha20_poly1305_dec##x) = {                     \
+    .op_id = VNET_CRYPTO_OP_CHACHA20_POLY1305##X##_DEC,                       \
+    .fn = chacha20_poly1305_dec##x,                                           \
+    .cfn = chacha20_poly1305_dec##x##_chained,                                \
+    .probe = probe,                                                           \
+  };
+
+foreach_chacha20_poly1305_handler_type;
+#undef _
+
+CRYPTO_NATIVE_KEY_HANDLER (chacha20_poly1305) = {
+  .alg_id = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .key_fn = chacha20_poly1305_key_exp,
+  .probe = probe,
+};
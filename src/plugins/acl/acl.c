@@ -39,6 +39,7 @@
 
 #include "fa_node.h"
 #include "public_inlines.h"
+#include "compiled_lookup.h"
 
 acl_main_t acl_main;
 
@@ -2560,6 +2561,12 @@ acl_set_aclplugin_fn (vlib_main_t * vm,
       am->use_hash_acl_matching = (val != 0);
       goto done;
     }
+  if (unformat (input, "use-compiled-acl-matching %u", &val))
+    {
+      am->use_compiled_acl_matching = (val != 0);
+      compiled_acl_rebuild_all (am);
+      goto done;
+    }
   if (unformat (input, "l4-match-nonfirst-fragment %u", &val))
     {
       am->l4_match_nonfirst_fragment = (val != 0);
@@ -3620,6 +3627,8 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
   int show_mask_type = 0;
   int show_bihash = 0;
   u32 show_bihash_verbose = 0;
+  int show_compiled = 0;
+  u32 show_compiled_verbose = 0;
 
   if (unformat (input, "acl"))
     {
@@ -3642,21 +3651,30 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
       show_bihash = 1;
       unformat (input, "verbose %u", &show_bihash_verbose);
     }
+  else if (unformat (input, "compiled"))
+    {
+      show_compiled = 1;
+      unformat (input, "lc_index %u", &lc_index);
+      unformat (input, "verbose %u", &show_compiled_verbose);
+    }
 
   if (!
       (show_mask_type || show_acl_hash_info || show_applied_info
-       || show_bihash))
+       || show_bihash || show_compiled))
     {
       /* if no qualifiers specified, show all */
       show_mask_type = 1;
       show_acl_hash_info = 1;
       show_applied_info = 1;
       show_bihash = 1;
+      show_compiled = 1;
     }
   vlib_cli_output (vm, "Stats counters enabled for interface ACLs: %d",
 		   acl_main.interface_acl_counters_enabled);
   vlib_cli_output (vm, "Use hash-based lookup for ACLs: %d",
 		   acl_main.use_hash_acl_matching);
+  vlib_cli_output (vm, "Use compiled lookup for ACLs: %d",
+		   acl_main.use_compiled_acl_matching);
   if (show_mask_type)
     acl_plugin_show_tables_mask_type ();
   if (show_acl_hash_info)
@@ -3665,6 +3683,8 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
     acl_plugin_show_tables_applied_info (lc_index);
   if (show_bihash)
     acl_plugin_show_tables_bihash (show_bihash_verbose);
+  if (show_compiled)
+    acl_plugin_show_tables_compiled_info (lc_index, show_compiled_verbose);
 
   return error;
 }
@@ -3730,7 +3750,7 @@ VLIB_CLI_COMMAND (aclplugin_show_sessions_command, static) = {
 
 VLIB_CLI_COMMAND (aclplugin_show_tables_command, static) = {
     .path = "show acl-plugin tables",
-    .short_help = "show acl-plugin tables [ acl [index N] | applied [ lc_index N ] | mask | hash [verbose N] ]",
+    .short_help = "show acl-plugin tables [ acl [index N] | applied [ lc_index N ] | mask | hash [verbose N] | compiled [ lc_index N ] [verbose N] ]",
     .function = acl_show_aclplugin_tables_fn,
 };
 
@@ -3868,6 +3888,7 @@ acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
   uword hash_lookup_hash_memory;
   u32 reclassify_sessions;
   u32 use_tuple_merge;
+  u32 use_compiled_acl_matching;
   u32 tuple_merge_split_threshold;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
@@ -3911,6 +3932,9 @@ acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
 	    (input, "tuple merge split threshold %d",
 	     &tuple_merge_split_threshold))
 	am->tuple_merge_split_threshold = tuple_merge_split_threshold;
+      else if (unformat (input, "use compiled acl matching %d",
+			 &use_compiled_acl_matching))
+	am->use_compiled_acl_matching = use_compiled_acl_matching;
 
       else if (unformat (input, "reclassify sessions %d",
 			 &reclassify_sessions))
@@ -32,6 +32,7 @@
 #include "types.h"
 #include "fa_node.h"
 #include "hash_lookup_types.h"
+#include "compiled_lookup_types.h"
 #include "lookup_context.h"
 
 #define  ACL_PLUGIN_VERSION_MAJOR 1
@@ -189,6 +190,14 @@ typedef struct {
   /* vec of vectors of all info of all mask types present in ACEs contained in each lc_index */
   hash_applied_mask_info_t **hash_applied_mask_info_vec_by_lc_index;
 
+  /* Do we use the compiled decision-tree ACL matching where it is built */
+  int use_compiled_acl_matching;
+
+  /* compiled lookup structures by lc_index, published with a single store */
+  compiled_acl_context_t **compiled_acl_context_by_lc_index;
+  u32 compiled_acl_n_builds;
+  u32 compiled_acl_n_build_failures;
+
   /*
    * Classify tables used to grab the packets for the ACL check,
    * and serving as the 5-tuple session tables at the same time
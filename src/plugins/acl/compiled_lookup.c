@@ -0,0 +1,553 @@
+/*
+ *------------------------------------------------------------------
+ * compiled_lookup.c - decision tree ACL lookup
+ *
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+/*
+ * The ACEs of a lookup context are seen as boxes in a seven dimensional
+ * space (source and destination address halves, protocol, ports), and
+ * the space is cut HyperSplit-style: every inner node splits one
+ * dimension in two at the rule endpoint which best balances the number
+ * of rules on either side. A packet walks at most COMPILED_ACL_MAX_DEPTH
+ * nodes and then checks the few ACEs of its leaf in priority order, so
+ * unlike the partitioned hash lookup the cost does not depend on how
+ * much the port ranges of the rules overlap. A leaf is never larger
+ * than COMPILED_ACL_MAX_LEAF_RULES: a context needing a bigger one is
+ * not compiled, just like one that replicates its rules too much.
+ *
+ * The trees are only a filter: the leaf check uses the same
+ * single_rule_match_5tuple() as the other engines, so TCP flags,
+ * l4_valid, and the address bits beyond the prefix length are handled
+ * exactly as before.
+ */
+
+#include <stddef.h>
+#include <vlib/vlib.h>
+
+#include "acl.h"
+#include "compiled_lookup.h"
+
+typedef struct
+{
+  u64 lo[COMPILED_ACL_N_DIMS];
+  u64 hi[COMPILED_ACL_N_DIMS];
+} compiled_acl_box_t;
+
+typedef struct
+{
+  compiled_acl_context_t *ctx;
+  compiled_acl_tree_t *tree;
+  /* the box of each ACE, by index in ctx->aces */
+  compiled_acl_box_t *boxes;
+  /* scratch space for the split selection */
+  u64 *los;
+  u64 *his;
+  u32 max_leaf_entries;
+  int failed;
+} compiled_acl_build_t;
+
+static void
+compiled_acl_prefix_range (u64 addr, u32 len, u32 width, u64 *lo, u64 *hi)
+{
+  u64 all = (width == 64) ? ~0ULL : ((1ULL << width) - 1);
+  u64 mask = len ? ((all << (width - len)) & all) : 0;
+
+  *lo = addr & mask;
+  *hi = (addr | ~mask) & all;
+}
+
+/*
+ * Compute the box covering the packets an ACE may match.
+ * Returns 0 if the ACE can not match anything.
+ */
+static int
+compiled_acl_rule_box (acl_rule_t *r, compiled_acl_box_t *box)
+{
+  u32 len;
+
+  if (r->is_ipv6)
+    {
+      len = clib_min (r->src_prefixlen, 128);
+      compiled_acl_prefix_range (clib_net_to_host_u64 (r->src.ip6.as_u64[0]),
+				 clib_min (len, 64), 64,
+				 &box->lo[COMPILED_ACL_DIM_SRC_HI],
+				 &box->hi[COMPILED_ACL_DIM_SRC_HI]);
+      compiled_acl_prefix_range (clib_net_to_host_u64 (r->src.ip6.as_u64[1]),
+				 len > 64 ? len - 64 : 0, 64,
+				 &box->lo[COMPILED_ACL_DIM_SRC_LO],
+				 &box->hi[COMPILED_ACL_DIM_SRC_LO]);
+      len = clib_min (r->dst_prefixlen, 128);
+      compiled_acl_prefix_range (clib_net_to_host_u64 (r->dst.ip6.as_u64[0]),
+				 clib_min (len, 64), 64,
+				 &box->lo[COMPILED_ACL_DIM_DST_HI],
+				 &box->hi[COMPILED_ACL_DIM_DST_HI]);
+      compiled_acl_prefix_range (clib_net_to_host_u64 (r->dst.ip6.as_u64[1]),
+				 len > 64 ? len - 64 : 0, 64,
+				 &box->lo[COMPILED_ACL_DIM_DST_LO],
+				 &box->hi[COMPILED_ACL_DIM_DST_LO]);
+    }
+  else
+    {
+      box->lo[COMPILED_ACL_DIM_SRC_HI] = box->hi[COMPILED_ACL_DIM_SRC_HI] = 0;
+      box->lo[COMPILED_ACL_DIM_DST_HI] = box->hi[COMPILED_ACL_DIM_DST_HI] = 0;
+      compiled_acl_prefix_range (clib_net_to_host_u32 (r->src.ip4.as_u32),
+				 clib_min (r->src_prefixlen, 32), 32,
+				 &box->lo[COMPILED_ACL_DIM_SRC_LO],
+				 &box->hi[COMPILED_ACL_DIM_SRC_LO]);
+      compiled_acl_prefix_range (clib_net_to_host_u32 (r->dst.ip4.as_u32),
+				 clib_min (r->dst_prefixlen, 32), 32,
+				 &box->lo[COMPILED_ACL_DIM_DST_LO],
+				 &box->hi[COMPILED_ACL_DIM_DST_LO]);
+    }
+
+  if (r->proto)
+    {
+      box->lo[COMPILED_ACL_DIM_PROTO] = box->hi[COMPILED_ACL_DIM_PROTO] =
+	r->proto;
+      box->lo[COMPILED_ACL_DIM_SPORT] = r->src_port_or_type_first;
+      box->hi[COMPILED_ACL_DIM_SPORT] = r->src_port_or_type_last;
+      box->lo[COMPILED_ACL_DIM_DPORT] = r->dst_port_or_code_first;
+      box->hi[COMPILED_ACL_DIM_DPORT] = r->dst_port_or_code_last;
+      if (r->src_port_or_type_first > r->src_port_or_type_last ||
+	  r->dst_port_or_code_first > r->dst_port_or_code_last)
+	return 0;
+    }
+  else
+    {
+      box->lo[COMPILED_ACL_DIM_PROTO] = 0;
+      box->hi[COMPILED_ACL_DIM_PROTO] = 255;
+      box->lo[COMPILED_ACL_DIM_SPORT] = 0;
+      box->hi[COMPILED_ACL_DIM_SPORT] = 65535;
+      box->lo[COMPILED_ACL_DIM_DPORT] = 0;
+      box->hi[COMPILED_ACL_DIM_DPORT] = 65535;
+    }
+  return 1;
+}
+
+static void
+compiled_acl_full_box (int is_ip6, compiled_acl_box_t *box)
+{
+  box->lo[COMPILED_ACL_DIM_SRC_HI] = box->lo[COMPILED_ACL_DIM_DST_HI] = 0;
+  box->hi[COMPILED_ACL_DIM_SRC_HI] = box->hi[COMPILED_ACL_DIM_DST_HI] =
+    is_ip6 ? ~0ULL : 0;
+  box->lo[COMPILED_ACL_DIM_SRC_LO] = box->lo[COMPILED_ACL_DIM_DST_LO] = 0;
+  box->hi[COMPILED_ACL_DIM_SRC_LO] = box->hi[COMPILED_ACL_DIM_DST_LO] =
+    is_ip6 ? ~0ULL : 0xffffffff;
+  box->lo[COMPILED_ACL_DIM_PROTO] = 0;
+  box->hi[COMPILED_ACL_DIM_PROTO] = 255;
+  box->lo[COMPILED_ACL_DIM_SPORT] = box->lo[COMPILED_ACL_DIM_DPORT] = 0;
+  box->hi[COMPILED_ACL_DIM_SPORT] = box->hi[COMPILED_ACL_DIM_DPORT] = 65535;
+}
+
+static int
+compiled_acl_u64_cmp (void *a1, void *a2)
+{
+  u64 v1 = *(u64 *) a1, v2 = *(u64 *) a2;
+  return (v1 < v2) ? -1 : (v1 > v2);
+}
+
+/* the number of elements <= s in a sorted vector */
+static u32
+compiled_acl_n_le (u64 *v, u64 s)
+{
+  u32 lo = 0, hi = vec_len (v);
+
+  while (lo < hi)
+    {
+      u32 mid = (lo + hi) / 2;
+      if (v[mid] <= s)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/*
+ * Find the cut which minimizes the number of rules on the bigger side,
+ * and then the total number of rules on both sides (the replication).
+ * Returns 0 if no cut reduces the number of rules on both sides.
+ */
+static int
+compiled_acl_choose_split (compiled_acl_build_t *b, u32 *rules,
+			   compiled_acl_box_t *region, u8 *r_dim, u64 *r_split)
+{
+  u32 n = vec_len (rules);
+  u32 best_max = n, best_sum = ~0;
+  u32 i, j, d, n_left, n_right;
+  u64 s;
+  int found = 0;
+
+  for (d = 0; d < COMPILED_ACL_N_DIMS; d++)
+    {
+      if (region->lo[d] == region->hi[d])
+	continue;
+
+      vec_reset_length (b->los);
+      vec_reset_length (b->his);
+      for (i = 0; i < n; i++)
+	{
+	  compiled_acl_box_t *box = &b->boxes[rules[i]];
+	  vec_add1 (b->los, clib_max (box->lo[d], region->lo[d]));
+	  vec_add1 (b->his, clib_min (box->hi[d], region->hi[d]));
+	}
+      vec_sort_with_function (b->los, compiled_acl_u64_cmp);
+      vec_sort_with_function (b->his, compiled_acl_u64_cmp);
+
+      /*
+       * A cut at s sends [lo, s] left and [s + 1, hi] right, so the
+       * interesting cuts are just below the start or at the end of a rule.
+       */
+      for (j = 0; j < 2 * n; j++)
+	{
+	  if (j < n)
+	    {
+	      if (b->his[j] >= region->hi[d])
+		continue;
+	      s = b->his[j];
+	    }
+	  else
+	    {
+	      if (b->los[j - n] <= region->lo[d])
+		continue;
+	      s = b->los[j - n] - 1;
+	    }
+	  n_left = compiled_acl_n_le (b->los, s);
+	  n_right = n - compiled_acl_n_le (b->his, s);
+	  if (clib_max (n_left, n_right) < best_max ||
+	      (clib_max (n_left, n_right) == best_max &&
+	       n_left + n_right < best_sum))
+	    {
+	      best_max = clib_max (n_left, n_right);
+	      best_sum = n_left + n_right;
+	      *r_dim = d;
+	      *r_split = s;
+	      found = 1;
+	    }
+	}
+    }
+  return found;
+}
+
+static u32
+compiled_acl_build_node (compiled_acl_build_t *b, u32 *rules,
+			 compiled_acl_box_t *region, u32 depth)
+{
+  compiled_acl_tree_t *tree = b->tree;
+  compiled_acl_node_t *node;
+  compiled_acl_box_t sub_region;
+  u32 *sub_rules = 0;
+  u32 node_index, child, i, d;
+  u64 split = 0;
+  u8 dim = 0;
+
+  /*
+   * A protocol-agnostic ACE covering the whole region matches
+   * every packet that gets here, so nothing after it matters.
+   */
+  for (i = 0; i < vec_len (rules); i++)
+    {
+      compiled_acl_box_t *box = &b->boxes[rules[i]];
+      if (b->ctx->aces[rules[i]].rule.proto)
+	continue;
+      for (d = 0; d < COMPILED_ACL_N_DIMS; d++)
+	if (box->lo[d] > region->lo[d] || box->hi[d] < region->hi[d])
+	  break;
+      if (d == COMPILED_ACL_N_DIMS)
+	{
+	  vec_set_len (rules, i + 1);
+	  break;
+	}
+    }
+
+  vec_add2 (tree->nodes, node, 1);
+  node_index = node - tree->nodes;
+  tree->max_depth = clib_max (tree->max_depth, depth);
+
+  if (vec_len (rules) <= COMPILED_ACL_LEAF_RULES ||
+      depth >= COMPILED_ACL_MAX_DEPTH ||
+      !compiled_acl_choose_split (b, rules, region, &dim, &split))
+    {
+      node->is_leaf = 1;
+      node->first_rule = vec_len (tree->leaf_rules);
+      node->n_rules = vec_len (rules);
+      vec_append (tree->leaf_rules, rules);
+      tree->n_leaves++;
+      tree->max_leaf_rules = clib_max (tree->max_leaf_rules, node->n_rules);
+      if (vec_len (tree->leaf_rules) > b->max_leaf_entries ||
+	  node->n_rules > COMPILED_ACL_MAX_LEAF_RULES)
+	b->failed = 1;
+      return node_index;
+    }
+
+  node->dim = dim;
+  node->split = split;
+
+  for (child = 0; child < 2 && !b->failed; child++)
+    {
+      sub_region = *region;
+      if (child)
+	sub_region.lo[dim] = split + 1;
+      else
+	sub_region.hi[dim] = split;
+
+      vec_reset_length (sub_rules);
+      for (i = 0; i < vec_len (rules); i++)
+	{
+	  compiled_acl_box_t *box = &b->boxes[rules[i]];
+	  if (box->lo[dim] <= sub_region.hi[dim] &&
+	      box->hi[dim] >= sub_region.lo[dim])
+	    vec_add1 (sub_rules, rules[i]);
+	}
+      i = compiled_acl_build_node (b, sub_rules, &sub_region, depth + 1);
+      /* the node vector may have moved */
+      tree->nodes[node_index].child[child] = i;
+    }
+  vec_free (sub_rules);
+  return node_index;
+}
+
+static void
+compiled_acl_build_tree (compiled_acl_build_t *b, int is_ip6)
+{
+  compiled_acl_context_t *ctx = b->ctx;
+  compiled_acl_box_t region;
+  u32 *rules = 0;
+  u32 i;
+
+  b->tree = &ctx->trees[is_ip6];
+  for (i = 0; i < vec_len (ctx->aces); i++)
+    if (ctx->aces[i].rule.is_ipv6 == is_ip6 &&
+	compiled_acl_rule_box (&ctx->aces[i].rule, &b->boxes[i]))
+      vec_add1 (rules, i);
+
+  b->max_leaf_entries =
+    COMPILED_ACL_MAX_REPLICATION * vec_len (rules) + 1024;
+  compiled_acl_full_box (is_ip6, &region);
+  compiled_acl_build_node (b, rules, &region, 0);
+  vec_free (rules);
+}
+
+static void
+compiled_acl_context_free (compiled_acl_context_t *ctx)
+{
+  int i;
+
+  for (i = 0; i < ARRAY_LEN (ctx->trees); i++)
+    {
+      vec_free (ctx->trees[i].nodes);
+      vec_free (ctx->trees[i].leaf_rules);
+    }
+  vec_free (ctx->aces);
+  clib_mem_free (ctx);
+}
+
+static void
+compiled_acl_context_free_deferred (uword data)
+{
+  compiled_acl_context_free (uword_to_pointer (data, compiled_acl_context_t *));
+}
+
+/*
+ * Swap in the new tree with a single store, so the workers see either
+ * the old or the new one, and reclaim the old one after every worker
+ * has gone around its loop at least once.
+ */
+static void
+compiled_acl_publish (acl_main_t *am, u32 lc_index,
+		      compiled_acl_context_t *ctx)
+{
+  compiled_acl_context_t *old;
+
+  vec_validate (am->compiled_acl_context_by_lc_index, lc_index);
+  old = am->compiled_acl_context_by_lc_index[lc_index];
+  clib_atomic_store_rel_n (&am->compiled_acl_context_by_lc_index[lc_index],
+			   ctx);
+  if (old)
+    vlib_worker_defer_one_loop (compiled_acl_context_free_deferred,
+				pointer_to_uword (old));
+}
+
+void
+compiled_acl_build (acl_main_t *am, u32 lc_index)
+{
+  acl_lookup_context_t *acontext =
+    pool_elt_at_index (am->acl_lookup_contexts, lc_index);
+  compiled_acl_build_t b = {};
+  compiled_acl_context_t *ctx;
+  compiled_ace_t *ace;
+  acl_rule_t *r;
+  f64 t0 = vlib_time_now (am->vlib_main);
+  u32 i, acl_index;
+  int is_ip6;
+
+  ctx = clib_mem_alloc (sizeof (*ctx));
+  clib_memset (ctx, 0, sizeof (*ctx));
+
+  for (i = 0; i < vec_len (acontext->acl_indices); i++)
+    {
+      acl_index = acontext->acl_indices[i];
+      /* a missing ACL never matches, same as in the linear lookup */
+      if (pool_is_free_index (am->acls, acl_index))
+	continue;
+      vec_foreach (r, am->acls[acl_index].rules)
+	{
+	  vec_add2 (ctx->aces, ace, 1);
+	  ace->rule = *r;
+	  ace->acl_index = acl_index;
+	  ace->ace_index = r - am->acls[acl_index].rules;
+	  ace->acl_position = i;
+	}
+    }
+
+  b.ctx = ctx;
+  vec_validate (b.boxes, vec_len (ctx->aces));
+  for (is_ip6 = 0; is_ip6 < 2 && !b.failed; is_ip6++)
+    compiled_acl_build_tree (&b, is_ip6);
+  vec_free (b.boxes);
+  vec_free (b.los);
+  vec_free (b.his);
+
+  am->compiled_acl_n_builds++;
+  if (b.failed)
+    {
+      clib_warning ("ACL: lc_index %d does not compile within %dx "
+		    "replication and %d rules per leaf, using the "
+		    "non-compiled lookup",
+		    lc_index, COMPILED_ACL_MAX_REPLICATION,
+		    COMPILED_ACL_MAX_LEAF_RULES);
+      am->compiled_acl_n_build_failures++;
+      compiled_acl_context_free (ctx);
+      compiled_acl_free (am, lc_index);
+      return;
+    }
+
+  ctx->memory_size = sizeof (*ctx) + vec_mem_size (ctx->aces);
+  for (is_ip6 = 0; is_ip6 < 2; is_ip6++)
+    ctx->memory_size += vec_mem_size (ctx->trees[is_ip6].nodes) +
+			vec_mem_size (ctx->trees[is_ip6].leaf_rules);
+  ctx->build_time = vlib_time_now (am->vlib_main) - t0;
+
+  compiled_acl_publish (am, lc_index, ctx);
+}
+
+void
+compiled_acl_free (acl_main_t *am, u32 lc_index)
+{
+  if (lc_index < vec_len (am->compiled_acl_context_by_lc_index))
+    compiled_acl_publish (am, lc_index, 0);
+}
+
+void
+compiled_acl_rebuild_by_acl (acl_main_t *am, u32 acl_index)
+{
+  u32 *lc_index;
+
+  if (!am->use_compiled_acl_matching ||
+      acl_index >= vec_len (am->lc_index_vec_by_acl))
+    return;
+
+  vec_foreach (lc_index, am->lc_index_vec_by_acl[acl_index])
+    compiled_acl_build (am, *lc_index);
+}
+
+void
+compiled_acl_rebuild_all (acl_main_t *am)
+{
+  acl_lookup_context_t *acontext;
+  u32 lc_index;
+
+  for (lc_index = 0; lc_index < vec_len (am->compiled_acl_context_by_lc_index);
+       lc_index++)
+    compiled_acl_free (am, lc_index);
+
+  if (!am->use_compiled_acl_matching)
+    return;
+
+  pool_foreach (acontext, am->acl_lookup_contexts)
+    compiled_acl_build (am, acontext - am->acl_lookup_contexts);
+}
+
+static void
+compiled_acl_show_node (vlib_main_t *vm, compiled_acl_context_t *ctx,
+			compiled_acl_tree_t *tree, u32 node_index, u32 depth)
+{
+  compiled_acl_node_t *node = &tree->nodes[node_index];
+  compiled_ace_t *ace;
+  u32 i;
+
+  if (node->is_leaf)
+    {
+      vlib_cli_output (vm, "%Uleaf %d rules:", format_white_space, 2 * depth,
+		       node->n_rules);
+      for (i = 0; i < node->n_rules; i++)
+	{
+	  ace = &ctx->aces[tree->leaf_rules[node->first_rule + i]];
+	  vlib_cli_output (vm, "%U  acl %d rule %d position %d action %d",
+			   format_white_space, 2 * depth, ace->acl_index,
+			   ace->ace_index, ace->acl_position,
+			   ace->rule.is_permit);
+	}
+      return;
+    }
+  vlib_cli_output (vm, "%Udim %d <= 0x%llx", format_white_space, 2 * depth,
+		   node->dim, node->split);
+  compiled_acl_show_node (vm, ctx, tree, node->child[0], depth + 1);
+  vlib_cli_output (vm, "%Udim %d > 0x%llx", format_white_space, 2 * depth,
+		   node->dim, node->split);
+  compiled_acl_show_node (vm, ctx, tree, node->child[1], depth + 1);
+}
+
+void
+acl_plugin_show_tables_compiled_info (u32 lc_index, u32 verbose)
+{
+  acl_main_t *am = &acl_main;
+  vlib_main_t *vm = am->vlib_main;
+  compiled_acl_context_t *ctx;
+  compiled_acl_tree_t *tree;
+  u32 lci;
+  int is_ip6;
+
+  vlib_cli_output (vm, "Compiled lookup: %d builds, %d failed",
+		   am->compiled_acl_n_builds,
+		   am->compiled_acl_n_build_failures);
+  for (lci = 0; lci < vec_len (am->compiled_acl_context_by_lc_index); lci++)
+    {
+      if ((lc_index != ~0) && (lc_index != lci))
+	continue;
+      ctx = am->compiled_acl_context_by_lc_index[lci];
+      if (!ctx)
+	continue;
+      vlib_cli_output (vm,
+		       "lc_index %d: %d rules, built in %.6f sec, "
+		       "memory %U",
+		       lci, vec_len (ctx->aces), ctx->build_time,
+		       format_memory_size, ctx->memory_size);
+      for (is_ip6 = 0; is_ip6 < 2; is_ip6++)
+	{
+	  tree = &ctx->trees[is_ip6];
+	  vlib_cli_output (vm,
+			   "  %s: %d nodes, %d leaves, depth %d, "
+			   "max leaf rules %d, leaf entries %d",
+			   is_ip6 ? "ip6" : "ip4", vec_len (tree->nodes),
+			   tree->n_leaves, tree->max_depth,
+			   tree->max_leaf_rules, vec_len (tree->leaf_rules));
+	  if (verbose)
+	    compiled_acl_show_node (vm, ctx, tree, 0, 2);
+	}
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef _ACL_COMPILED_LOOKUP_H_
+#define _ACL_COMPILED_LOOKUP_H_
+
+#include <stddef.h>
+#include "lookup_context.h"
+#include "acl.h"
+
+/*
+ * (Re)compile the ACLs of a lookup context into a decision tree and
+ * publish it for the dataplane. The previous tree, if any, is freed once
+ * the workers can no longer be using it. If the build fails, the lookups
+ * in the context fall back to the hash or linear matching.
+ */
+
+void compiled_acl_build(acl_main_t *am, u32 lc_index);
+
+/* Drop the compiled representation of a lookup context */
+
+void compiled_acl_free(acl_main_t *am, u32 lc_index);
+
+/*
+ * Rebuild the compiled representation of all the lookup contexts
+ * which use a given ACL, e.g. after the ACL has been modified.
+ */
+
+void compiled_acl_rebuild_by_acl(acl_main_t *am, u32 acl_index);
+
+/* Build or free all the compiled contexts, following use_compiled_acl_matching */
+
+void compiled_acl_rebuild_all(acl_main_t *am);
+
+void acl_plugin_show_tables_compiled_info(u32 lc_index, u32 verbose);
+
+#endif
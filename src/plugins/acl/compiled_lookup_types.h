@@ -0,0 +1,95 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef _ACL_COMPILED_LOOKUP_TYPES_H_
+#define _ACL_COMPILED_LOOKUP_TYPES_H_
+
+#include "types.h"
+
+/*
+ * The dimensions of the compiled lookup key. IPv4 addresses live
+ * in the "lo" dimensions, with the "hi" dimensions being always zero.
+ */
+typedef enum {
+  COMPILED_ACL_DIM_SRC_HI,
+  COMPILED_ACL_DIM_SRC_LO,
+  COMPILED_ACL_DIM_DST_HI,
+  COMPILED_ACL_DIM_DST_LO,
+  COMPILED_ACL_DIM_PROTO,
+  COMPILED_ACL_DIM_SPORT,
+  COMPILED_ACL_DIM_DPORT,
+  COMPILED_ACL_N_DIMS,
+} compiled_acl_dim_t;
+
+/* stop splitting once a node has this many candidate rules or fewer */
+#define COMPILED_ACL_LEAF_RULES 8
+/* the hard bound on the number of nodes a lookup visits */
+#define COMPILED_ACL_MAX_DEPTH 32
+/*
+ * a leaf which cannot be split any further (the maximum depth was
+ * reached, or no cut separates its rules) may hold up to this many
+ * rules; above that the context is left to the non-compiled lookup
+ */
+#define COMPILED_ACL_MAX_LEAF_RULES 64
+/* give up on a tree that replicates rules more than this on average */
+#define COMPILED_ACL_MAX_REPLICATION 64
+
+/* The copy of an applied ACE, in the priority order of the lookup context */
+typedef struct {
+  acl_rule_t rule;
+  u32 acl_index;
+  u32 ace_index;
+  u32 acl_position;
+} compiled_ace_t;
+
+/*
+ * The node of a HyperSplit-style decision tree. An inner node sends the
+ * key to child[key[dim] > split]; a leaf holds n_rules candidate ACEs,
+ * in priority order, starting at first_rule within the leaf rule vector.
+ */
+typedef struct {
+  u64 split;
+  union {
+    u32 child[2];
+    struct {
+      u32 first_rule;
+      u32 n_rules;
+    };
+  };
+  u8 dim;
+  u8 is_leaf;
+} compiled_acl_node_t;
+
+typedef struct {
+  compiled_acl_node_t *nodes;	/* nodes[0] is the root */
+  u32 *leaf_rules;		/* indices into compiled_acl_context_t.aces */
+  u32 n_leaves;
+  u32 max_depth;
+  u32 max_leaf_rules;
+} compiled_acl_tree_t;
+
+/* The compiled representation of all the ACLs of one lookup context */
+typedef struct {
+  compiled_ace_t *aces;
+  /* indexed by is_ip6 */
+  compiled_acl_tree_t trees[2];
+  /* how long the build took, in seconds, and what the result takes */
+  f64 build_time;
+  uword memory_size;
+} compiled_acl_context_t;
+
+#endif
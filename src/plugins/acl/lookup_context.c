@@ -18,6 +18,7 @@
 #include <vlib/unix/plugin.h>
 #include <plugins/acl/public_inlines.h>
 #include "hash_lookup.h"
+#include "compiled_lookup.h"
 #include "elog_acl_trace.h"
 
 /* check if a given ACL exists */
@@ -205,6 +206,7 @@ static void acl_plugin_put_lookup_context_index (u32 lc_index)
   vec_del1(am->acl_users[acontext->context_user_id].lookup_contexts, index);
   unapply_acl_vec(lc_index, acontext->acl_indices);
   unlock_acl_vec(lc_index, acontext->acl_indices);
+  compiled_acl_free(am, lc_index);
   vec_free(acontext->acl_indices);
   pool_put(am->acl_lookup_contexts, acontext);
 }
@@ -258,6 +260,8 @@ static int acl_plugin_set_acl_vec_for_context (u32 lc_index, u32 *acl_list)
   unlock_acl_vec(lc_index, old_acl_vector);
   lock_acl_vec(lc_index, acontext->acl_indices);
   apply_acl_vec(lc_index, acontext->acl_indices);
+  if (am->use_compiled_acl_matching)
+    compiled_acl_build(am, lc_index);
 
   vec_free(old_acl_vector);
 
@@ -276,6 +280,8 @@ void acl_plugin_lookup_context_notify_acl_change(u32 acl_num)
         hash_acl_delete(am, acl_num);
     }
     hash_acl_add(am, acl_num);
+    /* the lookup contexts using the modified ACL need to be recompiled */
+    compiled_acl_rebuild_by_acl(am, acl_num);
   } else {
     /* this is a deletion notification */
     hash_acl_delete(am, acl_num);
@@ -647,6 +647,68 @@ hash_multi_acl_match_5tuple (void *p_acl_main, u32 lc_index, fa_5tuple_t * pkt_5
   return 0;
 }
 
+/*
+ * Return the published compiled lookup structure for the context,
+ * if the compiled matching is on and the packet can use it.
+ */
+always_inline compiled_acl_context_t *
+compiled_acl_context_get (acl_main_t *am, u32 lc_index, fa_5tuple_t * pkt_5tuple)
+{
+  /*
+   * Same as the tuplemerge, the trees do not take the fragments into account:
+   * the nonfirst fragments are matched linearly.
+   */
+  if (PREDICT_TRUE(!am->use_compiled_acl_matching) ||
+      PREDICT_FALSE(pkt_5tuple->pkt.is_nonfirst_fragment) ||
+      lc_index >= vec_len(am->compiled_acl_context_by_lc_index))
+    return 0;
+  return clib_atomic_load_acq_n(&am->compiled_acl_context_by_lc_index[lc_index]);
+}
+
+always_inline int
+compiled_multi_acl_match_5tuple (compiled_acl_context_t *ctx, fa_5tuple_t * pkt_5tuple,
+                       int is_ip6, u8 *action, u32 *acl_pos_p, u32 * acl_match_p,
+                       u32 * rule_match_p, u32 * trace_bitmap)
+{
+  compiled_acl_tree_t *tree = &ctx->trees[is_ip6];
+  compiled_acl_node_t *node = tree->nodes;
+  compiled_ace_t *ace;
+  u64 key[COMPILED_ACL_N_DIMS];
+  u32 i;
+
+  if (is_ip6) {
+    key[COMPILED_ACL_DIM_SRC_HI] = clib_net_to_host_u64(pkt_5tuple->ip6_addr[0].as_u64[0]);
+    key[COMPILED_ACL_DIM_SRC_LO] = clib_net_to_host_u64(pkt_5tuple->ip6_addr[0].as_u64[1]);
+    key[COMPILED_ACL_DIM_DST_HI] = clib_net_to_host_u64(pkt_5tuple->ip6_addr[1].as_u64[0]);
+    key[COMPILED_ACL_DIM_DST_LO] = clib_net_to_host_u64(pkt_5tuple->ip6_addr[1].as_u64[1]);
+  } else {
+    key[COMPILED_ACL_DIM_SRC_HI] = 0;
+    key[COMPILED_ACL_DIM_SRC_LO] = clib_net_to_host_u32(pkt_5tuple->ip4_addr[0].as_u32);
+    key[COMPILED_ACL_DIM_DST_HI] = 0;
+    key[COMPILED_ACL_DIM_DST_LO] = clib_net_to_host_u32(pkt_5tuple->ip4_addr[1].as_u32);
+  }
+  key[COMPILED_ACL_DIM_PROTO] = pkt_5tuple->l4.proto;
+  key[COMPILED_ACL_DIM_SPORT] = pkt_5tuple->l4.port[0];
+  key[COMPILED_ACL_DIM_DPORT] = pkt_5tuple->l4.port[1];
+
+  /* at most COMPILED_ACL_MAX_DEPTH steps... */
+  while (!node->is_leaf)
+    node = tree->nodes + node->child[key[node->dim] > node->split];
+
+  /* ...and then at most max_leaf_rules checks */
+  for (i = 0; i < node->n_rules; i++) {
+    ace = ctx->aces + tree->leaf_rules[node->first_rule + i];
+    if (single_rule_match_5tuple(&ace->rule, is_ip6, pkt_5tuple)) {
+      *acl_pos_p = ace->acl_position;
+      *acl_match_p = ace->acl_index;
+      *rule_match_p = ace->ace_index;
+      *action = ace->rule.is_permit;
+      return 1;
+    }
+  }
+  return 0;
+}
+
 
 
 always_inline int
@@ -660,8 +722,13 @@ acl_plugin_match_5tuple_inline (void *p_acl_main, u32 lc_index,
 {
   acl_main_t *am = p_acl_main;
   fa_5tuple_t * pkt_5tuple_internal = (fa_5tuple_t *)pkt_5tuple;
+  compiled_acl_context_t *ctx;
   pkt_5tuple_internal->pkt.lc_index = lc_index;
-  if (PREDICT_TRUE(am->use_hash_acl_matching)) {
+  ctx = compiled_acl_context_get(am, lc_index, pkt_5tuple_internal);
+  if (ctx) {
+    return compiled_multi_acl_match_5tuple(ctx, pkt_5tuple_internal, is_ip6, r_action,
+                                 r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
+  } else if (PREDICT_TRUE(am->use_hash_acl_matching)) {
     if (PREDICT_FALSE(pkt_5tuple_internal->pkt.is_nonfirst_fragment)) {
       /*
        * tuplemerge does not take fragments into account,
@@ -695,8 +762,13 @@ acl_plugin_match_5tuple_inline_and_count (void *p_acl_main, u32 lc_index,
   acl_main_t *am = p_acl_main;
   int ret = 0;
   fa_5tuple_t * pkt_5tuple_internal = (fa_5tuple_t *)pkt_5tuple;
+  compiled_acl_context_t *ctx;
   pkt_5tuple_internal->pkt.lc_index = lc_index;
-  if (PREDICT_TRUE(am->use_hash_acl_matching)) {
+  ctx = compiled_acl_context_get(am, lc_index, pkt_5tuple_internal);
+  if (ctx) {
+    ret = compiled_multi_acl_match_5tuple(ctx, pkt_5tuple_internal, is_ip6, r_action,
+                                 r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
+  } else if (PREDICT_TRUE(am->use_hash_acl_matching)) {
     if (PREDICT_FALSE(pkt_5tuple_internal->pkt.is_nonfirst_fragment)) {
       /*
        * tuplemerge does not take fragments into account,
@@ -25,6 +25,7 @@
 
 #include <vlib/vlib.h>
 #include <vlib/unix/unix.h>
+#include <vlib/file.h>
 #include <vnet/ip/ip.h>
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/ip/ip4_packet.h>
@@ -615,7 +616,13 @@ VNET_DEVICE_CLASS_TX_FN (af_packet_device_class) (vlib_main_t * vm,
       tx_queue->next_tx_frame = tx_frame;
       tx_queue->is_tx_pending = 0;
 
-      if (PREDICT_FALSE (
+      /* with io_uring the kick is submitted at the end of the dispatch
+       * cycle, and a kick which fails is counted in the same tx errors
+       * once its completion is reaped */
+      if (vlib_file_queue_kick (vm, tx_queue->fd, VLIB_FILE_KICK_SEND,
+				node->errors[AF_PACKET_TX_ERROR_TXRING_EAGAIN],
+				node->errors[AF_PACKET_TX_ERROR_TXRING_FATAL]) &&
+	  PREDICT_FALSE (
 	    sendto (tx_queue->fd, NULL, 0, MSG_DONTWAIT, NULL, 0) == -1))
 	{
 	  /* Uh-oh, drop & move on, but count whether it was fatal or not.
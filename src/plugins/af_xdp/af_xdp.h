@@ -24,6 +24,18 @@
 
 #define AF_XDP_NUM_RX_QUEUES_ALL        ((u16)-1)
 
+#define AF_XDP_BUSY_POLL_BUDGET_DEFAULT 64
+#define AF_XDP_BUSY_POLL_USEC		20
+/* frame size announced for multi-buffer interfaces */
+#define AF_XDP_MULTI_BUFFER_MAX_FRAME_SIZE 9216
+
+#ifndef XDP_USE_SG
+#define XDP_USE_SG (1 << 4)
+#endif
+#ifndef XDP_PKT_CONTD
+#define XDP_PKT_CONTD (1 << 0)
+#endif
+
 #define af_xdp_log(lvl, dev, f, ...) \
   vlib_log(lvl, af_xdp_main.log_class, "%v: " f, (dev)->name, ##__VA_ARGS__)
 
@@ -33,7 +45,9 @@
   _ (2, ADMIN_UP, "admin-up")                                                 \
   _ (3, LINK_UP, "link-up")                                                   \
   _ (4, ZEROCOPY, "zero-copy")                                                \
-  _ (5, SYSCALL_LOCK, "syscall-lock")
+  _ (5, SYSCALL_LOCK, "syscall-lock")                                         \
+  _ (6, MULTI_BUFFER, "multi-buffer")                                         \
+  _ (7, BUSY_POLL, "busy-poll")
 
 enum
 {
@@ -119,7 +133,8 @@ typedef struct
 
   char *netns;
 
-  struct xsk_umem **umem;
+  u32 umem_index;
+  u16 busy_poll_budget;
   struct xsk_socket **xsk;
 
   struct bpf_object *bpf_obj;
@@ -129,9 +144,28 @@ typedef struct
   clib_error_t *error;
 } af_xdp_device_t;
 
+/*
+ * A UMEM covers the whole vlib buffer memory, so a single one can be shared
+ * by all the queues of all the devices on a NUMA node, each socket getting
+ * its own fill and completion rings.
+ */
+typedef struct
+{
+  struct xsk_umem *umem;
+  /* rings created with the umem, handed over to its first socket */
+  struct xsk_ring_prod fq;
+  struct xsk_ring_cons cq;
+  u32 numa_node;
+  u32 fill_size;
+  u32 comp_size;
+  u32 bind_flags;
+  u32 n_sockets;
+} af_xdp_umem_t;
+
 typedef struct
 {
   af_xdp_device_t *devices;
+  af_xdp_umem_t *umems;
   vlib_log_class_t log_class;
   u16 msg_id_base;
 } af_xdp_main_t;
@@ -148,6 +182,8 @@ typedef enum
 typedef enum
 {
   AF_XDP_CREATE_FLAGS_NO_SYSCALL_LOCK = 1,
+  AF_XDP_CREATE_FLAGS_MULTI_BUFFER = 2,
+  AF_XDP_CREATE_FLAGS_BUSY_POLL = 4,
 } af_xdp_create_flag_t;
 
 typedef struct
@@ -161,6 +197,7 @@ typedef struct
   u32 rxq_size;
   u32 txq_size;
   u32 rxq_num;
+  u32 busy_poll_budget;
 
   /* return */
   int rv;
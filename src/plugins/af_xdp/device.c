@@ -38,6 +38,16 @@
 #define XDP_UMEM_MIN_CHUNK_SIZE 2048
 #endif
 
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+#ifndef BPF_F_XDP_HAS_FRAGS
+#define BPF_F_XDP_HAS_FRAGS (1U << 5)
+#endif
+
 af_xdp_main_t af_xdp_main;
 
 typedef struct
@@ -78,7 +88,14 @@ af_xdp_set_max_frame_size (vnet_main_t *vnm, vnet_hw_interface_t *hw,
 {
   af_xdp_main_t *am = &af_xdp_main;
   af_xdp_device_t *ad = vec_elt_at_index (am->devices, hw->dev_instance);
-  af_xdp_log (VLIB_LOG_LEVEL_ERR, ad, "set mtu not supported yet");
+
+  /* frames span as many chunks as needed */
+  if ((ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER) &&
+      frame_size <= AF_XDP_MULTI_BUFFER_MAX_FRAME_SIZE)
+    return 0;
+
+  af_xdp_log (VLIB_LOG_LEVEL_ERR, ad,
+	      "set mtu not supported without multi-buffer");
   return vnet_error (VNET_ERR_UNSUPPORTED, 0);
 }
 
@@ -178,13 +195,88 @@ err0:
   return ret;
 }
 
+static void
+af_xdp_umem_put (af_xdp_device_t *ad, u32 n_sockets)
+{
+  af_xdp_main_t *axm = &af_xdp_main;
+  af_xdp_umem_t *um;
+
+  if (ad->umem_index == ~0)
+    return;
+
+  um = pool_elt_at_index (axm->umems, ad->umem_index);
+  ASSERT (um->n_sockets >= n_sockets);
+  um->n_sockets -= n_sockets;
+  ad->umem_index = ~0;
+
+  if (um->n_sockets)
+    return;
+
+  xsk_umem__delete (um->umem);
+  pool_put (axm->umems, um);
+}
+
+/* find the umem the device queues can share, or create it */
+static int
+af_xdp_umem_get (vlib_main_t *vm, af_xdp_create_if_args_t *args,
+		 af_xdp_device_t *ad, u32 numa_node, u32 bind_flags)
+{
+  af_xdp_main_t *axm = &af_xdp_main;
+  struct xsk_umem_config umem_config;
+  af_xdp_umem_t *um;
+
+  pool_foreach (um, axm->umems)
+    if (um->numa_node == numa_node && um->fill_size == args->rxq_size &&
+	um->comp_size == args->txq_size && um->bind_flags == bind_flags)
+      {
+	ad->umem_index = um - axm->umems;
+	return 0;
+      }
+
+  pool_get_zero (axm->umems, um);
+  um->numa_node = numa_node;
+  um->fill_size = args->rxq_size;
+  um->comp_size = args->txq_size;
+  um->bind_flags = bind_flags;
+
+  memset (&umem_config, 0, sizeof (umem_config));
+  umem_config.fill_size = args->rxq_size;
+  umem_config.comp_size = args->txq_size;
+  umem_config.frame_size =
+    sizeof (vlib_buffer_t) + vlib_buffer_get_default_data_size (vm);
+  umem_config.frame_headroom = sizeof (vlib_buffer_t);
+  umem_config.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
+  if (xsk_umem__create (
+	&um->umem, uword_to_pointer (vm->buffer_main->buffer_mem_start, void *),
+	vm->buffer_main->buffer_mem_size, &um->fq, &um->cq, &umem_config))
+    {
+      uword sys_page_size = clib_mem_get_page_size ();
+      args->rv = VNET_API_ERROR_SYSCALL_ERROR_1;
+      args->error = clib_error_return_unix (0, "xsk_umem__create() failed");
+      /* this should mimic the Linux kernel net/xdp/xdp_umem.c:xdp_umem_reg()
+       * check */
+      if (umem_config.frame_size < XDP_UMEM_MIN_CHUNK_SIZE ||
+	  umem_config.frame_size > sys_page_size)
+	args->error = clib_error_return (
+	  args->error,
+	  "(unsupported data-size? (should be between %d and %d))",
+	  XDP_UMEM_MIN_CHUNK_SIZE - sizeof (vlib_buffer_t),
+	  sys_page_size - sizeof (vlib_buffer_t));
+      pool_put (axm->umems, um);
+      return -1;
+    }
+
+  ad->umem_index = um - axm->umems;
+  return 0;
+}
+
 void
 af_xdp_delete_if (vlib_main_t * vm, af_xdp_device_t * ad)
 {
   vnet_main_t *vnm = vnet_get_main ();
   af_xdp_main_t *axm = &af_xdp_main;
   struct xsk_socket **xsk;
-  struct xsk_umem **umem;
+  u32 n_sockets = 0;
   int i;
 
   if (ad->hw_if_index)
@@ -197,10 +289,13 @@ af_xdp_delete_if (vlib_main_t * vm, af_xdp_device_t * ad)
     clib_spinlock_free (&vec_elt (ad->txqs, i).lock);
 
   vec_foreach (xsk, ad->xsk)
-    xsk_socket__delete (*xsk);
+    if (*xsk)
+      {
+	xsk_socket__delete (*xsk);
+	n_sockets++;
+      }
 
-  vec_foreach (umem, ad->umem)
-    xsk_umem__delete (*umem);
+  af_xdp_umem_put (ad, n_sockets);
 
   for (i = 0; i < ad->rxq_num; i++)
     clib_file_del_by_index (&file_main, vec_elt (ad->rxqs, i).file_index);
@@ -209,7 +304,6 @@ af_xdp_delete_if (vlib_main_t * vm, af_xdp_device_t * ad)
     af_xdp_log (VLIB_LOG_LEVEL_ERR, ad, "Error while removing XDP program.\n");
 
   vec_free (ad->xsk);
-  vec_free (ad->umem);
   vec_free (ad->buffer_template);
   vec_free (ad->rxqs);
   vec_free (ad->txqs);
@@ -246,6 +340,10 @@ af_xdp_load_program (af_xdp_create_if_args_t * args, af_xdp_device_t * ad)
     goto err1;
 
   bpf_program__set_type (bpf_prog, BPF_PROG_TYPE_XDP);
+  /* the program must accept frames spanning several buffers */
+  if (args->flags & AF_XDP_CREATE_FLAGS_MULTI_BUFFER)
+    bpf_program__set_flags (bpf_prog, bpf_program__flags (bpf_prog) |
+					BPF_F_XDP_HAS_FRAGS);
 
   if (bpf_object__load (ad->bpf_obj))
     goto err1;
@@ -274,18 +372,17 @@ static int
 af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
 		     af_xdp_device_t *ad, int qid)
 {
-  struct xsk_umem **umem;
+  af_xdp_main_t *axm = &af_xdp_main;
+  af_xdp_umem_t *um = pool_elt_at_index (axm->umems, ad->umem_index);
   struct xsk_socket **xsk;
   af_xdp_rxq_t *rxq;
   af_xdp_txq_t *txq;
-  struct xsk_umem_config umem_config;
   struct xsk_socket_config sock_config;
   struct xdp_options opt;
   socklen_t optlen;
   const int is_rx = qid < ad->rxq_num;
   const int is_tx = qid < ad->txq_num;
 
-  umem = vec_elt_at_index (ad->umem, qid);
   xsk = vec_elt_at_index (ad->xsk, qid);
   rxq = vec_elt_at_index (ad->rxqs, qid);
   txq = vec_elt_at_index (ad->txqs, qid);
@@ -300,59 +397,23 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
   struct xsk_ring_cons *cq = &txq->cq;
   int fd;
 
-  memset (&umem_config, 0, sizeof (umem_config));
-  umem_config.fill_size = args->rxq_size;
-  umem_config.comp_size = args->txq_size;
-  umem_config.frame_size =
-    sizeof (vlib_buffer_t) + vlib_buffer_get_default_data_size (vm);
-  umem_config.frame_headroom = sizeof (vlib_buffer_t);
-  umem_config.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
-  if (xsk_umem__create
-      (umem, uword_to_pointer (vm->buffer_main->buffer_mem_start, void *),
-       vm->buffer_main->buffer_mem_size, fq, cq, &umem_config))
-    {
-      uword sys_page_size = clib_mem_get_page_size ();
-      args->rv = VNET_API_ERROR_SYSCALL_ERROR_1;
-      args->error = clib_error_return_unix (0, "xsk_umem__create() failed");
-      /* this should mimic the Linux kernel net/xdp/xdp_umem.c:xdp_umem_reg()
-       * check */
-      if (umem_config.frame_size < XDP_UMEM_MIN_CHUNK_SIZE ||
-	  umem_config.frame_size > sys_page_size)
-	args->error = clib_error_return (
-	  args->error,
-	  "(unsupported data-size? (should be between %d and %d))",
-	  XDP_UMEM_MIN_CHUNK_SIZE - sizeof (vlib_buffer_t),
-	  sys_page_size - sizeof (vlib_buffer_t));
-      goto err0;
-    }
-
   memset (&sock_config, 0, sizeof (sock_config));
   sock_config.rx_size = args->rxq_size;
   sock_config.tx_size = args->txq_size;
-  sock_config.bind_flags = XDP_USE_NEED_WAKEUP;
-  switch (args->mode)
-    {
-    case AF_XDP_MODE_AUTO:
-      break;
-    case AF_XDP_MODE_COPY:
-      sock_config.bind_flags |= XDP_COPY;
-      break;
-    case AF_XDP_MODE_ZERO_COPY:
-      sock_config.bind_flags |= XDP_ZEROCOPY;
-      break;
-    }
+  /* sockets sharing the umem inherit its bind flags */
+  sock_config.bind_flags = um->bind_flags;
   if (args->prog)
     sock_config.libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD;
-  if (xsk_socket__create
-      (xsk, ad->linux_ifname, qid, *umem, rx, tx, &sock_config))
+  if (xsk_socket__create_shared (xsk, ad->linux_ifname, qid, um->umem, rx,
+				 tx, fq, cq, &sock_config))
     {
       args->rv = VNET_API_ERROR_SYSCALL_ERROR_2;
-      args->error =
-	clib_error_return_unix (0,
-				"xsk_socket__create() failed (is linux netdev %s up?)",
-				ad->linux_ifname);
-      goto err1;
+      args->error = clib_error_return_unix (
+	0, "xsk_socket__create_shared() failed (is linux netdev %s up?)",
+	ad->linux_ifname);
+      goto err0;
     }
+  um->n_sockets++;
 
   fd = xsk_socket__fd (*xsk);
   if (args->prog)
@@ -415,10 +476,8 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
 
 err2:
   xsk_socket__delete (*xsk);
-err1:
-  xsk_umem__delete (*umem);
+  um->n_sockets--;
 err0:
-  *umem = 0;
   *xsk = 0;
   return -1;
 }
@@ -473,6 +532,34 @@ af_xdp_device_rxq_read_ready (clib_file_t * f)
   return 0;
 }
 
+/*
+ * In busy-poll mode the NIC interrupts stay masked as long as the socket is
+ * polled, the NAPI processing being done on behalf of the input node when
+ * it kicks the socket.
+ */
+static clib_error_t *
+af_xdp_device_set_busy_poll (const af_xdp_device_t *ad, af_xdp_rxq_t *rxq,
+			     int enable)
+{
+  int prefer = enable;
+  int usec = enable ? AF_XDP_BUSY_POLL_USEC : 0;
+  int budget = ad->busy_poll_budget;
+
+  if (setsockopt (rxq->xsk_fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer,
+		  sizeof (prefer)))
+    return clib_error_return_unix (0, "setsockopt(SO_PREFER_BUSY_POLL)");
+
+  if (setsockopt (rxq->xsk_fd, SOL_SOCKET, SO_BUSY_POLL, &usec,
+		  sizeof (usec)))
+    return clib_error_return_unix (0, "setsockopt(SO_BUSY_POLL)");
+
+  if (enable && setsockopt (rxq->xsk_fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET,
+			    &budget, sizeof (budget)))
+    return clib_error_return_unix (0, "setsockopt(SO_BUSY_POLL_BUDGET)");
+
+  return 0;
+}
+
 static clib_error_t *
 af_xdp_device_set_rxq_mode (const af_xdp_device_t *ad, af_xdp_rxq_t *rxq,
 			    const af_xdp_rxq_mode_t mode)
@@ -500,6 +587,14 @@ af_xdp_device_set_rxq_mode (const af_xdp_device_t *ad, af_xdp_rxq_t *rxq,
       return clib_error_create ("unknown rxq mode %i", mode);
     }
 
+  if (ad->flags & AF_XDP_DEVICE_F_BUSY_POLL)
+    {
+      clib_error_t *err = af_xdp_device_set_busy_poll (
+	ad, rxq, mode == AF_XDP_RXQ_MODE_POLLING);
+      if (err)
+	return err;
+    }
+
   f = clib_file_get (fm, rxq->file_index);
   fm->file_update (f, update);
   rxq->mode = mode;
@@ -584,6 +679,7 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
   int rxq_num, txq_num, q_num;
   int ns_fds[2];
   int i, ret;
+  u32 numa_node, bind_flags;
 
   args->rxq_size = args->rxq_size ? args->rxq_size : 2 * VLIB_FRAME_SIZE;
   args->txq_size = args->txq_size ? args->txq_size : 2 * VLIB_FRAME_SIZE;
@@ -629,11 +725,23 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
   txq_num = clib_min (txq_num, tm->n_vlib_mains);
 
   pool_get_zero (am->devices, ad);
+  ad->umem_index = ~0;
 
   if (tm->n_vlib_mains > 1 &&
       0 == (args->flags & AF_XDP_CREATE_FLAGS_NO_SYSCALL_LOCK))
     ad->flags |= AF_XDP_DEVICE_F_SYSCALL_LOCK;
 
+  if (args->flags & AF_XDP_CREATE_FLAGS_MULTI_BUFFER)
+    ad->flags |= AF_XDP_DEVICE_F_MULTI_BUFFER;
+
+  if (args->flags & AF_XDP_CREATE_FLAGS_BUSY_POLL)
+    {
+      ad->flags |= AF_XDP_DEVICE_F_BUSY_POLL;
+      ad->busy_poll_budget = args->busy_poll_budget ?
+			       args->busy_poll_budget :
+			       AF_XDP_BUSY_POLL_BUDGET_DEFAULT;
+    }
+
   ad->linux_ifname = (char *) format (0, "%s", args->linux_ifname);
   vec_validate (ad->linux_ifname, IFNAMSIZ - 1);	/* libbpf expects ifname to be at least IFNAMSIZ */
 
@@ -654,11 +762,29 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
       (af_xdp_remove_program (ad) || af_xdp_load_program (args, ad)))
     goto err2;
 
+  bind_flags = XDP_USE_NEED_WAKEUP;
+  switch (args->mode)
+    {
+    case AF_XDP_MODE_AUTO:
+      break;
+    case AF_XDP_MODE_COPY:
+      bind_flags |= XDP_COPY;
+      break;
+    case AF_XDP_MODE_ZERO_COPY:
+      bind_flags |= XDP_ZEROCOPY;
+      break;
+    }
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    bind_flags |= XDP_USE_SG;
+
+  numa_node = af_xdp_get_numa (ad->linux_ifname);
+  if (af_xdp_umem_get (vm, args, ad, numa_node, bind_flags))
+    goto err2;
+
   q_num = clib_max (rxq_num, txq_num);
   ad->rxq_num = rxq_num;
   ad->txq_num = txq_num;
 
-  vec_validate_aligned (ad->umem, q_num - 1, CLIB_CACHE_LINE_BYTES);
   vec_validate_aligned (ad->xsk, q_num - 1, CLIB_CACHE_LINE_BYTES);
   vec_validate_aligned (ad->rxqs, q_num - 1, CLIB_CACHE_LINE_BYTES);
   vec_validate_aligned (ad->txqs, q_num - 1, CLIB_CACHE_LINE_BYTES);
@@ -678,7 +804,6 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
 		      "create interface failed to create queue qid=%d", i);
 
 	  /* fixup vectors length */
-	  vec_set_len (ad->umem, i);
 	  vec_set_len (ad->xsk, i);
 	  vec_set_len (ad->rxqs, i);
 	  vec_set_len (ad->txqs, i);
@@ -710,10 +835,7 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
 
   ad->dev_instance = ad - am->devices;
   ad->per_interface_next_index = VNET_DEVICE_INPUT_NEXT_ETHERNET_INPUT;
-  ad->pool =
-    vlib_buffer_pool_get_default_for_numa (vm,
-					   af_xdp_get_numa
-					   (ad->linux_ifname));
+  ad->pool = vlib_buffer_pool_get_default_for_numa (vm, numa_node);
   if (!args->name)
     {
       char *ifname = ad->linux_ifname;
@@ -736,6 +858,8 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
   eir.address = ad->hwaddr;
   eir.cb.flag_change = af_xdp_flag_change;
   eir.cb.set_max_frame_size = af_xdp_set_max_frame_size;
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    eir.max_frame_size = AF_XDP_MULTI_BUFFER_MAX_FRAME_SIZE;
   ad->hw_if_index = vnet_eth_register_interface (vnm, &eir);
 
   sw = vnet_get_hw_sw_interface (vnm, ad->hw_if_index);
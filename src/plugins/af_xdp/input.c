@@ -76,13 +76,19 @@ af_xdp_device_input_refill_db (vlib_main_t * vm,
 			       af_xdp_device_t * ad, af_xdp_rxq_t * rxq,
 			       const u32 n_alloc)
 {
+  int needs_wakeup;
+
   xsk_ring_prod__submit (&rxq->fq, n_alloc);
 
-  if (AF_XDP_RXQ_MODE_INTERRUPT == rxq->mode ||
-      !xsk_ring_prod__needs_wakeup (&rxq->fq))
+  if (AF_XDP_RXQ_MODE_INTERRUPT == rxq->mode)
+    return;
+
+  /* in busy-poll mode the kick is what drives the NIC */
+  needs_wakeup = xsk_ring_prod__needs_wakeup (&rxq->fq);
+  if (!needs_wakeup && !(ad->flags & AF_XDP_DEVICE_F_BUSY_POLL))
     return;
 
-  if (node)
+  if (node && needs_wakeup)
     vlib_error_count (vm, node->node_index,
 		      AF_XDP_INPUT_ERROR_SYSCALL_REQUIRED, 1);
 
@@ -277,6 +283,71 @@ af_xdp_device_input_bufs (vlib_main_t *vm, const af_xdp_device_t *ad,
   return bytes;
 }
 
+/*
+ * Multi-buffer variant: the descriptors of a frame larger than a chunk
+ * are all flagged XDP_PKT_CONTD but the last one, and are turned into a
+ * buffer chain.
+ */
+static_always_inline u32
+af_xdp_device_input_bufs_mb (vlib_main_t *vm, const af_xdp_device_t *ad,
+			     af_xdp_rxq_t *rxq, u32 *bis, u32 n_desc,
+			     vlib_buffer_t *bt, u32 idx, u32 *n_rx_bytes)
+{
+  const u32 mask = rxq->rx.mask;
+  const u32 n_peeked = n_desc;
+  vlib_buffer_t *hb = 0, *pb = 0;
+  u32 n, n_rx = 0, bytes = 0;
+
+  /* do not consume the head of a frame whose tail isn't there yet */
+  while (n_desc &&
+	 xsk_ring_cons__rx_desc (&rxq->rx, (idx + n_desc - 1) & mask)
+	     ->options &
+	   XDP_PKT_CONTD)
+    n_desc--;
+
+  /* and hand it back, so the next peek starts with it */
+  if (n_desc < n_peeked)
+    xsk_ring_cons__cancel (&rxq->rx, n_peeked - n_desc);
+
+  for (n = 0; n < n_desc; n++)
+    {
+      const struct xdp_desc *desc =
+	xsk_ring_cons__rx_desc (&rxq->rx, (idx + n) & mask);
+      const u64 addr = desc->addr;
+      const u32 bi = addr2bi (xsk_umem__extract_addr (addr));
+      vlib_buffer_t *b = vlib_get_buffer (vm, bi);
+
+      ASSERT (vlib_buffer_is_known (vm, bi) == VLIB_BUFFER_KNOWN_ALLOCATED);
+      vlib_buffer_copy_template (b, bt);
+      b->current_data =
+	xsk_umem__extract_offset (addr) - sizeof (vlib_buffer_t);
+      b->current_length = desc->len;
+      bytes += desc->len;
+
+      if (hb == 0)
+	{
+	  hb = b;
+	  hb->total_length_not_including_first_buffer = 0;
+	  bis[n_rx++] = bi;
+	}
+      else
+	{
+	  b->flags = 0;
+	  pb->next_buffer = bi;
+	  pb->flags |= VLIB_BUFFER_NEXT_PRESENT;
+	  hb->total_length_not_including_first_buffer += desc->len;
+	}
+
+      pb = b;
+      if ((desc->options & XDP_PKT_CONTD) == 0)
+	hb = 0;
+    }
+
+  xsk_ring_cons__release (&rxq->rx, n_desc);
+  *n_rx_bytes = bytes;
+  return n_rx;
+}
+
 static_always_inline uword
 af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 			    vlib_frame_t *frame, af_xdp_device_t *ad, u16 qid)
@@ -291,7 +362,17 @@ af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   n_rx_packets = xsk_ring_cons__peek (&rxq->rx, VLIB_FRAME_SIZE, &idx);
 
   if (PREDICT_FALSE (0 == n_rx_packets))
-    goto refill;
+    {
+      /* nothing received, let the kernel run the NAPI poll */
+      if ((ad->flags & AF_XDP_DEVICE_F_BUSY_POLL) &&
+	  AF_XDP_RXQ_MODE_POLLING == rxq->mode &&
+	  clib_spinlock_trylock_if_init (&rxq->syscall_lock))
+	{
+	  recvfrom (rxq->xsk_fd, 0, 0, MSG_DONTWAIT, 0, 0);
+	  clib_spinlock_unlock_if_init (&rxq->syscall_lock);
+	}
+      goto refill;
+    }
 
   vlib_buffer_copy_template (&bt, ad->buffer_template);
   next_index = ad->per_interface_next_index;
@@ -300,8 +381,12 @@ af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
   vlib_get_new_next_frame (vm, node, next_index, to_next, n_left_to_next);
 
-  n_rx_bytes =
-    af_xdp_device_input_bufs (vm, ad, rxq, to_next, n_rx_packets, &bt, idx);
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    n_rx_packets = af_xdp_device_input_bufs_mb (
+      vm, ad, rxq, to_next, n_rx_packets, &bt, idx, &n_rx_bytes);
+  else
+    n_rx_bytes = af_xdp_device_input_bufs (vm, ad, rxq, to_next,
+					   n_rx_packets, &bt, idx);
   af_xdp_device_input_ethernet (vm, node, next_index, ad->sw_if_index,
 				ad->hw_if_index);
 
@@ -90,16 +90,23 @@ af_xdp_device_output_tx_db (vlib_main_t * vm,
 			    af_xdp_device_t * ad,
 			    af_xdp_txq_t * txq, const u32 n_tx)
 {
+  const int busy_poll = ad->flags & AF_XDP_DEVICE_F_BUSY_POLL;
+  int needs_wakeup;
+
   xsk_ring_prod__submit (&txq->tx, n_tx);
 
-  if (!xsk_ring_prod__needs_wakeup (&txq->tx))
+  needs_wakeup = xsk_ring_prod__needs_wakeup (&txq->tx);
+  if (!busy_poll && !needs_wakeup)
     return;
 
-  vlib_error_count (vm, node->node_index, AF_XDP_TX_ERROR_SYSCALL_REQUIRED, 1);
+  /* busy-poll kicks on every tx, only count the wakeups the kernel wants */
+  if (needs_wakeup)
+    vlib_error_count (vm, node->node_index, AF_XDP_TX_ERROR_SYSCALL_REQUIRED,
+		      1);
 
   clib_spinlock_lock_if_init (&txq->syscall_lock);
 
-  if (xsk_ring_prod__needs_wakeup (&txq->tx))
+  if (busy_poll || xsk_ring_prod__needs_wakeup (&txq->tx))
     {
       const struct msghdr msg = {};
       int ret;
@@ -235,6 +242,101 @@ wrap_around:
   return n_tx;
 }
 
+/*
+ * Multi-buffer variant: a buffer chain is sent as one descriptor per
+ * buffer, all flagged XDP_PKT_CONTD but the last one. The buffers are
+ * unchained as they are completed one by one.
+ */
+static_always_inline u32
+af_xdp_device_output_tx_try_mb (vlib_main_t *vm,
+				const vlib_node_runtime_t *node,
+				af_xdp_device_t *ad, af_xdp_txq_t *txq,
+				u32 n_tx, u32 *bi, u32 *n_desc_ret)
+{
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  const uword start = vm->buffer_main->buffer_mem_start;
+  const u32 mask = txq->tx.size - 1;
+  struct xdp_desc *desc;
+  u32 n_free, n_desc = 0, n, idx;
+
+  vlib_get_buffers (vm, bi, bufs, n_tx);
+
+  /* only take the frames which fit entirely */
+  n_free = xsk_prod_nb_free (&txq->tx, txq->tx.size);
+  for (n = 0; n < n_tx; n++)
+    {
+      vlib_buffer_t *s = b[n];
+      u32 n_segs = 1;
+      int shared = 0;
+
+      if (s->flags & VLIB_BUFFER_NEXT_PRESENT)
+	{
+	  shared = s->ref_count > 1;
+	  do
+	    {
+	      s = vlib_get_buffer (vm, s->next_buffer);
+	      shared |= s->ref_count > 1;
+	      n_segs++;
+	    }
+	  while (s->flags & VLIB_BUFFER_NEXT_PRESENT);
+	}
+
+      /* buffers shared with a clone can't be unchained, send a copy */
+      if (PREDICT_FALSE (shared))
+	{
+	  vlib_buffer_t *c = vlib_buffer_copy (vm, b[n]);
+	  if (c == 0)
+	    break;
+	  vlib_buffer_free_one (vm, bi[n]);
+	  bi[n] = vlib_get_buffer_index (vm, c);
+	  b[n] = c;
+	  for (s = c, n_segs = 1; s->flags & VLIB_BUFFER_NEXT_PRESENT;
+	       n_segs++)
+	    s = vlib_get_buffer (vm, s->next_buffer);
+	}
+
+      if (n_desc + n_segs > n_free)
+	break;
+      n_desc += n_segs;
+    }
+  n_tx = n;
+
+  *n_desc_ret = n_desc;
+  if (PREDICT_FALSE (0 == n_desc))
+    return 0;
+
+  n = xsk_ring_prod__reserve (&txq->tx, n_desc, &idx);
+  ASSERT (n == n_desc);
+
+  for (n = 0; n < n_tx; n++)
+    {
+      vlib_buffer_t *s = b[n];
+
+      while (1)
+	{
+	  const int more = s->flags & VLIB_BUFFER_NEXT_PRESENT;
+	  const u32 next = s->next_buffer;
+
+	  desc = xsk_ring_prod__tx_desc (&txq->tx, idx);
+	  desc->addr = ((sizeof (vlib_buffer_t) + s->current_data)
+			<< XSK_UNALIGNED_BUF_OFFSET_SHIFT) |
+		       (pointer_to_uword (s) - start);
+	  desc->len = s->current_length;
+	  desc->options = more ? XDP_PKT_CONTD : 0;
+	  idx = (idx + 1) & mask;
+
+	  if (!more)
+	    break;
+
+	  s->flags &=
+	    ~(VLIB_BUFFER_NEXT_PRESENT | VLIB_BUFFER_TOTAL_LENGTH_VALID);
+	  s = vlib_get_buffer (vm, next);
+	}
+    }
+
+  return n_tx;
+}
+
 VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
 					       vlib_node_runtime_t * node,
 					       vlib_frame_t * frame)
@@ -246,7 +348,7 @@ VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
   const int shared_queue = tf->shared_queue;
   af_xdp_txq_t *txq = vec_elt_at_index (ad->txqs, tf->queue_id);
   u32 *from;
-  u32 n, n_tx;
+  u32 n, n_tx, n_desc_total = 0;
   int i;
 
   from = vlib_frame_vector_args (frame);
@@ -259,12 +361,23 @@ VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
     {
       u32 n_enq;
       af_xdp_device_output_free (vm, node, txq);
-      n_enq =
-	af_xdp_device_output_tx_try (vm, node, ad, txq, n_tx - n, from + n);
+      if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+	{
+	  u32 n_desc;
+	  n_enq = af_xdp_device_output_tx_try_mb (vm, node, ad, txq, n_tx - n,
+						  from + n, &n_desc);
+	  n_desc_total += n_desc;
+	}
+      else
+	{
+	  n_enq = af_xdp_device_output_tx_try (vm, node, ad, txq, n_tx - n,
+					       from + n);
+	  n_desc_total += n_enq;
+	}
       n += n_enq;
     }
 
-  af_xdp_device_output_tx_db (vm, node, ad, txq, n);
+  af_xdp_device_output_tx_db (vm, node, ad, txq, n_desc_total);
 
   if (shared_queue)
     clib_spinlock_unlock (&txq->lock);
@@ -54,6 +54,13 @@ unformat_af_xdp_create_if_args (unformat_input_t * input, va_list * vargs)
 	args->mode = AF_XDP_MODE_ZERO_COPY;
       else if (unformat (line_input, "no-syscall-lock"))
 	args->flags |= AF_XDP_CREATE_FLAGS_NO_SYSCALL_LOCK;
+      else if (unformat (line_input, "multi-buffer"))
+	args->flags |= AF_XDP_CREATE_FLAGS_MULTI_BUFFER;
+      else if (unformat (line_input, "busy-poll-budget %u",
+			 &args->busy_poll_budget))
+	args->flags |= AF_XDP_CREATE_FLAGS_BUSY_POLL;
+      else if (unformat (line_input, "busy-poll"))
+	args->flags |= AF_XDP_CREATE_FLAGS_BUSY_POLL;
       else
 	{
 	  /* return failure on unknown input */
@@ -424,7 +424,7 @@ dpdk_ops_vpp_get_count (const struct rte_mempool *mp)
       vlib_buffer_pool_t *pool = vlib_get_buffer_pool (vm, mp->pool_id);
       if (pool)
 	{
-	  return pool->n_avail;
+	  return pool->n_avail + vlib_buffer_pool_depot_n_buffers (pool);
 	}
     }
   return 0;
@@ -0,0 +1,977 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/feature/feature.h>
+#include <vpp/app/version.h>
+#include <hqos/hqos.h>
+
+hqos_main_t hqos_main;
+
+#define HQOS_DBG(...) vlib_log_debug (hqos_main.log_class, __VA_ARGS__);
+
+static const char *hqos_level_names[HQOS_N_LEVELS] = {
+  [HQOS_LEVEL_PORT] = "port",
+  [HQOS_LEVEL_SUBPORT] = "subport",
+  [HQOS_LEVEL_PIPE] = "pipe",
+  [HQOS_LEVEL_TC] = "tc",
+};
+
+static hqos_port_t *
+hqos_port_get_by_sw_if_index (u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  if (sw_if_index >= vec_len (hm->port_by_sw_if_index) ||
+      hm->port_by_sw_if_index[sw_if_index] == ~0)
+    return NULL;
+
+  return pool_elt_at_index (hm->ports, hm->port_by_sw_if_index[sw_if_index]);
+}
+
+static void
+hqos_node_set_params (hqos_node_t *n, const hqos_node_params_t *params)
+{
+  n->rate = params->rate / 8;
+  n->burst = params->burst;
+  /* by default, allow bursts of 10ms at the node's rate */
+  if (!n->burst)
+    n->burst = clib_max (n->rate * 10e-3, HQOS_WRR_QUANTUM);
+  n->quantum = clib_max (params->weight, 1) * HQOS_WRR_QUANTUM;
+  n->deficit = n->quantum;
+  n->tokens = n->burst;
+  n->last_update = vlib_time_now (vlib_get_main ());
+}
+
+static u32
+hqos_node_add (hqos_port_t *hp, hqos_level_t level, u32 id, u32 parent,
+	       u8 priority, const hqos_node_params_t *params)
+{
+  hqos_node_t *n;
+
+  pool_get_zero (hp->nodes, n);
+
+  n->level = level;
+  n->id = id;
+  n->parent = parent;
+  n->priority = priority;
+  n->next = n->prev = ~0;
+  n->timer_handle = ~0;
+  hqos_node_set_params (n, params);
+
+  if (parent != ~0)
+    vec_add1 (hqos_node_get (hp, parent)->children, n - hp->nodes);
+
+  return (n - hp->nodes);
+}
+
+static void
+hqos_node_free (hqos_port_t *hp, u32 index)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  hqos_node_t *n;
+  u32 *children, *ci, i;
+
+  n = hqos_node_get (hp, index);
+
+  children = n->children;
+  n->children = NULL;
+  vec_foreach (ci, children)
+    hqos_node_free (hp, *ci);
+  vec_free (children);
+
+  n = hqos_node_get (hp, index);
+  hqos_node_deactivate (hp, n);
+
+  if (n->timer_handle != ~0)
+    tw_timer_stop_1t_3w_1024sl_ov (&hp->wheel, n->timer_handle);
+
+  for (i = 0; i < n->ring_len; i++)
+    vlib_buffer_free_one (
+      vm, n->ring[(n->ring_head + i) & (hp->queue_size - 1)]);
+  hp->n_queued -= n->ring_len;
+  vec_free (n->ring);
+
+  if (n->parent != ~0)
+    {
+      hqos_node_t *p = hqos_node_get (hp, n->parent);
+
+      if (p->children)
+	{
+	  i = vec_search (p->children, index);
+	  if (i != ~0)
+	    vec_del1 (p->children, i);
+	}
+    }
+
+  pool_put (hp->nodes, n);
+}
+
+static void
+hqos_unmap_node (hqos_port_t *hp, u32 pipe)
+{
+  hqos_main_t *hm = &hqos_main;
+  u32 sw_if_index;
+
+  vec_foreach_index (sw_if_index, hm->map_by_sw_if_index)
+    {
+      hqos_map_t *map = &hm->map_by_sw_if_index[sw_if_index];
+
+      if (map->port_index == hp - hm->ports &&
+	  (pipe == ~0 || map->pipe == pipe))
+	hqos_map (hp->sw_if_index, ~0, sw_if_index, 0);
+    }
+}
+
+int
+hqos_port_add (u32 sw_if_index, const hqos_node_params_t *params, u8 n_tcs,
+	       u32 queue_size, u32 worker)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vlib_main_t *vm = vlib_get_main ();
+  vnet_sw_interface_t *sw;
+  hqos_port_t *hp;
+  u32 qos;
+
+  if (!vnet_sw_interface_is_valid (vnm, sw_if_index))
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  /* the hierarchy is that of a physical port */
+  sw = vnet_get_sw_interface (vnm, sw_if_index);
+  if (sw->type != VNET_SW_INTERFACE_TYPE_HARDWARE)
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (hp)
+    {
+      /* only the port's shaper can be changed once it exists */
+      hqos_node_set_params (hqos_node_get (hp, hp->root), params);
+      return 0;
+    }
+
+  if (n_tcs == 0 || n_tcs > HQOS_MAX_TCS || !is_pow2 (queue_size))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (worker != ~0 && worker >= vlib_num_workers ())
+    return VNET_API_ERROR_INVALID_WORKER;
+
+  pool_get_zero (hm->ports, hp);
+
+  hp->sw_if_index = sw_if_index;
+  hp->n_tcs = n_tcs;
+  hp->queue_size = queue_size;
+
+  /* spread the ports over the workers by default */
+  if (worker == ~0 && vlib_num_workers ())
+    worker = (hp - hm->ports) % vlib_num_workers ();
+  hp->thread_index =
+    (worker == ~0) ? 0 : vlib_get_worker_thread_index (worker);
+
+  /* IP precedences, highest first, shared out over the TCs */
+  for (qos = 0; qos < ARRAY_LEN (hp->tc_by_qos); qos++)
+    hp->tc_by_qos[qos] = ((7 - (qos >> 5)) * n_tcs) / 8;
+
+  hp->root = hqos_node_add (hp, HQOS_LEVEL_PORT, 0, ~0, 0, params);
+
+  tw_timer_wheel_init_1t_3w_1024sl_ov (&hp->wheel, NULL, HQOS_TIMER_INTERVAL,
+				       ~0);
+  hp->wheel.last_run_time = vlib_time_now (vm);
+
+  vec_validate_init_empty (hm->port_by_sw_if_index, sw_if_index, ~0);
+  hm->port_by_sw_if_index[sw_if_index] = hp - hm->ports;
+
+  vec_validate (hm->ports_by_thread, hp->thread_index);
+  vec_add1 (hm->ports_by_thread[hp->thread_index], hp - hm->ports);
+
+  if (vec_len (hm->ports_by_thread[hp->thread_index]) == 1)
+    vlib_node_set_state (vlib_get_main_by_index (hp->thread_index),
+			 hqos_sched_node.index, VLIB_NODE_STATE_POLLING);
+
+  HQOS_DBG ("port %U on thread %u", format_vnet_sw_if_index_name, vnm,
+	    sw_if_index, hp->thread_index);
+
+  return 0;
+}
+
+int
+hqos_port_del (u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_port_t *hp;
+  u32 **ports, i;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  hqos_unmap_node (hp, ~0);
+  hqos_node_free (hp, hp->root);
+
+  ports = &hm->ports_by_thread[hp->thread_index];
+  i = vec_search (*ports, hp - hm->ports);
+  vec_del1 (*ports, i);
+  if (vec_len (*ports) == 0)
+    vlib_node_set_state (vlib_get_main_by_index (hp->thread_index),
+			 hqos_sched_node.index, VLIB_NODE_STATE_DISABLED);
+
+  tw_timer_wheel_free_1t_3w_1024sl_ov (&hp->wheel);
+  vec_free (hp->expired);
+  pool_free (hp->nodes);
+  hash_free (hp->subport_by_id);
+  hash_free (hp->pipe_by_id);
+
+  hm->port_by_sw_if_index[sw_if_index] = ~0;
+  pool_put (hm->ports, hp);
+
+  return 0;
+}
+
+int
+hqos_subport_add (u32 sw_if_index, u32 id, const hqos_node_params_t *params)
+{
+  hqos_port_t *hp;
+  uword *p;
+  u32 si;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  p = hash_get (hp->subport_by_id, id);
+  if (p)
+    {
+      hqos_node_set_params (hqos_node_get (hp, p[0]), params);
+      return 0;
+    }
+
+  si = hqos_node_add (hp, HQOS_LEVEL_SUBPORT, id, hp->root, 0, params);
+  hash_set (hp->subport_by_id, id, si);
+  return 0;
+}
+
+int
+hqos_subport_del (u32 sw_if_index, u32 id)
+{
+  hqos_node_t *subport;
+  hqos_port_t *hp;
+  u32 *ci;
+  uword *p;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  p = hash_get (hp->subport_by_id, id);
+  if (!p)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  /* the pipes go with the subport */
+  subport = hqos_node_get (hp, p[0]);
+  vec_foreach (ci, subport->children)
+    {
+      hqos_unmap_node (hp, *ci);
+      hash_unset (hp->pipe_by_id, hqos_node_get (hp, *ci)->id);
+    }
+
+  hqos_node_free (hp, p[0]);
+  hash_unset (hp->subport_by_id, id);
+
+  return 0;
+}
+
+int
+hqos_pipe_add (u32 sw_if_index, u32 subport_id, u32 id,
+	       const hqos_node_params_t *params,
+	       const hqos_node_params_t *tc_params)
+{
+  hqos_node_t *pipe, *tc;
+  hqos_port_t *hp;
+  u32 pi, ti, i;
+  uword *p;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  p = hash_get (hp->pipe_by_id, id);
+  if (p)
+    {
+      pipe = hqos_node_get (hp, p[0]);
+      if (subport_id != hqos_node_get (hp, pipe->parent)->id)
+	return VNET_API_ERROR_VALUE_EXIST;
+
+      hqos_node_set_params (pipe, params);
+      for (i = 0; i < hp->n_tcs; i++)
+	hqos_node_set_params (hqos_node_get (hp, pipe->children[i]),
+			      &tc_params[i]);
+      return 0;
+    }
+
+  p = hash_get (hp->subport_by_id, subport_id);
+  if (!p)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  pi = hqos_node_add (hp, HQOS_LEVEL_PIPE, id, p[0], 0, params);
+
+  for (i = 0; i < hp->n_tcs; i++)
+    {
+      ti = hqos_node_add (hp, HQOS_LEVEL_TC, i, pi, i, &tc_params[i]);
+      tc = hqos_node_get (hp, ti);
+      vec_validate (tc->ring, hp->queue_size - 1);
+    }
+
+  hash_set (hp->pipe_by_id, id, pi);
+  return 0;
+}
+
+int
+hqos_pipe_del (u32 sw_if_index, u32 id)
+{
+  hqos_port_t *hp;
+  uword *p;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  p = hash_get (hp->pipe_by_id, id);
+  if (!p)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  hqos_unmap_node (hp, p[0]);
+  hqos_node_free (hp, p[0]);
+  hash_unset (hp->pipe_by_id, id);
+
+  return 0;
+}
+
+/*
+ * Queue the packets output on an interface, the port itself or one of its
+ * sub-interfaces, to a pipe.
+ */
+int
+hqos_map (u32 port_sw_if_index, u32 pipe_id, u32 sw_if_index, bool is_add)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  hqos_map_t *map;
+  hqos_port_t *hp;
+  bool was_mapped;
+  uword *p = NULL;
+
+  hp = hqos_port_get_by_sw_if_index (port_sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (!vnet_sw_interface_is_valid (vnm, sw_if_index) ||
+      vnet_get_sup_hw_interface (vnm, sw_if_index)->sw_if_index !=
+	port_sw_if_index)
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  if (is_add)
+    {
+      p = hash_get (hp->pipe_by_id, pipe_id);
+      if (!p)
+	return VNET_API_ERROR_NO_SUCH_ENTRY;
+    }
+
+  vec_validate_init_empty (hm->map_by_sw_if_index, sw_if_index,
+			   ((hqos_map_t){ .port_index = ~0, .pipe = ~0 }));
+  map = &hm->map_by_sw_if_index[sw_if_index];
+  was_mapped = (map->port_index != ~0);
+
+  if (!is_add && map->port_index != hp - hm->ports)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (is_add)
+    {
+      map->port_index = hp - hm->ports;
+      map->pipe = p[0];
+    }
+  else
+    {
+      map->port_index = ~0;
+      map->pipe = ~0;
+    }
+
+  if (was_mapped != is_add)
+    vnet_feature_enable_disable ("interface-output", "hqos-output",
+				 sw_if_index, is_add, 0, 0);
+
+  return 0;
+}
+
+int
+hqos_tc_map (u32 sw_if_index, u8 qos, u8 tc)
+{
+  hqos_port_t *hp;
+
+  hp = hqos_port_get_by_sw_if_index (sw_if_index);
+  if (!hp)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (tc >= hp->n_tcs)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  hp->tc_by_qos[qos] = tc;
+  return 0;
+}
+
+static clib_error_t *
+hqos_sw_interface_add_del (vnet_main_t *vnm, u32 sw_if_index, u32 is_add)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_map_t *map;
+
+  if (is_add)
+    return NULL;
+
+  if (sw_if_index < vec_len (hm->map_by_sw_if_index))
+    {
+      map = &hm->map_by_sw_if_index[sw_if_index];
+      if (map->port_index != ~0)
+	hqos_map (pool_elt_at_index (hm->ports, map->port_index)->sw_if_index,
+		  ~0, sw_if_index, 0);
+    }
+
+  hqos_port_del (sw_if_index);
+
+  return NULL;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (hqos_sw_interface_add_del);
+
+static uword
+unformat_hqos_rate (unformat_input_t *input, va_list *args)
+{
+  f64 *result = va_arg (*args, f64 *);
+  f64 tmp;
+
+  if (unformat (input, "%f gbps", &tmp))
+    *result = tmp * 1e9;
+  else if (unformat (input, "%f mbps", &tmp))
+    *result = tmp * 1e6;
+  else if (unformat (input, "%f kbps", &tmp))
+    *result = tmp * 1e3;
+  else if (unformat (input, "%f bps", &tmp))
+    *result = tmp;
+  else
+    return 0;
+  return 1;
+}
+
+static u8 *
+format_hqos_rate (u8 *s, va_list *args)
+{
+  f64 bps = va_arg (*args, f64);
+
+  if (bps == 0)
+    return format (s, "unshaped");
+  if (bps >= 1e9)
+    return format (s, "%.2f gbps", bps / 1e9);
+  if (bps >= 1e6)
+    return format (s, "%.2f mbps", bps / 1e6);
+  if (bps >= 1e3)
+    return format (s, "%.2f kbps", bps / 1e3);
+  return format (s, "%.0f bps", bps);
+}
+
+static u8 *
+format_hqos_node (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (hqos_port_t * hp) = va_arg (*args, hqos_port_t *);
+  hqos_node_t *n = va_arg (*args, hqos_node_t *);
+  u32 indent = va_arg (*args, u32);
+
+  s = format (s, "%U%s %u: rate %U burst %u", format_white_space, indent,
+	      hqos_level_names[n->level], n->id, format_hqos_rate, n->rate * 8,
+	      n->burst);
+  if (n->level != HQOS_LEVEL_PORT && n->level != HQOS_LEVEL_TC)
+    s = format (s, " weight %u", n->quantum / HQOS_WRR_QUANTUM);
+  if (n->flags & HQOS_NODE_F_THROTTLED)
+    s = format (s, " throttled");
+  if (n->level == HQOS_LEVEL_TC)
+    s = format (s, "\n%Uqueued %u tx %llu packets %llu bytes drops %llu",
+		format_white_space, indent + 2, n->ring_len, n->n_tx_packets,
+		n->n_tx_bytes, n->n_drops);
+  return s;
+}
+
+static u8 *
+format_hqos_port (u8 *s, va_list *args)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_port_t *hp = va_arg (*args, hqos_port_t *);
+  int verbose = va_arg (*args, int);
+  hqos_node_t *subport, *pipe;
+  u32 *si, *pi, *ti, sw_if_index;
+
+  s = format (s, "%U: thread %u, %u TCs, queue-size %u, %u queued\n",
+	      format_vnet_sw_if_index_name, vnet_get_main (), hp->sw_if_index,
+	      hp->thread_index, hp->n_tcs, hp->queue_size, hp->n_queued);
+  s = format (s, "%U\n", format_hqos_node, hp, hqos_node_get (hp, hp->root),
+	      2);
+  s = format (s, "  %u subports, %u pipes\n", hash_elts (hp->subport_by_id),
+	      hash_elts (hp->pipe_by_id));
+
+  if (!verbose)
+    return s;
+
+  vec_foreach (si, hqos_node_get (hp, hp->root)->children)
+    {
+      subport = hqos_node_get (hp, *si);
+      s = format (s, "%U\n", format_hqos_node, hp, subport, 4);
+      vec_foreach (pi, subport->children)
+	{
+	  pipe = hqos_node_get (hp, *pi);
+	  s = format (s, "%U", format_hqos_node, hp, pipe, 6);
+	  vec_foreach_index (sw_if_index, hm->map_by_sw_if_index)
+	    if (hm->map_by_sw_if_index[sw_if_index].pipe == *pi &&
+		hm->map_by_sw_if_index[sw_if_index].port_index ==
+		  hp - hm->ports)
+	      s = format (s, " %U", format_vnet_sw_if_index_name,
+			  vnet_get_main (), sw_if_index);
+	  s = format (s, "\n");
+	  vec_foreach (ti, pipe->children)
+	    s = format (s, "%U\n", format_hqos_node, hp,
+			hqos_node_get (hp, *ti), 8);
+	}
+    }
+  return s;
+}
+
+static clib_error_t *
+hqos_port_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  hqos_node_params_t params = {};
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, n_tcs = HQOS_DEFAULT_N_TCS;
+  u32 queue_size = HQOS_DEFAULT_QSIZE, worker = ~0;
+  clib_error_t *error = NULL;
+  u8 is_del = 0;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "expected arguments");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "rate %U", unformat_hqos_rate,
+			 &params.rate))
+	;
+      else if (unformat (line_input, "burst %u", &params.burst))
+	;
+      else if (unformat (line_input, "tcs %u", &n_tcs))
+	;
+      else if (unformat (line_input, "queue-size %u", &queue_size))
+	;
+      else if (unformat (line_input, "worker %u", &worker))
+	;
+      else if (unformat (line_input, "del"))
+	is_del = 1;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "interface required");
+      goto done;
+    }
+
+  if (is_del)
+    rv = hqos_port_del (sw_if_index);
+  else
+    rv = hqos_port_add (sw_if_index, &params, n_tcs, queue_size, worker);
+
+  if (rv)
+    error = clib_error_return (0, "hqos port %s failed: %U",
+			       is_del ? "del" : "add", format_vnet_api_errno,
+			       rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Create the hierarchical QoS scheduler of a port, or update the port's
+ * shaper. The number of traffic classes, the queue size (a power of 2)
+ * and the worker serving the port can only be given at creation.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos port GigabitEthernet0/8/0 rate 10 gbps tcs 4 queue-size
+ * 128}
+ ?*/
+VLIB_CLI_COMMAND (hqos_port_command, static) = {
+  .path = "hqos port",
+  .short_help = "hqos port <interface> [rate <n> gbps|mbps|kbps|bps] "
+		"[burst <bytes>] [tcs <n>] [queue-size <n>] [worker <n>] [del]",
+  .function = hqos_port_command_fn,
+};
+
+static clib_error_t *
+hqos_subport_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  hqos_node_params_t params = {};
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, id = ~0;
+  clib_error_t *error = NULL;
+  u8 is_del = 0;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "expected arguments");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "id %u", &id))
+	;
+      else if (unformat (line_input, "rate %U", unformat_hqos_rate,
+			 &params.rate))
+	;
+      else if (unformat (line_input, "burst %u", &params.burst))
+	;
+      else if (unformat (line_input, "weight %u", &params.weight))
+	;
+      else if (unformat (line_input, "del"))
+	is_del = 1;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || id == ~0)
+    {
+      error = clib_error_return (0, "interface and id required");
+      goto done;
+    }
+
+  if (is_del)
+    rv = hqos_subport_del (sw_if_index, id);
+  else
+    rv = hqos_subport_add (sw_if_index, id, &params);
+
+  if (rv)
+    error = clib_error_return (0, "hqos subport %s failed: %U",
+			       is_del ? "del" : "add", format_vnet_api_errno,
+			       rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Add or update a subport of a port, typically one per VLAN. Subports are
+ * served in weighted round robin.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos subport GigabitEthernet0/8/0 id 100 rate 1 gbps weight 2}
+ ?*/
+VLIB_CLI_COMMAND (hqos_subport_command, static) = {
+  .path = "hqos subport",
+  .short_help = "hqos subport <interface> id <n> [rate <n> "
+		"gbps|mbps|kbps|bps] [burst <bytes>] [weight <n>] [del]",
+  .function = hqos_subport_command_fn,
+};
+
+static clib_error_t *
+hqos_pipe_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  hqos_node_params_t params = {}, tc_params[HQOS_MAX_TCS] = {};
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, subport = ~0, id = ~0, tc, burst;
+  clib_error_t *error = NULL;
+  u8 is_del = 0;
+  f64 rate;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "expected arguments");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "subport %u", &subport))
+	;
+      else if (unformat (line_input, "id %u", &id))
+	;
+      else if (unformat (line_input, "tc %u rate %U burst %u", &tc,
+			 unformat_hqos_rate, &rate, &burst) &&
+	       tc < HQOS_MAX_TCS)
+	{
+	  tc_params[tc].rate = rate;
+	  tc_params[tc].burst = burst;
+	}
+      else if (unformat (line_input, "tc %u rate %U", &tc,
+			 unformat_hqos_rate, &rate) &&
+	       tc < HQOS_MAX_TCS)
+	tc_params[tc].rate = rate;
+      else if (unformat (line_input, "rate %U", unformat_hqos_rate,
+			 &params.rate))
+	;
+      else if (unformat (line_input, "burst %u", &params.burst))
+	;
+      else if (unformat (line_input, "weight %u", &params.weight))
+	;
+      else if (unformat (line_input, "del"))
+	is_del = 1;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || id == ~0 || (!is_del && subport == ~0))
+    {
+      error = clib_error_return (0, "interface, subport and id required");
+      goto done;
+    }
+
+  if (is_del)
+    rv = hqos_pipe_del (sw_if_index, id);
+  else
+    rv = hqos_pipe_add (sw_if_index, subport, id, &params, tc_params);
+
+  if (rv)
+    error = clib_error_return (0, "hqos pipe %s failed: %U",
+			       is_del ? "del" : "add", format_vnet_api_errno,
+			       rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Add or update a pipe, typically one per subscriber, and its traffic
+ * classes. The pipes of a subport are served in weighted round robin, and
+ * the traffic classes of a pipe in strict priority, TC 0 first. Each
+ * traffic class may be shaped on its own.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos pipe GigabitEthernet0/8/0 subport 100 id 1 rate 50 mbps
+ * tc 0 rate 2 mbps}
+ ?*/
+VLIB_CLI_COMMAND (hqos_pipe_command, static) = {
+  .path = "hqos pipe",
+  .short_help = "hqos pipe <interface> subport <n> id <n> [rate <n> "
+		"gbps|mbps|kbps|bps] [burst <bytes>] [weight <n>] "
+		"[tc <n> rate <rate> [burst <bytes>]]... [del]",
+  .function = hqos_pipe_command_fn,
+};
+
+static clib_error_t *
+hqos_map_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, pipe = ~0;
+  clib_error_t *error = NULL;
+  u8 is_del = 0;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "expected arguments");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "pipe %u", &pipe))
+	;
+      else if (unformat (line_input, "del"))
+	is_del = 1;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || (!is_del && pipe == ~0))
+    {
+      error = clib_error_return (0, "interface and pipe required");
+      goto done;
+    }
+
+  rv = hqos_map (vnet_get_sup_hw_interface (vnm, sw_if_index)->sw_if_index,
+		 pipe, sw_if_index, !is_del);
+
+  if (rv)
+    error = clib_error_return (0, "hqos map failed: %U",
+			       format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Queue the packets output on an interface, a port with a hierarchy or one
+ * of its sub-interfaces, to a pipe of the port's hierarchy.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos map GigabitEthernet0/8/0.100 pipe 1}
+ ?*/
+VLIB_CLI_COMMAND (hqos_map_command, static) = {
+  .path = "hqos map",
+  .short_help = "hqos map <interface> pipe <n> [del]",
+  .function = hqos_map_command_fn,
+};
+
+static clib_error_t *
+hqos_tc_map_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, qos = ~0, tc = ~0;
+  clib_error_t *error = NULL;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "expected arguments");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "qos %u", &qos))
+	;
+      else if (unformat (line_input, "tc %u", &tc))
+	;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || qos > 255 || tc == ~0)
+    {
+      error = clib_error_return (0, "interface, qos and tc required");
+      goto done;
+    }
+
+  rv = hqos_tc_map (sw_if_index, qos, tc);
+  if (rv)
+    error = clib_error_return (0, "hqos tc-map failed: %U",
+			       format_vnet_api_errno, rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Set the traffic class of the packets with the given recorded QoS bits
+ * (see 'qos record'). By default the bits are taken as an IP TOS byte and
+ * the precedences are shared out over the traffic classes, precedence 7 in
+ * TC 0. VLAN PCP or MPLS EXP sources need a map of their own. Packets
+ * without recorded QoS bits go to the last traffic class.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos tc-map GigabitEthernet0/8/0 qos 184 tc 0}
+ ?*/
+VLIB_CLI_COMMAND (hqos_tc_map_command, static) = {
+  .path = "hqos tc-map",
+  .short_help = "hqos tc-map <interface> qos <0-255> tc <n>",
+  .function = hqos_tc_map_command_fn,
+};
+
+static clib_error_t *
+show_hqos_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0;
+  hqos_port_t *hp;
+  int verbose = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	return unformat_parse_error (input);
+    }
+
+  pool_foreach (hp, hm->ports)
+    {
+      if (sw_if_index == ~0 || sw_if_index == hp->sw_if_index)
+	vlib_cli_output (vm, "%U", format_hqos_port, hp, verbose);
+    }
+
+  return NULL;
+}
+
+VLIB_CLI_COMMAND (show_hqos_command, static) = {
+  .path = "show hqos",
+  .short_help = "show hqos [<interface>] [verbose]",
+  .function = show_hqos_command_fn,
+};
+
+static clib_error_t *
+hqos_init (vlib_main_t *vm)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  hm->log_class = vlib_log_register_class ("hqos", 0);
+  hm->fq_index = vlib_frame_queue_main_init (hqos_output_node.index, 0);
+
+  return NULL;
+}
+
+VLIB_INIT_FUNCTION (hqos_init);
+
+VNET_FEATURE_INIT (hqos_output, static) = {
+  .arc_name = "interface-output",
+  .node_name = "hqos-output",
+  .runs_before = VNET_FEATURES ("interface-output-arc-end"),
+};
+
+VLIB_PLUGIN_REGISTER () = {
+  .version = VPP_BUILD_VER,
+  .description = "Hierarchical QoS Scheduler",
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
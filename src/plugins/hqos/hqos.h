@@ -0,0 +1,268 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#ifndef __included_hqos_h__
+#define __included_hqos_h__
+
+#include <stdbool.h>
+
+#include <vnet/vnet.h>
+#include <vppinfra/tw_timer_1t_3w_1024sl_ov.h>
+
+/*
+ * Hierarchical QoS scheduler.
+ *
+ * A hierarchy is attached to a port (a hardware interface) and has four
+ * levels:
+ *
+ *   port -> subport (e.g. a VLAN) -> pipe (a subscriber) -> traffic class
+ *
+ * Each traffic class of a pipe is a leaf queue holding buffer indices.
+ * Siblings are served in strict priority order, and siblings of the same
+ * priority by byte-based weighted round robin. Subports and pipes all have
+ * the same priority, the traffic classes of a pipe have the priority of
+ * their number, TC 0 first. Any node may be shaped by a token bucket; a
+ * node that runs out of tokens is taken out of its parent's schedule and
+ * put back by a timer when it has tokens again.
+ *
+ * A hierarchy is served by a single thread. Packets output on other
+ * threads are handed off to it.
+ */
+
+#define HQOS_MAX_TCS	     8
+#define HQOS_N_PRIORITIES    HQOS_MAX_TCS
+#define HQOS_DEFAULT_N_TCS   4
+#define HQOS_DEFAULT_QSIZE   64
+#define HQOS_WRR_QUANTUM     1536 /* bytes served per unit of weight */
+#define HQOS_TIMER_INTERVAL  10e-6
+#define HQOS_MAX_TX_BURST    VLIB_FRAME_SIZE
+
+typedef enum hqos_level_t_
+{
+  HQOS_LEVEL_PORT,
+  HQOS_LEVEL_SUBPORT,
+  HQOS_LEVEL_PIPE,
+  HQOS_LEVEL_TC,
+  HQOS_N_LEVELS,
+} hqos_level_t;
+
+typedef enum hqos_node_flags_t_
+{
+  /* linked in the parent's schedule */
+  HQOS_NODE_F_ACTIVE = (1 << 0),
+  /* out of tokens, waiting on the timer wheel */
+  HQOS_NODE_F_THROTTLED = (1 << 1),
+} __clib_packed hqos_node_flags_t;
+
+typedef struct hqos_node_t_
+{
+  /* token bucket shaper, no shaping when the rate is zero */
+  f64 rate; /* bytes per second */
+  f64 tokens;
+  f64 last_update;
+  u32 burst;
+
+  u32 id;
+  u32 parent;
+  u8 level;
+  u8 priority;
+  hqos_node_flags_t flags;
+  /* priorities for which children are scheduled */
+  u8 active_mask;
+
+  /* weighted round robin amongst the siblings of the same priority */
+  u32 quantum;
+  i32 deficit;
+
+  /* links in the parent's circular list of scheduled children */
+  u32 next;
+  u32 prev;
+
+  /* next child to serve, per priority */
+  u32 active_head[HQOS_N_PRIORITIES];
+
+  /* subport and pipe: children; the pipe's are indexed by TC */
+  u32 *children;
+
+  /* TC: ring of buffer indices */
+  u32 *ring;
+  u32 ring_head;
+  u32 ring_len;
+
+  u32 timer_handle;
+
+  u64 n_tx_packets;
+  u64 n_tx_bytes;
+  u64 n_drops;
+} hqos_node_t;
+
+typedef struct hqos_port_t_
+{
+  u32 sw_if_index;
+  clib_thread_index_t thread_index;
+  u32 queue_size;
+  u8 n_tcs;
+  /* TC of a packet by its recorded QoS bits */
+  u8 tc_by_qos[256];
+
+  u32 root;
+  hqos_node_t *nodes;
+  uword *subport_by_id;
+  uword *pipe_by_id;
+  u32 n_queued;
+
+  tw_timer_wheel_1t_3w_1024sl_ov_t wheel;
+  u32 *expired;
+} hqos_port_t;
+
+/* where the packets output on an interface are queued */
+typedef struct hqos_map_t_
+{
+  u32 port_index;
+  u32 pipe;
+} hqos_map_t;
+
+typedef struct hqos_main_t_
+{
+  hqos_port_t *ports;
+  u32 *port_by_sw_if_index;
+  hqos_map_t *map_by_sw_if_index;
+
+  /* ports served by each thread */
+  u32 **ports_by_thread;
+
+  u32 fq_index;
+
+  vlib_log_class_t log_class;
+} hqos_main_t;
+
+extern hqos_main_t hqos_main;
+
+extern vlib_node_registration_t hqos_output_node;
+extern vlib_node_registration_t hqos_sched_node;
+
+typedef struct hqos_node_params_t_
+{
+  f64 rate; /* bits per second, 0 for unshaped */
+  u32 burst;
+  u32 weight;
+} hqos_node_params_t;
+
+extern int hqos_port_add (u32 sw_if_index, const hqos_node_params_t *params,
+			  u8 n_tcs, u32 queue_size, u32 worker);
+extern int hqos_port_del (u32 sw_if_index);
+extern int hqos_subport_add (u32 sw_if_index, u32 id,
+			     const hqos_node_params_t *params);
+extern int hqos_subport_del (u32 sw_if_index, u32 id);
+extern int hqos_pipe_add (u32 sw_if_index, u32 subport_id, u32 id,
+			  const hqos_node_params_t *params,
+			  const hqos_node_params_t *tc_params);
+extern int hqos_pipe_del (u32 sw_if_index, u32 id);
+extern int hqos_map (u32 port_sw_if_index, u32 pipe_id, u32 sw_if_index,
+		     bool is_add);
+extern int hqos_tc_map (u32 sw_if_index, u8 qos, u8 tc);
+
+static_always_inline hqos_node_t *
+hqos_node_get (hqos_port_t *hp, u32 index)
+{
+  return pool_elt_at_index (hp->nodes, index);
+}
+
+static_always_inline void
+hqos_shaper_refill (hqos_node_t *n, f64 now)
+{
+  n->tokens += (now - n->last_update) * n->rate;
+  if (n->tokens > n->burst)
+    n->tokens = n->burst;
+  n->last_update = now;
+}
+
+static_always_inline bool
+hqos_node_has_backlog (hqos_node_t *n)
+{
+  if (n->level == HQOS_LEVEL_TC)
+    return (n->ring_len != 0);
+  return (n->active_mask != 0);
+}
+
+/*
+ * Link the node into its parent's schedule, and the parent into its own
+ * parent's if the parent was idle, and so on up. The caller ensures the
+ * node has a backlog and is not throttled.
+ */
+static_always_inline void
+hqos_node_activate (hqos_port_t *hp, hqos_node_t *n)
+{
+  hqos_node_t *p, *head, *tail;
+  u8 was_idle;
+
+  while (n->parent != ~0)
+    {
+      p = hqos_node_get (hp, n->parent);
+      was_idle = (p->active_mask == 0);
+
+      if (p->active_mask & (1 << n->priority))
+	{
+	  /* insert at the tail, i.e. just before the head */
+	  head = hqos_node_get (hp, p->active_head[n->priority]);
+	  tail = hqos_node_get (hp, head->prev);
+	  n->next = head - hp->nodes;
+	  n->prev = tail - hp->nodes;
+	  tail->next = n - hp->nodes;
+	  head->prev = n - hp->nodes;
+	}
+      else
+	{
+	  n->next = n->prev = n - hp->nodes;
+	  p->active_head[n->priority] = n - hp->nodes;
+	  p->active_mask |= (1 << n->priority);
+	}
+      n->flags |= HQOS_NODE_F_ACTIVE;
+
+      if (!was_idle || (p->flags & HQOS_NODE_F_THROTTLED) ||
+	  p->parent == ~0)
+	return;
+      n = p;
+    }
+}
+
+/*
+ * Unlink the node from its parent's schedule, and the parent from its own
+ * parent's if that left it with nothing to schedule, and so on up.
+ */
+static_always_inline void
+hqos_node_deactivate (hqos_port_t *hp, hqos_node_t *n)
+{
+  hqos_node_t *p;
+
+  while (n->flags & HQOS_NODE_F_ACTIVE)
+    {
+      p = hqos_node_get (hp, n->parent);
+
+      if (n->next == n - hp->nodes)
+	p->active_mask &= ~(1 << n->priority);
+      else
+	{
+	  hqos_node_get (hp, n->prev)->next = n->next;
+	  hqos_node_get (hp, n->next)->prev = n->prev;
+	  if (p->active_head[n->priority] == n - hp->nodes)
+	    p->active_head[n->priority] = n->next;
+	}
+      n->flags &= ~HQOS_NODE_F_ACTIVE;
+
+      if (p->active_mask)
+	return;
+      n = p;
+    }
+}
+
+#endif /* __included_hqos_h__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,461 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vnet/feature/feature.h>
+#include <hqos/hqos.h>
+
+typedef struct
+{
+  u32 port_index;
+  u32 pipe_id;
+  u32 thread_index;
+  u8 tc;
+  u8 is_drop;
+} hqos_output_trace_t;
+
+typedef struct
+{
+  u32 port_index;
+  u32 sw_if_index;
+  u8 tc;
+} hqos_sched_trace_t;
+
+#ifndef CLIB_MARCH_VARIANT
+static u8 *
+format_hqos_output_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  hqos_output_trace_t *t = va_arg (*args, hqos_output_trace_t *);
+
+  if (t->port_index == ~0)
+    return format (s, "HQOS: not mapped, dropped");
+
+  s = format (s, "HQOS: port %u pipe %u tc %u", t->port_index, t->pipe_id,
+	      t->tc);
+  if (t->thread_index != ~0)
+    s = format (s, ", handoff to thread %u", t->thread_index);
+  else if (t->is_drop)
+    s = format (s, ", queue full, dropped");
+  return s;
+}
+
+static u8 *
+format_hqos_sched_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  hqos_sched_trace_t *t = va_arg (*args, hqos_sched_trace_t *);
+
+  return format (s, "HQOS: port %u tc %u dequeued, sw_if_index %u",
+		 t->port_index, t->tc, t->sw_if_index);
+}
+#endif /* CLIB_MARCH_VARIANT */
+
+#define foreach_hqos_output_error                                             \
+  _ (QUEUED, "packets queued")                                                \
+  _ (TAIL_DROP, "queue full drops")                                           \
+  _ (NOT_MAPPED, "interface not mapped drops")                                \
+  _ (HANDOFF, "packets handed off")                                           \
+  _ (CONGESTION_DROP, "handoff congestion drops")
+
+typedef enum
+{
+#define _(sym, str) HQOS_OUTPUT_ERROR_##sym,
+  foreach_hqos_output_error
+#undef _
+    HQOS_OUTPUT_N_ERROR,
+} hqos_output_error_t;
+
+#ifndef CLIB_MARCH_VARIANT
+static char *hqos_output_error_strings[] = {
+#define _(sym, string) string,
+  foreach_hqos_output_error
+#undef _
+};
+#endif /* CLIB_MARCH_VARIANT */
+
+#define foreach_hqos_sched_error _ (TRANSMITTED, "packets transmitted")
+
+typedef enum
+{
+#define _(sym, str) HQOS_SCHED_ERROR_##sym,
+  foreach_hqos_sched_error
+#undef _
+    HQOS_SCHED_N_ERROR,
+} hqos_sched_error_t;
+
+#ifndef CLIB_MARCH_VARIANT
+static char *hqos_sched_error_strings[] = {
+#define _(sym, string) string,
+  foreach_hqos_sched_error
+#undef _
+};
+#endif /* CLIB_MARCH_VARIANT */
+
+typedef enum
+{
+  HQOS_OUTPUT_NEXT_DROP,
+  HQOS_OUTPUT_N_NEXT,
+} hqos_output_next_t;
+
+typedef enum
+{
+  /* the node following hqos-output on the output arc, which picks the
+     tx queue; the interface's output node would run the arc again */
+  HQOS_SCHED_NEXT_TX,
+  HQOS_SCHED_N_NEXT,
+} hqos_sched_next_t;
+
+static_always_inline u8
+hqos_buffer_tc (hqos_port_t *hp, vlib_buffer_t *b)
+{
+  if (b->flags & VNET_BUFFER_F_QOS_DATA_VALID)
+    return hp->tc_by_qos[vnet_buffer2 (b)->qos.bits];
+
+  /* unclassified traffic is best effort */
+  return hp->n_tcs - 1;
+}
+
+always_inline uword
+hqos_output_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
+		    vlib_frame_t *frame, int is_trace)
+{
+  hqos_main_t *hm = &hqos_main;
+  clib_thread_index_t thread_index = vm->thread_index;
+  u32 drops[VLIB_FRAME_SIZE], handoffs[VLIB_FRAME_SIZE];
+  u16 threads[VLIB_FRAME_SIZE];
+  u32 n_left, n_drops = 0, n_handoffs = 0, n_queued = 0;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  hqos_output_trace_t *t;
+  hqos_node_t *pipe, *leaf;
+  hqos_port_t *hp;
+  hqos_map_t *map;
+  u32 *from, sw_if_index;
+  u8 tc;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+  b = bufs;
+
+  while (n_left > 0)
+    {
+      if (n_left > 2)
+	vlib_prefetch_buffer_header (b[2], LOAD);
+
+      sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_TX];
+      map = NULL;
+      if (sw_if_index < vec_len (hm->map_by_sw_if_index))
+	map = vec_elt_at_index (hm->map_by_sw_if_index, sw_if_index);
+
+      if (PREDICT_FALSE (!map || map->port_index == ~0))
+	{
+	  /* unmapped while the packet was in flight */
+	  b[0]->error = node->errors[HQOS_OUTPUT_ERROR_NOT_MAPPED];
+	  drops[n_drops++] = from[0];
+	  if (is_trace && (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	    {
+	      t = vlib_add_trace (vm, node, b[0], sizeof (*t));
+	      t->port_index = ~0;
+	    }
+	  goto next;
+	}
+
+      hp = pool_elt_at_index (hm->ports, map->port_index);
+      pipe = hqos_node_get (hp, map->pipe);
+      tc = hqos_buffer_tc (hp, b[0]);
+
+      t = NULL;
+      if (is_trace && (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  t = vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->port_index = map->port_index;
+	  t->pipe_id = pipe->id;
+	  t->tc = tc;
+	  t->thread_index =
+	    (hp->thread_index != thread_index) ? hp->thread_index : ~0;
+	  t->is_drop = 0;
+	}
+
+      if (PREDICT_FALSE (hp->thread_index != thread_index))
+	{
+	  handoffs[n_handoffs] = from[0];
+	  threads[n_handoffs] = hp->thread_index;
+	  n_handoffs++;
+	  goto next;
+	}
+
+      leaf = hqos_node_get (hp, pipe->children[tc]);
+
+      if (PREDICT_FALSE (leaf->ring_len == hp->queue_size))
+	{
+	  leaf->n_drops++;
+	  b[0]->error = node->errors[HQOS_OUTPUT_ERROR_TAIL_DROP];
+	  drops[n_drops++] = from[0];
+	  if (t)
+	    t->is_drop = 1;
+	  goto next;
+	}
+
+      leaf->ring[(leaf->ring_head + leaf->ring_len) & (hp->queue_size - 1)] =
+	from[0];
+      leaf->ring_len++;
+      hp->n_queued++;
+      n_queued++;
+
+      if (leaf->ring_len == 1 && !(leaf->flags & HQOS_NODE_F_THROTTLED))
+	hqos_node_activate (hp, leaf);
+
+    next:
+      from += 1;
+      b += 1;
+      n_left -= 1;
+    }
+
+  if (n_drops)
+    vlib_buffer_enqueue_to_single_next (vm, node, drops, HQOS_OUTPUT_NEXT_DROP,
+					n_drops);
+
+  if (n_handoffs)
+    {
+      u32 n_enq;
+
+      n_enq = vlib_buffer_enqueue_to_thread (vm, node, hm->fq_index, handoffs,
+					     threads, n_handoffs, 1);
+      vlib_node_increment_counter (vm, node->node_index,
+				   HQOS_OUTPUT_ERROR_HANDOFF, n_enq);
+      if (n_enq < n_handoffs)
+	vlib_node_increment_counter (vm, node->node_index,
+				     HQOS_OUTPUT_ERROR_CONGESTION_DROP,
+				     n_handoffs - n_enq);
+    }
+
+  vlib_node_increment_counter (vm, node->node_index, HQOS_OUTPUT_ERROR_QUEUED,
+			       n_queued);
+  return frame->n_vectors;
+}
+
+VLIB_NODE_FN (hqos_output_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+    return hqos_output_inline (vm, node, frame, 1 /* is_trace */);
+  else
+    return hqos_output_inline (vm, node, frame, 0 /* is_trace */);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+VLIB_REGISTER_NODE (hqos_output_node) = {
+  .name = "hqos-output",
+  .vector_size = sizeof (u32),
+  .format_trace = format_hqos_output_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+
+  .n_errors = ARRAY_LEN (hqos_output_error_strings),
+  .error_strings = hqos_output_error_strings,
+
+  .n_next_nodes = HQOS_OUTPUT_N_NEXT,
+  .next_nodes = {
+    [HQOS_OUTPUT_NEXT_DROP] = "error-drop",
+  },
+};
+#endif /* CLIB_MARCH_VARIANT */
+
+/*
+ * Take a node that ran out of tokens out of the schedule until the timer
+ * fires, when it is back to a non-negative balance.
+ */
+static_always_inline void
+hqos_node_throttle (hqos_port_t *hp, hqos_node_t *n)
+{
+  u64 ticks;
+
+  ticks = 1 + (u64) ((-n->tokens / n->rate) / HQOS_TIMER_INTERVAL);
+
+  hqos_node_deactivate (hp, n);
+  n->flags |= HQOS_NODE_F_THROTTLED;
+  n->timer_handle =
+    tw_timer_start_1t_3w_1024sl_ov (&hp->wheel, n - hp->nodes, 0, ticks);
+}
+
+static_always_inline void
+hqos_port_expire_timers (hqos_port_t *hp, f64 now)
+{
+  hqos_node_t *n;
+  u32 *ni;
+
+  vec_reset_length (hp->expired);
+  hp->expired = tw_timer_expire_timers_vec_1t_3w_1024sl_ov (&hp->wheel, now,
+							     hp->expired);
+
+  vec_foreach (ni, hp->expired)
+    {
+      n = hqos_node_get (hp, ni[0]);
+      n->timer_handle = ~0;
+      n->flags &= ~HQOS_NODE_F_THROTTLED;
+      hqos_shaper_refill (n, now);
+
+      if (n->parent != ~0 && hqos_node_has_backlog (n))
+	hqos_node_activate (hp, n);
+    }
+}
+
+/*
+ * Dequeue the next packet of the port, walking down from the port through
+ * the highest priority scheduled child at each level. The nodes on the path
+ * are then charged for the packet.
+ */
+static_always_inline u32
+hqos_dequeue_one (vlib_main_t *vm, hqos_port_t *hp, f64 now, u32 *bi)
+{
+  hqos_node_t *root, *leaf, *n, *p;
+  u32 len;
+
+  root = hqos_node_get (hp, hp->root);
+  if (!root->active_mask || (root->flags & HQOS_NODE_F_THROTTLED))
+    return 0;
+
+  n = root;
+  while (n->level != HQOS_LEVEL_TC)
+    n = hqos_node_get (
+      hp, n->active_head[count_trailing_zeros (n->active_mask)]);
+  leaf = n;
+
+  *bi = leaf->ring[leaf->ring_head];
+  leaf->ring_head = (leaf->ring_head + 1) & (hp->queue_size - 1);
+  leaf->ring_len--;
+  hp->n_queued--;
+
+  len = vlib_buffer_length_in_chain (vm, vlib_get_buffer (vm, *bi));
+  leaf->n_tx_packets++;
+  leaf->n_tx_bytes += len;
+
+  while (1)
+    {
+      if (n->rate != 0)
+	{
+	  hqos_shaper_refill (n, now);
+	  n->tokens -= len;
+	}
+      if (n->parent == ~0)
+	break;
+
+      /* move on to the next sibling once the quantum is used up */
+      p = hqos_node_get (hp, n->parent);
+      n->deficit -= len;
+      if (n->deficit <= 0)
+	{
+	  n->deficit += n->quantum;
+	  p->active_head[n->priority] = n->next;
+	}
+      n = p;
+    }
+
+  if (leaf->ring_len == 0)
+    hqos_node_deactivate (hp, leaf);
+
+  for (n = leaf; n; n = (n->parent == ~0 ? 0 : hqos_node_get (hp, n->parent)))
+    if (n->rate != 0 && n->tokens < 0)
+      hqos_node_throttle (hp, n);
+
+  return 1;
+}
+
+always_inline uword
+hqos_sched_inline (vlib_main_t *vm, vlib_node_runtime_t *node, int is_trace)
+{
+  hqos_main_t *hm = &hqos_main;
+  u32 bis[HQOS_MAX_TX_BURST];
+  u32 n_tx, n_tx_total = 0;
+  hqos_port_t *hp;
+  u32 *pi;
+  f64 now;
+
+  if (vm->thread_index >= vec_len (hm->ports_by_thread))
+    return 0;
+
+  now = vlib_time_now (vm);
+
+  vec_foreach (pi, hm->ports_by_thread[vm->thread_index])
+    {
+      hp = pool_elt_at_index (hm->ports, pi[0]);
+
+      hqos_port_expire_timers (hp, now);
+
+      n_tx = 0;
+      while (hp->n_queued && n_tx < HQOS_MAX_TX_BURST &&
+	     hqos_dequeue_one (vm, hp, now, &bis[n_tx]))
+	n_tx++;
+
+      if (!n_tx)
+	continue;
+
+      if (is_trace)
+	{
+	  u32 i;
+
+	  for (i = 0; i < n_tx; i++)
+	    {
+	      vlib_buffer_t *b = vlib_get_buffer (vm, bis[i]);
+	      if (b->flags & VLIB_BUFFER_IS_TRACED)
+		{
+		  hqos_sched_trace_t *t =
+		    vlib_add_trace (vm, node, b, sizeof (*t));
+		  t->port_index = pi[0];
+		  t->sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_TX];
+		  t->tc = hqos_buffer_tc (hp, b);
+		}
+	    }
+	}
+
+      vlib_buffer_enqueue_to_single_next (vm, node, bis, HQOS_SCHED_NEXT_TX,
+					  n_tx);
+      n_tx_total += n_tx;
+    }
+
+  if (n_tx_total)
+    vlib_node_increment_counter (vm, node->node_index,
+				 HQOS_SCHED_ERROR_TRANSMITTED, n_tx_total);
+  return n_tx_total;
+}
+
+VLIB_NODE_FN (hqos_sched_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+    return hqos_sched_inline (vm, node, 1 /* is_trace */);
+  else
+    return hqos_sched_inline (vm, node, 0 /* is_trace */);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+VLIB_REGISTER_NODE (hqos_sched_node) = {
+  .type = VLIB_NODE_TYPE_INPUT,
+  .name = "hqos-sched",
+
+  /* enabled on the threads serving a port */
+  .state = VLIB_NODE_STATE_DISABLED,
+
+  .format_trace = format_hqos_sched_trace,
+
+  .n_errors = ARRAY_LEN (hqos_sched_error_strings),
+  .error_strings = hqos_sched_error_strings,
+
+  .n_next_nodes = HQOS_SCHED_N_NEXT,
+  .next_nodes = {
+    [HQOS_SCHED_NEXT_TX] = "interface-output-arc-end",
+  },
+};
+#endif /* CLIB_MARCH_VARIANT */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
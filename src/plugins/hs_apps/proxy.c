@@ -680,6 +680,9 @@ proxy_session_start_connect (proxy_session_side_ctx_t *sc, session_t *s)
 
   a->api_context = ps_index;
   a->app_index = pm->active_open_app_index;
+  /* ask for a source port whose return traffic lands on this thread */
+  a->sep_ext.thread_hint = s->thread_index;
+  a->sep_ext.transport_flags |= TRANSPORT_CFG_F_THREAD_HINT;
 
   if (proxy_transport_needs_crypto (a->sep.transport_proto))
     {
@@ -35,6 +35,7 @@
 #include <nat/nat44-ed/nat44_ed.h>
 #include <nat/nat44-ed/nat44_ed_affinity.h>
 #include <nat/nat44-ed/nat44_ed_inlines.h>
+#include <nat/nat44-ed/nat44_ed_offload.h>
 
 #include <vlib/stats/stats.h>
 
@@ -2674,6 +2675,8 @@ nat44_plugin_disable ()
 
   fail_if_disabled ();
 
+  nat44_ed_offload_disable ();
+
   rc = nat44_ed_del_static_mappings ();
   if (rc)
     error = VNET_API_ERROR_BUG;
@@ -3017,6 +3020,11 @@ nat44_ed_get_in2out_worker_index (vlib_buffer_t *b, ip4_header_t *ip,
 	    }
 	}
 
+      if (PREDICT_TRUE (!is_output) && ip->protocol != IP_PROTOCOL_ICMP &&
+	  nat44_ed_offload_handoff_lookup (b, ip, fib_index,
+					   &next_worker_index))
+	goto out;
+
       init_ed_k (&kv16, ip->src_address.as_u32,
 		 vnet_buffer (b)->ip.reass.l4_src_port, ip->dst_address.as_u32,
 		 vnet_buffer (b)->ip.reass.l4_dst_port, fib_index,
@@ -3112,6 +3120,14 @@ nat44_ed_get_out2in_worker_index (vlib_buffer_t *b, ip4_header_t *ip,
 	}
     }
 
+  if (IP_PROTOCOL_ICMP != proto)
+    {
+      u32 thread_index;
+      if (nat44_ed_offload_handoff_lookup (b, ip, rx_fib_index,
+					   &thread_index))
+	return thread_index;
+    }
+
   init_ed_k (&kv16, ip->src_address.as_u32,
 	     vnet_buffer (b)->ip.reass.l4_src_port, ip->dst_address.as_u32,
 	     vnet_buffer (b)->ip.reass.l4_dst_port, rx_fib_index,
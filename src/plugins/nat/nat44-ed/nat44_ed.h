@@ -168,6 +168,8 @@ format_function_t format_nat44_ed_tcp_state;
 #define SNAT_SESSION_FLAG_AFFINITY	     (1 << 6)
 #define SNAT_SESSION_FLAG_EXACT_ADDRESS	     (1 << 7)
 #define SNAT_SESSION_FLAG_HAIRPINNING	     (1 << 8)
+#define SNAT_SESSION_FLAG_OFFLOAD_I2O	     (1 << 9)
+#define SNAT_SESSION_FLAG_OFFLOAD_O2I	     (1 << 10)
 
 /* NAT interface flags */
 #define NAT_INTERFACE_FLAG_IS_INSIDE 1
@@ -336,6 +338,11 @@ typedef CLIB_PACKED(struct
   u32 per_vrf_sessions_index;
 
   u32 thread_index;
+
+  /* NIC flow offload entries, valid with SNAT_SESSION_FLAG_OFFLOAD_* */
+  u32 offload_index[NAT44_ED_N_DIR];
+  /* creation time, for the minimum age of an offloaded session */
+  f64 create_time;
 }) snat_session_t;
 
 typedef struct
@@ -835,6 +842,9 @@ int snat_set_workers (uword *bitmap);
 int nat44_plugin_enable (nat44_config_t c);
 int nat44_plugin_disable ();
 
+/* drop the NIC flow offload of a session, see nat44_ed_offload.h */
+void nat44_ed_offload_session_del (snat_session_t *s, u32 thread_index);
+
 int nat44_ed_add_interface (u32 sw_if_index, u8 is_inside);
 int nat44_ed_del_interface (u32 sw_if_index, u8 is_inside);
 int nat44_ed_add_output_interface (u32 sw_if_index);
@@ -26,6 +26,7 @@
 #include <nat/nat44-ed/nat44_ed.h>
 #include <nat/nat44-ed/nat44_ed_inlines.h>
 #include <nat/nat44-ed/nat44_ed_affinity.h>
+#include <nat/nat44-ed/nat44_ed_offload.h>
 
 #define NAT44_ED_EXPECTED_ARGUMENT "expected required argument(s)"
 
@@ -1755,6 +1756,78 @@ done:
   return error;
 }
 
+static clib_error_t *
+nat44_ed_flow_offload_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				  vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *error = 0;
+  u32 min_packets = 10, max_flows = 64 << 10;
+  f64 min_age = 1.0;
+  u8 enable_set = 0, enable = 0;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, NAT44_ED_EXPECTED_ARGUMENT);
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (!enable_set && unformat (line_input, "enable"))
+	enable_set = enable = 1;
+      else if (!enable_set && unformat (line_input, "disable"))
+	enable_set = 1;
+      else if (unformat (line_input, "packets %u", &min_packets))
+	;
+      else if (unformat (line_input, "age %f", &min_age))
+	;
+      else if (unformat (line_input, "max-flows %u", &max_flows))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (!enable_set)
+    {
+      error = clib_error_return (0, "expected enable | disable");
+      goto done;
+    }
+
+  if (enable)
+    rv = nat44_ed_offload_enable (min_packets, min_age, max_flows);
+  else
+    rv = nat44_ed_offload_disable ();
+
+  if (rv == VNET_API_ERROR_INVALID_VALUE)
+    error = clib_error_return (0, "max-flows must be between %u and %u",
+			       vlib_get_n_threads (),
+			       NAT44_ED_OFFLOAD_MAX_FLOWS);
+  else if (rv)
+    error = clib_error_return (0, "flow offload already %s",
+			       enable ? "enabled" : "disabled");
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+static clib_error_t *
+nat44_ed_show_flow_offload_command_fn (vlib_main_t *vm,
+				       unformat_input_t *input,
+				       vlib_cli_command_t *cmd)
+{
+  int verbose = 0;
+
+  if (unformat (input, "verbose"))
+    verbose = 1;
+
+  vlib_cli_output (vm, "%U", format_nat44_ed_offload, verbose);
+  return 0;
+}
+
 static clib_error_t *
 set_timeout_command_fn (vlib_main_t * vm,
 			unformat_input_t * input, vlib_cli_command_t * cmd)
@@ -2358,6 +2431,44 @@ VLIB_CLI_COMMAND (snat_forwarding_set_command, static) = {
   .function = snat_forwarding_set_command_fn,
 };
 
+/*?
+ * @cliexpar
+ * @cliexstart{nat44 flow-offload}
+ * Enable or disable the offload of established sessions to the NIC.
+ * A session direction is offloaded once it has seen the given number of
+ * packets and is at least the given number of seconds old. The NIC marks
+ * the packets of the offloaded flows, which lets them skip the session
+ * lookup; the translation itself is still done in software.
+ * To enable flow offload, use:
+ *  vpp# nat44 flow-offload enable packets 10 age 1 max-flows 65536
+ * To disable flow offload, use:
+ *  vpp# nat44 flow-offload disable
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (nat44_ed_flow_offload_command, static) = {
+  .path = "nat44 flow-offload",
+  .short_help = "nat44 flow-offload enable [packets <n>] [age <sec>] "
+		"[max-flows <n>] | disable",
+  .function = nat44_ed_flow_offload_command_fn,
+};
+
+/*?
+ * @cliexpar
+ * @cliexstart{show nat44 flow-offload}
+ * Show NAT44 flow offload state and counters
+ * vpp# show nat44 flow-offload
+ * NAT44 flow offload enabled
+ * min packets 10, min age 1.00s, max flows 65536
+ * flows: active 2 installed 2 failed 0 removed 0
+ * mark hits 1024 misses 0
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (nat44_ed_show_flow_offload_command, static) = {
+  .path = "show nat44 flow-offload",
+  .short_help = "show nat44 flow-offload [verbose]",
+  .function = nat44_ed_show_flow_offload_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -30,6 +30,7 @@
 
 #include <nat/nat44-ed/nat44_ed.h>
 #include <nat/nat44-ed/nat44_ed_inlines.h>
+#include <nat/nat44-ed/nat44_ed_offload.h>
 
 static char *nat_in2out_ed_error_strings[] = {
 #define _(sym,string) string,
@@ -1179,6 +1180,19 @@ nat44_ed_in2out_fast_path_node_fn_inline (vlib_main_t *vm,
 	  s0 = NULL;
 	}
 
+      /* the NIC might have marked the packet with an offloaded flow */
+      if (!is_output_feature)
+	{
+	  u32 si =
+	    nat44_ed_offload_mark_lookup_local (b0, &lookup, thread_index);
+	  if (si != ~0)
+	    {
+	      s0 = pool_elt_at_index (tsm->sessions, si);
+	      lookup_skipped = 1;
+	      goto skip_lookup;
+	    }
+	}
+
       init_ed_k (&kv0, lookup.saddr.as_u32, lookup.sport, lookup.daddr.as_u32,
 		 lookup.dport, lookup.fib_index, lookup.proto);
 
@@ -1286,6 +1300,9 @@ nat44_ed_in2out_fast_path_node_fn_inline (vlib_main_t *vm,
 				     thread_index);
       /* Per-user LRU list maintenance */
       nat44_session_update_lru (sm, s0, thread_index);
+      if (!is_output_feature && f == &s0->i2o)
+	nat44_ed_offload_session_update (s0, f, NAT44_ED_DIR_I2O,
+					 rx_sw_if_index0, thread_index, now);
 
     trace0:
       if (PREDICT_FALSE
@@ -327,6 +327,9 @@ nat_ed_session_delete (snat_main_t *sm, snat_session_t *ses, u32 thread_index,
     nat_elog_warn (sm, "flow hash del failed");
   if (nat_ed_ses_o2i_flow_hash_add_del (sm, thread_index, ses, 0))
     nat_elog_warn (sm, "flow hash del failed");
+  if (ses->flags &
+      (SNAT_SESSION_FLAG_OFFLOAD_I2O | SNAT_SESSION_FLAG_OFFLOAD_O2I))
+    nat44_ed_offload_session_del (ses, thread_index);
   pool_put (tsm->sessions, ses);
   vlib_set_simple_counter (&sm->total_sessions, thread_index, 0,
 			   pool_elts (tsm->sessions));
@@ -397,6 +400,7 @@ nat_ed_session_alloc (snat_main_t *sm, u32 thread_index, f64 now, u8 proto)
   nat_ed_lru_insert (tsm, s, now, proto);
 
   s->ha_last_refreshed = now;
+  s->create_time = now;
   vlib_set_simple_counter (&sm->total_sessions, thread_index, 0,
 			   pool_elts (tsm->sessions));
 #if CLIB_ASSERT_ENABLE
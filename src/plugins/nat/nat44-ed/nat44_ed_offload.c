@@ -0,0 +1,436 @@
+/*
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file
+ * @brief NAT44 endpoint-dependent flow offload
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/flow/flow.h>
+
+#include <nat/nat44-ed/nat44_ed.h>
+#include <nat/nat44-ed/nat44_ed_offload.h>
+
+nat44_ed_offload_main_t nat44_ed_offload_main;
+
+/* entries given back by the main thread once the grace period is over */
+typedef struct
+{
+  u32 generation;
+  u32 *entries;
+} nat44_ed_offload_return_t;
+
+static void
+nat44_ed_offload_ptd_add_request (nat44_ed_offload_per_thread_t *ptd,
+				  u32 entry_index, u8 is_add)
+{
+  nat44_ed_offload_req_t *req;
+
+  clib_spinlock_lock (&ptd->lock);
+  vec_add2 (ptd->requests, req, 1);
+  req->entry_index = entry_index;
+  req->is_add = is_add;
+  clib_spinlock_unlock (&ptd->lock);
+}
+
+void
+nat44_ed_offload_session_add (snat_session_t *s, nat_6t_flow_t *f,
+			      nat44_ed_dir_e dir, u32 sw_if_index,
+			      u32 thread_index)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_per_thread_t *ptd =
+    vec_elt_at_index (om->per_thread, thread_index);
+  snat_main_per_thread_data_t *tsm =
+    vec_elt_at_index (snat_main.per_thread_data, thread_index);
+  nat44_ed_offload_entry_t *e;
+  u32 entry_index;
+
+  /* one attempt per session direction, successful or not */
+  s->flags |= nat44_ed_offload_session_flag (dir);
+  s->offload_index[dir] = ~0;
+
+  if (PREDICT_FALSE (!vec_len (ptd->free_entries)))
+    {
+      clib_spinlock_lock (&ptd->lock);
+      vec_append (ptd->free_entries, ptd->returned_entries);
+      vec_reset_length (ptd->returned_entries);
+      clib_spinlock_unlock (&ptd->lock);
+
+      if (!vec_len (ptd->free_entries))
+	{
+	  ptd->n_no_entry++;
+	  return;
+	}
+    }
+
+  entry_index = vec_pop (ptd->free_entries);
+  e = vec_elt_at_index (om->entries, entry_index);
+  e->match = f->match;
+  e->sw_if_index = sw_if_index;
+  clib_atomic_store_rel_n (&e->session_index, s - tsm->sessions);
+  s->offload_index[dir] = entry_index;
+
+  nat44_ed_offload_ptd_add_request (ptd, entry_index, 1);
+  ptd->n_requests++;
+}
+
+void
+nat44_ed_offload_session_del (snat_session_t *s, u32 thread_index)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_per_thread_t *ptd;
+  nat44_ed_dir_e dir;
+  u32 entry_index;
+
+  for (dir = NAT44_ED_DIR_I2O; dir < NAT44_ED_N_DIR; dir++)
+    {
+      if (!(s->flags & nat44_ed_offload_session_flag (dir)))
+	continue;
+
+      entry_index = s->offload_index[dir];
+      if (entry_index >= vec_len (om->entries))
+	continue;
+
+      /* marked packets take the regular lookup from now on */
+      clib_atomic_store_rel_n (&om->entries[entry_index].session_index, ~0);
+
+      ptd = vec_elt_at_index (om->per_thread, thread_index);
+      nat44_ed_offload_ptd_add_request (ptd, entry_index, 0);
+    }
+
+  s->flags &=
+    ~(SNAT_SESSION_FLAG_OFFLOAD_I2O | SNAT_SESSION_FLAG_OFFLOAD_O2I);
+}
+
+static void
+nat44_ed_offload_return_entries (uword data)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_return_t *r = (nat44_ed_offload_return_t *) data;
+  nat44_ed_offload_per_thread_t *ptd;
+  u32 *entry_index;
+
+  /* the entries are gone if offload was disabled in the meantime */
+  if (om->enabled && r->generation == om->generation)
+    {
+      vec_foreach (entry_index, r->entries)
+	{
+	  ptd = vec_elt_at_index (om->per_thread,
+				  *entry_index / om->entries_per_thread);
+	  clib_spinlock_lock (&ptd->lock);
+	  vec_add1 (ptd->returned_entries, *entry_index);
+	  clib_spinlock_unlock (&ptd->lock);
+	}
+    }
+
+  vec_free (r->entries);
+  clib_mem_free (r);
+}
+
+static void
+nat44_ed_offload_flow_del (nat44_ed_offload_entry_t *e)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+
+  if (e->flow_index == ~0)
+    return;
+
+  vnet_flow_del (vnet_get_main (), e->flow_index);
+  e->flow_index = ~0;
+  om->n_removed++;
+  om->n_active--;
+}
+
+static void
+nat44_ed_offload_flow_add (u32 entry_index)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_entry_t *e = vec_elt_at_index (om->entries, entry_index);
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_interface_t *hw;
+  nat_6t_t *m = &e->match;
+  u32 flow_index;
+  int rv;
+
+  /* the session went away before we got to it */
+  if (e->session_index == ~0)
+    return;
+
+  hw = vnet_get_sup_hw_interface_api_visible_or_null (vnm, e->sw_if_index);
+  if (!hw)
+    {
+      om->n_install_failures++;
+      return;
+    }
+
+  vnet_flow_t flow = {
+    .type = VNET_FLOW_TYPE_IP4_N_TUPLE,
+    .actions = VNET_FLOW_ACTION_MARK,
+    .mark_flow_id = om->flow_id_base + entry_index,
+    .ip4_n_tuple = {
+      .src_addr = { .addr = m->saddr, .mask.as_u32 = ~0 },
+      .dst_addr = { .addr = m->daddr, .mask.as_u32 = ~0 },
+      .protocol = { .prot = m->proto, .mask = 0xff },
+      .src_port = { .port = clib_net_to_host_u16 (m->sport), .mask = ~0 },
+      .dst_port = { .port = clib_net_to_host_u16 (m->dport), .mask = ~0 },
+    },
+  };
+
+  rv = vnet_flow_add (vnm, &flow, &flow_index);
+  if (rv)
+    {
+      om->n_install_failures++;
+      return;
+    }
+
+  rv = vnet_flow_enable (vnm, flow_index, hw->hw_if_index);
+  if (rv)
+    {
+      nat_log_debug ("flow offload on %U failed (%d)",
+		     format_vnet_hw_if_index_name, vnm, hw->hw_if_index, rv);
+      vnet_flow_del (vnm, flow_index);
+      om->n_install_failures++;
+      return;
+    }
+
+  e->flow_index = flow_index;
+  om->n_installed++;
+  om->n_active++;
+}
+
+static void
+nat44_ed_offload_service (vlib_main_t *vm)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_per_thread_t *ptd;
+  nat44_ed_offload_req_t *req;
+  nat44_ed_offload_return_t *r;
+  u32 *done = 0;
+
+  vec_foreach (ptd, om->per_thread)
+    {
+      clib_spinlock_lock (&ptd->lock);
+      vec_append (om->pending, ptd->requests);
+      vec_reset_length (ptd->requests);
+      clib_spinlock_unlock (&ptd->lock);
+    }
+
+  if (!vec_len (om->pending))
+    return;
+
+  /* neither the flow pool nor the drivers are thread safe */
+  vlib_worker_thread_barrier_sync (vm);
+
+  vec_foreach (req, om->pending)
+    {
+      if (req->is_add)
+	nat44_ed_offload_flow_add (req->entry_index);
+      else
+	{
+	  nat44_ed_offload_flow_del (
+	    vec_elt_at_index (om->entries, req->entry_index));
+	  vec_add1 (done, req->entry_index);
+	}
+    }
+
+  vlib_worker_thread_barrier_release (vm);
+
+  vec_reset_length (om->pending);
+
+  if (!done)
+    return;
+
+  /* packets marked with these entries may still be in flight */
+  r = clib_mem_alloc (sizeof (*r));
+  r->generation = om->generation;
+  r->entries = done;
+  vlib_worker_defer_one_loop (nat44_ed_offload_return_entries, (uword) r);
+}
+
+static uword
+nat44_ed_offload_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
+			  vlib_frame_t *f)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  uword *event_data = 0;
+
+  while (1)
+    {
+      if (om->enabled)
+	vlib_process_wait_for_event_or_clock (vm, NAT44_ED_OFFLOAD_INTERVAL);
+      else
+	vlib_process_wait_for_event (vm);
+
+      vlib_process_get_events (vm, &event_data);
+      vec_reset_length (event_data);
+
+      if (om->enabled)
+	nat44_ed_offload_service (vm);
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (nat44_ed_offload_process_node) = {
+  .function = nat44_ed_offload_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "nat44-ed-offload-process",
+};
+
+int
+nat44_ed_offload_enable (u32 min_packets, f64 min_age, u32 max_flows)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_per_thread_t *ptd;
+  vlib_main_t *vm = vlib_get_main ();
+  u32 n_threads = vlib_get_n_threads ();
+  u32 thread_index, i;
+
+  if (om->enabled)
+    return VNET_API_ERROR_FEATURE_ALREADY_ENABLED;
+
+  if (max_flows == 0 || max_flows > NAT44_ED_OFFLOAD_MAX_FLOWS ||
+      max_flows < n_threads)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (!om->flow_id_base)
+    vnet_flow_get_range (vnet_get_main (), "nat44-ed",
+			 NAT44_ED_OFFLOAD_MAX_FLOWS, &om->flow_id_base);
+
+  om->min_packets = min_packets;
+  om->min_age = min_age;
+  om->max_flows = max_flows;
+  om->entries_per_thread = max_flows / n_threads;
+
+  vec_validate (om->entries, om->entries_per_thread * n_threads - 1);
+  for (i = 0; i < vec_len (om->entries); i++)
+    {
+      om->entries[i].session_index = ~0;
+      om->entries[i].flow_index = ~0;
+    }
+
+  vec_validate_aligned (om->per_thread, n_threads - 1, CLIB_CACHE_LINE_BYTES);
+  vec_foreach_index (thread_index, om->per_thread)
+    {
+      ptd = vec_elt_at_index (om->per_thread, thread_index);
+      clib_spinlock_init (&ptd->lock);
+      /* hand out the low entries first */
+      for (i = om->entries_per_thread; i > 0; i--)
+	vec_add1 (ptd->free_entries,
+		  thread_index * om->entries_per_thread + i - 1);
+    }
+
+  om->enabled = 1;
+  vlib_process_signal_event (vm, nat44_ed_offload_process_node.index, 0, 0);
+
+  return 0;
+}
+
+int
+nat44_ed_offload_disable (void)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  snat_main_t *sm = &snat_main;
+  snat_main_per_thread_data_t *tsm;
+  nat44_ed_offload_per_thread_t *ptd;
+  nat44_ed_offload_entry_t *e;
+  vlib_main_t *vm = vlib_get_main ();
+  snat_session_t *s;
+
+  if (!om->enabled)
+    return VNET_API_ERROR_FEATURE_ALREADY_DISABLED;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  om->enabled = 0;
+  om->generation++;
+
+  vec_foreach (e, om->entries)
+    nat44_ed_offload_flow_del (e);
+
+  vec_foreach (tsm, sm->per_thread_data)
+    {
+      pool_foreach (s, tsm->sessions)
+	{
+	  s->flags &=
+	    ~(SNAT_SESSION_FLAG_OFFLOAD_I2O | SNAT_SESSION_FLAG_OFFLOAD_O2I);
+	}
+    }
+
+  vec_foreach (ptd, om->per_thread)
+    {
+      clib_spinlock_free (&ptd->lock);
+      vec_free (ptd->free_entries);
+      vec_free (ptd->requests);
+      vec_free (ptd->returned_entries);
+    }
+  vec_free (om->per_thread);
+  vec_free (om->entries);
+  vec_free (om->pending);
+  om->entries_per_thread = 0;
+
+  vlib_worker_thread_barrier_release (vm);
+
+  return 0;
+}
+
+u8 *
+format_nat44_ed_offload (u8 *s, va_list *args)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  int verbose = va_arg (*args, int);
+  nat44_ed_offload_per_thread_t *ptd;
+  u32 indent = format_get_indent (s);
+  u64 n_hits = 0, n_misses = 0;
+
+  if (!om->enabled)
+    return format (s, "NAT44 flow offload disabled");
+
+  s = format (s, "NAT44 flow offload enabled\n");
+  s = format (s, "%Umin packets %u, min age %.2fs, max flows %u\n",
+	      format_white_space, indent, om->min_packets, om->min_age,
+	      om->max_flows);
+  s = format (s, "%Uflows: active %u installed %llu failed %llu removed %llu",
+	      format_white_space, indent, om->n_active, om->n_installed,
+	      om->n_install_failures, om->n_removed);
+
+  vec_foreach (ptd, om->per_thread)
+    {
+      n_hits += ptd->n_mark_hits;
+      n_misses += ptd->n_mark_misses;
+      if (verbose)
+	s = format (s,
+		    "\n%Uthread %u: requests %llu no entry %llu "
+		    "free entries %u mark hits %llu misses %llu",
+		    format_white_space, indent + 2, ptd - om->per_thread,
+		    ptd->n_requests, ptd->n_no_entry,
+		    vec_len (ptd->free_entries), ptd->n_mark_hits,
+		    ptd->n_mark_misses);
+    }
+
+  s = format (s, "\n%Umark hits %llu misses %llu", format_white_space, indent,
+	      n_hits, n_misses);
+
+  return s;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
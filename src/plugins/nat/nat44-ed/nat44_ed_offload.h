@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file
+ * @brief NAT44 endpoint-dependent flow offload
+ *
+ * Established sessions are pushed to the NIC as n-tuple flows with a MARK
+ * action. The mark identifies an offload entry, which names the session
+ * and the thread owning it, so the marked packets skip the flow hash
+ * lookup. The NIC only classifies: the rewrite stays in software, and a
+ * packet whose mark is stale or missing simply takes the regular lookup.
+ *
+ * The entries are split in per-thread ranges. A worker takes an entry
+ * from its range when a session qualifies and hands it to the main
+ * thread to install the flow; when the session goes away the worker
+ * invalidates the entry at once and the main thread removes the flow and
+ * gives the entry back after a grace period.
+ */
+
+#ifndef __included_nat44_ed_offload_h__
+#define __included_nat44_ed_offload_h__
+
+#include <vppinfra/lock.h>
+#include <vnet/flow/flow.h>
+#include <nat/nat44-ed/nat44_ed.h>
+#include <nat/nat44-ed/nat44_ed_inlines.h>
+
+/* marks reserved in the vnet flow id space */
+#define NAT44_ED_OFFLOAD_MAX_FLOWS (1 << 20)
+/* how often the main thread services the requests of the workers */
+#define NAT44_ED_OFFLOAD_INTERVAL 0.1
+
+typedef struct
+{
+  /* flow the entry is for, written by the owning thread */
+  nat_6t_t match;
+  /* index of the session in the pool of the owning thread, or ~0 */
+  u32 session_index;
+  /* interface the flow packets are received on */
+  u32 sw_if_index;
+  /* installed vnet flow, owned by the main thread, or ~0 */
+  u32 flow_index;
+} nat44_ed_offload_entry_t;
+
+typedef struct
+{
+  u32 entry_index;
+  u8 is_add;
+} nat44_ed_offload_req_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* entries of this thread's range which are not in use */
+  u32 *free_entries;
+
+  /* protects the two vectors below */
+  clib_spinlock_t lock;
+  /* adds and deletes for the main thread, in order */
+  nat44_ed_offload_req_t *requests;
+  /* entries the main thread is done with */
+  u32 *returned_entries;
+
+  /* counters */
+  u64 n_mark_hits;
+  u64 n_mark_misses;
+  u64 n_requests;
+  u64 n_no_entry;
+} nat44_ed_offload_per_thread_t;
+
+typedef struct
+{
+  u8 enabled;
+
+  /* a session is offloaded after this many packets... */
+  u32 min_packets;
+  /* ...once it is at least this old (seconds) */
+  f64 min_age;
+  u32 max_flows;
+
+  /* mark of entry 0 */
+  u32 flow_id_base;
+
+  nat44_ed_offload_entry_t *entries;
+  u32 entries_per_thread;
+  nat44_ed_offload_per_thread_t *per_thread;
+
+  /* requests being serviced by the main thread */
+  nat44_ed_offload_req_t *pending;
+  /* bumped whenever the entries are freed */
+  u32 generation;
+
+  /* main thread counters */
+  u64 n_installed;
+  u64 n_install_failures;
+  u64 n_removed;
+  u32 n_active;
+} nat44_ed_offload_main_t;
+
+extern nat44_ed_offload_main_t nat44_ed_offload_main;
+
+int nat44_ed_offload_enable (u32 min_packets, f64 min_age, u32 max_flows);
+int nat44_ed_offload_disable (void);
+void nat44_ed_offload_session_add (snat_session_t *s, nat_6t_flow_t *f,
+				   nat44_ed_dir_e dir, u32 sw_if_index,
+				   u32 thread_index);
+format_function_t format_nat44_ed_offload;
+
+always_inline u32
+nat44_ed_offload_session_flag (nat44_ed_dir_e dir)
+{
+  return dir == NAT44_ED_DIR_I2O ? SNAT_SESSION_FLAG_OFFLOAD_I2O :
+				   SNAT_SESSION_FLAG_OFFLOAD_O2I;
+}
+
+/**
+ * @brief Look up the session of a packet marked by the NIC
+ *
+ * @param b buffer
+ * @param lookup flow of the packet
+ * @param thread_index [out] thread owning the session
+ *
+ * @returns session index, or ~0 if the packet carries no valid mark for
+ *          the flow
+ */
+always_inline u32
+nat44_ed_offload_mark_lookup (vlib_buffer_t *b, nat_6t_t *lookup,
+			      u32 *thread_index)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_entry_t *e;
+  u32 entry_index = b->flow_id - om->flow_id_base;
+  u32 session_index;
+
+  if (PREDICT_TRUE (entry_index >= vec_len (om->entries)))
+    return ~0;
+
+  e = vec_elt_at_index (om->entries, entry_index);
+  session_index = clib_atomic_load_acq_n (&e->session_index);
+  if (session_index == ~0 || !nat_6t_t_eq (&e->match, lookup))
+    return ~0;
+
+  *thread_index = entry_index / om->entries_per_thread;
+  return session_index;
+}
+
+/**
+ * @brief Session lookup shortcut for the fast path of the owning thread
+ */
+always_inline u32
+nat44_ed_offload_mark_lookup_local (vlib_buffer_t *b, nat_6t_t *lookup,
+				    u32 thread_index)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat44_ed_offload_per_thread_t *ptd;
+  u32 session_index, owner = ~0;
+
+  if (PREDICT_TRUE (!om->enabled))
+    return ~0;
+
+  ptd = vec_elt_at_index (om->per_thread, thread_index);
+  session_index = nat44_ed_offload_mark_lookup (b, lookup, &owner);
+  if (session_index == ~0 || owner != thread_index)
+    {
+      if (b->flow_id - om->flow_id_base < vec_len (om->entries))
+	ptd->n_mark_misses++;
+      return ~0;
+    }
+  ptd->n_mark_hits++;
+  return session_index;
+}
+
+/**
+ * @brief Session lookup shortcut for the handoff nodes
+ *
+ * Stashes the session index for the fast path of the owning thread.
+ *
+ * @returns 1 if the thread owning the session was found, 0 otherwise
+ */
+always_inline int
+nat44_ed_offload_handoff_lookup (vlib_buffer_t *b, ip4_header_t *ip,
+				 u32 fib_index, u32 *thread_index)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+  nat_6t_t lookup;
+  u32 session_index;
+
+  if (PREDICT_TRUE (!om->enabled))
+    return 0;
+
+  lookup.saddr.as_u32 = ip->src_address.as_u32;
+  lookup.daddr.as_u32 = ip->dst_address.as_u32;
+  lookup.sport = vnet_buffer (b)->ip.reass.l4_src_port;
+  lookup.dport = vnet_buffer (b)->ip.reass.l4_dst_port;
+  lookup.fib_index = fib_index;
+  lookup.proto = ip->protocol;
+
+  session_index = nat44_ed_offload_mark_lookup (b, &lookup, thread_index);
+  if (session_index == ~0)
+    return 0;
+
+  /* counted by the thread doing the handoff, as it saved the lookup */
+  vec_elt (om->per_thread, vlib_get_thread_index ()).n_mark_hits++;
+  vnet_buffer2 (b)->nat.cached_session_index = session_index;
+  return 1;
+}
+
+/**
+ * @brief Request the offload of a session direction once it qualifies
+ */
+always_inline void
+nat44_ed_offload_session_update (snat_session_t *s, nat_6t_flow_t *f,
+				 nat44_ed_dir_e dir, u32 sw_if_index,
+				 u32 thread_index, f64 now)
+{
+  nat44_ed_offload_main_t *om = &nat44_ed_offload_main;
+
+  if (PREDICT_TRUE (!om->enabled))
+    return;
+
+  if (s->flags & nat44_ed_offload_session_flag (dir) ||
+      s->total_pkts < om->min_packets ||
+      (s->proto != IP_PROTOCOL_TCP && s->proto != IP_PROTOCOL_UDP))
+    return;
+
+  if (now - s->create_time < om->min_age)
+    return;
+
+  nat44_ed_offload_session_add (s, f, dir, sw_if_index, thread_index);
+}
+
+#endif /* __included_nat44_ed_offload_h__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -29,6 +29,7 @@
 
 #include <nat/nat44-ed/nat44_ed.h>
 #include <nat/nat44-ed/nat44_ed_inlines.h>
+#include <nat/nat44-ed/nat44_ed_offload.h>
 
 static char *nat_out2in_ed_error_strings[] = {
 #define _(sym,string) string,
@@ -857,6 +858,16 @@ nat44_ed_out2in_fast_path_node_fn_inline (vlib_main_t * vm,
 	  s0 = NULL;
 	}
 
+      /* the NIC might have marked the packet with an offloaded flow */
+      u32 offload_si =
+	nat44_ed_offload_mark_lookup_local (b0, &lookup, thread_index);
+      if (offload_si != ~0)
+	{
+	  s0 = pool_elt_at_index (tsm->sessions, offload_si);
+	  lookup_skipped = 1;
+	  goto skip_lookup;
+	}
+
       init_ed_k (&kv0, lookup.saddr.as_u32, lookup.sport, lookup.daddr.as_u32,
 		 lookup.dport, lookup.fib_index, lookup.proto);
 
@@ -992,6 +1003,9 @@ nat44_ed_out2in_fast_path_node_fn_inline (vlib_main_t * vm,
 				     thread_index);
       /* Per-user LRU list maintenance */
       nat44_session_update_lru (sm, s0, thread_index);
+      if (f == &s0->o2i)
+	nat44_ed_offload_session_update (s0, f, NAT44_ED_DIR_O2I, sw_if_index0,
+					 thread_index, now);
 
     trace0:
       if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
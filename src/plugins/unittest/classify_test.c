@@ -0,0 +1,240 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vppinfra/time.h>
+#include <vppinfra/random.h>
+#include <vnet/classify/vnet_classify.h>
+
+#define CLASSIFY_TEST_PACKET_SIZE 64
+#define CLASSIFY_TEST_N_ROUNDS	  5
+
+typedef struct
+{
+  int verbose;
+  u32 n_sessions;
+  u32 n_packets;
+  u32 n_tables;
+  u32 rounds;
+  u32 seed;
+} classify_test_main_t;
+
+static classify_test_main_t classify_test_main;
+
+/*
+ * The key is the 8 bytes at offset 16, i.e. one skip vector, one match
+ * vector.
+ */
+static void
+classify_test_make_key (u8 *h, u32 k)
+{
+  clib_memset (h, 0xa5, CLASSIFY_TEST_PACKET_SIZE);
+  *(u32u *) (h + 16) = clib_host_to_net_u32 (k);
+  *(u32u *) (h + 20) = clib_host_to_net_u32 (k * 2654435761);
+}
+
+/*
+ * The per-packet walk of a table chain the classify nodes used
+ */
+static vnet_classify_entry_t *
+classify_test_scalar_lookup (u32 table_index, const u8 *h, f64 now,
+			     u32 *hit_table_index)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  vnet_classify_table_t *t;
+  vnet_classify_entry_t *e;
+  u32 hash;
+
+  *hit_table_index = table_index;
+
+  while (table_index != ~0)
+    {
+      t = pool_elt_at_index (cm->tables, table_index);
+      hash = vnet_classify_hash_packet (t, (u8 *) h);
+      e = vnet_classify_find_entry (t, (u8 *) h, hash, now);
+      *hit_table_index = table_index;
+
+      if (e)
+	return e;
+
+      table_index = t->next_table_index;
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+test_classify_batch (vlib_main_t *vm, classify_test_main_t *tm)
+{
+  vnet_classify_main_t *cm = &vnet_classify_main;
+  u32 n_packets = tm->n_packets, n_tables = tm->n_tables;
+  u32 *table_indices = 0, head_table_index = ~0;
+  u32 i, j, k, round, seed = tm->seed, n_hits = 0, n_errors = 0;
+  u64 t0[CLASSIFY_TEST_N_ROUNDS], t1[CLASSIFY_TEST_N_ROUNDS];
+  u64 t2[CLASSIFY_TEST_N_ROUNDS];
+  u8 mask[VNET_CLASSIFY_VECTOR_SIZE] = {};
+  u8 *data = 0, *match;
+  const u8 *headers[VLIB_FRAME_SIZE];
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE], *e;
+  u32 starts[VLIB_FRAME_SIZE], hits[VLIB_FRAME_SIZE], hit;
+  clib_error_t *err = 0;
+  f64 now = vlib_time_now (vm);
+  int rv;
+
+  if (n_packets == 0 || n_packets > VLIB_FRAME_SIZE)
+    return clib_error_return (0, "packets must be 1..%d", VLIB_FRAME_SIZE);
+  if (n_tables == 0)
+    return clib_error_return (0, "tables must be non-zero");
+
+  clib_memset (mask, 0xff, 8);
+
+  /* build the chain back to front, so each table knows its next */
+  vec_validate_init_empty (table_indices, n_tables - 1, ~0);
+  for (i = n_tables; i > 0; i--)
+    {
+      rv = vnet_classify_add_del_table (
+	cm, mask, clib_max (tm->n_sessions / n_tables / 2, 1),
+	(2 << 20) + tm->n_sessions * 128, 1 /* skip */, 1 /* match */,
+	head_table_index, ~0 /* miss next */, &table_indices[i - 1], 0, 0,
+	1 /* is_add */, 0);
+      if (rv)
+	{
+	  err = clib_error_return (0, "table add failed: %d", rv);
+	  goto done;
+	}
+      head_table_index = table_indices[i - 1];
+    }
+
+  /* spread the sessions over the tables in the chain */
+  vec_validate (data, CLASSIFY_TEST_PACKET_SIZE - 1);
+  match = data;
+  for (k = 0; k < tm->n_sessions; k++)
+    {
+      classify_test_make_key (match, k);
+      rv = vnet_classify_add_del_session (cm, table_indices[k % n_tables],
+					  match, 0, k, 0, 0, 0, 1 /* is_add */);
+      if (rv)
+	{
+	  err = clib_error_return (0, "session add failed: %d", rv);
+	  goto done;
+	}
+    }
+
+  /* half the packets should match, the others miss the whole chain */
+  vec_validate (data, n_packets * CLASSIFY_TEST_PACKET_SIZE - 1);
+  for (i = 0; i < n_packets; i++)
+    {
+      headers[i] = data + i * CLASSIFY_TEST_PACKET_SIZE;
+      classify_test_make_key ((u8 *) headers[i],
+			      random_u32 (&seed) % (2 * tm->n_sessions + 1));
+      starts[i] = head_table_index;
+    }
+
+  /* the batch must give the same answers as the scalar walk */
+  n_hits = vnet_classify_find_entries_inline (starts, headers, n_packets, now,
+					      1 /* walk_chain */, entries, hits);
+  for (i = 0; i < n_packets; i++)
+    {
+      e = classify_test_scalar_lookup (head_table_index, headers[i], now,
+				       &hit);
+      if (e != entries[i] || hit != hits[i])
+	{
+	  if (tm->verbose)
+	    vlib_cli_output (vm, "packet %d: scalar %p/%d batch %p/%d", i, e,
+			     hit, entries[i], hits[i]);
+	  n_errors++;
+	}
+    }
+  if (n_errors)
+    {
+      err = clib_error_return (0, "%d of %d lookups differ", n_errors,
+			       n_packets);
+      goto done;
+    }
+
+  for (round = 0; round < CLASSIFY_TEST_N_ROUNDS; round++)
+    {
+      t0[round] = clib_cpu_time_now ();
+      for (j = 0; j < tm->rounds; j++)
+	for (i = 0; i < n_packets; i++)
+	  entries[i] = classify_test_scalar_lookup (head_table_index,
+						    headers[i], now, &hits[i]);
+      t1[round] = clib_cpu_time_now ();
+      for (j = 0; j < tm->rounds; j++)
+	vnet_classify_find_entries_inline (starts, headers, n_packets, now,
+					   1 /* walk_chain */, entries, hits);
+      t2[round] = clib_cpu_time_now ();
+    }
+
+  vlib_cli_output (vm, "%d sessions in %d tables, %d packets, %d hits",
+		   tm->n_sessions, n_tables, n_packets, n_hits);
+  for (round = 0; round < CLASSIFY_TEST_N_ROUNDS; round++)
+    {
+      f64 scalar = (f64) (t1[round] - t0[round]) / (n_packets * tm->rounds);
+      f64 batch = (f64) (t2[round] - t1[round]) / (n_packets * tm->rounds);
+
+      vlib_cli_output (vm,
+		       "%-2u: scalar %.02f ticks/packet, batch %.02f "
+		       "ticks/packet",
+		       round + 1, scalar, batch);
+    }
+
+done:
+  if (head_table_index != ~0)
+    vnet_classify_delete_table_index (cm, head_table_index, 1 /* chain */);
+  vec_free (table_indices);
+  vec_free (data);
+  return err;
+}
+
+static clib_error_t *
+test_classify_batch_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				vlib_cli_command_t *cmd)
+{
+  classify_test_main_t *tm = &classify_test_main;
+
+  tm->verbose = 0;
+  tm->n_sessions = 10000;
+  tm->n_packets = VLIB_FRAME_SIZE;
+  tm->n_tables = 2;
+  tm->rounds = 1000;
+  tm->seed = 0xdeaddabe;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "verbose"))
+	tm->verbose = 1;
+      else if (unformat (input, "sessions %u", &tm->n_sessions))
+	;
+      else if (unformat (input, "packets %u", &tm->n_packets))
+	;
+      else if (unformat (input, "tables %u", &tm->n_tables))
+	;
+      else if (unformat (input, "rounds %u", &tm->rounds))
+	;
+      else if (unformat (input, "seed %u", &tm->seed))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  return test_classify_batch (vm, tm);
+}
+
+VLIB_CLI_COMMAND (test_classify_batch_command, static) = {
+  .path = "test classify batch",
+  .short_help = "test classify batch [sessions <n>] [packets <n>] "
+		"[tables <n>] [rounds <n>] [seed <n>] [verbose]",
+  .function = test_classify_batch_command_fn,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -72,6 +72,26 @@ UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_tc1) = {
   .ciphertext = TEST_DATA (tc1_ciphertext),
 };
 
+UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_tc1_chain) = {
+  .name = "CHACHA20-POLY1305 TC1 [chained]",
+  .alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .key = TEST_DATA (tc1_key),
+  .iv = TEST_DATA (tc1_iv),
+  .aad = TEST_DATA (tc1_aad),
+  .tag = TEST_DATA (tc1_tag),
+  .is_chained = 1,
+  .pt_chunks = {
+    TEST_DATA_CHUNK (tc1_plaintext, 0, 20),
+    TEST_DATA_CHUNK (tc1_plaintext, 20, 50),
+    TEST_DATA_CHUNK (tc1_plaintext, 70, 44),
+  },
+  .ct_chunks = {
+    TEST_DATA_CHUNK (tc1_ciphertext, 0, 20),
+    TEST_DATA_CHUNK (tc1_ciphertext, 20, 50),
+    TEST_DATA_CHUNK (tc1_ciphertext, 70, 44),
+  },
+};
+
 static u8 tc2_key[] = {
     0x2d, 0xb0, 0x5d, 0x40, 0xc8, 0xed, 0x44, 0x88,
     0x34, 0xd1, 0x13, 0xaf, 0x57, 0xa1, 0xeb, 0x3a,
@@ -144,3 +164,47 @@ UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_tc3) = {
   .ciphertext = TEST_DATA (tc3_ciphertext),
 };
 
+UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_inc_1024) = {
+  .name = "CHACHA20-POLY1305 (incr 1024 B)",
+  .alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .plaintext_incremental = 1024,
+  .key.length = 32,
+  .aad.length = 12,
+  .tag.length = 16,
+};
+
+UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_inc1) = {
+  .name = "CHACHA20-POLY1305 (incr 1088 B)",
+  .alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .plaintext_incremental = 1024 + 64,
+  .key.length = 32,
+  .aad.length = 12,
+  .tag.length = 16,
+};
+
+UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_inc2) = {
+  .name = "CHACHA20-POLY1305 (incr 1025 B)",
+  .alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .plaintext_incremental = 1024 + 1,
+  .key.length = 32,
+  .aad.length = 12,
+  .tag.length = 16,
+};
+
+UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_inc3) = {
+  .name = "CHACHA20-POLY1305 (incr 1009 B)",
+  .alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .plaintext_incremental = 1024 - 15,
+  .key.length = 32,
+  .aad.length = 12,
+  .tag.length = 16,
+};
+
+UNITTEST_REGISTER_CRYPTO_TEST (chacha20_poly1305_inc4) = {
+  .name = "CHACHA20-POLY1305 (incr 960 B)",
+  .alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305,
+  .plaintext_incremental = 1024 - 64,
+  .key.length = 32,
+  .aad.length = 12,
+  .tag.length = 16,
+};
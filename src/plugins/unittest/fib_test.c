@@ -5336,6 +5336,176 @@ fib_test_v6 (void)
     return (res);
 }
 
+/*
+ * Validate that the mtrie and the hash forwarding lookups agree with the
+ * LPM in the non-forwarding table for each of the addresses
+ */
+static int
+fib_test_v6_mtrie_validate (u32 fib_index,
+                            const ip6_address_t *addrs,
+                            u32 n_addrs)
+{
+    fib_node_index_t fei;
+    index_t lbi, hlbi, lbi2[2];
+    const dpo_id_t *dpo;
+    int ii, res;
+
+    res = 0;
+
+    for (ii = 0; ii < n_addrs; ii++)
+    {
+        fib_prefix_t pfx = {
+            .fp_len = 128,
+            .fp_proto = FIB_PROTOCOL_IP6,
+            .fp_addr.ip6 = addrs[ii],
+        };
+
+        fei = fib_table_lookup(fib_index, &pfx);
+        dpo = fib_entry_contribute_ip_forwarding(fei);
+
+        lbi = ip6_fib_table_fwding_lookup(fib_index, &addrs[ii]);
+        hlbi = ip6_fib_table_fwding_hash_lookup(fib_index, &addrs[ii]);
+
+        FIB_TEST((dpo->dpoi_index == lbi),
+                 "%U; fwd and non-fwd tables match: %d != %d",
+                 format_ip6_address, &addrs[ii], dpo->dpoi_index, lbi);
+        FIB_TEST((hlbi == lbi),
+                 "%U; %U and hash lookups match: %d != %d",
+                 format_ip6_address, &addrs[ii],
+                 format_ip6_fib_lookup_engine,
+                 ip6_fib_table_get_lookup_engine(fib_index),
+                 lbi, hlbi);
+
+        ip6_fib_table_fwding_lookup_x2(fib_index, fib_index,
+                                       &addrs[ii],
+                                       &addrs[(ii + 1) % n_addrs],
+                                       &lbi2[0], &lbi2[1]);
+        FIB_TEST((lbi2[0] == lbi &&
+                  lbi2[1] == ip6_fib_table_fwding_lookup(
+                      fib_index, &addrs[(ii + 1) % n_addrs])),
+                 "%U; x2 lookup matches", format_ip6_address, &addrs[ii]);
+    }
+
+    return (res);
+}
+
+/*
+ * Test the IPv6 mtrie lookup engine
+ */
+static int
+fib_test_v6_mtrie (void)
+{
+    u32 fib_index, ii;
+    int res;
+
+#define FIB_TEST_V6_PFX(_hi, _lo, _len)                                 \
+    {                                                                   \
+        .fp_len = _len,                                                 \
+        .fp_proto = FIB_PROTOCOL_IP6,                                   \
+        .fp_addr.ip6.as_u64 = {                                         \
+            [0] = clib_host_to_net_u64(_hi),                            \
+            [1] = clib_host_to_net_u64(_lo),                            \
+        },                                                              \
+    }
+    /*
+     * prefixes that end in the root ply, on a ply boundary,
+     * mid-ply and in the last ply
+     */
+    fib_prefix_t pfxs[] = {
+        FIB_TEST_V6_PFX(0x3000000000000000, 0, 7),
+        FIB_TEST_V6_PFX(0x2000000000000000, 0, 12),
+        FIB_TEST_V6_PFX(0x20010db800000000, 0, 32),
+        FIB_TEST_V6_PFX(0x20010db880000000, 0, 33),
+        FIB_TEST_V6_PFX(0x20010db800010000, 0, 48),
+        FIB_TEST_V6_PFX(0x20010db800010001, 0, 64),
+        FIB_TEST_V6_PFX(0x20010db800010001, 0x0000000000000100, 121),
+        FIB_TEST_V6_PFX(0x20010db800010001, 0x0000000000000001, 128),
+    };
+    ip6_address_t addrs[] = {
+        { .as_u64 = { clib_host_to_net_u64(0x3100000000000000), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x4000000000000000), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x2001000000000000), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db800000001), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db880000001), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db800010002), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db800010001), 0 } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db800010001),
+                      clib_host_to_net_u64(0x0000000000000001) } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db800010001),
+                      clib_host_to_net_u64(0x0000000000000102) } },
+        { .as_u64 = { clib_host_to_net_u64(0x20010db800010001),
+                      clib_host_to_net_u64(0x0000000000000180) } },
+        { .as_u64 = { clib_host_to_net_u64(0xfe80000000000000),
+                      clib_host_to_net_u64(0x0000000000000001) } },
+    };
+#undef FIB_TEST_V6_PFX
+
+    res = 0;
+    fib_index = fib_table_find_or_create_and_lock(FIB_PROTOCOL_IP6, 12,
+                                                  FIB_SOURCE_API);
+
+    FIB_TEST((IP6_FIB_LOOKUP_ENGINE_HASH ==
+              ip6_fib_table_get_lookup_engine(fib_index)),
+             "table uses the hash by default");
+
+    /*
+     * add half the routes, then build the mtrie from the table
+     */
+    for (ii = 0; ii < ARRAY_LEN(pfxs); ii += 2)
+        fib_table_entry_special_add(fib_index, &pfxs[ii],
+                                    FIB_SOURCE_API, FIB_ENTRY_FLAG_DROP);
+
+    ip6_fib_table_set_lookup_engine(fib_index, IP6_FIB_LOOKUP_ENGINE_MTRIE);
+    FIB_TEST((IP6_FIB_LOOKUP_ENGINE_MTRIE ==
+              ip6_fib_table_get_lookup_engine(fib_index)),
+             "table uses the mtrie");
+    res += fib_test_v6_mtrie_validate(fib_index, addrs, ARRAY_LEN(addrs));
+
+    /*
+     * the rest are inserted directly into the trie
+     */
+    for (ii = 1; ii < ARRAY_LEN(pfxs); ii += 2)
+        fib_table_entry_special_add(fib_index, &pfxs[ii],
+                                    FIB_SOURCE_API, FIB_ENTRY_FLAG_DROP);
+    res += fib_test_v6_mtrie_validate(fib_index, addrs, ARRAY_LEN(addrs));
+
+    /*
+     * remove the less specifics, the more specifics must remain
+     */
+    for (ii = 0; ii < ARRAY_LEN(pfxs) / 2; ii++)
+    {
+        fib_table_entry_special_remove(fib_index, &pfxs[ii], FIB_SOURCE_API);
+        res += fib_test_v6_mtrie_validate(fib_index, addrs, ARRAY_LEN(addrs));
+    }
+
+    /*
+     * back to the hash and then to a rebuilt trie
+     */
+    ip6_fib_table_set_lookup_engine(fib_index, IP6_FIB_LOOKUP_ENGINE_HASH);
+    FIB_TEST((NULL == ip6_fib_table_get_mtrie(fib_index)),
+             "table uses the hash");
+    res += fib_test_v6_mtrie_validate(fib_index, addrs, ARRAY_LEN(addrs));
+
+    ip6_fib_table_set_lookup_engine(fib_index, IP6_FIB_LOOKUP_ENGINE_MTRIE);
+    res += fib_test_v6_mtrie_validate(fib_index, addrs, ARRAY_LEN(addrs));
+
+    /*
+     * remove the more specifics, most specific first
+     */
+    for (ii = ARRAY_LEN(pfxs) - 1; ii >= ARRAY_LEN(pfxs) / 2; ii--)
+    {
+        fib_table_entry_special_remove(fib_index, &pfxs[ii], FIB_SOURCE_API);
+        res += fib_test_v6_mtrie_validate(fib_index, addrs, ARRAY_LEN(addrs));
+    }
+
+    /*
+     * the table is destroyed with the trie still in use
+     */
+    fib_table_unlock(fib_index, FIB_PROTOCOL_IP6, FIB_SOURCE_API);
+
+    return (res);
+}
+
 /*
  * Test Attached Exports
  */
@@ -10860,6 +11030,146 @@ fib_test_sticky (void)
     return 0;
 }
 
+/*
+ * Count the buckets of a resilient LB on each path, and check the
+ * buckets which changed from the previous layout moved to (or from) the
+ * given path only.
+ */
+static int
+fib_test_resilient_buckets (const dpo_id_t *dpo,
+                            u32 *layout,
+                            const adj_index_t *ais,
+                            u32 n_ais,
+                            u32 *counts,
+                            adj_index_t moved)
+{
+    const load_balance_t *lb;
+    const dpo_id_t *bucket;
+    u32 ii, jj;
+    int res = 0;
+
+    lb = load_balance_get(dpo->dpoi_index);
+    FIB_TEST((LB_RESILIENT_N_BUCKETS == lb->lb_n_buckets),
+             "resilient LB has %d buckets", lb->lb_n_buckets);
+    FIB_TEST((lb->lb_flags & LOAD_BALANCE_FLAG_RESILIENT),
+             "LB is resilient");
+
+    clib_memset(counts, 0, n_ais * sizeof(counts[0]));
+
+    for (ii = 0; ii < lb->lb_n_buckets; ii++)
+    {
+        bucket = load_balance_get_bucket_i(lb, ii);
+
+        FIB_TEST((DPO_ADJACENCY == bucket->dpoi_type),
+                 "bucket %d is an adjacency", ii);
+        for (jj = 0; jj < n_ais; jj++)
+            if (ais[jj] == bucket->dpoi_index)
+                counts[jj]++;
+
+        if (INDEX_INVALID != moved && layout[ii] != bucket->dpoi_index)
+        {
+            FIB_TEST((moved == layout[ii] || moved == bucket->dpoi_index),
+                     "bucket %d moved from %d to %d", ii,
+                     layout[ii], bucket->dpoi_index);
+        }
+        layout[ii] = bucket->dpoi_index;
+    }
+
+    return (res);
+}
+
+static int
+fib_test_resilient (void)
+{
+    fib_route_path_t *r_paths = NULL, *r_path_last = NULL;
+    u32 layout[LB_RESILIENT_N_BUCKETS];
+    test_main_t *tm = &test_main;
+    fib_node_index_t fei;
+    u32 ii, lb_count;
+    int res = 0;
+#define N_RESILIENT_PATHS 4
+
+    adj_index_t ais[N_RESILIENT_PATHS];
+    u32 counts[N_RESILIENT_PATHS];
+    fib_prefix_t pfx = {
+        .fp_len = 32,
+        .fp_proto = FIB_PROTOCOL_IP4,
+        .fp_addr = {
+            .ip4.as_u32 = clib_host_to_net_u32(0x01010101),
+        },
+    };
+
+    lb_count = pool_elts(load_balance_pool);
+
+    for (ii = 0; ii < N_RESILIENT_PATHS; ii++)
+    {
+        ip46_address_t nh = {
+            .ip4.as_u32 = clib_host_to_net_u32(0x0a0a0a02 + ii),
+        };
+        fib_route_path_t r_path = {
+            .frp_proto = DPO_PROTO_IP4,
+            .frp_addr = nh,
+            .frp_sw_if_index = tm->hw[0]->sw_if_index,
+            .frp_weight = 1,
+            .frp_fib_index = ~0,
+        };
+
+        ais[ii] = adj_nbr_add_or_lock(FIB_PROTOCOL_IP4,
+                                      VNET_LINK_IP4,
+                                      &nh, tm->hw[0]->sw_if_index);
+        vec_add1(r_paths, r_path);
+    }
+    vec_add1(r_path_last, r_paths[N_RESILIENT_PATHS - 1]);
+
+    fei = fib_table_entry_path_add2(0, &pfx, FIB_SOURCE_API,
+                                    FIB_ENTRY_FLAG_RESILIENT, r_paths);
+
+    res += fib_test_resilient_buckets(fib_entry_contribute_ip_forwarding(fei),
+                                      layout, ais, N_RESILIENT_PATHS,
+                                      counts, INDEX_INVALID);
+    for (ii = 0; ii < N_RESILIENT_PATHS; ii++)
+        FIB_TEST((LB_RESILIENT_N_BUCKETS / N_RESILIENT_PATHS == counts[ii]),
+                 "path %d has %d buckets", ii, counts[ii]);
+
+    /*
+     * remove a path. only its buckets move
+     */
+    fib_table_entry_path_remove2(0, &pfx, FIB_SOURCE_API, r_path_last);
+
+    res += fib_test_resilient_buckets(fib_entry_contribute_ip_forwarding(fei),
+                                      layout, ais, N_RESILIENT_PATHS,
+                                      counts, ais[N_RESILIENT_PATHS - 1]);
+    FIB_TEST((0 == counts[N_RESILIENT_PATHS - 1]), "removed path unused");
+    for (ii = 0; ii < N_RESILIENT_PATHS - 1; ii++)
+        FIB_TEST((counts[ii] >= LB_RESILIENT_N_BUCKETS / (N_RESILIENT_PATHS - 1) &&
+                  counts[ii] <= LB_RESILIENT_N_BUCKETS / (N_RESILIENT_PATHS - 1) + 1),
+                 "path %d has %d buckets", ii, counts[ii]);
+
+    /*
+     * add it back. only the buckets it takes move
+     */
+    fib_table_entry_path_add2(0, &pfx, FIB_SOURCE_API,
+                              FIB_ENTRY_FLAG_RESILIENT, r_path_last);
+
+    res += fib_test_resilient_buckets(fib_entry_contribute_ip_forwarding(fei),
+                                      layout, ais, N_RESILIENT_PATHS,
+                                      counts, ais[N_RESILIENT_PATHS - 1]);
+    for (ii = 0; ii < N_RESILIENT_PATHS; ii++)
+        FIB_TEST((LB_RESILIENT_N_BUCKETS / N_RESILIENT_PATHS == counts[ii]),
+                 "path %d has %d buckets", ii, counts[ii]);
+
+    fib_table_entry_delete(0, &pfx, FIB_SOURCE_API);
+
+    for (ii = 0; ii < N_RESILIENT_PATHS; ii++)
+        adj_unlock(ais[ii]);
+    vec_free(r_paths);
+    vec_free(r_path_last);
+
+    FIB_TEST(lb_count == pool_elts(load_balance_pool), "no leaked LBs");
+
+    return (res);
+}
+
 static clib_error_t *
 fib_test (vlib_main_t * vm,
           unformat_input_t * input,
@@ -10880,6 +11190,10 @@ fib_test (vlib_main_t * vm,
     {
         res += fib_test_v4();
     }
+    else if (unformat (input, "ip6-mtrie"))
+    {
+        res += fib_test_v6_mtrie();
+    }
     else if (unformat (input, "ip6"))
     {
         res += fib_test_v6();
@@ -10888,6 +11202,7 @@ fib_test (vlib_main_t * vm,
     {
         res += fib_test_v4();
         res += fib_test_v6();
+        res += fib_test_v6_mtrie();
     }
     else if (unformat (input, "label"))
     {
@@ -10921,15 +11236,21 @@ fib_test (vlib_main_t * vm,
     {
         res += fib_test_sticky();
     }
+    else if (unformat (input, "resilient"))
+    {
+        res += fib_test_resilient();
+    }
     else
     {
         res += fib_test_v4();
         res += fib_test_v6();
+        res += fib_test_v6_mtrie();
         res += fib_test_ae();
         res += fib_test_bfd();
         res += fib_test_pref();
         res += fib_test_label();
         res += fib_test_inherit();
+        res += fib_test_resilient();
         res += lfib_test();
 
         /*
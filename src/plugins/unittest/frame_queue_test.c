@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Handoff throughput benchmark: workers allocate buffers as fast as they
+ * can and hand them off to the last worker, which frees them.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/threads.h>
+#include <vlib/buffer_node.h>
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u64 n_offered;
+  u64 n_enqueued;
+  u64 n_received;
+} fq_test_per_thread_t;
+
+typedef struct
+{
+  fq_test_per_thread_t *per_thread;
+  u32 fq_index;
+  u32 consumer_thread;
+} fq_test_main_t;
+
+static fq_test_main_t fq_test_main = { .fq_index = ~0 };
+
+vlib_node_registration_t fq_test_sink_node;
+vlib_node_registration_t fq_test_producer_node;
+
+VLIB_NODE_FN (fq_test_sink_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  fq_test_main_t *ftm = &fq_test_main;
+
+  ftm->per_thread[vm->thread_index].n_received += frame->n_vectors;
+  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (fq_test_sink_node) = {
+  .name = "test-frame-queue-sink",
+  .vector_size = sizeof (u32),
+  .type = VLIB_NODE_TYPE_INTERNAL,
+};
+
+VLIB_NODE_FN (fq_test_producer_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  fq_test_main_t *ftm = &fq_test_main;
+  fq_test_per_thread_t *ptd = &ftm->per_thread[vm->thread_index];
+  u32 buffers[VLIB_FRAME_SIZE];
+  u16 threads[VLIB_FRAME_SIZE];
+  u32 n_alloc;
+
+  n_alloc = vlib_buffer_alloc (vm, buffers, VLIB_FRAME_SIZE);
+  if (n_alloc == 0)
+    return 0;
+
+  clib_memset_u16 (threads, ftm->consumer_thread, n_alloc);
+  ptd->n_offered += n_alloc;
+  ptd->n_enqueued +=
+    vlib_buffer_enqueue_to_thread (vm, node, ftm->fq_index, buffers, threads,
+				   n_alloc, 1 /* drop on congestion */);
+
+  return n_alloc;
+}
+
+VLIB_REGISTER_NODE (fq_test_producer_node) = {
+  .name = "test-frame-queue-producer",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+static void
+fq_test_set_producers (u32 n_producers, vlib_node_state_t state)
+{
+  u32 i;
+
+  vlib_worker_thread_barrier_sync (vlib_get_main ());
+  for (i = 1; i <= n_producers; i++)
+    vlib_node_set_state (vlib_get_main_by_index (i),
+			 fq_test_producer_node.index, state);
+  vlib_worker_thread_barrier_release (vlib_get_main ());
+}
+
+static void
+fq_test_run (vlib_main_t *vm, u32 n_producers, f64 duration)
+{
+  fq_test_main_t *ftm = &fq_test_main;
+  fq_test_per_thread_t *ptd;
+  u64 n_offered = 0, n_enqueued = 0, min_enq = ~0ULL, max_enq = 0;
+  f64 t0, dt;
+  u32 i;
+
+  vec_foreach (ptd, ftm->per_thread)
+    ptd->n_offered = ptd->n_enqueued = ptd->n_received = 0;
+
+  t0 = vlib_time_now (vm);
+  fq_test_set_producers (n_producers, VLIB_NODE_STATE_POLLING);
+  vlib_process_suspend (vm, duration);
+  fq_test_set_producers (n_producers, VLIB_NODE_STATE_DISABLED);
+  dt = vlib_time_now (vm) - t0;
+
+  /* let the consumer drain the queue */
+  vlib_process_suspend (vm, 0.1);
+
+  for (i = 1; i <= n_producers; i++)
+    {
+      ptd = &ftm->per_thread[i];
+      n_offered += ptd->n_offered;
+      n_enqueued += ptd->n_enqueued;
+      min_enq = clib_min (min_enq, ptd->n_enqueued);
+      max_enq = clib_max (max_enq, ptd->n_enqueued);
+    }
+
+  vlib_cli_output (
+    vm,
+    "producers %2u: offered %8.2f Mpps handed off %8.2f Mpps "
+    "received %8.2f Mpps dropped %6.2f%% fairness %.2f",
+    n_producers, n_offered / dt * 1e-6, n_enqueued / dt * 1e-6,
+    ftm->per_thread[ftm->consumer_thread].n_received / dt * 1e-6,
+    n_offered ? 100.0 * (n_offered - n_enqueued) / n_offered : 0.0,
+    max_enq ? (f64) min_enq / max_enq : 0.0);
+}
+
+static clib_error_t *
+test_frame_queue_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  fq_test_main_t *ftm = &fq_test_main;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  u32 n_producers = ~0, nelts = 16, i;
+  f64 duration = 1;
+  int sweep = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "producers %u", &n_producers))
+	;
+      else if (unformat (input, "time %f", &duration))
+	;
+      else if (unformat (input, "nelts %u", &nelts))
+	;
+      else if (unformat (input, "sweep"))
+	sweep = 1;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (tm->n_vlib_mains < 3)
+    return clib_error_return (0, "needs at least 2 workers");
+
+  if (n_producers == ~0)
+    n_producers = tm->n_vlib_mains - 2;
+  if (n_producers == 0 || n_producers > tm->n_vlib_mains - 2)
+    return clib_error_return (0, "producers must be between 1 and %u",
+			      tm->n_vlib_mains - 2);
+
+  if (ftm->fq_index == ~0)
+    {
+      if (!is_pow2 (nelts) || nelts < 8 + tm->n_vlib_mains)
+	return clib_error_return (
+	  0, "nelts must be a power of 2 of at least %u",
+	  8 + tm->n_vlib_mains);
+
+      vlib_worker_thread_barrier_sync (vm);
+      vec_validate_aligned (ftm->per_thread, tm->n_vlib_mains - 1,
+			    CLIB_CACHE_LINE_BYTES);
+      ftm->consumer_thread = tm->n_vlib_mains - 1;
+      ftm->fq_index =
+	vlib_frame_queue_main_init (fq_test_sink_node.index, nelts);
+      vlib_worker_thread_barrier_release (vm);
+    }
+
+  vlib_cli_output (vm, "frame-queue %u consumer thread %u", ftm->fq_index,
+		   ftm->consumer_thread);
+
+  for (i = sweep ? 1 : n_producers; i <= n_producers; i++)
+    fq_test_run (vm, i, duration);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_frame_queue_command, static) = {
+  .path = "test frame-queue throughput",
+  .short_help = "test frame-queue throughput [producers <n>] [time <sec>] "
+		"[nelts <n>] [sweep]",
+  .function = test_frame_queue_command_fn,
+  .is_mp_safe = 1,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
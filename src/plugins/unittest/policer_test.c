@@ -26,8 +26,10 @@ policer_test (vlib_main_t *vm, unformat_input_t *input,
   double cpu_speed, cpu_ticks_per_byte;
   policer_result_e result, input_colour = POLICE_CONFORM;
   uint64_t policer_time;
+  u32 n_threads = 1;
 
   policer_t *pol;
+  policer_slice_t *slice;
   vnet_policer_main_t *pm = &vnet_policer_main;
 
   if (!unformat (input, "index %d", &policer_index) || /* policer to use */
@@ -37,6 +39,9 @@ policer_test (vlib_main_t *vm, unformat_input_t *input,
 		 &input_colour)) /* input colour if aware */
     return clib_error_return (0, "Policer test failed to parse params");
 
+  /* threads to spread the packets of a distributed policer over */
+  unformat (input, "threads %u", &n_threads);
+
   total_bytes = (rate_kbps * burst) / 8;
   num_pkts = total_bytes / PKT_LEN;
 
@@ -46,11 +51,26 @@ policer_test (vlib_main_t *vm, unformat_input_t *input,
 
   pol = &pm->policers[policer_index];
 
+  if (n_threads > 1 && (!pol->distributed ||
+			n_threads > vec_len (pm->slices[policer_index])))
+    return clib_error_return (0, "Policer is not distributed over %u threads",
+			      n_threads);
+
   for (i = 0; i < num_pkts; i++)
     {
       time += cpu_ticks_per_pkt;
       policer_time = ((uint64_t) time) >> POLICER_TICKS_PER_PERIOD_SHIFT;
-      result = vnet_police_packet (pol, PKT_LEN, input_colour, policer_time);
+      if (pol->distributed)
+	{
+	  /* each thread polices a frame of packets in turn */
+	  slice =
+	    &pm->slices[policer_index][(i / VLIB_FRAME_SIZE) % n_threads];
+	  result = vnet_police_packet_distributed (pol, slice, PKT_LEN,
+						   input_colour, policer_time);
+	}
+      else
+	result =
+	  vnet_police_packet (pol, PKT_LEN, input_colour, policer_time);
       vlib_increment_combined_counter (&policer_counters[result], 0,
 				       policer_index, 1, PKT_LEN);
     }
@@ -19,6 +19,7 @@
 #include <vnet/session/transport.h>
 #include <sys/epoll.h>
 #include <vnet/session/session_rules_table.h>
+#include <vnet/interface/rx_queue_funcs.h>
 
 #define SESSION_TEST_I(_cond, _comment, _args...)		\
 ({								\
@@ -2687,6 +2688,116 @@ session_test_ext_cfg (vlib_main_t *vm, unformat_input_t *input)
   return 0;
 }
 
+/* Microsoft RSS verification suite, source is the remote of the return
+ * traffic, hashes computed with the default key over the 4-tuple */
+typedef struct
+{
+  u8 is_ip4;
+  char *src;
+  u16 sport;
+  char *dst;
+  u16 dport;
+  u32 hash;
+} session_test_rss_vector_t;
+
+static session_test_rss_vector_t session_test_rss_vectors[] = {
+  { 1, "66.9.149.187", 2794, "161.142.100.80", 1766, 0x51ccc178 },
+  { 1, "199.92.111.2", 14230, "65.69.140.83", 4739, 0xc626b0ea },
+  { 1, "24.19.198.95", 12898, "12.22.207.184", 38024, 0x5c2b394a },
+  { 1, "38.27.205.30", 48228, "209.142.163.6", 2217, 0xafc7327f },
+  { 1, "153.39.163.191", 44251, "202.188.127.2", 1303, 0x10e828a2 },
+  { 0, "3ffe:2501:200:1fff::7", 2794, "3ffe:2501:200:3::1", 1766,
+    0x40207d3d },
+  { 0, "3ffe:501:8::260:97ff:fe40:efab", 14230, "ff02::1", 4739, 0xdde51bbf },
+  { 0, "3ffe:1900:4545:3:200:f8ff:fe21:67cf", 44251,
+    "fe80::200:f8ff:fe21:67cf", 38024, 0x02d1feef },
+};
+
+#define SESSION_TEST_RSS_N_QUEUES 4
+
+static int
+session_test_rss (vlib_main_t *vm, unformat_input_t *input)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  ip4_address_t intf_addr = { .as_u32 = clib_host_to_net_u32 (0x01011e01) };
+  u32 queue_threads[SESSION_TEST_RSS_N_QUEUES], n_threads, reta_size;
+  u32 sw_if_index, hw_if_index, thread, hash, queue, i, j;
+  session_test_rss_vector_t *v;
+  transport_endpoint_cfg_t rmt;
+  ip46_address_t lcl_addr;
+  int port, af;
+
+  if (!session_main.rss_steering)
+    {
+      vlib_cli_output (vm, "rss steering not configured, skipping");
+      return 0;
+    }
+
+  if (session_create_lookpback (0, &sw_if_index, &intf_addr))
+    return -1;
+
+  /* rx queues spread round-robin over the main thread and the workers */
+  n_threads = clib_min (vlib_num_workers () + 1, SESSION_TEST_RSS_N_QUEUES);
+  hw_if_index = vnet_get_sw_interface (vnm, sw_if_index)->hw_if_index;
+  for (i = 0; i < SESSION_TEST_RSS_N_QUEUES; i++)
+    {
+      queue_threads[i] = i % n_threads;
+      vnet_hw_if_register_rx_queue (vnm, hw_if_index, i, queue_threads[i]);
+    }
+  reta_size = session_main.rss_reta_size ? session_main.rss_reta_size : 128;
+
+  for (i = 0; i < ARRAY_LEN (session_test_rss_vectors); i++)
+    {
+      v = &session_test_rss_vectors[i];
+      af = v->is_ip4 ? AF_INET : AF_INET6;
+
+      clib_memset (&rmt, 0, sizeof (rmt));
+      rmt.is_ip4 = v->is_ip4;
+      inet_pton (af, v->src, v->is_ip4 ? (void *) &rmt.ip.ip4 :
+					 (void *) &rmt.ip.ip6);
+      rmt.port = clib_host_to_net_u16 (v->sport);
+      rmt.peer.sw_if_index = sw_if_index;
+      rmt.transport_flags = TRANSPORT_CFG_F_THREAD_HINT;
+
+      clib_memset (&lcl_addr, 0, sizeof (lcl_addr));
+      inet_pton (af, v->dst, v->is_ip4 ? (void *) &lcl_addr.ip4 :
+					 (void *) &lcl_addr.ip6);
+
+      /* published hashes only hold for the default key */
+      if (!session_main.rss_key)
+	{
+	  hash = transport_rss_hash (&rmt, &lcl_addr,
+				     clib_host_to_net_u16 (v->dport));
+	  SESSION_TEST ((hash == v->hash), "vector %u hash 0x%08x expected "
+			"0x%08x", i, hash, v->hash);
+	}
+
+      for (thread = 0; thread < n_threads; thread++)
+	{
+	  rmt.thread_hint = thread;
+	  for (j = 0; j < 8; j++)
+	    {
+	      port = transport_alloc_local_port (TRANSPORT_PROTO_TCP,
+						 &lcl_addr, &rmt);
+	      SESSION_TEST ((port > 0), "port allocated");
+
+	      hash = transport_rss_hash (&rmt, &lcl_addr, port);
+	      queue = (hash & (reta_size - 1)) % SESSION_TEST_RSS_N_QUEUES;
+	      SESSION_TEST ((queue_threads[queue] == thread),
+			    "vector %u port %u steered to queue %u, hint %u", i,
+			    clib_net_to_host_u16 (port), queue, thread);
+	      transport_release_local_endpoint (TRANSPORT_PROTO_TCP, 0,
+						&lcl_addr, port);
+	    }
+	}
+    }
+
+  vnet_hw_if_unregister_all_rx_queues (vnm, hw_if_index);
+  session_delete_loopback (sw_if_index);
+
+  return 0;
+}
+
 static clib_error_t *
 session_test (vlib_main_t * vm,
 	      unformat_input_t * input, vlib_cli_command_t * cmd_arg)
@@ -2719,6 +2830,8 @@ session_test (vlib_main_t * vm,
 	res = session_test_sdl (vm, input);
       else if (unformat (input, "ext-cfg"))
 	res = session_test_ext_cfg (vm, input);
+      else if (unformat (input, "rss"))
+	res = session_test_rss (vm, input);
       else if (unformat (input, "all"))
 	{
 	  if ((res = session_test_basic (vm, input)))
@@ -2741,6 +2854,8 @@ session_test (vlib_main_t * vm,
 	    goto done;
 	  if ((res = session_test_ext_cfg (vm, input)))
 	    goto done;
+	  if ((res = session_test_rss (vm, input)))
+	    goto done;
 	  if ((res = session_test_enable_disable (vm, input)))
 	    goto done;
 	}
@@ -316,6 +316,261 @@ VLIB_CLI_COMMAND (test_linearize_speed_command, static) = {
   .function = test_linearize_speed_fn,
 };
 
+/*
+ * Buffer pool alloc/free benchmark. Each thread allocates bursts of buffers
+ * and hands them over to the next thread, which frees them, so that the
+ * buffers are allocated and freed on different threads, as with handoffs.
+ */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* buffers handed over by the previous thread, non zero when full */
+  u32 n_handoff;
+  u32 handoff[VLIB_FRAME_SIZE];
+  u32 n_iter;
+  u8 done;
+  u64 n_alloc;
+  u64 n_free;
+  u64 alloc_clocks;
+  u64 free_clocks;
+} buffer_pool_test_thread_t;
+
+typedef struct
+{
+  buffer_pool_test_thread_t *threads;
+  u32 first_thread;
+  u32 n_threads;
+  u32 n_iter;
+  u32 n_buffers;
+} buffer_pool_test_main_t;
+
+static buffer_pool_test_main_t buffer_pool_test_main;
+
+static_always_inline void
+buffer_pool_test_free (vlib_main_t *vm, buffer_pool_test_thread_t *tt,
+		       u32 *buffers, u32 n_buffers)
+{
+  u64 t0 = clib_cpu_time_now ();
+
+  vlib_buffer_free (vm, buffers, n_buffers);
+  tt->free_clocks += clib_cpu_time_now () - t0;
+  tt->n_free += n_buffers;
+}
+
+static uword
+buffer_pool_test_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+			  vlib_frame_t *frame)
+{
+  buffer_pool_test_main_t *tm = &buffer_pool_test_main;
+  u32 i = vm->thread_index - tm->first_thread;
+  buffer_pool_test_thread_t *tt = vec_elt_at_index (tm->threads, i);
+  buffer_pool_test_thread_t *peer =
+    vec_elt_at_index (tm->threads, (i + 1) % tm->n_threads);
+  u32 buffers[VLIB_FRAME_SIZE], n, j;
+  u64 t0;
+
+  /* a slice of the iterations per dispatch, not to starve the thread */
+  for (j = 0; j < 64 && tt->n_iter < tm->n_iter; j++, tt->n_iter++)
+    {
+      t0 = clib_cpu_time_now ();
+      n = vlib_buffer_alloc (vm, buffers, tm->n_buffers);
+      tt->alloc_clocks += clib_cpu_time_now () - t0;
+      tt->n_alloc += n;
+
+      if (n && clib_atomic_load_acq_n (&peer->n_handoff) == 0)
+	{
+	  vlib_buffer_copy_indices (peer->handoff, buffers, n);
+	  clib_atomic_store_rel_n (&peer->n_handoff, n);
+	}
+      else if (n)
+	buffer_pool_test_free (vm, tt, buffers, n);
+
+      if ((n = clib_atomic_load_acq_n (&tt->n_handoff)))
+	{
+	  buffer_pool_test_free (vm, tt, tt->handoff, n);
+	  clib_atomic_store_rel_n (&tt->n_handoff, 0);
+	}
+    }
+
+  if (tt->n_iter == tm->n_iter)
+    {
+      vlib_node_set_state (vm, node->node_index, VLIB_NODE_STATE_DISABLED);
+      clib_atomic_store_rel_n (&tt->done, 1);
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (buffer_pool_test_node) = {
+  .function = buffer_pool_test_node_fn,
+  .type = VLIB_NODE_TYPE_INPUT,
+  .name = "buffer-pool-test",
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+static void
+buffer_pool_test_counters (vlib_main_t *vm, u64 *counters)
+{
+  vlib_buffer_main_t *bm = vm->buffer_main;
+  vlib_buffer_pool_thread_t *bpt;
+  vlib_buffer_pool_t *bp;
+
+  clib_memset (counters, 0, 4 * sizeof (counters[0]));
+  vec_foreach (bp, bm->buffer_pools)
+    vec_foreach (bpt, bp->threads)
+      {
+	counters[0] += bpt->n_depot_get;
+	counters[1] += bpt->n_depot_put;
+	counters[2] += bpt->n_lock;
+	counters[3] += bpt->n_lock_contended;
+      }
+}
+
+static clib_error_t *
+test_buffer_pool_speed_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  buffer_pool_test_main_t *tm = &buffer_pool_test_main;
+  buffer_pool_test_thread_t *tt;
+  u64 before[4], after[4];
+  u32 i, n_done;
+
+  tm->n_iter = 100000;
+  tm->n_buffers = 32;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "iterations %u", &tm->n_iter))
+	;
+      else if (unformat (input, "buffers %u", &tm->n_buffers))
+	;
+      else
+	return clib_error_create ("unknown input `%U'", format_unformat_error,
+				  input);
+    }
+
+  if (tm->n_buffers == 0 || tm->n_buffers > VLIB_FRAME_SIZE)
+    return clib_error_create ("buffers must be between 1 and %u",
+			      VLIB_FRAME_SIZE);
+
+  /* the workers if any, the main thread otherwise */
+  tm->n_threads = clib_max (vlib_num_workers (), 1);
+  tm->first_thread = vlib_num_workers () ? 1 : 0;
+  vec_validate_aligned (tm->threads, tm->n_threads - 1, CLIB_CACHE_LINE_BYTES);
+  vec_foreach (tt, tm->threads)
+    clib_memset (tt, 0, sizeof (*tt));
+
+  buffer_pool_test_counters (vm, before);
+
+  vlib_worker_thread_barrier_sync (vm);
+  for (i = 0; i < tm->n_threads; i++)
+    vlib_node_set_state (vlib_get_main_by_index (tm->first_thread + i),
+			 buffer_pool_test_node.index,
+			 VLIB_NODE_STATE_POLLING);
+  vlib_worker_thread_barrier_release (vm);
+
+  do
+    {
+      vlib_process_suspend (vm, 1e-3);
+      n_done = 0;
+      vec_foreach (tt, tm->threads)
+	n_done += clib_atomic_load_acq_n (&tt->done);
+    }
+  while (n_done < tm->n_threads);
+
+  /* handoffs nobody was left to free */
+  vec_foreach (tt, tm->threads)
+    if (tt->n_handoff)
+      {
+	vlib_buffer_free (vm, tt->handoff, tt->n_handoff);
+	tt->n_handoff = 0;
+      }
+
+  buffer_pool_test_counters (vm, after);
+
+  vec_foreach (tt, tm->threads)
+    vlib_cli_output (vm,
+		     "thread %u: %lu allocated %.02f ticks/buffer, "
+		     "%lu freed %.02f ticks/buffer",
+		     tm->first_thread + (tt - tm->threads), tt->n_alloc,
+		     tt->n_alloc ? (f64) tt->alloc_clocks / tt->n_alloc : 0,
+		     tt->n_free,
+		     tt->n_free ? (f64) tt->free_clocks / tt->n_free : 0);
+
+  vlib_cli_output (vm,
+		   "depot get %lu put %lu, pool lock %lu contended %lu",
+		   after[0] - before[0], after[1] - before[1],
+		   after[2] - before[2], after[3] - before[3]);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_buffer_pool_speed_command, static) = {
+  .path = "test buffer-pool speed",
+  .short_help = "test buffer-pool speed [iterations <n>] [buffers <n>]",
+  .function = test_buffer_pool_speed_fn,
+};
+
+/*
+ * Allocations larger than the per-thread cache go to the pool directly,
+ * and must still get the buffers parked in the depot.
+ */
+static clib_error_t *
+test_buffer_pool_depot_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  u8 index = vlib_buffer_pool_get_default_for_numa (vm, vm->numa_node);
+  vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, index);
+  u32 *buffers = 0, n_mags, n_depot, n_want, n_alloc, i;
+
+  if (vlib_num_workers ())
+    return clib_error_return (0, "run without workers");
+
+  /* park some magazines in the depot: bursts freed through the cache */
+  n_mags = clib_min (VLIB_BUFFER_POOL_DEPOT_SZ / 2,
+		     bp->n_avail / VLIB_BUFFER_POOL_MAGAZINE_SZ / 2);
+  vec_validate (buffers, (n_mags + 2) * VLIB_BUFFER_POOL_MAGAZINE_SZ - 1);
+  for (i = 0; i < vec_len (buffers); i += VLIB_FRAME_SIZE)
+    if (vlib_buffer_alloc (vm, buffers + i, VLIB_FRAME_SIZE) !=
+	VLIB_FRAME_SIZE)
+      {
+	vlib_buffer_free (vm, buffers, i);
+	vec_free (buffers);
+	return clib_error_return (0, "alloc failed");
+      }
+  for (i = 0; i < vec_len (buffers); i += VLIB_FRAME_SIZE)
+    vlib_buffer_free (vm, buffers + i, VLIB_FRAME_SIZE);
+
+  n_depot = vlib_buffer_pool_depot_n_buffers (bp);
+  if (n_depot == 0)
+    {
+      vec_free (buffers);
+      return clib_error_return (0, "depot is empty");
+    }
+
+  /* more than the pool alone holds */
+  n_want = bp->n_avail + n_depot;
+  vec_validate (buffers, n_want - 1);
+  n_alloc = vlib_buffer_alloc (vm, buffers, n_want);
+  vlib_buffer_free (vm, buffers, n_alloc);
+  vec_free (buffers);
+
+  if (n_alloc != n_want)
+    return clib_error_return (0,
+			      "allocated %u of %u buffers, %u in the depot",
+			      n_alloc, n_want, n_depot);
+
+  vlib_cli_output (vm, "allocated %u buffers, %u from the depot: ok",
+		   n_alloc, n_depot);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_buffer_pool_depot_command, static) = {
+  .path = "test buffer-pool depot",
+  .short_help = "test buffer-pool depot",
+  .function = test_buffer_pool_depot_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
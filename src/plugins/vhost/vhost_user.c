@@ -302,6 +302,7 @@ vhost_user_vring_init (vhost_user_intf_t * vui, u32 qid)
   vring->queue_index = ~0;
   vring->thread_index = ~0;
   vring->mode = VNET_HW_IF_RX_MODE_POLLING;
+  vring->dma_epoch = ++vhost_user_main.dma_epoch;
 
   clib_spinlock_init (&vring->vring_lock);
 
@@ -343,6 +344,30 @@ vhost_user_vring_close (vhost_user_intf_t * vui, u32 qid)
 
   clib_spinlock_free (&vring->vring_lock);
 
+  /*
+   * The engine may still access the buffers of the batches in flight, so
+   * they are left to the completions, which see the vring was reset.
+   */
+  if (vring->dma_info_head != vring->dma_info_tail)
+    {
+      vhost_cpu_t *cpu =
+	vec_elt_at_index (vhost_user_main.cpus, vring->dma_thread_index);
+      vhost_user_dma_retired_t *r;
+
+      vec_add2 (cpu->dma_retired, r, 1);
+      r->dma_info = vring->dma_info;
+      r->dma_epoch = vring->dma_epoch;
+      r->dma_info_head = vring->dma_info_head;
+      r->dma_info_tail = vring->dma_info_tail;
+    }
+  else if (vring->dma_info)
+    {
+      vhost_user_dma_info_t *di;
+      vec_foreach (di, vring->dma_info)
+	vec_free (di->buffers);
+      vec_free (vring->dma_info);
+    }
+
   // save the needed information in vrings prior to being wiped out
   u16 q = vui->vrings[qid].qid;
   u32 queue_index = vui->vrings[qid].queue_index;
@@ -1370,7 +1395,9 @@ vhost_user_process (vlib_main_t * vm,
 		  if (retval)
 		    {
 		      vu_log_debug (vui, "getsockopt returned %d", retval);
+		      vlib_worker_thread_barrier_sync (vm);
 		      vhost_user_if_disconnect (vui);
+		      vlib_worker_thread_barrier_release (vm);
 		    }
 		}
 	  }
@@ -1403,6 +1430,12 @@ vhost_user_term_if (vhost_user_intf_t * vui)
   for (q = 0; q < vec_len (vui->vrings); q++)
     clib_spinlock_free (&vui->vrings[q].vring_lock);
 
+  if (vui->dma_config >= 0)
+    {
+      vlib_dma_config_del (vlib_get_main (), vui->dma_config);
+      vui->dma_config = -1;
+    }
+
   if (vui->unix_server_index != ~0)
     {
       //Close server socket
@@ -1575,6 +1608,35 @@ vhost_user_create_ethernet (vnet_main_t *vnm, vlib_main_t *vm,
 /*
  *  Initialize vui with specified attributes
  */
+static void
+vhost_user_dma_config (vhost_user_intf_t *vui,
+		       vhost_user_create_if_args_t *args)
+{
+  vlib_dma_config_t dma_args = {
+    .max_batches = 256,
+    .max_transfers = VHOST_USER_DMA_MAX_TRANSFERS,
+    .max_transfer_size = VHOST_USER_DMA_MAX_TRANSFER_SIZE,
+    .sw_fallback = 1,
+    .callback_fn = vhost_user_dma_completion_cb,
+  };
+
+  vui->dma_threshold = args->dma_threshold ? args->dma_threshold :
+					     VHOST_USER_DMA_THRESHOLD_DEFAULT;
+  /* the virtio headers must never be offloaded, they are reused */
+  vui->dma_threshold = clib_max (vui->dma_threshold,
+				 VHOST_USER_DMA_THRESHOLD_MIN);
+  if (vui->if_index > VHOST_USER_DMA_MAX_IF_INDEX)
+    {
+      vu_log_warn (vui, "interface index too large for dma, copies are "
+			"done by the cpu");
+      return;
+    }
+
+  vui->dma_config = vlib_dma_config_add (vlib_get_main (), &dma_args);
+  if (vui->dma_config < 0)
+    vu_log_warn (vui, "no dma backend, copies are done by the cpu");
+}
+
 static void
 vhost_user_vui_init (vnet_main_t * vnm, vhost_user_intf_t * vui,
 		     int server_sock_fd, vhost_user_create_if_args_t * args,
@@ -1611,6 +1673,9 @@ vhost_user_vui_init (vnet_main_t * vnm, vhost_user_intf_t * vui,
   vui->enable_gso = args->enable_gso;
   vui->enable_event_idx = args->enable_event_idx;
   vui->enable_packed = args->enable_packed;
+  vui->dma_config = -1;
+  if (args->use_dma)
+    vhost_user_dma_config (vui, args);
   /*
    * enable_gso takes precedence over configurable feature mask if there
    * is a clash.
@@ -1786,6 +1851,10 @@ vhost_user_connect_command_fn (vlib_main_t * vm,
 	args.enable_packed = 1;
       else if (unformat (line_input, "event-idx"))
 	args.enable_event_idx = 1;
+      else if (unformat (line_input, "use-dma"))
+	args.use_dma = 1;
+      else if (unformat (line_input, "dma-threshold %u", &args.dma_threshold))
+	;
       else if (unformat (line_input, "feature-mask 0x%llx",
 			 &args.feature_mask))
 	;
@@ -2200,6 +2269,9 @@ show_vhost_user_command_fn (vlib_main_t * vm,
 	vlib_cli_output (vm, "  Packed ring enable");
       if (vui->enable_event_idx)
 	vlib_cli_output (vm, "  Event index enable");
+      if (vui->dma_config >= 0)
+	vlib_cli_output (vm, "  DMA copy offload threshold %u",
+			 vui->dma_threshold);
 
       vlib_cli_output (vm, "virtio_net_hdr_sz %d\n"
 		       " features mask (0x%llx): \n"
@@ -2363,6 +2435,14 @@ done:
  * will be used anyway and multiple instances will have the same name. Use
  * with caution.
  *
+ * - <b>use-dma</b> - Optional flag to offload the copies between the guest
+ * memory and the buffers to a DMA engine registered with the vlib DMA
+ * framework. The descriptors are given back to the guest once the copies
+ * complete. Not used with packed ring, nor on tx queues shared by threads.
+ *
+ * - <b>dma-threshold <bytes></b> - Optional, copies smaller than this are
+ * still done by the cpu. The default is 1024.
+ *
  * @cliexpar
  * Example of how to create a vhost interface with VPP as the client and all
  * features enabled:
@@ -2382,7 +2462,7 @@ VLIB_CLI_COMMAND (vhost_user_connect_command, static) = {
     .path = "create vhost-user",
     .short_help = "create vhost-user socket <socket-filename> [server] "
     "[feature-mask <hex>] [hwaddr <mac-addr>] [renumber <dev_instance>] [gso] "
-    "[packed] [event-idx]",
+    "[packed] [event-idx] [use-dma [dma-threshold <bytes>]]",
     .function = vhost_user_connect_command_fn,
     .is_mp_safe = 1,
 };
@@ -17,6 +17,7 @@
 
 #include <vhost/virtio_std.h>
 #include <vhost/vhost_std.h>
+#include <vlib/dma/dma.h>
 
 /* vhost-user data structures */
 
@@ -112,6 +113,8 @@ typedef struct
   u8 enable_packed;
   u8 enable_event_idx;
   u8 use_custom_mac;
+  u8 use_dma;
+  u32 dma_threshold;
 
   /* return */
   u32 sw_if_index;
@@ -177,6 +180,49 @@ typedef struct vhost_user_msg {
     };
 } __attribute ((packed)) vhost_user_msg_t;
 
+/*
+ * With use-dma, copies of at least dma_threshold bytes between the guest
+ * memory and the vlib buffers are done by the DMA engine. The used
+ * descriptors are given back to the driver, and the received packets to the
+ * graph, when the batch completes. Smaller copies are still done by the cpu.
+ */
+#define VHOST_USER_DMA_THRESHOLD_DEFAULT 1024
+#define VHOST_USER_DMA_THRESHOLD_MIN	 64
+#define VHOST_USER_DMA_MAX_TRANSFERS	 VLIB_FRAME_SIZE
+#define VHOST_USER_DMA_MAX_TRANSFER_SIZE VLIB_BUFFER_DEFAULT_DATA_SIZE
+/* batches in flight per vring */
+#define VHOST_USER_DMA_INFO_SIZE 16
+/*
+ * The cookie of a batch holds the vring epoch in bits 32-63, the interface
+ * index in bits 8-31 and the vring index in bits 0-7.
+ */
+#define VHOST_USER_DMA_MAX_IF_INDEX ((1 << 24) - 1)
+STATIC_ASSERT (2 * VHOST_VRING_MAX_MQ_PAIR_SZ <= 256,
+	       "vring index does not fit in the dma cookie");
+
+typedef struct
+{
+  /* buffers held until the batch completes */
+  u32 *buffers;
+  /* used index given back to the driver on completion */
+  u16 used_idx;
+  /* rx only, next node of the received packets */
+  u32 next_index;
+} vhost_user_dma_info_t;
+
+/*
+ * The batches still in flight when a vring was closed. The engine may
+ * still access their buffers, so these are only freed by the completions,
+ * on the thread which submitted the batches.
+ */
+typedef struct
+{
+  vhost_user_dma_info_t *dma_info;
+  u32 dma_epoch;
+  u16 dma_info_head;
+  u16 dma_info_tail;
+} vhost_user_dma_retired_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -232,6 +278,15 @@ typedef struct
   u8 first_kick;
   u32 queue_index;
   clib_thread_index_t thread_index;
+
+  /* DMA batches in flight, completed in order */
+  vhost_user_dma_info_t *dma_info;
+  u16 dma_info_head;
+  u16 dma_info_tail;
+  /* completions of a previous life of the vring are ignored */
+  u32 dma_epoch;
+  /* thread whose dma completions hold the batches in flight */
+  clib_thread_index_t dma_thread_index;
 } vhost_user_vring_t;
 
 #define VHOST_USER_EVENT_START_TIMER 1
@@ -285,6 +340,10 @@ typedef struct
   u8 enable_packed;
 
   u8 enable_event_idx;
+
+  /* DMA config index, -1 if copies are done by the cpu only */
+  int dma_config;
+  u32 dma_threshold;
 } vhost_user_intf_t;
 
 #define FOR_ALL_VHOST_TXQ(qid, vui) for (qid = 1; qid < vui->num_qid; qid += 2)
@@ -327,6 +386,9 @@ typedef struct
   u32 *to_next_list;
   vlib_buffer_t **rx_buffers_pdesc;
   u32 polling_q_count;
+
+  /* batches in flight of closed vrings */
+  vhost_user_dma_retired_t *dma_retired;
 } vhost_cpu_t;
 
 typedef struct
@@ -353,6 +415,9 @@ typedef struct
 
   /* gso interface count */
   u32 gso_count;
+
+  /* last vring dma epoch */
+  u32 dma_epoch;
 } vhost_user_main_t;
 
 typedef struct
@@ -371,6 +436,7 @@ int vhost_user_dump_ifs (vnet_main_t * vnm, vlib_main_t * vm,
 			 vhost_user_intf_details_t ** out_vuids);
 void vhost_user_set_operation_mode (vhost_user_intf_t *vui,
 				    vhost_user_vring_t *txvq);
+void vhost_user_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b);
 
 extern vlib_node_registration_t vhost_user_send_interrupt_node;
 extern vnet_device_class_t vhost_user_device_class;
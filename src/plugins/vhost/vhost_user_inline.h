@@ -483,6 +483,101 @@ vhost_user_advance_last_used_idx (vhost_user_vring_t * vring)
     }
 }
 
+static_always_inline vhost_user_dma_info_t *
+vhost_user_dma_info_at (vhost_user_vring_t *vq, u16 idx)
+{
+  return vq->dma_info + (idx & (VHOST_USER_DMA_INFO_SIZE - 1));
+}
+
+/**
+ * New DMA batch for the copies of a vring, 0 if the vring has too many
+ * batches in flight or the engine has no free batch.
+ */
+static_always_inline vlib_dma_batch_t *
+vhost_user_dma_batch_new (vlib_main_t *vm, vhost_user_intf_t *vui,
+			  vhost_user_vring_t *vq)
+{
+  if ((u16) (vq->dma_info_tail - vq->dma_info_head) >=
+      VHOST_USER_DMA_INFO_SIZE)
+    return 0;
+
+  if (PREDICT_FALSE (vq->dma_info == 0))
+    vec_validate_aligned (vq->dma_info, VHOST_USER_DMA_INFO_SIZE - 1,
+			  CLIB_CACHE_LINE_BYTES);
+
+  return vlib_dma_batch_new (vm, vui->dma_config);
+}
+
+/**
+ * Copy through the DMA batch if the copy is worth it and the batch has room,
+ * with the cpu otherwise.
+ */
+static_always_inline void
+vhost_user_dma_copy (vlib_main_t *vm, vhost_user_intf_t *vui,
+		     vlib_dma_batch_t *b, void *dst, void *src, u32 len)
+{
+  if (b && len >= vui->dma_threshold &&
+      len <= VHOST_USER_DMA_MAX_TRANSFER_SIZE &&
+      b->n_enq < VHOST_USER_DMA_MAX_TRANSFERS)
+    vlib_dma_batch_add (vm, b, dst, src, len);
+  else
+    clib_memcpy_fast (dst, src, len);
+}
+
+/**
+ * Submit the batch, its completion gives the descriptors used so far back
+ * to the driver.
+ *
+ * @returns the batch info, or 0 if there was nothing to offload
+ */
+static_always_inline vhost_user_dma_info_t *
+vhost_user_dma_submit (vlib_main_t *vm, vhost_user_intf_t *vui,
+		       vhost_user_vring_t *vq, vlib_dma_batch_t *b)
+{
+  vhost_user_dma_info_t *di;
+  u64 cookie;
+
+  if (b == 0)
+    return 0;
+
+  if (b->n_enq == 0)
+    {
+      /* gives the batch back */
+      vlib_dma_batch_submit (vm, b);
+      return 0;
+    }
+
+  di = vhost_user_dma_info_at (vq, vq->dma_info_tail);
+  di->used_idx = vq->last_used_idx;
+  vq->dma_info_tail++;
+
+  vq->dma_thread_index = vm->thread_index;
+  cookie = ((u64) vq->dma_epoch << 32) | (vui->if_index << 8) |
+	   (vq - vui->vrings);
+  vlib_dma_batch_set_cookie (vm, b, cookie);
+  vlib_dma_batch_submit (vm, b);
+  return di;
+}
+
+/**
+ * Give the used descriptors back to the driver. With batches in flight,
+ * which hold older descriptors, it is left to the last one.
+ */
+static_always_inline void
+vhost_user_dma_update_used (vhost_user_intf_t *vui, vhost_user_vring_t *vq)
+{
+  if (PREDICT_FALSE (vq->dma_info_head != vq->dma_info_tail))
+    {
+      vhost_user_dma_info_at (vq, vq->dma_info_tail - 1)->used_idx =
+	vq->last_used_idx;
+      return;
+    }
+
+  CLIB_MEMORY_STORE_BARRIER ();
+  vq->used->idx = vq->last_used_idx;
+  vhost_user_log_dirty_ring (vui, vq, idx);
+}
+
 #endif
 
 /*
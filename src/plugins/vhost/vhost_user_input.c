@@ -141,8 +141,9 @@ vhost_user_rx_trace (vhost_trace_t * t,
 }
 
 static_always_inline u32
-vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
-		       u16 copy_len, u32 * map_hint)
+vhost_user_input_copy (vlib_main_t *vm, vhost_user_intf_t *vui,
+		       vlib_dma_batch_t *b, vhost_copy_t *cpy, u16 copy_len,
+		       u32 *map_hint)
 {
   void *src0, *src1, *src2, *src3;
   if (PREDICT_TRUE (copy_len >= 4))
@@ -167,8 +168,10 @@ vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
 	  clib_prefetch_load (src2);
 	  clib_prefetch_load (src3);
 
-	  clib_memcpy_fast ((void *) cpy[0].dst, src0, cpy[0].len);
-	  clib_memcpy_fast ((void *) cpy[1].dst, src1, cpy[1].len);
+	  vhost_user_dma_copy (vm, vui, b, (void *) cpy[0].dst, src0,
+			       cpy[0].len);
+	  vhost_user_dma_copy (vm, vui, b, (void *) cpy[1].dst, src1,
+			       cpy[1].len);
 	  copy_len -= 2;
 	  cpy += 2;
 	}
@@ -177,7 +180,7 @@ vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
     {
       if (PREDICT_FALSE (!(src0 = map_guest_mem (vui, cpy->src, map_hint))))
 	return 1;
-      clib_memcpy_fast ((void *) cpy->dst, src0, cpy->len);
+      vhost_user_dma_copy (vm, vui, b, (void *) cpy->dst, src0, cpy->len);
       copy_len -= 1;
       cpy += 1;
     }
@@ -220,9 +223,7 @@ vhost_user_rx_discard_packet (vlib_main_t * vm,
 out:
   txvq->last_avail_idx = last_avail_idx;
   txvq->last_used_idx = last_used_idx;
-  CLIB_MEMORY_STORE_BARRIER ();
-  txvq->used->idx = txvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, txvq, idx);
+  vhost_user_dma_update_used (vui, txvq);
   return discarded_packets;
 }
 
@@ -344,10 +345,8 @@ vhost_user_input_do_interrupt (vlib_main_t * vm, vhost_user_intf_t * vui,
 }
 
 static_always_inline void
-vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
-			      vhost_user_intf_t * vui,
-			      u32 * current_config_index, u32 * next_index,
-			      u32 ** to_next, u32 * n_left_to_next)
+vhost_user_input_get_next (vhost_user_intf_t *vui, u32 *current_config_index,
+			   u32 *next_index)
 {
   vnet_feature_main_t *fm = &feature_main;
   u8 feature_arc_idx = fm->device_input_feature_arc_index;
@@ -361,6 +360,15 @@ vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
       vnet_get_config_data (&cm->config_main, current_config_index,
 			    next_index, 0);
     }
+}
+
+static_always_inline void
+vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
+			      vhost_user_intf_t * vui,
+			      u32 * current_config_index, u32 * next_index,
+			      u32 ** to_next, u32 * n_left_to_next)
+{
+  vhost_user_input_get_next (vui, current_config_index, next_index);
 
   vlib_get_new_next_frame (vm, node, *next_index, *to_next, *n_left_to_next);
 
@@ -381,6 +389,47 @@ vhost_user_input_setup_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
     }
 }
 
+/**
+ * Submit the copies of the received packets. When all of them were done by
+ * the cpu, the packets go right away, unless a batch in flight is ahead of
+ * them.
+ *
+ * @returns 1 if the packets and descriptors are left to a completion
+ */
+static_always_inline int
+vhost_user_input_dma_submit (vlib_main_t *vm, vlib_node_runtime_t *node,
+			     vhost_user_intf_t *vui, vhost_user_vring_t *txvq,
+			     vlib_dma_batch_t *b, vhost_user_dma_info_t *di,
+			     u32 next_index)
+{
+  vhost_user_dma_info_t *last;
+  u32 n_buffers = vec_len (di->buffers);
+
+  di->next_index = next_index;
+  if (vhost_user_dma_submit (vm, vui, txvq, b))
+    return 1;
+
+  if (txvq->dma_info_head != txvq->dma_info_tail)
+    {
+      last = vhost_user_dma_info_at (txvq, txvq->dma_info_tail - 1);
+      if (last->next_index == next_index)
+	{
+	  vec_add (last->buffers, di->buffers, n_buffers);
+	  vec_reset_length (di->buffers);
+	  last->used_idx = txvq->last_used_idx;
+	  return 1;
+	}
+    }
+
+  /* nothing ahead in flight, or the next node changed meanwhile */
+  if (n_buffers)
+    vlib_buffer_enqueue_to_single_next (vm, node, di->buffers, next_index,
+					n_buffers);
+  vec_reset_length (di->buffers);
+  vhost_user_dma_update_used (vui, txvq);
+  return 0;
+}
+
 static_always_inline u32
 vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 		     vhost_user_intf_t *vui, u16 qid,
@@ -401,6 +450,8 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
   u8 feature_arc_idx = fm->device_input_feature_arc_index;
   u32 current_config_index = ~(u32) 0;
   u16 mask = txvq->qsz_mask;
+  vlib_dma_batch_t *dma_batch = 0;
+  vhost_user_dma_info_t *dma_info = 0;
 
   /* The descriptor table is not ready yet */
   if (PREDICT_FALSE (txvq->avail == 0))
@@ -468,6 +519,14 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
   if (n_left > VLIB_FRAME_SIZE)
     n_left = VLIB_FRAME_SIZE;
 
+  if (PREDICT_FALSE (vui->dma_config >= 0))
+    {
+      /* retried once a batch in flight completes */
+      if (!(dma_batch = vhost_user_dma_batch_new (vm, vui, txvq)))
+	goto done;
+      dma_info = vhost_user_dma_info_at (txvq, txvq->dma_info_tail);
+    }
+
   /*
    * For small packets (<2kB), we will not need more than one vlib buffer
    * per packet. In case packets are bigger, we will just yield at some point
@@ -505,8 +564,17 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	}
     }
 
-  vhost_user_input_setup_frame (vm, node, vui, &current_config_index,
-				&next_index, &to_next, &n_left_to_next);
+  if (PREDICT_FALSE (dma_info != 0))
+    {
+      /* the packets are held until their batch completes */
+      vhost_user_input_get_next (vui, &current_config_index, &next_index);
+      vec_validate (dma_info->buffers, VLIB_FRAME_SIZE - 1);
+      to_next = dma_info->buffers;
+      n_left_to_next = VLIB_FRAME_SIZE;
+    }
+  else
+    vhost_user_input_setup_frame (vm, node, vui, &current_config_index,
+				  &next_index, &to_next, &n_left_to_next);
 
   u16 last_avail_idx = txvq->last_avail_idx;
   u16 last_used_idx = txvq->last_used_idx;
@@ -518,6 +586,7 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
       u16 desc_current;
       u32 desc_data_offset;
       vnet_virtio_vring_desc_t *desc_table = txvq->desc;
+      u16 pkt_copy_len = copy_len;
 
       if (PREDICT_FALSE (cpu->rx_buffers_len <= 1))
 	{
@@ -643,11 +712,11 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 		  /*
 		   * Checking if there are some left buffers.
 		   * If not, just rewind the used buffers and stop.
-		   * Note: Scheduled copies are not cancelled. This is
-		   * not an issue as they would still be valid. Useless,
-		   * but valid.
+		   * The copies scheduled to them are cancelled, a DMA
+		   * transfer would land in buffers which are reused.
 		   */
 		  vhost_user_input_rewind_buffers (vm, cpu, b_head);
+		  copy_len = pkt_copy_len;
 		  n_left = 0;
 		  goto stop;
 		}
@@ -709,38 +778,55 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_RX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_input_copy (vui, cpu->copy,
-						    copy_len, &map_hint)))
+	  if (PREDICT_FALSE (vhost_user_input_copy (vm, vui, dma_batch,
+						    cpu->copy, copy_len,
+						    &map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
 				VHOST_USER_INPUT_FUNC_ERROR_MMAP_FAIL, 1);
 	    }
 	  copy_len = 0;
 
-	  /* give buffers back to driver */
-	  CLIB_MEMORY_STORE_BARRIER ();
-	  txvq->used->idx = last_used_idx;
-	  vhost_user_log_dirty_ring (vui, txvq, idx);
+	  /* give buffers back to driver, once the batch completes with dma */
+	  if (PREDICT_TRUE (dma_info == 0))
+	    {
+	      CLIB_MEMORY_STORE_BARRIER ();
+	      txvq->used->idx = last_used_idx;
+	      vhost_user_log_dirty_ring (vui, txvq, idx);
+	    }
 	}
     }
 stop:
-  vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+  if (PREDICT_FALSE (dma_info != 0))
+    vec_set_len (dma_info->buffers, VLIB_FRAME_SIZE - n_left_to_next);
+  else
+    vlib_put_next_frame (vm, node, next_index, n_left_to_next);
 
   txvq->last_used_idx = last_used_idx;
   txvq->last_avail_idx = last_avail_idx;
 
   /* Do the memory copies */
-  if (PREDICT_FALSE (vhost_user_input_copy (vui, cpu->copy, copy_len,
-					    &map_hint)))
+  if (PREDICT_FALSE (vhost_user_input_copy (vm, vui, dma_batch, cpu->copy,
+					    copy_len, &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_INPUT_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  /* give buffers back to driver */
-  CLIB_MEMORY_STORE_BARRIER ();
-  txvq->used->idx = txvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, txvq, idx);
+  if (PREDICT_FALSE (dma_info != 0))
+    {
+      /* the last completion calls */
+      if (vhost_user_input_dma_submit (vm, node, vui, txvq, dma_batch,
+				       dma_info, next_index))
+	goto counters;
+    }
+  else
+    {
+      /* give buffers back to driver */
+      CLIB_MEMORY_STORE_BARRIER ();
+      txvq->used->idx = txvq->last_used_idx;
+      vhost_user_log_dirty_ring (vui, txvq, idx);
+    }
 
   /* interrupt (call) handling */
   if ((txvq->callfd_idx != ~0) &&
@@ -752,6 +838,7 @@ stop:
 	vhost_user_send_call (vm, vui, txvq);
     }
 
+counters:
   /* increase rx counters */
   vlib_increment_combined_counter
     (vnet_main.interface_main.combined_sw_if_counters
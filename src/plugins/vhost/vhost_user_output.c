@@ -37,6 +37,7 @@
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/devices/devices.h>
 #include <vnet/feature/feature.h>
+#include <vnet/interface/rx_queue_funcs.h>
 #include <vnet/ip/ip_psh_cksum.h>
 
 #include <vhost/vhost_user.h>
@@ -155,8 +156,9 @@ vhost_user_tx_trace (vhost_trace_t * t,
 }
 
 static_always_inline u32
-vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
-		    u16 copy_len, u32 * map_hint)
+vhost_user_tx_copy (vlib_main_t *vm, vhost_user_intf_t *vui,
+		    vlib_dma_batch_t *b, vhost_copy_t *cpy, u16 copy_len,
+		    u32 *map_hint)
 {
   void *dst0, *dst1, *dst2, *dst3;
   if (PREDICT_TRUE (copy_len >= 4))
@@ -180,8 +182,10 @@ vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
 	  clib_prefetch_load ((void *) cpy[2].src);
 	  clib_prefetch_load ((void *) cpy[3].src);
 
-	  clib_memcpy_fast (dst0, (void *) cpy[0].src, cpy[0].len);
-	  clib_memcpy_fast (dst1, (void *) cpy[1].src, cpy[1].len);
+	  vhost_user_dma_copy (vm, vui, b, dst0, (void *) cpy[0].src,
+			       cpy[0].len);
+	  vhost_user_dma_copy (vm, vui, b, dst1, (void *) cpy[1].src,
+			       cpy[1].len);
 
 	  vhost_user_log_dirty_pages_2 (vui, cpy[0].dst, cpy[0].len, 1);
 	  vhost_user_log_dirty_pages_2 (vui, cpy[1].dst, cpy[1].len, 1);
@@ -193,7 +197,7 @@ vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
     {
       if (PREDICT_FALSE (!(dst0 = map_guest_mem (vui, cpy->dst, map_hint))))
 	return 1;
-      clib_memcpy_fast (dst0, (void *) cpy->src, cpy->len);
+      vhost_user_dma_copy (vm, vui, b, dst0, (void *) cpy->src, cpy->len);
       vhost_user_log_dirty_pages_2 (vui, cpy->dst, cpy->len, 1);
       copy_len -= 1;
       cpy += 1;
@@ -627,8 +631,8 @@ retry:
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD) || chained)
 	{
-	  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-						 &map_hint)))
+	  if (PREDICT_FALSE (vhost_user_tx_copy (vm, vui, 0, cpu->copy,
+						 copy_len, &map_hint)))
 	    vlib_error_count (vm, node->node_index,
 			      VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
 	  copy_len = 0;
@@ -644,7 +648,7 @@ retry:
 done:
   if (PREDICT_TRUE (copy_len))
     {
-      if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
+      if (PREDICT_FALSE (vhost_user_tx_copy (vm, vui, 0, cpu->copy, copy_len,
 					     &map_hint)))
 	vlib_error_count (vm, node->node_index,
 			  VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
@@ -706,6 +710,9 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   u16 tx_headers_len;
   u32 or_flags;
   vnet_hw_if_tx_frame_t *tf = vlib_frame_scalar_args (frame);
+  vlib_dma_batch_t *dma_batch = 0;
+  vhost_user_dma_info_t *dma_held = 0;
+  u8 use_dma;
 
   if (PREDICT_FALSE (!vui->admin_up))
     {
@@ -734,10 +741,15 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   if (vhost_user_is_packed_ring_supported (vui))
     return (vhost_user_device_class_packed (vm, node, frame, vui, rxvq));
 
+  /* completions are in order per thread, a shared queue can't be deferred */
+  use_dma = vui->dma_config >= 0 && !tf->shared_queue;
+
 retry:
   error = VHOST_USER_TX_FUNC_ERROR_NONE;
   tx_headers_len = 0;
   copy_len = 0;
+  if (PREDICT_FALSE (use_dma))
+    dma_batch = vhost_user_dma_batch_new (vm, vui, rxvq);
   while (n_left > 0)
     {
       vlib_buffer_t *b0, *current_b0;
@@ -746,6 +758,7 @@ retry:
       uword buffer_map_addr;
       u32 buffer_len;
       u16 bytes_left;
+      u16 pkt_copy_len = copy_len;
 
       if (PREDICT_TRUE (n_left > 1))
 	vlib_prefetch_buffer_with_index (vm, buffers[1], LOAD);
@@ -859,6 +872,8 @@ retry:
 		      //Dequeue queued descriptors for this packet
 		      rxvq->last_used_idx -= hdr->num_buffers - 1;
 		      rxvq->last_avail_idx -= hdr->num_buffers - 1;
+		      //and its copies, the descriptors will be reused
+		      copy_len = pkt_copy_len;
 		      error = VHOST_USER_TX_FUNC_ERROR_PKT_DROP_NOBUF;
 		      goto done;
 		    }
@@ -954,7 +969,8 @@ retry:
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
+	  if (PREDICT_FALSE (vhost_user_tx_copy (vm, vui, dma_batch,
+						 cpu->copy, copy_len,
 						 &map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
@@ -962,26 +978,43 @@ retry:
 	    }
 	  copy_len = 0;
 
-	  /* give buffers back to driver */
-	  CLIB_MEMORY_BARRIER ();
-	  rxvq->used->idx = rxvq->last_used_idx;
-	  vhost_user_log_dirty_ring (vui, rxvq, idx);
+	  /* give buffers back to driver, once the batch completes with dma */
+	  if (PREDICT_TRUE (!use_dma))
+	    {
+	      CLIB_MEMORY_BARRIER ();
+	      rxvq->used->idx = rxvq->last_used_idx;
+	      vhost_user_log_dirty_ring (vui, rxvq, idx);
+	    }
 	}
       buffers++;
     }
 
 done:
   //Do the memory copies
-  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-					 &map_hint)))
+  if (PREDICT_FALSE (vhost_user_tx_copy (vm, vui, dma_batch, cpu->copy,
+					 copy_len, &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  CLIB_MEMORY_BARRIER ();
-  rxvq->used->idx = rxvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, rxvq, idx);
+  if (PREDICT_FALSE (use_dma))
+    {
+      vhost_user_dma_info_t *di;
+
+      /* the frame is held by the last batch of the call */
+      if ((di = vhost_user_dma_submit (vm, vui, rxvq, dma_batch)))
+	dma_held = di;
+      else
+	vhost_user_dma_update_used (vui, rxvq);
+      dma_batch = 0;
+    }
+  else
+    {
+      CLIB_MEMORY_BARRIER ();
+      rxvq->used->idx = rxvq->last_used_idx;
+      vhost_user_log_dirty_ring (vui, rxvq, idx);
+    }
 
   /*
    * When n_left is set, error is always set to something too.
@@ -1007,7 +1040,9 @@ done:
     {
       rxvq->n_since_last_int += frame->n_vectors - n_left;
 
-      if (rxvq->n_since_last_int > vum->coalesce_frames)
+      /* with batches in flight, the last completion calls */
+      if (rxvq->n_since_last_int > vum->coalesce_frames &&
+	  rxvq->dma_info_head == rxvq->dma_info_tail)
 	vhost_user_send_call (vm, vui, rxvq);
     }
 
@@ -1023,10 +1058,124 @@ done3:
 	 thread_index, vui->sw_if_index, n_left);
     }
 
-  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+  if (PREDICT_FALSE (dma_held != 0))
+    vec_add (dma_held->buffers, vlib_frame_vector_args (frame),
+	     frame->n_vectors);
+  else
+    vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
   return frame->n_vectors;
 }
 
+/**
+ * Completion of a batch of a closed vring, only its buffers are left.
+ *
+ * @returns 1 if the batch was one of those
+ */
+static_always_inline int
+vhost_user_dma_retired_completion (vlib_main_t *vm, vhost_cpu_t *cpu,
+				   u32 epoch)
+{
+  vhost_user_dma_retired_t *r;
+  vhost_user_dma_info_t *di;
+
+  vec_foreach (r, cpu->dma_retired)
+    {
+      if (r->dma_epoch != epoch)
+	continue;
+
+      di = r->dma_info +
+	   (r->dma_info_head++ & (VHOST_USER_DMA_INFO_SIZE - 1));
+      vlib_buffer_free (vm, di->buffers, vec_len (di->buffers));
+      vec_reset_length (di->buffers);
+
+      if (r->dma_info_head == r->dma_info_tail)
+	{
+	  vec_foreach (di, r->dma_info)
+	    vec_free (di->buffers);
+	  vec_free (r->dma_info);
+	  vec_del1 (cpu->dma_retired, r - cpu->dma_retired);
+	}
+      return 1;
+    }
+  return 0;
+}
+
+CLIB_MARCH_FN (vhost_user_dma_completion_cb, void, vlib_main_t *vm,
+	       vlib_dma_batch_t *b)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_cpu_t *cpu = vec_elt_at_index (vum->cpus, vm->thread_index);
+  u32 if_index = (b->cookie >> 8) & VHOST_USER_DMA_MAX_IF_INDEX;
+  u32 qid = b->cookie & 0xff;
+  vhost_user_intf_t *vui;
+  vhost_user_vring_t *vq;
+  vhost_user_dma_info_t *di;
+  u32 n_buffers;
+
+  if (PREDICT_FALSE (vec_len (cpu->dma_retired) != 0) &&
+      vhost_user_dma_retired_completion (vm, cpu, b->cookie >> 32))
+    return;
+
+  if (pool_is_free_index (vum->vhost_user_interfaces, if_index))
+    return;
+
+  vui = pool_elt_at_index (vum->vhost_user_interfaces, if_index);
+  if (qid >= vec_len (vui->vrings))
+    return;
+
+  /* the vring was reset while the batch was in flight */
+  vq = vec_elt_at_index (vui->vrings, qid);
+  if (vq->dma_epoch != (u32) (b->cookie >> 32) ||
+      vq->dma_info_head == vq->dma_info_tail)
+    return;
+
+  di = vhost_user_dma_info_at (vq, vq->dma_info_head);
+  n_buffers = vec_len (di->buffers);
+
+  if (qid & 1)
+    {
+      /* driver tx ring, the received packets can go */
+      vlib_node_runtime_t *node =
+	vlib_node_get_runtime (vm, vhost_user_input_node.index);
+      if (n_buffers)
+	vlib_buffer_enqueue_to_single_next (vm, node, di->buffers,
+					    di->next_index, n_buffers);
+      /* the input node skipped the queue while the batches were in flight */
+      if (vq->mode != VNET_HW_IF_RX_MODE_POLLING)
+	vnet_hw_if_rx_queue_set_int_pending (vnet_get_main (),
+					     vq->queue_index);
+    }
+  else
+    vlib_buffer_free (vm, di->buffers, n_buffers);
+  vec_reset_length (di->buffers);
+
+  /* a queue which became shared since may already be ahead */
+  CLIB_MEMORY_STORE_BARRIER ();
+  if ((i16) (di->used_idx - vq->used->idx) > 0)
+    {
+      vq->used->idx = di->used_idx;
+      vhost_user_log_dirty_ring (vui, vq, idx);
+    }
+  vq->dma_info_head++;
+
+  if ((vq->callfd_idx != ~0) &&
+      !(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+    {
+      if (qid & 1)
+	vq->n_since_last_int += n_buffers;
+      if (vq->n_since_last_int > vum->coalesce_frames)
+	vhost_user_send_call (vm, vui, vq);
+    }
+}
+
+#ifndef CLIB_MARCH_VARIANT
+void
+vhost_user_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b)
+{
+  return CLIB_MARCH_FN_SELECT (vhost_user_dma_completion_cb) (vm, b);
+}
+#endif
+
 static __clib_unused clib_error_t *
 vhost_user_interface_rx_mode_change (vnet_main_t * vnm, u32 hw_if_index,
 				     u32 qid, vnet_hw_if_rx_mode mode)
@@ -14,51 +14,40 @@
  */
 
 #include <vlib/vlib.h>
-#include <vppinfra/hash.h>
-#include <vppinfra/pool.h>
 #include <vppinfra/random.h>
 #include <wireguard/wireguard_index_table.h>
 
+void
+wg_index_table_init (wg_index_table_t *table)
+{
+  clib_bihash_init_8_8 (&table->hash, "wireguard index table",
+			WG_INDEX_TABLE_N_BUCKETS, WG_INDEX_TABLE_MEMORY);
+}
+
 u32
 wg_index_table_add (vlib_main_t *vm, wg_index_table_t *table,
 		    u32 peer_pool_idx, u32 rnd_seed)
 {
-  u32 key;
+  clib_bihash_kv_8_8_t kv;
 
   while (1)
     {
-      key = random_u32 (&rnd_seed);
-      if (hash_get (table->hash, key))
+      kv.key = random_u32 (&rnd_seed);
+      kv.value = peer_pool_idx;
+      /* add, unless the index is already in use */
+      if (clib_bihash_add_del_8_8 (&table->hash, &kv, 2 /* no overwrite */))
 	continue;
-
-      vlib_worker_thread_barrier_sync (vm);
-      hash_set (table->hash, key, peer_pool_idx);
-      vlib_worker_thread_barrier_release (vm);
       break;
     }
-  return key;
+  return kv.key;
 }
 
 void
 wg_index_table_del (vlib_main_t *vm, wg_index_table_t *table, u32 key)
 {
-  uword *p;
-  p = hash_get (table->hash, key);
-  if (p)
-    {
-      vlib_worker_thread_barrier_sync (vm);
-      hash_unset (table->hash, key);
-      vlib_worker_thread_barrier_release (vm);
-    }
-}
-
-u32 *
-wg_index_table_lookup (const wg_index_table_t * table, u32 key)
-{
-  uword *p;
+  clib_bihash_kv_8_8_t kv = { .key = key };
 
-  p = hash_get (table->hash, key);
-  return (u32 *) p;
+  clib_bihash_add_del_8_8 (&table->hash, &kv, 0 /* is_add */);
 }
 
 /*
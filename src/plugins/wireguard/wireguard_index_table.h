@@ -18,16 +18,35 @@
 
 #include <vlib/vlib.h>
 #include <vppinfra/types.h>
+#include <vppinfra/bihash_8_8.h>
 
+/*
+ * Receiver index to peer index. Lookups are lock free and updates need no
+ * barrier, so a worker dropping an old keypair does not stop the others.
+ */
 typedef struct
 {
-  uword *hash;
+  clib_bihash_8_8_t hash;
 } wg_index_table_t;
 
+#define WG_INDEX_TABLE_N_BUCKETS (64 << 10)
+#define WG_INDEX_TABLE_MEMORY	 (64 << 20)
+
+void wg_index_table_init (wg_index_table_t *table);
 u32 wg_index_table_add (vlib_main_t *vm, wg_index_table_t *table,
 			u32 peer_pool_idx, u32 rnd_seed);
 void wg_index_table_del (vlib_main_t *vm, wg_index_table_t *table, u32 key);
-u32 *wg_index_table_lookup (const wg_index_table_t * table, u32 key);
+
+/* the index of the peer a receiver index was given to, ~0 if none */
+static_always_inline u32
+wg_index_table_lookup (wg_index_table_t *table, u32 key)
+{
+  clib_bihash_kv_8_8_t kv = { .key = key };
+
+  if (clib_bihash_search_inline_8_8 (&table->hash, &kv))
+    return ~0;
+  return kv.value;
+}
 
 #endif //__included_wg_index_table_h__
 
@@ -170,10 +170,10 @@ wg_handshake_process (vlib_main_t *vm, wg_main_t *wmp, vlib_buffer_t *b,
     {
       message_handshake_cookie_t *packet =
 	(message_handshake_cookie_t *) current_b_data;
-      u32 *entry =
+      index_t peeri =
 	wg_index_table_lookup (&wmp->index_table, packet->receiver_index);
-      if (entry)
-	peer = wg_peer_get (*entry);
+      if (peeri != INDEX_INVALID)
+	peer = wg_peer_get (peeri);
       else
 	return WG_INPUT_ERROR_PEER;
 
@@ -283,13 +283,11 @@ wg_handshake_process (vlib_main_t *vm, wg_main_t *wmp, vlib_buffer_t *b,
 	    return WG_INPUT_ERROR_NONE;
 	  }
 
-	index_t peeri = INDEX_INVALID;
-	u32 *entry =
+	index_t peeri =
 	  wg_index_table_lookup (&wmp->index_table, resp->receiver_index);
 
-	if (PREDICT_TRUE (entry != NULL))
+	if (PREDICT_TRUE (peeri != INDEX_INVALID))
 	  {
-	    peeri = *entry;
 	    peer = wg_peer_get (peeri);
 	    if (wg_peer_is_dead (peer))
 	      return WG_INPUT_ERROR_PEER;
@@ -609,7 +607,7 @@ wg_input_process (vlib_main_t *vm, wg_per_thread_data_t *ptd,
       if (NULL == *async_frame ||
 	  vnet_crypto_async_frame_is_full (*async_frame))
 	{
-	  *async_frame = vnet_crypto_async_get_frame (
+	  *async_frame = vnet_crypto_async_get_open_frame (
 	    vm, VNET_CRYPTO_OP_CHACHA20_POLY1305_TAG16_AAD0_DEC);
 	  if (PREDICT_FALSE (NULL == *async_frame))
 	    goto error;
@@ -720,11 +718,11 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   f64 time = clib_time_now (&vm->clib_time) + vm->time_offset;
 
   wg_peer_t *peer = NULL;
-  u32 *last_peer_time_idx = NULL;
+  index_t last_peer_time_idx = INDEX_INVALID;
   u32 last_rec_idx = ~0;
 
   bool is_keepalive = false;
-  u32 *peer_idx = NULL;
+  index_t peer_idx = INDEX_INVALID;
   index_t peeri = INDEX_INVALID;
 
   while (n_left_from > 0)
@@ -751,16 +749,15 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  u8 *iv_data = b[0]->pre_data;
 	  u32 buf_idx = from[b - bufs];
 	  u32 n_bufs;
-	  peer_idx = wg_index_table_lookup (&wmp->index_table,
-					    data->receiver_index);
 
+	  /* consecutive packets of a keypair share the lookup */
 	  if (data->receiver_index != last_rec_idx)
 	    {
 	      peer_idx = wg_index_table_lookup (&wmp->index_table,
 						data->receiver_index);
-	      if (PREDICT_TRUE (peer_idx != NULL))
+	      if (PREDICT_TRUE (peer_idx != INDEX_INVALID))
 		{
-		  peeri = *peer_idx;
+		  peeri = peer_idx;
 		  peer = wg_peer_get (peeri);
 		  last_rec_idx = data->receiver_index;
 		}
@@ -771,7 +768,7 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		}
 	    }
 
-	  if (PREDICT_FALSE (!peer_idx))
+	  if (PREDICT_FALSE (peer_idx == INDEX_INVALID))
 	    {
 	      other_next[n_other] = WG_INPUT_NEXT_ERROR;
 	      b[0]->error = node->errors[WG_INPUT_ERROR_PEER];
@@ -857,7 +854,7 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
 	  if (PREDICT_FALSE (state_cr == SC_FAILED))
 	    {
-	      wg_peer_update_flags (*peer_idx, WG_PEER_ESTABLISHED, false);
+	      wg_peer_update_flags (peer_idx, WG_PEER_ESTABLISHED, false);
 	      other_next[n_other] = WG_INPUT_NEXT_ERROR;
 	      b[0]->error = node->errors[WG_INPUT_ERROR_DECRYPTION];
 	      other_bi[n_other] = buf_idx;
@@ -923,7 +920,7 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  t->type = header_type;
 	  t->current_length = b[0]->current_length;
 	  t->is_keepalive = is_keepalive;
-	  t->peer = peer_idx ? peeri : INDEX_INVALID;
+	  t->peer = peer_idx;
 	}
 
     next:
@@ -941,12 +938,12 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   b = data_bufs;
   n_left_from = n_data;
   last_rec_idx = ~0;
-  last_peer_time_idx = NULL;
+  last_peer_time_idx = INDEX_INVALID;
 
   while (n_left_from > 0)
     {
       bool is_keepalive = false;
-      u32 *peer_idx = NULL;
+      index_t peer_idx = INDEX_INVALID;
 
       if (PREDICT_FALSE (data_next[0] == WG_INPUT_NEXT_PUNT))
 	{
@@ -972,9 +969,9 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	{
 	  peer_idx =
 	    wg_index_table_lookup (&wmp->index_table, data->receiver_index);
-	  if (PREDICT_TRUE (peer_idx != NULL))
+	  if (PREDICT_TRUE (peer_idx != INDEX_INVALID))
 	    {
-	      peeri = *peer_idx;
+	      peeri = peer_idx;
 	      peer = wg_peer_get (peeri);
 	      last_rec_idx = data->receiver_index;
 	    }
@@ -997,7 +994,8 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  goto trace;
 	}
 
-      if (PREDICT_FALSE (peer_idx && (last_peer_time_idx != peer_idx)))
+      if (PREDICT_FALSE (peer_idx != INDEX_INVALID &&
+			 last_peer_time_idx != peer_idx))
 	{
 	  if (PREDICT_FALSE (
 		!ip46_address_is_equal (&peer->dst.addr, &out_src_ip) ||
@@ -1006,7 +1004,7 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 					     out_udp_src_port);
 	  wg_timers_any_authenticated_packet_received_opt (peer, time);
 	  wg_timers_any_authenticated_packet_traversal (peer);
-	  wg_peer_update_flags (*peer_idx, WG_PEER_ESTABLISHED, true);
+	  wg_peer_update_flags (peer_idx, WG_PEER_ESTABLISHED, true);
 	  last_peer_time_idx = peer_idx;
 	}
 
@@ -1023,7 +1021,7 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  t->type = header_type;
 	  t->current_length = b[0]->current_length;
 	  t->is_keepalive = is_keepalive;
-	  t->peer = peer_idx ? peeri : INDEX_INVALID;
+	  t->peer = peer_idx;
 	}
 
       b += 1;
@@ -1038,9 +1036,16 @@ wg_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       vec_foreach (async_frame, ptd->async_frames)
 	{
 	  if (PREDICT_FALSE (
-		vnet_crypto_async_submit_open_frame (vm, *async_frame) < 0))
+		vnet_crypto_async_submit_or_hold_frame (vm, *async_frame) < 0))
 	    {
 	      u32 n_drop = (*async_frame)->n_elts;
+	      /* a frame held by an earlier call may not fit */
+	      if (n_other + n_drop > VLIB_FRAME_SIZE)
+		{
+		  vlib_buffer_enqueue_to_next (vm, node, other_bi, other_next,
+					       n_other);
+		  n_other = 0;
+		}
 	      u32 *bi = (*async_frame)->buffer_indices;
 	      u16 index = n_other;
 	      while (n_drop--)
@@ -1083,8 +1088,8 @@ wg_input_post (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
   u32 *from = vlib_frame_vector_args (frame);
   u32 n_left = frame->n_vectors;
   wg_peer_t *peer = NULL;
-  u32 *peer_idx = NULL;
-  u32 *last_peer_time_idx = NULL;
+  index_t peer_idx = INDEX_INVALID;
+  index_t last_peer_time_idx = INDEX_INVALID;
   index_t peeri = INDEX_INVALID;
   u32 last_rec_idx = ~0;
   f64 time = clib_time_now (&vm->clib_time) + vm->time_offset;
@@ -1119,9 +1124,9 @@ wg_input_post (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
 	  peer_idx =
 	    wg_index_table_lookup (&wmp->index_table, data->receiver_index);
 
-	  if (PREDICT_TRUE (peer_idx != NULL))
+	  if (PREDICT_TRUE (peer_idx != INDEX_INVALID))
 	    {
-	      peeri = *peer_idx;
+	      peeri = peer_idx;
 	      peer = wg_peer_get (peeri);
 	      last_rec_idx = data->receiver_index;
 	    }
@@ -1144,7 +1149,8 @@ wg_input_post (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
 	  goto trace;
 	}
 
-      if (PREDICT_FALSE (peer_idx && (last_peer_time_idx != peer_idx)))
+      if (PREDICT_FALSE (peer_idx != INDEX_INVALID &&
+			 last_peer_time_idx != peer_idx))
 	{
 	  if (PREDICT_FALSE (
 		!ip46_address_is_equal (&peer->dst.addr, &out_src_ip) ||
@@ -1153,7 +1159,7 @@ wg_input_post (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
 					     out_udp_src_port);
 	  wg_timers_any_authenticated_packet_received_opt (peer, time);
 	  wg_timers_any_authenticated_packet_traversal (peer);
-	  wg_peer_update_flags (*peer_idx, WG_PEER_ESTABLISHED, true);
+	  wg_peer_update_flags (peer_idx, WG_PEER_ESTABLISHED, true);
 	  last_peer_time_idx = peer_idx;
 	}
 
@@ -1169,7 +1175,7 @@ wg_input_post (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame,
 	  wg_input_post_trace_t *t =
 	    vlib_add_trace (vm, node, b[0], sizeof (*t));
 	  t->next = next[0];
-	  t->peer = peer_idx ? peeri : INDEX_INVALID;
+	  t->peer = peer_idx;
 	}
 
       b += 1;
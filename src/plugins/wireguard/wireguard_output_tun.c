@@ -366,7 +366,7 @@ wg_add_to_async_frame (vlib_main_t *vm, wg_per_thread_data_t *ptd,
   /* get a frame for this op if we don't yet have one or it's full  */
   if (NULL == *async_frame || vnet_crypto_async_frame_is_full (*async_frame))
     {
-      *async_frame = vnet_crypto_async_get_frame (
+      *async_frame = vnet_crypto_async_get_open_frame (
 	vm, VNET_CRYPTO_OP_CHACHA20_POLY1305_TAG16_AAD0_ENC);
       if (PREDICT_FALSE (NULL == *async_frame))
 	goto error;
@@ -734,9 +734,16 @@ wg_output_tun_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       vec_foreach (async_frame, ptd->async_frames)
 	{
 	  if (PREDICT_FALSE (
-		vnet_crypto_async_submit_open_frame (vm, *async_frame) < 0))
+		vnet_crypto_async_submit_or_hold_frame (vm, *async_frame) < 0))
 	    {
 	      u32 n_drop = (*async_frame)->n_elts;
+	      /* a frame held by an earlier call may not fit */
+	      if (n_noop + n_drop > VLIB_FRAME_SIZE)
+		{
+		  vlib_buffer_enqueue_to_next (vm, node, noop_bi, noop_nexts,
+					       n_noop);
+		  n_noop = 0;
+		}
 	      u32 *bi = (*async_frame)->buffer_indices;
 	      u16 index = n_noop;
 	      while (n_drop--)
@@ -552,6 +552,12 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
 
   clib_spinlock_init (&bp->lock);
 
+  bp->depot = clib_mem_alloc_aligned (VLIB_BUFFER_POOL_DEPOT_SZ *
+					sizeof (bp->depot[0]),
+				      CLIB_CACHE_LINE_BYTES);
+  for (int i = 0; i < VLIB_BUFFER_POOL_DEPOT_SZ; i++)
+    bp->depot[i].seq = i;
+
   p = m->base;
 
   /* start with naturally aligned address */
@@ -592,7 +598,7 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
   vlib_main_t *vm = va_arg (*va, vlib_main_t *);
   vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
   vlib_buffer_pool_thread_t *bpt;
-  u32 cached = 0;
+  u32 cached = 0, avail;
 
   if (!bp)
     return format (s, "%-20s%=6s%=6s%=6s%=11s%=6s%=8s%=8s%=8s",
@@ -602,12 +608,15 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
   vec_foreach (bpt, bp->threads)
     cached += bpt->n_cached;
 
+  /* full magazines in the depot are available to any thread */
+  avail = bp->n_avail + vlib_buffer_pool_depot_n_buffers (bp);
+
   s = format (s, "%-20v%=6d%=6d%=6u%=11u%=6u%=8u%=8u%=8u", bp->name, bp->index,
 	      bp->numa_node,
 	      bp->data_size + sizeof (vlib_buffer_t) +
 		vm->buffer_main->ext_hdr_size,
-	      bp->data_size, bp->n_buffers, bp->n_avail, cached,
-	      bp->n_buffers - bp->n_avail - cached);
+	      bp->data_size, bp->n_buffers, avail, cached,
+	      bp->n_buffers - avail - cached);
 
   return s;
 }
@@ -627,17 +636,53 @@ format_vlib_buffer_pool_all (u8 *s, va_list *va)
   return s;
 }
 
+static u8 *
+format_vlib_buffer_pool_contention (u8 *s, va_list *va)
+{
+  vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
+  vlib_buffer_pool_thread_t *bpt;
+
+  if (!bp)
+    return format (s, "%-20s%=8s%=12s%=12s%=12s%=12s", "Pool Name", "Thread",
+		   "Depot Get", "Depot Put", "Lock", "Contended");
+
+  vec_foreach (bpt, bp->threads)
+    {
+      if (bpt->n_depot_get + bpt->n_depot_put + bpt->n_lock == 0)
+	continue;
+      s = format (s, "\n%-20v%=8u%=12lu%=12lu%=12lu%=12lu", bp->name,
+		  bpt - bp->threads, bpt->n_depot_get, bpt->n_depot_put,
+		  bpt->n_lock, bpt->n_lock_contended);
+    }
+
+  return s;
+}
+
 static clib_error_t *
 show_buffers (vlib_main_t *vm, unformat_input_t *input,
 	      vlib_cli_command_t *cmd)
 {
+  vlib_buffer_main_t *bm = vm->buffer_main;
+  vlib_buffer_pool_t *bp;
+  u8 *s = 0;
+
   vlib_cli_output (vm, "%U", format_vlib_buffer_pool_all, vm);
+
+  if (unformat (input, "verbose"))
+    {
+      s = format (s, "%U", format_vlib_buffer_pool_contention, 0);
+      vec_foreach (bp, bm->buffer_pools)
+	s = format (s, "%U", format_vlib_buffer_pool_contention, bp);
+      vlib_cli_output (vm, "\n%v", s);
+      vec_free (s);
+    }
+
   return 0;
 }
 
 VLIB_CLI_COMMAND (show_buffers_command, static) = {
   .path = "show buffers",
-  .short_help = "Show packet buffer allocation",
+  .short_help = "show buffers [verbose]",
   .function = show_buffers,
 };
 
@@ -795,7 +840,9 @@ buffer_gauges_collect_used_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_buffers - bp->n_avail - buffer_get_cached (bp);
+  d->entry->value = bp->n_buffers - bp->n_avail -
+		    vlib_buffer_pool_depot_n_buffers (bp) -
+		    buffer_get_cached (bp);
 }
 
 static void
@@ -807,7 +854,7 @@ buffer_gauges_collect_available_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_avail;
+  d->entry->value = bp->n_avail + vlib_buffer_pool_depot_n_buffers (bp);
 }
 
 static void
@@ -456,13 +456,38 @@ struct vlib_main_t;
 
 #define VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ 512
 
+/* buffers exchanged at once between a per-thread cache and the depot */
+#define VLIB_BUFFER_POOL_MAGAZINE_SZ (VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ / 2)
+
+/* full magazines held by the depot of a pool, power of 2 */
+#define VLIB_BUFFER_POOL_DEPOT_SZ 32
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
   u32 cached_buffers[VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ];
   u32 n_cached;
+
+  /* magazines taken from and given to the depot */
+  u64 n_depot_get;
+  u64 n_depot_put;
+  /* pool lock acquisitions, and how many found it taken */
+  u64 n_lock;
+  u64 n_lock_contended;
 } vlib_buffer_pool_thread_t;
 
+/*
+ * Slot of the depot ring. The depot is a bounded lock-free queue of full
+ * magazines shared by all the threads: the sequence number tells if the
+ * slot is free or full for a given lap of the ring.
+ */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 seq;
+  u32 buffers[VLIB_BUFFER_POOL_MAGAZINE_SZ];
+} vlib_buffer_pool_magazine_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -485,6 +510,13 @@ typedef struct
 
   /* buffer metadata template */
   vlib_buffer_template_t buffer_template;
+
+  /* depot of full magazines, VLIB_BUFFER_POOL_DEPOT_SZ slots */
+  vlib_buffer_pool_magazine_t *depot;
+  CLIB_CACHE_LINE_ALIGN_MARK (depot_put_line);
+  u32 depot_put_pos;
+  CLIB_CACHE_LINE_ALIGN_MARK (depot_get_line);
+  u32 depot_get_pos;
 } vlib_buffer_pool_t;
 
 #define VLIB_BUFFER_MAX_NUMA_NODES 32
@@ -254,36 +254,80 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_single_next_with_aux_fn)
 }
 CLIB_MARCH_FN_REGISTRATION (vlib_buffer_enqueue_to_single_next_with_aux_fn);
 
-static inline vlib_frame_queue_elt_t *
-vlib_get_frame_queue_elt (vlib_frame_queue_main_t *fqm, u32 index,
-			  int dont_wait)
+/* reserve up to n slots in a handoff queue, returns how many it got */
+static_always_inline u32
+vlib_frame_queue_reserve (vlib_frame_queue_t *fq, u32 n, int dont_wait,
+			  u64 *start)
 {
-  vlib_frame_queue_t *fq;
-  u64 nelts, tail, new_tail;
-
-  fq = vec_elt (fqm->vlib_frame_queues, index);
-  ASSERT (fq);
-  nelts = fq->nelts;
+  u64 capacity = (u64) fq->nelts * VLIB_FRAME_SIZE;
+  u64 tail, n_used, n_free;
 
 retry:
-  tail = __atomic_load_n (&fq->tail, __ATOMIC_ACQUIRE);
-  new_tail = tail + 1;
+  tail = __atomic_load_n (&fq->tail_reserved, __ATOMIC_RELAXED);
+  n_used = tail - __atomic_load_n (&fq->head, __ATOMIC_ACQUIRE);
 
-  if (new_tail >= fq->head + nelts)
+  /* head moved past our stale tail */
+  if (PREDICT_FALSE ((i64) n_used < 0))
+    goto retry;
+
+  n_free = n_used < capacity ? capacity - n_used : 0;
+
+  if (PREDICT_FALSE (n_free < n))
     {
-      if (dont_wait)
-	return 0;
+      if (!dont_wait)
+	{
+	  /* Wait until enough slots are available */
+	  vlib_worker_thread_barrier_check ();
+	  goto retry;
+	}
 
-      /* Wait until a ring slot is available */
-      while (new_tail >= fq->head + nelts)
-	vlib_worker_thread_barrier_check ();
+      /* congested, leave the other producers their share of what is left */
+      n = clib_min (n_free, clib_max (n_free / fq->n_producers, 1));
+      if (n == 0)
+	return 0;
     }
 
-  if (!__atomic_compare_exchange_n (&fq->tail, &tail, new_tail, 0 /* weak */,
-				    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+  if (!__atomic_compare_exchange_n (&fq->tail_reserved, &tail, tail + n,
+				    0 /* weak */, __ATOMIC_RELAXED,
+				    __ATOMIC_RELAXED))
     goto retry;
 
-  return fq->elts + (new_tail & (nelts - 1));
+  *start = tail;
+  return n;
+}
+
+static_always_inline void
+vlib_frame_queue_ring_write (u32 *ring, u32 ring_mask, u64 start, u32 *src,
+			     u32 n)
+{
+  u32 off = start & ring_mask;
+  u32 n_first = clib_min (n, ring_mask + 1 - off);
+
+  vlib_buffer_copy_indices (ring + off, src, n_first);
+  if (n_first < n)
+    vlib_buffer_copy_indices (ring, src + n_first, n - n_first);
+}
+
+static_always_inline void
+vlib_frame_queue_ring_read (u32 *ring, u32 ring_mask, u64 start, u32 *dst,
+			    u32 n)
+{
+  u32 off = start & ring_mask;
+  u32 n_first = clib_min (n, ring_mask + 1 - off);
+
+  vlib_buffer_copy_indices (dst, ring + off, n_first);
+  if (n_first < n)
+    vlib_buffer_copy_indices (dst + n_first, ring, n - n_first);
+}
+
+static_always_inline void
+vlib_frame_queue_publish (vlib_frame_queue_t *fq, u64 start, u32 n)
+{
+  /* batches reserved before this one go first */
+  while (__atomic_load_n (&fq->tail, __ATOMIC_ACQUIRE) != start)
+    CLIB_PAUSE ();
+
+  __atomic_store_n (&fq->tail, start + n, __ATOMIC_RELEASE);
 }
 
 static_always_inline u32
@@ -295,33 +339,49 @@ vlib_buffer_enqueue_to_thread_inline (vlib_main_t *vm,
 				      int with_aux, u32 *aux_data)
 {
   u32 drop_list[VLIB_FRAME_SIZE], n_drop = 0;
+  u32 aux_list[VLIB_FRAME_SIZE];
   vlib_frame_bitmap_t mask, used_elts = {};
-  vlib_frame_queue_elt_t *hf = 0;
+  vlib_frame_queue_t *fq;
   clib_thread_index_t thread_index;
-  u32 n_comp, off = 0, n_left = n_packets;
+  u32 n_comp, n_enq, *batch, off = 0, n_left = n_packets;
+  u64 start;
 
   thread_index = thread_indices[0];
 
 more:
   clib_mask_compare_u16 (thread_index, thread_indices, mask, n_packets);
-  hf = vlib_get_frame_queue_elt (fqm, thread_index, drop_on_congestion);
 
-  n_comp = clib_compress_u32 (hf ? hf->buffer_index : drop_list + n_drop,
-			      buffer_indices, mask, n_packets);
+  /* the batch is staged at the end of the drop list, where the part that
+   * does not fit in the queue already is */
+  batch = drop_list + n_drop;
+  n_comp = clib_compress_u32 (batch, buffer_indices, mask, n_packets);
   if (with_aux)
-    clib_compress_u32 (hf ? hf->aux_data : drop_list + n_drop, aux_data, mask,
-		       n_packets);
+    clib_compress_u32 (aux_list, aux_data, mask, n_packets);
+
+  fq = vec_elt (fqm->vlib_frame_queues, thread_index);
+  ASSERT (fq);
+  n_enq = vlib_frame_queue_reserve (fq, n_comp, drop_on_congestion, &start);
 
-  if (hf)
+  if (n_enq)
     {
+      vlib_frame_queue_ring_write (fq->buffer_index, fq->ring_mask, start,
+				   batch, n_enq);
+      if (with_aux)
+	vlib_frame_queue_ring_write (fq->aux_data, fq->ring_mask, start,
+				     aux_list, n_enq);
       if (node->flags & VLIB_NODE_FLAG_TRACE)
-	hf->maybe_trace = 1;
-      hf->n_vectors = n_comp;
-      __atomic_store_n (&hf->valid, 1, __ATOMIC_RELEASE);
+	fq->maybe_trace = 1;
+      vlib_frame_queue_publish (fq, start, n_enq);
       vlib_get_main_by_index (thread_index)->check_frame_queues = 1;
     }
-  else
-    n_drop += n_comp;
+
+  if (PREDICT_FALSE (n_enq < n_comp))
+    {
+      clib_memmove (batch, batch + n_enq, (n_comp - n_enq) * sizeof (u32));
+      n_drop += n_comp - n_enq;
+      vlib_increment_simple_counter (&fqm->congestion_drops, vm->thread_index,
+				     thread_index, n_comp - n_enq);
+    }
 
   n_left -= n_comp;
 
@@ -419,17 +479,21 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
 {
   u32 thread_id = vm->thread_index;
   vlib_frame_queue_t *fq = fqm->vlib_frame_queues[thread_id];
-  u32 mask = fq->nelts - 1;
-  vlib_frame_queue_elt_t *elt;
-  u32 n_free, n_copy, *from, *from_aux, *to = 0, *to_aux = 0, processed = 0,
-					vectors = 0;
-  vlib_frame_t *f = 0;
+  u64 capacity, head, tail, n_left;
+  u32 n, bucket, vectors = 0;
+  vlib_frame_t *f;
 
   ASSERT (fq);
   ASSERT (vm == vlib_global_main.vlib_mains[thread_id]);
 
   if (PREDICT_FALSE (fqm->node_index == ~0))
     return 0;
+
+  capacity = (u64) fq->nelts * VLIB_FRAME_SIZE;
+  head = fq->head;
+  tail = __atomic_load_n (&fq->tail, __ATOMIC_ACQUIRE);
+  n_left = tail - head;
+
   /*
    * Gather trace data for frame queues
    */
@@ -442,10 +506,11 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
       fqt = &fqm->frame_queue_traces[thread_id];
 
       fqt->nelts = fq->nelts;
-      fqt->head = fq->head;
-      fqt->tail = fq->tail;
+      fqt->head = head;
+      fqt->tail = tail;
       fqt->threshold = fq->vector_threshold;
-      fqt->n_in_use = fqt->tail - fqt->head;
+      /* in frames worth of buffers */
+      fqt->n_in_use = (n_left + VLIB_FRAME_SIZE - 1) / VLIB_FRAME_SIZE;
       if (fqt->n_in_use >= fqt->nelts)
 	{
 	  // if beyond max then use max
@@ -457,91 +522,56 @@ vlib_frame_queue_dequeue_inline (vlib_main_t *vm, vlib_frame_queue_main_t *fqm,
       fqh->count[fqt->n_in_use]++;
 
       /* Record a snapshot of the elements in use */
-      for (elix = 0; elix < fqt->nelts; elix++)
+      for (elix = 0; elix < fqt->nelts && elix < FRAME_QUEUE_MAX_NELTS;
+	   elix++)
 	{
-	  elt = fq->elts + ((fq->head + 1 + elix) & (mask));
-	  if (1 || elt->valid)
-	    {
-	      fqt->n_vectors[elix] = elt->n_vectors;
-	    }
+	  i64 n_vectors = (i64) n_left - (i64) elix * VLIB_FRAME_SIZE;
+	  fqt->n_vectors[elix] = clib_max (clib_min (n_vectors, VLIB_FRAME_SIZE),
+					   0);
 	}
       fqt->written = 1;
     }
 
-  while (1)
-    {
-      if (fq->head == fq->tail)
-	break;
-
-      elt = fq->elts + ((fq->head + 1) & mask);
-
-      if (!__atomic_load_n (&elt->valid, __ATOMIC_ACQUIRE))
-	break;
-
-      from = elt->buffer_index + elt->offset;
-      if (with_aux)
-	from_aux = elt->aux_data + elt->offset;
-      ASSERT (elt->offset + elt->n_vectors <= VLIB_FRAME_SIZE);
+  if (n_left == 0)
+    return 0;
 
-      if (f == 0)
-	{
-	  f = vlib_get_frame_to_node (vm, fqm->node_index);
-	  to = vlib_frame_vector_args (f);
-	  if (with_aux)
-	    to_aux = vlib_frame_aux_args (f);
-	  n_free = VLIB_FRAME_SIZE;
-	}
+  bucket = (clib_min (n_left, capacity) - 1) *
+	   VLIB_FRAME_QUEUE_N_OCCUPANCY_BUCKETS / capacity;
+  vlib_increment_simple_counter (&fqm->occupancy, thread_id, bucket, 1);
 
-      if (elt->maybe_trace)
-	f->frame_flags |= VLIB_NODE_FLAG_TRACE;
+  /* Limit the number of packets pushed into the graph */
+  n_left = clib_min (n_left, fq->vector_threshold);
 
-      n_copy = clib_min (n_free, elt->n_vectors);
+  while (n_left)
+    {
+      n = clib_min (n_left, VLIB_FRAME_SIZE);
 
-      vlib_buffer_copy_indices (to, from, n_copy);
-      to += n_copy;
+      f = vlib_get_frame_to_node (vm, fqm->node_index);
+      vlib_frame_queue_ring_read (fq->buffer_index, fq->ring_mask, head,
+				  vlib_frame_vector_args (f), n);
       if (with_aux)
-	{
-	  vlib_buffer_copy_indices (to_aux, from_aux, n_copy);
-	  to_aux += n_copy;
-	}
+	vlib_frame_queue_ring_read (fq->aux_data, fq->ring_mask, head,
+				    vlib_frame_aux_args (f), n);
 
-      n_free -= n_copy;
-      vectors += n_copy;
+      if (fq->maybe_trace)
+	f->frame_flags |= VLIB_NODE_FLAG_TRACE;
 
-      if (n_free == 0)
-	{
-	  f->n_vectors = VLIB_FRAME_SIZE;
-	  vlib_put_frame_to_node (vm, fqm->node_index, f);
-	  f = 0;
-	}
+      f->n_vectors = n;
+      vlib_put_frame_to_node (vm, fqm->node_index, f);
 
-      if (n_copy < elt->n_vectors)
-	{
-	  /* not empty - leave it on the ring */
-	  elt->n_vectors -= n_copy;
-	  elt->offset += n_copy;
-	}
-      else
-	{
-	  /* empty - reset and bump head */
-	  u32 sz = STRUCT_OFFSET_OF (vlib_frame_queue_elt_t, end_of_reset);
-	  clib_memset (elt, 0, sz);
-	  __atomic_store_n (&fq->head, fq->head + 1, __ATOMIC_RELEASE);
-	  processed++;
-	}
+      head += n;
+      n_left -= n;
+      vectors += n;
 
-      /* Limit the number of packets pushed into the graph */
-      if (vectors >= fq->vector_threshold)
-	break;
+      /* give the slots back as soon as possible */
+      __atomic_store_n (&fq->head, head, __ATOMIC_RELEASE);
     }
 
-  if (f)
-    {
-      f->n_vectors = VLIB_FRAME_SIZE - n_free;
-      vlib_put_frame_to_node (vm, fqm->node_index, f);
-    }
+  /* tracing is per batch, so only forget about it once all are seen */
+  if (fq->maybe_trace && head == __atomic_load_n (&fq->tail, __ATOMIC_ACQUIRE))
+    fq->maybe_trace = 0;
 
-  return processed;
+  return vectors;
 }
 
 u32 __clib_section (".vlib_frame_queue_dequeue_fn")
@@ -505,16 +505,122 @@ vlib_get_buffer_pool (vlib_main_t * vm, u8 buffer_pool_index)
   return vec_elt_at_index (bm->buffer_pools, buffer_pool_index);
 }
 
+static_always_inline void
+vlib_buffer_pool_lock (vlib_buffer_pool_t *bp, vlib_buffer_pool_thread_t *bpt)
+{
+  bpt->n_lock++;
+  if (PREDICT_FALSE (!clib_spinlock_trylock (&bp->lock)))
+    {
+      bpt->n_lock_contended++;
+      clib_spinlock_lock (&bp->lock);
+    }
+}
+
+/** \brief Take a full magazine from the depot of a pool
+
+    Lock-free, any thread can call it.
+
+    @param bp - (vlib_buffer_pool_t *) buffer pool
+    @param buffers - (u32 *) VLIB_BUFFER_POOL_MAGAZINE_SZ buffer indices
+    @return - (int) 1 on success, 0 if the depot is empty
+*/
+static_always_inline int
+vlib_buffer_pool_depot_get (vlib_buffer_pool_t *bp, u32 *buffers)
+{
+  vlib_buffer_pool_magazine_t *mag;
+  u32 pos, seq;
+  i32 diff;
+
+  pos = clib_atomic_load_relax_n (&bp->depot_get_pos);
+  while (1)
+    {
+      mag = bp->depot + (pos & (VLIB_BUFFER_POOL_DEPOT_SZ - 1));
+      seq = clib_atomic_load_acq_n (&mag->seq);
+      diff = (i32) (seq - (pos + 1));
+
+      if (diff == 0)
+	{
+	  if (clib_atomic_cmp_and_swap_acq_relax_n (&bp->depot_get_pos, &pos,
+						    pos + 1, 1 /* weak */))
+	    break;
+	}
+      else if (diff < 0)
+	return 0;
+      else
+	pos = clib_atomic_load_relax_n (&bp->depot_get_pos);
+    }
+
+  vlib_buffer_copy_indices (buffers, mag->buffers,
+			    VLIB_BUFFER_POOL_MAGAZINE_SZ);
+  clib_atomic_store_rel_n (&mag->seq, pos + VLIB_BUFFER_POOL_DEPOT_SZ);
+  return 1;
+}
+
+/** \brief Give a full magazine to the depot of a pool
+
+    Lock-free, any thread can call it.
+
+    @param bp - (vlib_buffer_pool_t *) buffer pool
+    @param buffers - (u32 *) VLIB_BUFFER_POOL_MAGAZINE_SZ buffer indices
+    @return - (int) 1 on success, 0 if the depot is full
+*/
+static_always_inline int
+vlib_buffer_pool_depot_put (vlib_buffer_pool_t *bp, u32 *buffers)
+{
+  vlib_buffer_pool_magazine_t *mag;
+  u32 pos, seq;
+  i32 diff;
+
+  pos = clib_atomic_load_relax_n (&bp->depot_put_pos);
+  while (1)
+    {
+      mag = bp->depot + (pos & (VLIB_BUFFER_POOL_DEPOT_SZ - 1));
+      seq = clib_atomic_load_acq_n (&mag->seq);
+      diff = (i32) (seq - pos);
+
+      if (diff == 0)
+	{
+	  if (clib_atomic_cmp_and_swap_acq_relax_n (&bp->depot_put_pos, &pos,
+						    pos + 1, 1 /* weak */))
+	    break;
+	}
+      else if (diff < 0)
+	return 0;
+      else
+	pos = clib_atomic_load_relax_n (&bp->depot_put_pos);
+    }
+
+  vlib_buffer_copy_indices (mag->buffers, buffers,
+			    VLIB_BUFFER_POOL_MAGAZINE_SZ);
+  clib_atomic_store_rel_n (&mag->seq, pos + 1);
+  return 1;
+}
+
+/** \brief Number of buffers in the depot of a pool, a snapshot */
+static_always_inline u32
+vlib_buffer_pool_depot_n_buffers (vlib_buffer_pool_t *bp)
+{
+  u32 put = clib_atomic_load_relax_n (&bp->depot_put_pos);
+  u32 get = clib_atomic_load_relax_n (&bp->depot_get_pos);
+
+  /* the get position may run ahead of a put still in flight */
+  if ((i32) (put - get) <= 0)
+    return 0;
+  return (put - get) * VLIB_BUFFER_POOL_MAGAZINE_SZ;
+}
+
 static_always_inline __clib_warn_unused_result uword
 vlib_buffer_pool_get (vlib_main_t * vm, u8 buffer_pool_index, u32 * buffers,
 		      u32 n_buffers)
 {
   vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, buffer_pool_index);
+  vlib_buffer_pool_thread_t *bpt =
+    vec_elt_at_index (bp->threads, vm->thread_index);
   u32 len;
 
   ASSERT (bp->buffers);
 
-  clib_spinlock_lock (&bp->lock);
+  vlib_buffer_pool_lock (bp, bpt);
   len = bp->n_avail;
   if (PREDICT_TRUE (n_buffers < len))
     {
@@ -534,6 +640,35 @@ vlib_buffer_pool_get (vlib_main_t * vm, u8 buffer_pool_index, u32 * buffers,
 }
 
 
+/** \brief Give the full magazines of the depot back to a pool
+
+    For the allocations which bypass the per-thread cache, so that the
+    buffers parked in the depot are not lost to them.
+
+    @param vm - (vlib_main_t *) vlib main data structure pointer
+    @param bp - (vlib_buffer_pool_t *) buffer pool
+    @param n_buffers - (u32) stop once the pool has that many buffers
+*/
+static_always_inline void
+vlib_buffer_pool_depot_drain (vlib_main_t *vm, vlib_buffer_pool_t *bp,
+			      u32 n_buffers)
+{
+  vlib_buffer_pool_thread_t *bpt =
+    vec_elt_at_index (bp->threads, vm->thread_index);
+  u32 mag[VLIB_BUFFER_POOL_MAGAZINE_SZ];
+
+  while (clib_atomic_load_relax_n (&bp->n_avail) < n_buffers &&
+	 vlib_buffer_pool_depot_get (bp, mag))
+    {
+      vlib_buffer_pool_lock (bp, bpt);
+      vlib_buffer_copy_indices (bp->buffers + bp->n_avail, mag,
+				VLIB_BUFFER_POOL_MAGAZINE_SZ);
+      bp->n_avail += VLIB_BUFFER_POOL_MAGAZINE_SZ;
+      clib_spinlock_unlock (&bp->lock);
+      bpt->n_depot_get++;
+    }
+}
+
 /** \brief Allocate buffers from specific pool into supplied array
 
     @param vm - (vlib_main_t *) vlib main data structure pointer
@@ -582,6 +717,9 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
   /* alloc bigger than cache - take buffers directly from main pool */
   if (n_buffers >= VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ)
     {
+      if (PREDICT_FALSE (clib_atomic_load_relax_n (&bp->n_avail) <
+			 n_buffers))
+	vlib_buffer_pool_depot_drain (vm, bp, n_buffers);
       n_buffers = vlib_buffer_pool_get (vm, buffer_pool_index, buffers,
 					n_buffers);
       goto done;
@@ -596,9 +734,24 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
       n_left -= len;
     }
 
-  len = round_pow2 (n_left, 32);
-  len = vlib_buffer_pool_get (vm, buffer_pool_index, bpt->cached_buffers,
-			      len);
+  /* refill the cache with full magazines from the depot first */
+  len = 0;
+  while (len < n_left &&
+	 vlib_buffer_pool_depot_get (bp, bpt->cached_buffers + len))
+    {
+      len += VLIB_BUFFER_POOL_MAGAZINE_SZ;
+      bpt->n_depot_get++;
+    }
+
+  /* and at least a magazine worth from the pool if still short */
+  if (len < n_left)
+    {
+      u32 n_get = clib_max (round_pow2 (n_left - len, 32),
+			    VLIB_BUFFER_POOL_MAGAZINE_SZ);
+      n_get = clib_min (n_get, VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ - len);
+      len += vlib_buffer_pool_get (vm, buffer_pool_index,
+				   bpt->cached_buffers + len, n_get);
+    }
   bpt->n_cached = len;
 
   if (len)
@@ -732,21 +885,34 @@ vlib_buffer_pool_put (vlib_main_t * vm, u8 buffer_pool_index,
   if (PREDICT_FALSE (bm->free_callback_fn != 0))
     bm->free_callback_fn (vm, buffer_pool_index, buffers, n_buffers);
 
-  n_cached = bpt->n_cached;
-  n_empty = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ - n_cached;
-  if (n_buffers <= n_empty)
+  while (1)
     {
-      vlib_buffer_copy_indices (bpt->cached_buffers + n_cached,
-				buffers, n_buffers);
-      bpt->n_cached = n_cached + n_buffers;
-      return;
+      n_cached = bpt->n_cached;
+      n_empty = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ - n_cached;
+      if (n_buffers <= n_empty)
+	{
+	  vlib_buffer_copy_indices (bpt->cached_buffers + n_cached, buffers,
+				    n_buffers);
+	  bpt->n_cached = n_cached + n_buffers;
+	  return;
+	}
+
+      /* make room by handing the top magazine of the cache to the depot */
+      if (n_cached < VLIB_BUFFER_POOL_MAGAZINE_SZ ||
+	  !vlib_buffer_pool_depot_put (
+	    bp, bpt->cached_buffers + n_cached - VLIB_BUFFER_POOL_MAGAZINE_SZ))
+	break;
+
+      bpt->n_cached = n_cached - VLIB_BUFFER_POOL_MAGAZINE_SZ;
+      bpt->n_depot_put++;
     }
 
+  /* the depot is full, return what doesn't fit in the cache to the pool */
   vlib_buffer_copy_indices (bpt->cached_buffers + n_cached,
 			    buffers + n_buffers - n_empty, n_empty);
   bpt->n_cached = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
 
-  clib_spinlock_lock (&bp->lock);
+  vlib_buffer_pool_lock (bp, bpt);
   vlib_buffer_copy_indices (bp->buffers + bp->n_avail, buffers,
 			    n_buffers - n_empty);
   bp->n_avail += n_buffers - n_empty;
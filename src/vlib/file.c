@@ -4,10 +4,12 @@
 
 #include <vlib/vlib.h>
 #include <vlib/unix/unix.h>
+#include <vlib/file.h>
 
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <limits.h>
+#include <poll.h>
 
 VLIB_REGISTER_LOG_CLASS (vlib_file_log, static) = {
   .class_name = "vlib",
@@ -76,6 +78,142 @@ wake_read_fn (struct clib_file *f)
   return 0;
 }
 
+#ifdef HAVE_IO_URING
+static void
+vlib_file_io_uring_init (vlib_main_t *vm)
+{
+  vlib_file_io_uring_t *fu;
+  clib_error_t *err;
+
+  fu = clib_mem_alloc_aligned (sizeof (*fu), CLIB_CACHE_LINE_BYTES);
+  clib_memset_u8 (fu, 0, sizeof (*fu));
+
+  if ((err = clib_io_uring_init (&fu->ring, 256)))
+    {
+      clib_warning ("thread %u: %U, using epoll", vm->thread_index,
+		    format_clib_error, err);
+      clib_error_free (err);
+      clib_mem_free (fu);
+      return;
+    }
+
+  vm->io_uring = fu;
+}
+
+static void
+vlib_file_io_uring_kick_error (vlib_main_t *vm, u64 user_data, int err)
+{
+  vlib_error_t e;
+
+  vm->io_uring->n_kick_errors++;
+
+  if ((user_data & VLIB_FILE_KICK_F_COUNT_ERRORS) == 0)
+    return;
+
+  if (err == EAGAIN || err == ENOBUFS || err == EINTR)
+    e = user_data >> 16;
+  else
+    e = user_data >> 32;
+
+  /* an index in the error heap, as in vlib_node_runtime_t.errors */
+  ASSERT (e < vec_len (vm->error_main.counters));
+  vm->error_main.counters[e]++;
+}
+
+static void
+vlib_file_io_uring_reap (vlib_main_t *vm)
+{
+  vlib_file_io_uring_t *fu = vm->io_uring;
+  struct io_uring_cqe *cqe;
+
+  while ((cqe = clib_io_uring_peek_cqe (&fu->ring)))
+    {
+      if (cqe->user_data == VLIB_FILE_IO_URING_EPOLL)
+	{
+	  fu->epoll_ready = 1;
+	  /* multishot poll terminated, e.g. on cq overflow */
+	  if ((cqe->flags & IORING_CQE_F_MORE) == 0)
+	    fu->epoll_armed = 0;
+	}
+      else if (cqe->res < 0)
+	vlib_file_io_uring_kick_error (vm, cqe->user_data, -cqe->res);
+
+      clib_io_uring_cqe_seen (&fu->ring);
+    }
+}
+
+static int
+vlib_file_io_uring_enter (vlib_main_t *vm, u32 wait_nr, int timeout_ms)
+{
+  vlib_file_io_uring_t *fu = vm->io_uring;
+  int rv;
+
+  rv = clib_io_uring_enter (&fu->ring, wait_nr, timeout_ms * 1000000LL);
+  fu->n_enters++;
+  vec_reset_length (fu->kick_fds);
+  vlib_file_io_uring_reap (vm);
+
+  return rv;
+}
+
+__clib_export void
+vlib_file_io_uring_submit (vlib_main_t *vm)
+{
+  if (vlib_file_io_uring_enter (vm, 0, 0) < 0)
+    log_debug ("%s: io_uring_enter() failed, errno %d", __func__, errno);
+}
+
+/*
+ * epoll_wait () counterpart: the epoll fd is watched by a multishot poll,
+ * so when nothing is ready this costs a look at the completion queue, or
+ * a single io_uring_enter () which also submits the pending kicks.
+ */
+static int
+vlib_file_io_uring_wait (vlib_main_t *vm, struct epoll_event *events,
+			 int max_events, int timeout_ms)
+{
+  vlib_file_io_uring_t *fu = vm->io_uring;
+  struct io_uring_sqe *sqe;
+  int n_fds_ready;
+
+  if (!fu->epoll_armed && (sqe = clib_io_uring_get_sqe (&fu->ring)))
+    {
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = vm->epoll_fd;
+      sqe->poll32_events = POLLIN;
+      sqe->len = IORING_POLL_ADD_MULTI;
+      sqe->user_data = VLIB_FILE_IO_URING_EPOLL;
+      fu->epoll_armed = 1;
+      /* events may have been missed while not armed */
+      fu->epoll_ready = 1;
+    }
+
+  vlib_file_io_uring_reap (vm);
+
+  if (fu->epoll_ready == 0 && timeout_ms)
+    {
+      if (vlib_file_io_uring_enter (vm, 1, timeout_ms) < 0 && errno != EBUSY)
+	return -1;
+    }
+  else if (clib_io_uring_n_pending (&fu->ring))
+    {
+      if (vlib_file_io_uring_enter (vm, 0, 0) < 0 && errno != EBUSY)
+	return -1;
+    }
+
+  if (fu->epoll_ready == 0)
+    return 0;
+
+  /* level triggered files which weren't drained don't wake the poll
+   * again, so epoll is asked until it has nothing left */
+  n_fds_ready = epoll_wait (vm->epoll_fd, events, max_events, 0);
+  if (n_fds_ready == 0)
+    fu->epoll_ready = 0;
+
+  return n_fds_ready;
+}
+#endif /* HAVE_IO_URING */
+
 void
 vlib_file_poll_init (vlib_main_t *vm)
 {
@@ -100,6 +238,14 @@ vlib_file_poll_init (vlib_main_t *vm)
 						      vm->thread_index),
 			       .read_function = wake_read_fn,
 			     });
+
+  if (unix_main.poll_io_uring)
+#ifdef HAVE_IO_URING
+    vlib_file_io_uring_init (vm);
+#else
+    clib_warning ("thread %u: built without io_uring support, using epoll",
+		  vm->thread_index);
+#endif
 }
 
 void
@@ -178,8 +324,14 @@ skip_loops:
   vm->file_poll_skip_loops = 1024;
 
 epoll:
-  n_fds_ready = epoll_wait (vm->epoll_fd, epoll_events,
-			    ARRAY_LEN (epoll_events), timeout_ms);
+#ifdef HAVE_IO_URING
+  if (vm->io_uring)
+    n_fds_ready = vlib_file_io_uring_wait (vm, epoll_events,
+					   ARRAY_LEN (epoll_events), timeout_ms);
+  else
+#endif
+    n_fds_ready = epoll_wait (vm->epoll_fd, epoll_events,
+			      ARRAY_LEN (epoll_events), timeout_ms);
 
   __atomic_store_n (&vm->thread_sleeps, 0, __ATOMIC_RELAXED);
   __atomic_store_n (&vm->wakeup_pending, 0, __ATOMIC_RELAXED);
@@ -295,6 +447,22 @@ show_files (vlib_main_t *vm, unformat_input_t *input, vlib_cli_command_t *cmd)
     }
   vec_free (s);
 
+#ifdef HAVE_IO_URING
+  foreach_vlib_main ()
+    {
+      vlib_file_io_uring_t *fu = this_vlib_main->io_uring;
+
+      if (fu == 0)
+	continue;
+
+      vlib_cli_output (vm,
+		       "thread %u io_uring: enters %lu kicks %lu merged %lu "
+		       "errors %lu",
+		       this_vlib_main->thread_index, fu->n_enters, fu->n_kicks,
+		       fu->n_kicks_merged, fu->n_kick_errors);
+    }
+#endif
+
   return error;
 }
 
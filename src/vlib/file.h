@@ -5,10 +5,152 @@
 #ifndef __vlib_file_h__
 #define __vlib_file_h__
 
+#include <sys/socket.h>
 #include <vppinfra/file.h>
+#ifdef HAVE_IO_URING
+#include <vppinfra/linux/io_uring.h>
+#endif
 
 extern clib_file_main_t file_main;
 
+typedef enum
+{
+  /* 8 byte write to an eventfd */
+  VLIB_FILE_KICK_EVENTFD,
+  /* zero length send on a socket */
+  VLIB_FILE_KICK_SEND,
+} vlib_file_kick_type_t;
+
 void vlib_file_poll_init (vlib_main_t *vm);
 void vlib_file_poll (vlib_main_t *vm);
+
+#ifdef HAVE_IO_URING
+/*
+ * Optional per-thread io_uring. The thread waits on its epoll fd through
+ * a multishot poll, so the readiness of the files is seen in the
+ * completion queue without a syscall, and the tx kicks queued by the
+ * drivers during a dispatch cycle are submitted with it.
+ */
+typedef enum
+{
+  VLIB_FILE_IO_URING_EPOLL = 1,
+  VLIB_FILE_IO_URING_KICK,
+} vlib_file_io_uring_user_data_t;
+
+typedef struct vlib_file_io_uring_t
+{
+  clib_io_uring_t ring;
+  /* fds kicked since the last submit */
+  int *kick_fds;
+  u8 epoll_armed;
+  u8 epoll_ready;
+
+  u64 n_enters;
+  u64 n_kicks;
+  u64 n_kicks_merged;
+  u64 n_kick_errors;
+} vlib_file_io_uring_t;
+
+void vlib_file_io_uring_submit (vlib_main_t *vm);
+
+/*
+ * The user data of a kick also carries the error counters to bump when
+ * its completion reports a failure: bits 16-31 for temporary failures
+ * (EAGAIN, ENOBUFS, EINTR), bits 32-47 for the others.
+ */
+#define VLIB_FILE_KICK_F_COUNT_ERRORS (1 << 8)
+
+static_always_inline u64
+vlib_file_kick_user_data (vlib_error_t error_again, vlib_error_t error_fatal)
+{
+  return VLIB_FILE_IO_URING_KICK | VLIB_FILE_KICK_F_COUNT_ERRORS |
+	 (u64) error_again << 16 | (u64) error_fatal << 32;
+}
+
+/**
+ * @brief Queue a tx kick, submitted at the end of the dispatch cycle
+ *
+ * Several kicks of the same fd in a cycle are merged. A send kick which
+ * fails bumps error_again or error_fatal of the caller when reaped.
+ *
+ * @returns 0 if queued, -1 if the caller has to kick itself
+ */
+static_always_inline int
+vlib_file_queue_kick (vlib_main_t *vm, int fd, vlib_file_kick_type_t type,
+		      vlib_error_t error_again, vlib_error_t error_fatal)
+{
+  static const u64 one = 1;
+  vlib_file_io_uring_t *fu = vm->io_uring;
+  struct io_uring_sqe *sqe;
+  int *kfd;
+
+  if (PREDICT_TRUE (fu == 0))
+    return -1;
+
+  vec_foreach (kfd, fu->kick_fds)
+    if (kfd[0] == fd)
+      {
+	fu->n_kicks_merged++;
+	return 0;
+      }
+
+  sqe = clib_io_uring_get_sqe (&fu->ring);
+  if (PREDICT_FALSE (sqe == 0))
+    {
+      vlib_file_io_uring_submit (vm);
+      if ((sqe = clib_io_uring_get_sqe (&fu->ring)) == 0)
+	return -1;
+    }
+
+  sqe->fd = fd;
+  if (type == VLIB_FILE_KICK_EVENTFD)
+    {
+      sqe->opcode = IORING_OP_WRITE;
+      sqe->addr = pointer_to_uword (&one);
+      sqe->len = sizeof (one);
+      sqe->off = ~0ULL;
+      sqe->user_data = VLIB_FILE_IO_URING_KICK;
+    }
+  else
+    {
+      /* never park an io-wq worker on a full ring */
+      sqe->opcode = IORING_OP_SEND;
+      sqe->msg_flags = MSG_DONTWAIT;
+      sqe->user_data = vlib_file_kick_user_data (error_again, error_fatal);
+    }
+
+  vec_add1 (fu->kick_fds, fd);
+  fu->n_kicks++;
+  return 0;
+}
+
+/**
+ * @brief Submit the kicks of a dispatch cycle which doesn't poll the files
+ */
+static_always_inline void
+vlib_file_submit (vlib_main_t *vm)
+{
+  vlib_file_io_uring_t *fu = vm->io_uring;
+
+  if (PREDICT_FALSE (fu != 0) && clib_io_uring_n_pending (&fu->ring))
+    vlib_file_io_uring_submit (vm);
+}
+
+#else /* HAVE_IO_URING */
+
+/* linux/io_uring.h lacks what the ring needs, the callers kick themselves */
+static_always_inline int
+vlib_file_queue_kick (vlib_main_t *vm, int fd, vlib_file_kick_type_t type,
+		      vlib_error_t error_again, vlib_error_t error_fatal)
+{
+  return -1;
+}
+
+static_always_inline void
+vlib_file_submit (vlib_main_t *vm)
+{
+}
+
+#endif /* HAVE_IO_URING */
+
 #endif /* __vlib_file_h__ */
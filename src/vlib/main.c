@@ -955,7 +955,8 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
 				      /* n_clocks */ t - last_time_stamp);
 
   /* When in adaptive mode and vector rate crosses threshold switch to
-     polling mode and vice versa. */
+     polling mode and vice versa. Work arriving within the busy-poll budget
+     of the previous one also keeps the node polling. */
   if (PREDICT_FALSE (attr.supports_adaptive_mode &&
 		     node->flags & VLIB_NODE_FLAG_ADAPTIVE_MODE))
     {
@@ -973,9 +974,24 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
       {
 	u32 node_name, vector_length, is_polling;
       } *ed;
+      vlib_node_adaptive_t *as;
+      u64 since_busy;
+
+      vec_validate (nm->adaptive_state, node->node_index);
+      as = vec_elt_at_index (nm->adaptive_state, node->node_index);
+
+      as->avg_vectors +=
+	((i32) (n << VLIB_NODE_ADAPTIVE_AVG_SHIFT) - (i32) as->avg_vectors) >>
+	nm->adaptive_log2_weight;
+      v = as->avg_vectors >> VLIB_NODE_ADAPTIVE_AVG_SHIFT;
+
+      since_busy = t - as->last_busy_cpu_time;
+      if (n)
+	as->last_busy_cpu_time = t;
 
       if ((node->state == VLIB_NODE_STATE_INTERRUPT &&
-	   v >= nm->polling_threshold_vector_length) &&
+	   (v >= nm->polling_threshold_vector_length ||
+	    (n && since_busy < nm->adaptive_busy_poll_clocks))) &&
 	  !(node->flags &
 	    VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE))
 	{
@@ -987,6 +1003,7 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  node->flags |= VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE;
 	  nm->input_node_counts_by_state[VLIB_NODE_STATE_INTERRUPT] -= 1;
 	  nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] += 1;
+	  as->n_switches++;
 
 	  if (PREDICT_FALSE (
 		vlib_get_first_main ()->elog_trace_graph_dispatch))
@@ -1002,7 +1019,8 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    }
 	}
       else if (node->state == VLIB_NODE_STATE_POLLING &&
-	       v <= nm->interrupt_threshold_vector_length)
+	       v <= nm->interrupt_threshold_vector_length &&
+	       t - as->last_busy_cpu_time >= nm->adaptive_busy_poll_clocks)
 	{
 	  vlib_node_t *n = vlib_get_node (vm, node->node_index);
 	  if (node->flags &
@@ -1016,7 +1034,7 @@ dispatch_node (vlib_main_t *vm, vlib_node_runtime_t *node,
 		~VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE;
 	      nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] -= 1;
 	      nm->input_node_counts_by_state[VLIB_NODE_STATE_INTERRUPT] += 1;
-
+	      as->n_switches++;
 	    }
 	  else
 	    {
@@ -1502,11 +1520,8 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
   else
     cpu_time_now = clib_cpu_time_now ();
 
-  /* Pre-allocate expired nodes. */
-  if (!nm->polling_threshold_vector_length)
-    nm->polling_threshold_vector_length = 10;
-  if (!nm->interrupt_threshold_vector_length)
-    nm->interrupt_threshold_vector_length = 5;
+  nm->adaptive_busy_poll_clocks =
+    nm->adaptive_busy_poll_usec * 1e-6 * vm->clib_time.clocks_per_second;
 
   vm->numa_node = clib_get_current_numa_node ();
   os_set_numa_index (vm->numa_node);
@@ -1573,7 +1588,10 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
       cpu_time_now = clib_cpu_time_now ();
 
       if (vm->file_poll_skip_loops)
-	vm->file_poll_skip_loops--;
+	{
+	  vm->file_poll_skip_loops--;
+	  vlib_file_submit (vm);
+	}
       else
 	vlib_file_poll (vm);
 
@@ -1726,6 +1744,10 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
       else
 	expired_timers = process_expired_timers (expired_timers);
 
+      /* Reclaim objects whose workers' grace period has ended. */
+      if (is_main && PREDICT_FALSE (tm->n_deferred_pending))
+	vlib_worker_deferred_poll (vm);
+
       vlib_increment_main_loop_counter (vm);
       /* Record time stamp in case there are no enabled nodes and above
          calls do not update time stamp. */
@@ -2004,6 +2026,12 @@ vlib_main (vlib_main_t * volatile vm, unformat_input_t * input)
       vm->buffer_alloc_success_rate = 0.80;
     }
 
+  /* Adaptive mode defaults, see the "node" config */
+  nm->polling_threshold_vector_length = 10;
+  nm->interrupt_threshold_vector_length = 5;
+  nm->adaptive_busy_poll_usec = 50;
+  nm->adaptive_log2_weight = 3;
+
   if ((error = vlib_call_all_config_functions (vm, input, 0 /* is_early */ )))
     goto done;
 
@@ -217,6 +217,9 @@ typedef struct vlib_main_t
   u8 wakeup_pending;
   u8 thread_sleeps;
 
+  /* io_uring used to wait on epoll_fd and to batch tx kicks, optional */
+  struct vlib_file_io_uring_t *io_uring;
+
   /* control-plane API queue signal pending, length indication */
   volatile u32 queue_signal_pending;
   volatile u32 api_queue_nonempty;
@@ -585,6 +585,20 @@ vlib_node_runtime_t;
 
 #define VLIB_NODE_RUNTIME_DATA_SIZE	(sizeof (vlib_node_runtime_t) - STRUCT_OFFSET_OF (vlib_node_runtime_t, runtime_data))
 
+/* Per thread state of an input node in adaptive mode. */
+typedef struct
+{
+  /* Moving average of vectors per dispatch, fixed point. */
+  u32 avg_vectors;
+#define VLIB_NODE_ADAPTIVE_AVG_SHIFT 8
+
+  /* Number of polling/interrupt mode switches. */
+  u32 n_switches;
+
+  /* CPU time of the last dispatch which found work. */
+  u64 last_busy_cpu_time;
+} vlib_node_adaptive_t;
+
 typedef struct
 {
   /* Number of allocated frames for this scalar/vector size. */
@@ -773,6 +787,17 @@ typedef struct
   u32 polling_threshold_vector_length;
   u32 interrupt_threshold_vector_length;
 
+  /* Adaptive nodes keep polling this long after the last vector, and
+     switch back to polling when interrupts come closer than that. */
+  u32 adaptive_busy_poll_usec;
+  u64 adaptive_busy_poll_clocks;
+
+  /* Weight of a dispatch in the average vector length, as 1 / 2^n. */
+  u8 adaptive_log2_weight;
+
+  /* Adaptive mode state, indexed by node index. */
+  vlib_node_adaptive_t *adaptive_state;
+
   /* Vector of next frames. */
   vlib_next_frame_t *next_frames;
 
@@ -893,6 +893,123 @@ VLIB_CLI_COMMAND (set_node_fn_command, static) = {
   .function = set_node_fn,
 };
 
+clib_error_t *
+vlib_node_adaptive_mode_config (unformat_input_t *input)
+{
+  vlib_node_main_t *nm = &vlib_get_first_main ()->node_main;
+  u32 poll = nm->polling_threshold_vector_length;
+  u32 intr = nm->interrupt_threshold_vector_length;
+  u32 busy_poll_usec = nm->adaptive_busy_poll_usec;
+  u32 log2_weight = nm->adaptive_log2_weight;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "poll-threshold %u", &poll))
+	;
+      else if (unformat (input, "interrupt-threshold %u", &intr))
+	;
+      else if (unformat (input, "busy-poll-usec %u", &busy_poll_usec))
+	;
+      else if (unformat (input, "weight-log2 %u", &log2_weight))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (intr >= poll)
+    return clib_error_return (
+      0, "interrupt threshold must be below the poll threshold");
+
+  if (log2_weight > 8)
+    return clib_error_return (0, "weight-log2 must be between 0 and 8");
+
+  foreach_vlib_main ()
+    {
+      nm = &this_vlib_main->node_main;
+      nm->polling_threshold_vector_length = poll;
+      nm->interrupt_threshold_vector_length = intr;
+      nm->adaptive_busy_poll_usec = busy_poll_usec;
+      nm->adaptive_busy_poll_clocks =
+	busy_poll_usec * 1e-6 * this_vlib_main->clib_time.clocks_per_second;
+      nm->adaptive_log2_weight = log2_weight;
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+set_node_adaptive_mode (vlib_main_t *vm, unformat_input_t *input,
+			vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *err;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  err = vlib_node_adaptive_mode_config (line_input);
+  unformat_free (line_input);
+  return err;
+}
+
+VLIB_CLI_COMMAND (set_node_adaptive_mode_command, static) = {
+  .path = "set node adaptive-mode",
+  .short_help = "set node adaptive-mode [poll-threshold <n>] "
+		"[interrupt-threshold <n>] [busy-poll-usec <n>] "
+		"[weight-log2 <n>]",
+  .function = set_node_adaptive_mode,
+};
+
+static clib_error_t *
+show_node_adaptive_mode (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_adaptive_t *as;
+
+  vlib_cli_output (vm,
+		   "poll-threshold %u interrupt-threshold %u "
+		   "busy-poll-usec %u weight-log2 %u",
+		   nm->polling_threshold_vector_length,
+		   nm->interrupt_threshold_vector_length,
+		   nm->adaptive_busy_poll_usec, nm->adaptive_log2_weight);
+
+  vlib_cli_output (vm, "%-7s%-32s%-10s%-12s%s", "Thread", "Node", "State",
+		   "Avg vector", "Switches");
+
+  foreach_vlib_main ()
+    {
+      vlib_main_t *tvm = this_vlib_main;
+
+      vec_foreach (as, tvm->node_main.adaptive_state)
+	{
+	  u32 node_index = as - tvm->node_main.adaptive_state;
+	  vlib_node_runtime_t *rt;
+
+	  if (as->avg_vectors == 0 && as->n_switches == 0 &&
+	      as->last_busy_cpu_time == 0)
+	    continue;
+
+	  rt = vlib_node_get_runtime (tvm, node_index);
+	  vlib_cli_output (
+	    vm, "%-7u%-32U%-10s%-12.2f%u", tvm->thread_index,
+	    format_vlib_node_name, vm, node_index,
+	    rt->state == VLIB_NODE_STATE_POLLING ? "polling" : "interrupt",
+	    (f64) as->avg_vectors / (1 << VLIB_NODE_ADAPTIVE_AVG_SHIFT),
+	    as->n_switches);
+	}
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_node_adaptive_mode_command, static) = {
+  .path = "show node adaptive-mode",
+  .short_help = "show node adaptive-mode",
+  .function = show_node_adaptive_mode,
+};
+
 /* Dummy function to get us linked in. */
 void
 vlib_node_cli_reference (void)
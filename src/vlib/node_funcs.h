@@ -1441,6 +1441,14 @@ vlib_node_set_dispatch_wrapper (vlib_main_t *vm, vlib_node_function_t *fn)
 int vlib_node_set_march_variant (vlib_main_t *vm, u32 node_index,
 				 clib_march_variant_type_t march_variant);
 
+/**
+ * @brief Set the adaptive mode parameters of all threads
+ *
+ * Parses [poll-threshold <n>] [interrupt-threshold <n>]
+ * [busy-poll-usec <n>] [weight-log2 <n>].
+ */
+clib_error_t *vlib_node_adaptive_mode_config (unformat_input_t *input);
+
 vlib_node_function_t *
 vlib_node_get_preferred_node_fn_variant (vlib_main_t *vm,
 					 vlib_node_fn_registration_t *regs);
@@ -72,6 +72,14 @@ vlib_node_config (vlib_main_t *vm, unformat_input_t *input)
 	      unformat_free (&sub_input);
 	    }
 	}
+      else if (unformat (input, "adaptive-mode %U",
+			 unformat_vlib_cli_sub_input, &sub_input))
+	{
+	  error = vlib_node_adaptive_mode_config (&sub_input);
+	  unformat_free (&sub_input);
+	  if (error)
+	    return error;
+	}
       else /* specify prioritization for an individual graph node */
 	if (unformat (input, "%U", unformat_vlib_node, vm, &node_index))
 	{
@@ -148,6 +148,8 @@ do_stat_segment_updates (vlib_main_t *vm, vlib_stats_segment_t *sm)
 
   /* Heartbeat, so clients detect we're still here */
   sm->directory_vector[STAT_COUNTER_HEARTBEAT].value++;
+
+  vlib_stats_delta_update (sm);
 }
 
 static uword
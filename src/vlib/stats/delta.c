@@ -0,0 +1,205 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/stats/stats.h>
+
+void
+vlib_stats_delta_init (vlib_stats_segment_t *sm)
+{
+  vlib_stats_delta_ring_t *r;
+  void *oldheap;
+
+  if (sm->delta_ring_size == 0)
+    return;
+
+  oldheap = clib_mem_set_heap (sm->heap);
+  r = clib_mem_alloc_aligned (sizeof (*r), CLIB_CACHE_LINE_BYTES);
+  clib_memset (r, 0, sizeof (*r));
+  r->n_records = sm->delta_ring_size;
+  r->records = clib_mem_alloc_aligned (
+    r->n_records * sizeof (r->records[0]), CLIB_CACHE_LINE_BYTES);
+  clib_memset (r->records, 0, r->n_records * sizeof (r->records[0]));
+  clib_mem_set_heap (oldheap);
+
+  sm->delta_ring = r;
+  __atomic_store_n (&sm->shared_header->delta_ring, r, __ATOMIC_RELEASE);
+}
+
+static_always_inline void
+vlib_stats_delta_emit (vlib_stats_delta_ring_t *r, u64 *pos, u32 entry_index,
+		       u32 vector_index, u64 v0, u64 v1)
+{
+  vlib_stats_delta_record_t *rec = r->records + (*pos & (r->n_records - 1));
+
+  /* invalidate the slot before overwriting it, for the readers still on the
+   * previous lap */
+  __atomic_store_n (&rec->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  rec->entry_index = entry_index;
+  rec->vector_index = vector_index;
+  rec->value[0] = v0;
+  rec->value[1] = v1;
+  __atomic_store_n (&rec->seq, *pos + 1, __ATOMIC_RELEASE);
+  *pos += 1;
+}
+
+/*
+ * Sum the per-thread vectors of an entry into sm->delta_sums, n_values
+ * values per index. The sums are scratch space of the main thread, in the
+ * process heap.
+ */
+static u32
+vlib_stats_delta_sum (vlib_stats_segment_t *sm, vlib_stats_entry_t *e,
+		      u32 n_values)
+{
+  u32 n_indices = 0, i, j;
+  u64 *sums;
+
+  if (e->type == STAT_DIR_TYPE_SCALAR_INDEX)
+    {
+      vec_validate (sm->delta_sums, 0);
+      sm->delta_sums[0] = e->value;
+      return 1;
+    }
+
+  if (e->type == STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE)
+    {
+      counter_t **c = e->data;
+
+      for (i = 0; i < vec_len (c); i++)
+	n_indices = clib_max (n_indices, vec_len (c[i]));
+
+      vec_validate (sm->delta_sums, n_indices);
+      sums = sm->delta_sums;
+      clib_memset (sums, 0, n_indices * sizeof (sums[0]));
+
+      for (i = 0; i < vec_len (c); i++)
+	for (j = 0; j < vec_len (c[i]); j++)
+	  sums[j] += c[i][j];
+    }
+  else
+    {
+      vlib_counter_t **c = e->data;
+
+      for (i = 0; i < vec_len (c); i++)
+	n_indices = clib_max (n_indices, vec_len (c[i]));
+
+      vec_validate (sm->delta_sums, n_indices * n_values);
+      sums = sm->delta_sums;
+      clib_memset (sums, 0, n_indices * n_values * sizeof (sums[0]));
+
+      for (i = 0; i < vec_len (c); i++)
+	for (j = 0; j < vec_len (c[i]); j++)
+	  {
+	    sums[2 * j] += c[i][j].packets;
+	    sums[2 * j + 1] += c[i][j].bytes;
+	  }
+    }
+
+  return n_indices;
+}
+
+/*
+ * Runs on the main thread, after the collectors. The counters themselves
+ * are read without the segment lock, as the collectors do.
+ */
+void
+vlib_stats_delta_update (vlib_stats_segment_t *sm)
+{
+  vlib_stats_delta_ring_t *r = sm->delta_ring;
+  vlib_stats_delta_snapshot_t *snapshot, *s;
+  vlib_stats_entry_t *e;
+  u32 i, j, n_values, n_indices;
+  u64 pos, *sums, *values;
+  void *oldheap;
+
+  if (r == 0)
+    return;
+
+  pos = r->head;
+  __atomic_store_n (&r->generation, r->generation + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+
+  /* the snapshot is read by the clients, it lives in the segment */
+  oldheap = clib_mem_set_heap (sm->heap);
+  snapshot = (vlib_stats_delta_snapshot_t *) r->snapshot;
+  vec_validate (snapshot, vec_len (sm->directory_vector) - 1);
+  r->snapshot = snapshot;
+  clib_mem_set_heap (oldheap);
+
+  vec_foreach_index (i, sm->directory_vector)
+    {
+      e = sm->directory_vector + i;
+      s = snapshot + i;
+
+      switch (e->type)
+	{
+	case STAT_DIR_TYPE_SCALAR_INDEX:
+	case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+	  n_values = 1;
+	  break;
+	case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
+	  n_values = 2;
+	  break;
+	default:
+	  /* names and symlinks are read from the directory */
+	  n_values = 0;
+	  break;
+	}
+
+      /* new, removed or reused since the last update */
+      if (s->n_values != n_values ||
+	  clib_bitmap_get (sm->delta_reset_bitmap, i))
+	{
+	  oldheap = clib_mem_set_heap (sm->heap);
+	  vec_free (s->values);
+	  clib_mem_set_heap (oldheap);
+	  s->n_indices = 0;
+	  s->n_values = n_values;
+	  vlib_stats_delta_emit (r, &pos, i, VLIB_STATS_DELTA_RESET_INDEX,
+				 n_values, 0);
+	}
+
+      if (n_values == 0)
+	continue;
+
+      n_indices = vlib_stats_delta_sum (sm, e, n_values);
+      if (n_indices > s->n_indices)
+	{
+	  oldheap = clib_mem_set_heap (sm->heap);
+	  vec_validate (s->values, n_indices * n_values - 1);
+	  clib_mem_set_heap (oldheap);
+	  s->n_indices = n_indices;
+	}
+
+      sums = sm->delta_sums;
+      values = s->values;
+      for (j = 0; j < n_indices; j++)
+	{
+	  if (n_values == 1)
+	    {
+	      if (values[j] == sums[j])
+		continue;
+	      values[j] = sums[j];
+	      vlib_stats_delta_emit (r, &pos, i, j, sums[j], 0);
+	    }
+	  else
+	    {
+	      if (values[2 * j] == sums[2 * j] &&
+		  values[2 * j + 1] == sums[2 * j + 1])
+		continue;
+	      values[2 * j] = sums[2 * j];
+	      values[2 * j + 1] = sums[2 * j + 1];
+	      vlib_stats_delta_emit (r, &pos, i, j, sums[2 * j],
+				     sums[2 * j + 1]);
+	    }
+	}
+    }
+
+  clib_bitmap_zero (sm->delta_reset_bitmap);
+
+  __atomic_store_n (&r->head, pos, __ATOMIC_RELEASE);
+  __atomic_store_n (&r->generation, r->generation + 1, __ATOMIC_RELEASE);
+}
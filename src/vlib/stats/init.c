@@ -120,6 +120,8 @@ vlib_stats_init (vlib_main_t *vm)
 
   vlib_stats_register_mem_heap (heap);
 
+  vlib_stats_delta_init (sm);
+
   reg.collect_fn = vector_rate_collector_fn;
   reg.private_data = vlib_stats_add_gauge ("/sys/vector_rate");
   reg.entry_index =
@@ -159,6 +161,11 @@ statseg_config (vlib_main_t *vm, unformat_input_t *input)
 	sm->node_counters_enabled = 0;
       else if (unformat (input, "update-interval %f", &sm->update_interval))
 	;
+      else if (unformat (input, "delta-ring-size %u", &sm->delta_ring_size))
+	{
+	  if (!is_pow2 (sm->delta_ring_size))
+	    return clib_error_return (0, "delta-ring-size must be a power of 2");
+	}
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
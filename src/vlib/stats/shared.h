@@ -35,6 +35,51 @@ typedef struct
   char name[VLIB_STATS_MAX_NAME_SZ];
 } vlib_stats_entry_t;
 
+/*
+ * Delta export. On each update the collector sums the counters of every
+ * entry over the threads into a snapshot, and writes the ones which changed
+ * since the previous update to a ring. Readers apply the records to their
+ * copy of the snapshot, and copy the whole snapshot again when they fall
+ * more than a ring behind.
+ */
+
+/* record resetting an entry, value[0] has its number of values per index */
+#define VLIB_STATS_DELTA_RESET_INDEX UINT32_MAX
+
+typedef struct
+{
+  /* position + 1 once written, checked again after reading the record */
+  volatile uint64_t seq;
+  uint32_t entry_index;
+  uint32_t vector_index;
+  /* the new value summed over the threads, packets and bytes for combined
+     counters */
+  uint64_t value[2];
+} vlib_stats_delta_record_t;
+
+typedef struct
+{
+  /* 0 if the entry isn't exported, 1 for simple counters and scalars, 2
+     for combined counters */
+  uint32_t n_values;
+  uint32_t n_indices;
+  /* n_indices * n_values values */
+  uint64_t *values;
+} vlib_stats_delta_snapshot_t;
+
+typedef struct
+{
+  /* power of 2 */
+  uint64_t n_records;
+  /* records written */
+  volatile uint64_t head;
+  /* odd while the collector updates the snapshot */
+  volatile uint64_t generation;
+  /* indexed by directory entry */
+  volatile vlib_stats_delta_snapshot_t *snapshot;
+  vlib_stats_delta_record_t *records;
+} vlib_stats_delta_ring_t;
+
 /*
  * Shared header first in the shared memory segment.
  */
@@ -45,6 +90,8 @@ typedef struct
   volatile uint64_t epoch;
   volatile uint64_t in_progress;
   volatile vlib_stats_entry_t *directory_vector;
+  /* 0 unless the delta export is enabled */
+  volatile vlib_stats_delta_ring_t *delta_ring;
 } vlib_stats_shared_header_t;
 
 #endif /* included_stat_segment_shared_h */
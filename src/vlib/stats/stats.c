@@ -184,6 +184,10 @@ vlib_stats_remove_entry (u32 entry_index)
 
   e->value = sm->dir_vector_first_free_elt;
   sm->dir_vector_first_free_elt = entry_index;
+
+  if (sm->delta_ring)
+    sm->delta_reset_bitmap =
+      clib_bitmap_set (sm->delta_reset_bitmap, entry_index, 1);
 }
 
 static void
@@ -82,6 +82,14 @@ typedef struct
     *shared_header; /* pointer to shared memory segment */
   int memfd;
 
+  /* delta export, in the shared memory segment */
+  u32 delta_ring_size;
+  vlib_stats_delta_ring_t *delta_ring;
+  /* entries to reset on the next update, removed since the last one */
+  uword *delta_reset_bitmap;
+  /* sums over the threads of the entry being exported, process heap */
+  u64 *delta_sums;
+
 } vlib_stats_segment_t;
 
 typedef struct
@@ -159,6 +167,10 @@ void vlib_stats_remove_entry (u32 entry_index);
 u32 vlib_stats_find_entry_index (char *fmt, ...);
 void vlib_stats_register_collector_fn (vlib_stats_collector_reg_t *r);
 
+/* delta export */
+void vlib_stats_delta_init (vlib_stats_segment_t *sm);
+void vlib_stats_delta_update (vlib_stats_segment_t *sm);
+
 format_function_t format_vlib_stats_symlink;
 
 #endif
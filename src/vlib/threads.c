@@ -386,15 +386,11 @@ vlib_thread_init (vlib_main_t * vm)
 }
 
 vlib_frame_queue_t *
-vlib_frame_queue_alloc (int nelts)
+vlib_frame_queue_alloc (int nelts, int with_aux)
 {
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
   vlib_frame_queue_t *fq;
-
-  fq = clib_mem_alloc_aligned (sizeof (*fq), CLIB_CACHE_LINE_BYTES);
-  clib_memset (fq, 0, sizeof (*fq));
-  fq->nelts = nelts;
-  fq->vector_threshold = 2 * VLIB_FRAME_SIZE;
-  vec_validate_aligned (fq->elts, nelts - 1, CLIB_CACHE_LINE_BYTES);
+  u32 ring_size = nelts * VLIB_FRAME_SIZE;
 
   if (nelts & (nelts - 1))
     {
@@ -402,6 +398,16 @@ vlib_frame_queue_alloc (int nelts)
       abort ();
     }
 
+  fq = clib_mem_alloc_aligned (sizeof (*fq), CLIB_CACHE_LINE_BYTES);
+  clib_memset (fq, 0, sizeof (*fq));
+  fq->nelts = nelts;
+  fq->ring_mask = ring_size - 1;
+  fq->n_producers = tm->n_vlib_mains;
+  fq->vector_threshold = 2 * VLIB_FRAME_SIZE;
+  vec_validate_aligned (fq->buffer_index, ring_size - 1, CLIB_CACHE_LINE_BYTES);
+  if (with_aux)
+    vec_validate_aligned (fq->aux_data, ring_size - 1, CLIB_CACHE_LINE_BYTES);
+
   return (fq);
 }
 
@@ -725,6 +731,9 @@ start_workers (vlib_main_t * vm)
 	      vec_validate (nm_clone->pending_frames, 10);
 	      vec_set_len (nm_clone->pending_frames, 0);
 
+	      /* adaptive mode state is learned by each thread */
+	      nm_clone->adaptive_state = 0;
+
 	      /* fork nodes */
 	      nm_clone->nodes = 0;
 
@@ -1629,6 +1638,76 @@ vlib_worker_wait_one_loop (void)
   return;
 }
 
+void
+vlib_worker_defer_one_loop (vlib_worker_deferred_fn_t *fn, uword data)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_worker_deferred_t *d;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  /*
+   * with no workers, or with the workers parked at the barrier, there
+   * is no-one that can be reading what we are about to reclaim
+   */
+  if (vlib_get_n_threads () < 2 || vlib_worker_thread_barrier_held ())
+    {
+      fn (data);
+      return;
+    }
+
+  vec_add2 (tm->deferred_next, d, 1);
+  d->fn = fn;
+  d->data = data;
+  tm->n_deferred_pending++;
+}
+
+void
+vlib_worker_deferred_poll (vlib_main_t *vm)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_worker_deferred_t *d;
+  vlib_main_t *wvm;
+  u32 ii;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  if (vec_len (tm->deferred_wait))
+    {
+      /*
+       * the grace period ends once each worker has either started
+       * a new loop, or been seen asleep (a sleeping worker is not
+       * in the middle of processing a frame)
+       */
+      for (ii = 1; ii < vec_len (vgm->vlib_mains); ii++)
+	{
+	  wvm = vgm->vlib_mains[ii];
+	  if (tm->deferred_loop_counts[ii] == wvm->main_loop_count &&
+	      !__atomic_load_n (&wvm->thread_sleeps, __ATOMIC_RELAXED))
+	    return;
+	}
+
+      vec_foreach (d, tm->deferred_wait)
+	d->fn (d->data);
+
+      tm->n_deferred_pending -= vec_len (tm->deferred_wait);
+      tm->n_deferred_runs += vec_len (tm->deferred_wait);
+      tm->n_deferred_grace_periods++;
+      vec_reset_length (tm->deferred_wait);
+    }
+
+  if (vec_len (tm->deferred_next))
+    {
+      /* start the next grace period */
+      vec_validate (tm->deferred_loop_counts, vec_len (vgm->vlib_mains) - 1);
+      vec_foreach_index (ii, vgm->vlib_mains)
+	tm->deferred_loop_counts[ii] = vgm->vlib_mains[ii]->main_loop_count;
+
+      CLIB_SWAP (tm->deferred_next, tm->deferred_wait);
+    }
+}
+
 void
 vlib_worker_flush_pending_rpc_requests (vlib_main_t *vm)
 {
@@ -1655,7 +1734,7 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
   vlib_frame_queue_t *fq;
   vlib_node_t *node;
   int i;
-  u32 num_threads;
+  u32 num_threads, fqm_index;
 
   if (frame_queue_nelts == 0)
     frame_queue_nelts = FRAME_QUEUE_MAX_NELTS;
@@ -1664,8 +1743,10 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
   ASSERT (frame_queue_nelts >= 8 + num_threads);
 
   vec_add2 (tm->frame_queue_mains, fqm, 1);
+  clib_memset (fqm, 0, sizeof (*fqm));
+  fqm_index = fqm - tm->frame_queue_mains;
 
-  node = vlib_get_node (vm, fqm->node_index);
+  node = vlib_get_node (vm, node_index);
   ASSERT (node);
   if (node->aux_offset)
     {
@@ -1685,11 +1766,23 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
   vec_set_len (fqm->vlib_frame_queues, 0);
   for (i = 0; i < tm->n_vlib_mains; i++)
     {
-      fq = vlib_frame_queue_alloc (frame_queue_nelts);
+      fq = vlib_frame_queue_alloc (frame_queue_nelts, node->aux_offset != 0);
       vec_add1 (fqm->vlib_frame_queues, fq);
     }
 
-  return (fqm - tm->frame_queue_mains);
+  fqm->occupancy.name = "frame-queue-occupancy";
+  fqm->occupancy.stat_segment_name =
+    (char *) format (0, "/sys/frame-queue/%u/occupancy%c", fqm_index, 0);
+  vlib_validate_simple_counter (&fqm->occupancy,
+				VLIB_FRAME_QUEUE_N_OCCUPANCY_BUCKETS - 1);
+
+  fqm->congestion_drops.name = "frame-queue-congestion-drops";
+  fqm->congestion_drops.stat_segment_name = (char *) format (
+    0, "/sys/frame-queue/%u/congestion-drops%c", fqm_index, 0);
+  vlib_validate_simple_counter (&fqm->congestion_drops,
+				tm->n_vlib_mains - 1);
+
+  return fqm_index;
 }
 
 void
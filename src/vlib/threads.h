@@ -52,21 +52,6 @@ typedef struct vlib_thread_registration_
 #define VLIB_LOG2_THREAD_STACK_SIZE (21)
 #define VLIB_THREAD_STACK_SIZE (1<<VLIB_LOG2_THREAD_STACK_SIZE)
 
-typedef struct
-{
-  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
-  volatile u32 valid;
-  u32 maybe_trace : 1;
-  u32 n_vectors;
-  u32 offset;
-  STRUCT_MARK (end_of_reset);
-
-  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
-  u32 buffer_index[VLIB_FRAME_SIZE];
-  u32 aux_data[VLIB_FRAME_SIZE];
-}
-vlib_frame_queue_elt_t;
-
 typedef struct
 {
   /* First cache line */
@@ -103,25 +88,44 @@ typedef struct
 
 extern vlib_worker_thread_t *vlib_worker_threads;
 
+/*
+ * The handoff queue of a thread, a ring of buffer indices. Producers
+ * reserve a batch of any size up to a frame by moving tail_reserved, fill
+ * it in, and publish it by moving tail once the batches reserved before
+ * theirs are published, which keeps the queue in reservation order.
+ * The consumer drains whatever is published into full frames.
+ */
 typedef struct
 {
   /* static data */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
-  vlib_frame_queue_elt_t *elts;
+  u32 *buffer_index;
+  u32 *aux_data;
   u64 vector_threshold;
   u64 trace;
+  /* capacity, in frames */
   u32 nelts;
+  u32 ring_mask;
+  u32 n_producers;
 
-  /* modified by enqueue side  */
+  /* reserved by the enqueue side */
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  volatile u64 tail_reserved;
+
+  /* published by the enqueue side */
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
   volatile u64 tail;
+  volatile u32 maybe_trace;
 
   /* modified by dequeue side  */
-  CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline3);
   volatile u64 head;
 }
 vlib_frame_queue_t;
 
+/* occupancy samples are taken in eighths of the queue capacity */
+#define VLIB_FRAME_QUEUE_N_OCCUPANCY_BUCKETS 8
+
 struct vlib_frame_queue_main_t_;
 typedef u32 (vlib_frame_queue_dequeue_fn_t) (
   vlib_main_t *vm, struct vlib_frame_queue_main_t_ *fqm);
@@ -136,6 +140,11 @@ typedef struct vlib_frame_queue_main_t_
   frame_queue_trace_t *frame_queue_traces;
   frame_queue_nelt_counter_t *frame_queue_histogram;
   vlib_frame_queue_dequeue_fn_t *frame_queue_dequeue_fn;
+
+  /* queue occupancy seen by the consumer, indexed by bucket */
+  vlib_simple_counter_main_t occupancy;
+  /* packets dropped by a producer, indexed by destination thread */
+  vlib_simple_counter_main_t congestion_drops;
 } vlib_frame_queue_main_t;
 
 typedef struct
@@ -181,6 +190,25 @@ void vlib_worker_thread_node_refork (void);
  * Wait until each of the workers has been once around the track
  */
 void vlib_worker_wait_one_loop (void);
+/**
+ * Function to run once the workers have been once around the track
+ */
+typedef void (vlib_worker_deferred_fn_t) (uword data);
+/**
+ * Run fn(data) on the main thread once each of the workers has been
+ * once around the track. This is the non-blocking equivalent of
+ * vlib_worker_wait_one_loop() followed by fn(data); it is used to
+ * reclaim objects that the workers may still be reading, after they
+ * have been unlinked from the forwarding structures.
+ * The work is batched; one grace period covers all the work deferred
+ * since the previous one began.
+ */
+void vlib_worker_defer_one_loop (vlib_worker_deferred_fn_t *fn, uword data);
+/**
+ * Run deferred work whose grace period has ended; called from the
+ * main thread's main loop
+ */
+void vlib_worker_deferred_poll (vlib_main_t *vm);
 /**
  * Flush worker's pending rpc requests to main thread's rpc queue
  */
@@ -246,6 +274,12 @@ typedef enum
     SCHED_POLICY_N,
 } sched_policy_t;
 
+typedef struct
+{
+  vlib_worker_deferred_fn_t *fn;
+  uword data;
+} vlib_worker_deferred_t;
+
 typedef struct
 {
   /* Link list of registrations, built by constructors */
@@ -305,6 +339,22 @@ typedef struct
   /* NUMA-bound heap size */
   uword numa_heap_size;
 
+  /* Deferred work queued, grace period not yet started */
+  vlib_worker_deferred_t *deferred_next;
+
+  /* Deferred work waiting for its grace period to end */
+  vlib_worker_deferred_t *deferred_wait;
+
+  /* Worker loop counts at the start of the grace period */
+  u32 *deferred_loop_counts;
+
+  /* Number of items in deferred_next + deferred_wait */
+  u32 n_deferred_pending;
+
+  /* Number of grace periods completed / items run */
+  u64 n_deferred_grace_periods;
+  u64 n_deferred_runs;
+
 } vlib_thread_main_t;
 
 extern vlib_thread_main_t vlib_thread_main;
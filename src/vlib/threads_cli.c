@@ -93,6 +93,13 @@ show_threads_fn (vlib_main_t * vm,
     }
 #endif
 
+  if (vlib_get_n_threads () > 1)
+    vlib_cli_output (vm,
+		     "deferred reclaims: pending %u, run %llu in %llu "
+		     "grace periods",
+		     tm->n_deferred_pending, tm->n_deferred_runs,
+		     tm->n_deferred_grace_periods);
+
   return 0;
 }
 
@@ -439,6 +446,18 @@ test_frame_queue_nelts (vlib_main_t * vm, unformat_input_t * input,
       goto done;
     }
 
+  /* the rings are allocated once, only the usable part can change */
+  for (fqix = 0; fqix < num_fq; fqix++)
+    {
+      vlib_frame_queue_t *fq = fqm->vlib_frame_queues[fqix];
+      if ((u64) nelts * VLIB_FRAME_SIZE > fq->ring_mask + 1)
+	{
+	  error = clib_error_return (0, "ring size is %u frames",
+				     (fq->ring_mask + 1) / VLIB_FRAME_SIZE);
+	  goto done;
+	}
+    }
+
   for (fqix = 0; fqix < num_fq; fqix++)
     {
       fqm->vlib_frame_queues[fqix]->nelts = nelts;
@@ -422,6 +422,8 @@ unix_config (vlib_main_t * vm, unformat_input_t * input)
 	um->cli_no_pager = 1;
       else if (unformat (input, "poll-sleep-usec %d", &um->poll_sleep_usec))
 	;
+      else if (unformat (input, "poll-io-uring"))
+	um->poll_io_uring = 1;
       else if (unformat (input, "cli-pager-buffer-limit %d",
 			 &um->cli_pager_buffer_limit))
 	;
@@ -652,6 +654,10 @@ unix_config (vlib_main_t * vm, unformat_input_t * input)
  *
  * @cfgcmd{poll-sleep-usec, &lt;nn&gt;}
  * Set a fixed poll sleep interval between main loop polls.
+ *
+ * @cfgcmd{poll-io-uring}
+ * Wait for file events through a per-thread io_uring, which also batches
+ * the tx kicks of the tap and af_packet interfaces.
 ?*/
 VLIB_EARLY_CONFIG_FUNCTION (unix_config, "unix");
 
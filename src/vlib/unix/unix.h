@@ -109,6 +109,9 @@ typedef struct
 
   u32 poll_sleep_usec;
 
+  /* Poll files and submit tx kicks through io_uring */
+  int poll_io_uring;
+
 } unix_main_t;
 
 /** CLI session events. */
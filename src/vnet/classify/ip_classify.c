@@ -61,8 +61,15 @@ ip_classify_inline (vlib_main_t * vm,
 		    vlib_node_runtime_t * node,
 		    vlib_frame_t * frame, int is_ip4)
 {
-  u32 n_left_from, *from, *to_next;
-  ip_lookup_next_t next_index;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  vnet_classify_per_thread_data_t *ptd =
+    vec_elt_at_index (vnet_classify_main.per_thread_data, vm->thread_index);
+  vnet_classify_entry_t **entries = ptd->entries;
+  u32 *table_indices = ptd->table_indices;
+  u32 *hit_table_indices = ptd->hit_table_indices;
+  const u8 **headers = ptd->headers;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left_from, *from, i;
   vnet_classify_main_t *vcm = &vnet_classify_main;
   f64 now = vlib_time_now (vm);
   u32 hits = 0;
@@ -81,217 +88,73 @@ ip_classify_inline (vlib_main_t * vm,
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left_from);
 
-  /* First pass: compute hashes */
-
-  while (n_left_from > 2)
-    {
-      vlib_buffer_t *b0, *b1;
-      u32 bi0, bi1;
-      u8 *h0, *h1;
-      u32 cd_index0, cd_index1;
-      classify_dpo_t *cd0, *cd1;
-      u32 table_index0, table_index1;
-      vnet_classify_table_t *t0, *t1;
-
-      /* prefetch next iteration */
-      {
-	vlib_buffer_t *p1, *p2;
-
-	p1 = vlib_get_buffer (vm, from[1]);
-	p2 = vlib_get_buffer (vm, from[2]);
-
-	vlib_prefetch_buffer_header (p1, STORE);
-	clib_prefetch_store (p1->data);
-	vlib_prefetch_buffer_header (p2, STORE);
-	clib_prefetch_store (p2->data);
-      }
-
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = vlib_buffer_get_current (b0) - ethernet_buffer_header_size (b0);
-
-      bi1 = from[1];
-      b1 = vlib_get_buffer (vm, bi1);
-      h1 = vlib_buffer_get_current (b1) - ethernet_buffer_header_size (b1);
-
-      cd_index0 = vnet_buffer (b0)->ip.adj_index[VLIB_TX];
-      cd0 = classify_dpo_get (cd_index0);
-      table_index0 = cd0->cd_table_index;
-
-      cd_index1 = vnet_buffer (b1)->ip.adj_index[VLIB_TX];
-      cd1 = classify_dpo_get (cd_index1);
-      table_index1 = cd1->cd_table_index;
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-
-      t1 = pool_elt_at_index (vcm->tables, table_index1);
-
-      vnet_buffer (b0)->l2_classify.hash = vnet_classify_hash_packet (t0, h0);
-
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      vnet_buffer (b1)->l2_classify.hash = vnet_classify_hash_packet (t1, h1);
-
-      vnet_classify_prefetch_bucket (t1, vnet_buffer (b1)->l2_classify.hash);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-
-      vnet_buffer (b1)->l2_classify.table_index = table_index1;
-
-      from += 2;
-      n_left_from -= 2;
-    }
-
-  while (n_left_from > 0)
+  /* First pass: gather the headers and the table each packet starts at */
+  for (i = 0; i < n_left_from; i++)
     {
-      vlib_buffer_t *b0;
-      u32 bi0;
-      u8 *h0;
-      u32 cd_index0;
       classify_dpo_t *cd0;
-      u32 table_index0;
-      vnet_classify_table_t *t0;
-
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = vlib_buffer_get_current (b0) - ethernet_buffer_header_size (b0);
-
-      cd_index0 = vnet_buffer (b0)->ip.adj_index[VLIB_TX];
-      cd0 = classify_dpo_get (cd_index0);
-      table_index0 = cd0->cd_table_index;
 
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-      vnet_buffer (b0)->l2_classify.hash = vnet_classify_hash_packet (t0, h0);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
+      if (PREDICT_TRUE (i + 2 < n_left_from))
+	{
+	  vlib_prefetch_buffer_header (bufs[i + 2], STORE);
+	  clib_prefetch_store (bufs[i + 2]->data);
+	}
 
-      from++;
-      n_left_from--;
+      headers[i] = vlib_buffer_get_current (bufs[i]) -
+		   ethernet_buffer_header_size (bufs[i]);
+      cd0 = classify_dpo_get (vnet_buffer (bufs[i])->ip.adj_index[VLIB_TX]);
+      table_indices[i] = cd0->cd_table_index;
     }
 
-  next_index = node->cached_next_index;
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
+  /* Second pass: look the whole frame up, walking the table chains */
+  hits = vnet_classify_find_entries_inline (table_indices, headers,
+					    n_left_from, now,
+					    1 /* walk_chain */, entries,
+					    hit_table_indices);
 
-  while (n_left_from > 0)
+  /* Third pass: act on the result */
+  b = bufs;
+  next = nexts;
+  for (i = 0; i < n_left_from; i++, b++, next++)
     {
-      u32 n_left_to_next;
-
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      /* Not enough load/store slots to dual loop... */
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0 = IP_LOOKUP_NEXT_DROP;
-	  u32 table_index0;
-	  vnet_classify_table_t *t0;
-	  vnet_classify_entry_t *e0;
-	  u32 hash0;
-	  u8 *h0;
-
-	  /* Stride 3 seems to work best */
-	  if (PREDICT_TRUE (n_left_from > 3))
-	    {
-	      vlib_buffer_t *p1 = vlib_get_buffer (vm, from[3]);
-	      vnet_classify_table_t *tp1;
-	      u32 table_index1;
-	      u32 phash1;
-
-	      table_index1 = vnet_buffer (p1)->l2_classify.table_index;
-
-	      if (PREDICT_TRUE (table_index1 != ~0))
-		{
-		  tp1 = pool_elt_at_index (vcm->tables, table_index1);
-		  phash1 = vnet_buffer (p1)->l2_classify.hash;
-		  vnet_classify_prefetch_entry (tp1, phash1);
-		}
-	    }
+      vnet_classify_entry_t *e0 = entries[i];
+      vnet_classify_table_t *t0 = 0;
 
-	  /* speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+      next[0] = IP_LOOKUP_NEXT_DROP;
+      vnet_buffer (b[0])->l2_classify.opaque_index = ~0;
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  h0 = b0->data;
-	  table_index0 = vnet_buffer (b0)->l2_classify.table_index;
-	  e0 = 0;
-	  t0 = 0;
-	  vnet_buffer (b0)->l2_classify.opaque_index = ~0;
+      if (PREDICT_TRUE (hit_table_indices[i] != ~0))
+	t0 = pool_elt_at_index (vcm->tables, hit_table_indices[i]);
 
-	  if (PREDICT_TRUE (table_index0 != ~0))
-	    {
-	      hash0 = vnet_buffer (b0)->l2_classify.hash;
-	      t0 = pool_elt_at_index (vcm->tables, table_index0);
-
-	      e0 = vnet_classify_find_entry (t0, h0, hash0, now);
-	      if (e0)
-		{
-		  vnet_buffer (b0)->l2_classify.opaque_index
-		    = e0->opaque_index;
-		  vlib_buffer_advance (b0, e0->advance);
-		  next0 = (e0->next_index < node->n_next_nodes) ?
-		    e0->next_index : next0;
-		  hits++;
-		}
-	      else
-		{
-		  while (1)
-		    {
-		      if (t0->next_table_index != ~0)
-			t0 = pool_elt_at_index (vcm->tables,
-						t0->next_table_index);
-		      else
-			{
-			  next0 = (t0->miss_next_index < n_next) ?
-			    t0->miss_next_index : next0;
-			  misses++;
-			  break;
-			}
-
-		      hash0 = vnet_classify_hash_packet (t0, h0);
-		      e0 = vnet_classify_find_entry (t0, h0, hash0, now);
-		      if (e0)
-			{
-			  vnet_buffer (b0)->l2_classify.opaque_index
-			    = e0->opaque_index;
-			  vlib_buffer_advance (b0, e0->advance);
-			  next0 = (e0->next_index < node->n_next_nodes) ?
-			    e0->next_index : next0;
-			  hits++;
-			  chain_hits++;
-			  break;
-			}
-		    }
-		}
-	    }
-
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-			     && (b0->flags & VLIB_BUFFER_IS_TRACED)))
-	    {
-	      ip_classify_trace_t *t =
-		vlib_add_trace (vm, node, b0, sizeof (*t));
-	      t->next_index = next0;
-	      t->table_index = t0 ? t0 - vcm->tables : ~0;
-	      t->entry_index = e0 ? e0->opaque_index : ~0;
-	    }
-
-	  /* verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, next0);
+      if (e0)
+	{
+	  vnet_buffer (b[0])->l2_classify.opaque_index = e0->opaque_index;
+	  vlib_buffer_advance (b[0], e0->advance);
+	  next[0] = (e0->next_index < node->n_next_nodes) ?
+		      e0->next_index : next[0];
+	  chain_hits += (hit_table_indices[i] != table_indices[i]);
+	}
+      else if (t0)
+	{
+	  next[0] =
+	    (t0->miss_next_index < n_next) ? t0->miss_next_index : next[0];
+	  misses++;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
+			 && (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  ip_classify_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->next_index = next[0];
+	  t->table_index = hit_table_indices[i];
+	  t->entry_index = e0 ? e0->opaque_index : ~0;
+	}
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
   vlib_node_increment_counter (vm, node->node_index,
 			       IP_CLASSIFY_ERROR_MISS, misses);
   vlib_node_increment_counter (vm, node->node_index,
@@ -3045,6 +3045,10 @@ vnet_classify_init (vlib_main_t * vm)
   cm->vlib_main = vm;
   cm->vnet_main = vnet_get_main ();
 
+  vec_validate_aligned (cm->per_thread_data,
+			vlib_get_thread_main ()->n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
+
   vnet_classify_register_unformat_opaque_index_fn
     (unformat_opaque_sw_if_index);
 
@@ -219,11 +219,31 @@ STATIC_ASSERT_OFFSET_OF (vnet_classify_table_t, cacheline1,
 #define VNET_CLASSIFY_VECTOR_SIZE                                             \
   sizeof (((vnet_classify_table_t *) 0)->mask[0])
 
+/* Per-thread scratch of the frame-at-a-time lookups */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* vnet_classify_find_entries_inline () internals */
+  vnet_classify_table_t *tables[VLIB_FRAME_SIZE];
+  u32 hashes[VLIB_FRAME_SIZE];
+  u16 todo[VLIB_FRAME_SIZE];
+
+  /* its arguments and results, for the classify nodes */
+  const u8 *headers[VLIB_FRAME_SIZE];
+  vnet_classify_entry_t *entries[VLIB_FRAME_SIZE];
+  u32 table_indices[VLIB_FRAME_SIZE];
+  u32 hit_table_indices[VLIB_FRAME_SIZE];
+} vnet_classify_per_thread_data_t;
+
 struct _vnet_classify_main
 {
   /* Table pool */
   vnet_classify_table_t *tables;
 
+  /* Per-thread lookup scratch */
+  vnet_classify_per_thread_data_t *per_thread_data;
+
   /* Registered next-index, opaque unformat fcns */
   unformat_function_t **unformat_l2_next_index_fns;
   unformat_function_t **unformat_ip_next_index_fns;
@@ -581,6 +601,86 @@ vnet_classify_find_entry_inline (const vnet_classify_table_t *t, const u8 *h,
   return 0;
 }
 
+/**
+ * @brief Look up a batch of packets in classify tables.
+ *
+ * Packet i, with header h[i], is looked up in table table_indices[i]
+ * (~0 means do not classify). The lookup is done in stages across the
+ * whole batch, hash and prefetch the buckets, prefetch the entries,
+ * then compare, so that the memory accesses for one packet overlap with
+ * the work on the others. If walk_chain is set, a packet that misses is
+ * looked up in the table's next_table_index, again in a batch with the
+ * other packets that missed.
+ *
+ * On return entries[i] is the matching entry or NULL, and
+ * hit_table_indices[i] the table that matched or, on a miss, the last
+ * table tried.
+ *
+ * @return the number of hits
+ */
+static_always_inline u32
+vnet_classify_find_entries_inline (const u32 *table_indices, const u8 **h,
+				   u32 n_packets, f64 now, int walk_chain,
+				   vnet_classify_entry_t **entries,
+				   u32 *hit_table_indices)
+{
+  vnet_classify_main_t *vcm = &vnet_classify_main;
+  vnet_classify_per_thread_data_t *ptd =
+    vec_elt_at_index (vcm->per_thread_data, vlib_get_thread_index ());
+  vnet_classify_table_t **tables = ptd->tables, *t;
+  u32 *hashes = ptd->hashes;
+  u16 *todo = ptd->todo;
+  u32 i, j, n_todo = 0, n_next, n_hits = 0;
+
+  ASSERT (n_packets <= VLIB_FRAME_SIZE);
+
+  for (i = 0; i < n_packets; i++)
+    {
+      entries[i] = 0;
+      hit_table_indices[i] = table_indices[i];
+      if (PREDICT_TRUE (table_indices[i] != ~0))
+	todo[n_todo++] = i;
+    }
+
+  while (n_todo)
+    {
+      /* mask and hash each key, prefetch its bucket */
+      for (j = 0; j < n_todo; j++)
+	{
+	  i = todo[j];
+	  t = tables[i] = pool_elt_at_index (vcm->tables, hit_table_indices[i]);
+	  hashes[i] = vnet_classify_hash_packet_inline (t, h[i]);
+	  vnet_classify_prefetch_bucket (t, hashes[i]);
+	}
+
+      /* the buckets are now (hopefully) cached, prefetch the entries */
+      for (j = 0; j < n_todo; j++)
+	{
+	  i = todo[j];
+	  vnet_classify_prefetch_entry (tables[i], hashes[i]);
+	}
+
+      /* match; those that miss move on to the next table in the chain */
+      for (j = n_next = 0; j < n_todo; j++)
+	{
+	  i = todo[j];
+	  t = tables[i];
+	  entries[i] = vnet_classify_find_entry_inline (t, h[i], hashes[i], now);
+
+	  if (entries[i])
+	    n_hits++;
+	  else if (walk_chain && t->next_table_index != ~0)
+	    {
+	      hit_table_indices[i] = t->next_table_index;
+	      todo[n_next++] = i;
+	    }
+	}
+      n_todo = n_next;
+    }
+
+  return n_hits;
+}
+
 vnet_classify_table_t *vnet_classify_new_table (vnet_classify_main_t *cm,
 						const u8 *mask, u32 nbuckets,
 						u32 memory_size,
@@ -209,6 +209,24 @@ show_crypto_async_status_command_fn (vlib_main_t * vm,
       if (state == VLIB_NODE_STATE_DISABLED)
 	vlib_cli_output (vm, "threadId: %-6d DISABLED", i);
     }
+
+  if (cm->async_batch_depth == 0)
+    vlib_cli_output (vm, "batching: disabled");
+  else
+    {
+      vnet_crypto_thread_t *ct;
+
+      vlib_cli_output (vm, "batching: depth %u deadline %.0fus",
+		       cm->async_batch_depth, cm->async_batch_deadline * 1e6);
+      vec_foreach (ct, cm->threads)
+	if (ct->n_flushed_by_deadline || ct->n_flushed_on_idle)
+	  vlib_cli_output (vm,
+			   "threadId: %-6d in-flight %u held %u flushed: "
+			   "deadline %lu idle %lu",
+			   ct - cm->threads, ct->n_inflight,
+			   vec_len (ct->held_ops), ct->n_flushed_by_deadline,
+			   ct->n_flushed_on_idle);
+    }
   return 0;
 }
 
@@ -257,3 +275,60 @@ VLIB_CLI_COMMAND (set_crypto_async_dispatch_mode_command, static) = {
   .short_help = "set crypto async dispatch mode <polling|interrupt|adaptive>",
   .function = set_crypto_async_dispatch_command_fn,
 };
+
+static clib_error_t *
+set_crypto_async_batching_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				      vlib_cli_command_t *cmd)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *error = 0;
+  u32 depth = cm->async_batch_depth;
+  f64 deadline = cm->async_batch_deadline * 1e6;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "depth %u", &depth))
+	;
+      else if (unformat (line_input, "deadline %f", &deadline))
+	;
+      else if (unformat (line_input, "disable"))
+	depth = 0;
+      else
+	{
+	  error = clib_error_return (0, "unknown input '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (deadline <= 0)
+    {
+      error = clib_error_return (0, "deadline must be positive");
+      goto done;
+    }
+
+  vnet_crypto_set_async_batching (depth, deadline * 1e-6);
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Hold partially filled async frames open for the packets of the next node
+ * calls while at least <depth> frames of the thread are in flight, so
+ * that busy engines get fuller frames. A held frame is submitted as soon
+ * as the engines catch up, or after <deadline> microseconds at the latest.
+ *
+ * @cliexpar
+ * @cliexcmd{set crypto async batching depth 4 deadline 50}
+?*/
+VLIB_CLI_COMMAND (set_crypto_async_batching_command, static) = {
+  .path = "set crypto async batching",
+  .short_help =
+    "set crypto async batching [depth <n>] [deadline <usec>] [disable]",
+  .function = set_crypto_async_batching_command_fn,
+};
@@ -545,6 +545,46 @@ vnet_crypto_register_post_node (vlib_main_t * vm, char *post_node_name)
   return nn->next_idx;
 }
 
+/**
+ * Submit the frames the threads hold open for batching. A held frame waits
+ * for crypto-dispatch of its thread, which may not run again once its mode
+ * or the batching settings change, so they are submitted right away. A
+ * frame the engine refuses stays held, for crypto-dispatch to drop.
+ */
+static void
+vnet_crypto_async_submit_held_frames (void)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_async_frame_t *f;
+  vnet_crypto_thread_t *ct;
+  vlib_main_t *ovm;
+  u32 i;
+  u8 op;
+
+  foreach_vlib_main ()
+    {
+      ovm = this_vlib_main;
+      ct = cm->threads + ovm->thread_index;
+      i = 0;
+      while (i < vec_len (ct->held_ops))
+	{
+	  op = ct->held_ops[i];
+	  f = ct->held_frames[op];
+
+	  if (vnet_crypto_async_submit_open_frame (ovm, f) < 0)
+	    {
+	      f->state = VNET_CRYPTO_FRAME_STATE_NOT_PROCESSED;
+	      vlib_node_set_interrupt_pending (ovm, cm->crypto_node_index);
+	      i++;
+	      continue;
+	    }
+
+	  ct->held_frames[op] = 0;
+	  vec_delete (ct->held_ops, 1, i);
+	}
+    }
+}
+
 void
 vnet_crypto_set_async_dispatch (u8 mode, u8 adaptive)
 {
@@ -560,6 +600,21 @@ vnet_crypto_set_async_dispatch (u8 mode, u8 adaptive)
       vlib_node_set_flag (ovm, node_index, VLIB_NODE_FLAG_ADAPTIVE_MODE,
 			  adaptive);
     }
+
+  /* a frame held in polling mode raised no interrupt to be flushed by */
+  vnet_crypto_async_submit_held_frames ();
+}
+
+void
+vnet_crypto_set_async_batching (u32 depth, f64 deadline)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+
+  cm->async_batch_depth = depth;
+  cm->async_batch_deadline = deadline;
+
+  if (depth == 0)
+    vnet_crypto_async_submit_held_frames ();
 }
 
 static void
@@ -715,7 +770,11 @@ vnet_crypto_init (vlib_main_t * vm)
   cm->alg_index_by_name = hash_create_string (0, sizeof (uword));
   vec_validate_aligned (cm->threads, tm->n_vlib_mains, CLIB_CACHE_LINE_BYTES);
   vec_foreach (ct, cm->threads)
-    pool_init_fixed (ct->frame_pool, VNET_CRYPTO_FRAME_POOL_SIZE);
+    {
+      pool_init_fixed (ct->frame_pool, VNET_CRYPTO_FRAME_POOL_SIZE);
+      vec_validate (ct->held_frames, VNET_CRYPTO_N_OP_IDS - 1);
+    }
+  cm->async_batch_deadline = VNET_CRYPTO_ASYNC_BATCH_DEADLINE;
 
   FOREACH_ARRAY_ELT (e, cm->algs)
     if (e->name)
@@ -20,6 +20,7 @@
 
 #define VNET_CRYPTO_FRAME_SIZE 64
 #define VNET_CRYPTO_FRAME_POOL_SIZE 1024
+#define VNET_CRYPTO_ASYNC_BATCH_DEADLINE 50e-6
 
 /* CRYPTO_ID, PRETTY_NAME, ARGS*/
 #define foreach_crypto_cipher_alg                                             \
@@ -327,6 +328,8 @@ typedef struct
   u32 buffer_indices[VNET_CRYPTO_FRAME_SIZE];
   u16 next_node_index[VNET_CRYPTO_FRAME_SIZE];
   clib_thread_index_t enqueue_thread_index;
+  /* when the frame started being held open for more elements */
+  f64 hold_time;
 } vnet_crypto_async_frame_t;
 
 typedef struct
@@ -335,6 +338,14 @@ typedef struct
   vnet_crypto_async_frame_t *frame_pool;
   u32 *buffer_indices;
   u16 *nexts;
+  /* partially filled frames held open across node calls, by op */
+  vnet_crypto_async_frame_t **held_frames;
+  /* ops with a held frame, oldest first */
+  u8 *held_ops;
+  /* frames submitted to the engines and not yet dequeued */
+  u32 n_inflight;
+  u64 n_flushed_by_deadline;
+  u64 n_flushed_on_idle;
 } vnet_crypto_thread_t;
 
 typedef u32 vnet_crypto_key_index_t;
@@ -442,6 +453,10 @@ typedef struct
   vnet_crypto_alg_data_t algs[VNET_CRYPTO_N_ALGS];
   vnet_crypto_op_data_t opt_data[VNET_CRYPTO_N_OP_IDS];
   u8 default_disabled;
+  /* frames in flight from which partial frames are held, 0 disables */
+  u32 async_batch_depth;
+  /* longest time a partial frame is held */
+  f64 async_batch_deadline;
 } vnet_crypto_main_t;
 
 extern vnet_crypto_main_t crypto_main;
@@ -453,6 +468,7 @@ u32 vnet_crypto_process_ops (vlib_main_t * vm, vnet_crypto_op_t ops[],
 			     u32 n_ops);
 
 void vnet_crypto_set_async_dispatch (u8 mode, u8 adaptive);
+void vnet_crypto_set_async_batching (u32 depth, f64 deadline);
 
 typedef struct
 {
@@ -573,6 +589,7 @@ vnet_crypto_async_submit_open_frame (vlib_main_t * vm,
 
   if (PREDICT_TRUE (ret == 0))
     {
+      cm->threads[vm->thread_index].n_inflight++;
       n = vlib_get_node (vm, cm->crypto_node_index);
       if (n->state == VLIB_NODE_STATE_INTERRUPT)
 	{
@@ -639,6 +656,67 @@ vnet_crypto_async_frame_is_full (const vnet_crypto_async_frame_t *f)
   return (f->n_elts == VNET_CRYPTO_FRAME_SIZE);
 }
 
+/**
+ * Get the frame to add elements of an op to: the frame held open for the
+ * op if there is one, a new frame otherwise.
+ */
+static_always_inline vnet_crypto_async_frame_t *
+vnet_crypto_async_get_open_frame (vlib_main_t *vm, vnet_crypto_op_id_t opt)
+{
+  vnet_crypto_thread_t *ct = crypto_main.threads + vm->thread_index;
+  vnet_crypto_async_frame_t *f = ct->held_frames[opt];
+
+  if (f)
+    {
+      ASSERT (f->state == VNET_CRYPTO_FRAME_STATE_NOT_PROCESSED);
+      ct->held_frames[opt] = 0;
+      vec_del1 (ct->held_ops, vec_search (ct->held_ops, opt));
+      return f;
+    }
+
+  return vnet_crypto_async_get_frame (vm, opt);
+}
+
+/**
+ * Submit a frame, unless it is partially filled and the engines are busy
+ * with enough frames of this thread. Then it is held open for the elements
+ * of the next node calls, which the engines won't get to earlier anyway,
+ * and crypto-dispatch submits it once the engines catch up or the batch
+ * deadline expires.
+ *
+ * The frames of an op are submitted in the order they are opened, so the
+ * elements of a SA complete in order with engines completing the frames
+ * of a thread in order.
+ */
+static_always_inline int
+vnet_crypto_async_submit_or_hold_frame (vlib_main_t *vm,
+					vnet_crypto_async_frame_t *frame)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_thread_t *ct = cm->threads + vm->thread_index;
+  vnet_crypto_op_id_t op = frame->op;
+  vlib_node_state_t state;
+
+  if (PREDICT_TRUE (ct->n_inflight < cm->async_batch_depth ||
+		    cm->async_batch_depth == 0) ||
+      vnet_crypto_async_frame_is_full (frame) || ct->held_frames[op])
+    return vnet_crypto_async_submit_open_frame (vm, frame);
+
+  /* no crypto-dispatch on this thread to flush the frame later */
+  state = vlib_node_get_state (vm, cm->crypto_node_index);
+  if (PREDICT_FALSE (state == VLIB_NODE_STATE_DISABLED))
+    return vnet_crypto_async_submit_open_frame (vm, frame);
+
+  frame->hold_time = vlib_time_now (vm);
+  ct->held_frames[op] = frame;
+  vec_add1 (ct->held_ops, op);
+
+  if (state == VLIB_NODE_STATE_INTERRUPT)
+    vlib_node_set_interrupt_pending (vm, cm->crypto_node_index);
+
+  return 0;
+}
+
 #endif /* included_vnet_crypto_crypto_h */
 
 /*
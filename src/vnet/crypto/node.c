@@ -70,6 +70,107 @@ vnet_crypto_async_add_trace (vlib_main_t *vm, vlib_node_runtime_t *node,
   tr->op = op_id;
 }
 
+static_always_inline u32
+crypto_dispatch_frame (vlib_main_t *vm, vlib_node_runtime_t *node,
+		       vnet_crypto_thread_t *ct, vnet_crypto_async_frame_t *cf,
+		       u32 n_cache)
+{
+  vec_validate (ct->buffer_indices, n_cache + cf->n_elts);
+  vec_validate (ct->nexts, n_cache + cf->n_elts);
+  clib_memcpy_fast (ct->buffer_indices + n_cache, cf->buffer_indices,
+		    sizeof (u32) * cf->n_elts);
+  if (cf->state == VNET_CRYPTO_FRAME_STATE_SUCCESS)
+    {
+      clib_memcpy_fast (ct->nexts + n_cache, cf->next_node_index,
+			sizeof (u16) * cf->n_elts);
+    }
+  else
+    {
+      u32 i;
+      for (i = 0; i < cf->n_elts; i++)
+	{
+	  if (cf->elts[i].status != VNET_CRYPTO_OP_STATUS_COMPLETED)
+	    {
+	      ct->nexts[i + n_cache] = CRYPTO_DISPATCH_NEXT_ERR_DROP;
+	      vlib_node_increment_counter (vm, node->node_index,
+					   cf->elts[i].status, 1);
+	    }
+	  else
+	    ct->nexts[i + n_cache] = cf->next_node_index[i];
+	}
+    }
+  n_cache += cf->n_elts;
+  if (n_cache >= VLIB_FRAME_SIZE)
+    {
+      vlib_buffer_enqueue_to_next_vec (vm, node, &ct->buffer_indices,
+				       &ct->nexts, n_cache);
+      n_cache = 0;
+    }
+
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+    {
+      u32 i;
+
+      for (i = 0; i < cf->n_elts; i++)
+	{
+	  vlib_buffer_t *b = vlib_get_buffer (vm, cf->buffer_indices[i]);
+	  if (b->flags & VLIB_BUFFER_IS_TRACED)
+	    vnet_crypto_async_add_trace (vm, node, b, cf->op,
+					 cf->elts[i].status);
+	}
+    }
+  vnet_crypto_async_free_frame (vm, cf);
+
+  return n_cache;
+}
+
+/**
+ * Submit the frames held open for batching once the engines have caught
+ * up with the frames in flight or the batch deadline expired. Frames the
+ * engine refuses are dropped.
+ */
+static_always_inline u32
+crypto_flush_held_frames (vlib_main_t *vm, vlib_node_runtime_t *node,
+			  vnet_crypto_thread_t *ct, u32 n_cache)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_async_frame_t *f;
+  f64 now = vlib_time_now (vm);
+  u32 i = 0, j;
+  u8 op;
+
+  while (i < vec_len (ct->held_ops))
+    {
+      op = ct->held_ops[i];
+      f = ct->held_frames[op];
+
+      if (ct->n_inflight >= cm->async_batch_depth &&
+	  cm->async_batch_depth != 0)
+	{
+	  if (now - f->hold_time < cm->async_batch_deadline)
+	    {
+	      i++;
+	      continue;
+	    }
+	  ct->n_flushed_by_deadline++;
+	}
+      else
+	ct->n_flushed_on_idle++;
+
+      ct->held_frames[op] = 0;
+      vec_delete (ct->held_ops, 1, i);
+
+      if (vnet_crypto_async_submit_open_frame (vm, f) < 0)
+	{
+	  for (j = 0; j < f->n_elts; j++)
+	    f->elts[j].status = VNET_CRYPTO_OP_STATUS_FAIL_ENGINE_ERR;
+	  n_cache = crypto_dispatch_frame (vm, node, ct, f, n_cache);
+	}
+    }
+
+  return n_cache;
+}
+
 static_always_inline u32
 crypto_dequeue_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
 		      vnet_crypto_thread_t * ct,
@@ -86,52 +187,10 @@ crypto_dequeue_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
     {
       if (cf)
 	{
-	  vec_validate (ct->buffer_indices, n_cache + cf->n_elts);
-	  vec_validate (ct->nexts, n_cache + cf->n_elts);
-	  clib_memcpy_fast (ct->buffer_indices + n_cache, cf->buffer_indices,
-			    sizeof (u32) * cf->n_elts);
-	  if (cf->state == VNET_CRYPTO_FRAME_STATE_SUCCESS)
-	    {
-	      clib_memcpy_fast (ct->nexts + n_cache, cf->next_node_index,
-				sizeof (u16) * cf->n_elts);
-	    }
-	  else
-	    {
-	      u32 i;
-	      for (i = 0; i < cf->n_elts; i++)
-		{
-		  if (cf->elts[i].status != VNET_CRYPTO_OP_STATUS_COMPLETED)
-		    {
-		      ct->nexts[i + n_cache] = CRYPTO_DISPATCH_NEXT_ERR_DROP;
-		      vlib_node_increment_counter (vm, node->node_index,
-						   cf->elts[i].status, 1);
-		    }
-		  else
-		    ct->nexts[i + n_cache] = cf->next_node_index[i];
-		}
-	    }
-	  n_cache += cf->n_elts;
-	  if (n_cache >= VLIB_FRAME_SIZE)
-	    {
-	      vlib_buffer_enqueue_to_next_vec (vm, node, &ct->buffer_indices,
-					       &ct->nexts, n_cache);
-	      n_cache = 0;
-	    }
-
-	  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
-	    {
-	      u32 i;
-
-	      for (i = 0; i < cf->n_elts; i++)
-		{
-		  vlib_buffer_t *b = vlib_get_buffer (vm,
-						      cf->buffer_indices[i]);
-		  if (b->flags & VLIB_BUFFER_IS_TRACED)
-		    vnet_crypto_async_add_trace (vm, node, b, cf->op,
-						 cf->elts[i].status);
-		}
-	    }
-	  vnet_crypto_async_free_frame (vm, cf);
+	  /* frames are dequeued by the thread which enqueued them */
+	  if (PREDICT_TRUE (ct->n_inflight))
+	    ct->n_inflight--;
+	  n_cache = crypto_dispatch_frame (vm, node, ct, cf, n_cache);
 	}
       /* signal enqueue-thread to dequeue the processed frame (n_elts>0) */
       if (n_elts > 0 &&
@@ -166,6 +225,8 @@ VLIB_NODE_FN (crypto_dispatch_node) (vlib_main_t * vm,
       n_cache = crypto_dequeue_frame (
 	vm, node, ct, cm->dequeue_handlers[index], n_cache, &n_dispatched);
     }
+  if (vec_len (ct->held_ops))
+    n_cache = crypto_flush_held_frames (vm, node, ct, n_cache);
   if (n_cache)
     vlib_buffer_enqueue_to_next_vec (vm, node, &ct->buffer_indices, &ct->nexts,
 				     n_cache);
@@ -173,6 +173,7 @@ typedef struct vnet_dev_port_cfg_change_req
   vnet_dev_port_cfg_type_t type;
   u8 validated : 1;
   u8 all_queues : 1;
+  u8 adaptive_mode : 1;
 
   union
   {
@@ -291,6 +292,7 @@ typedef struct vnet_dev_rx_queue
   u16 index;
   u16 size;
   u8 interrupt_mode : 1;
+  u8 adaptive_mode : 1;
   u8 enabled : 1;
   u8 started : 1;
   u8 suspended : 1;
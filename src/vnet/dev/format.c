@@ -179,7 +179,9 @@ format_vnet_dev_rx_queue_info (u8 *s, va_list *args)
   s = format (s, "\n%UPolling thread is %u, %sabled, %sstarted, %s mode",
 	      format_white_space, indent, rxq->rx_thread_index,
 	      rxq->enabled ? "en" : "dis", rxq->started ? "" : "not-",
-	      rxq->interrupt_mode ? "interrupt" : "polling");
+	      rxq->adaptive_mode  ? "adaptive" :
+	      rxq->interrupt_mode ? "interrupt" :
+				    "polling");
   if (rxq->port->rx_queue_ops.format_info)
     s = format (s, "\n%U%U", format_white_space, indent,
 		rxq->port->rx_queue_ops.format_info, a, rxq);
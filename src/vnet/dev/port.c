@@ -428,6 +428,7 @@ vnet_dev_port_cfg_change (vlib_main_t *vm, vnet_dev_port_t *port,
 	  foreach_vnet_dev_port_rx_queue (q, port)
 	    {
 	      q->interrupt_mode = enable;
+	      q->adaptive_mode = enable && req->adaptive_mode;
 	      bmp = clib_bitmap_set (bmp, q->rx_thread_index, 1);
 	    }
 
@@ -444,6 +445,7 @@ vnet_dev_port_cfg_change (vlib_main_t *vm, vnet_dev_port_t *port,
       else
 	{
 	  rxq->interrupt_mode = enable;
+	  rxq->adaptive_mode = enable && req->adaptive_mode;
 	  vnet_dev_rt_exec_ops (vm, port->dev,
 				&(vnet_dev_rt_op_t){
 				  .port = port,
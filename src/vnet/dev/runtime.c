@@ -24,6 +24,7 @@ _vnet_dev_rt_exec_op (vlib_main_t *vm, vnet_dev_rt_op_t *op)
   vnet_dev_rx_node_runtime_t *rtd;
   vlib_node_state_t state = VLIB_NODE_STATE_DISABLED;
   u32 node_index = vnet_dev_get_port_rx_node_index (port);
+  int adaptive = 1;
 
   rtd = vlib_node_get_runtime_data (vm, node_index);
 
@@ -37,6 +38,10 @@ _vnet_dev_rt_exec_op (vlib_main_t *vm, vnet_dev_rt_op_t *op)
       else if (state != VLIB_NODE_STATE_POLLING)
 	state = VLIB_NODE_STATE_INTERRUPT;
 
+      /* the node adapts only if none of its queues is pinned to a mode */
+      if (q->adaptive_mode == 0)
+	adaptive = 0;
+
       q->next_on_thread = 0;
       if (previous == 0)
 	first = q;
@@ -48,6 +53,8 @@ _vnet_dev_rt_exec_op (vlib_main_t *vm, vnet_dev_rt_op_t *op)
 
   rtd->first_rx_queue = first;
   vlib_node_set_state (vm, node_index, state);
+  vlib_node_set_flag (vm, node_index, VLIB_NODE_FLAG_ADAPTIVE_MODE,
+		      adaptive && state == VLIB_NODE_STATE_INTERRUPT);
   __atomic_store_n (&op->completed, 1, __ATOMIC_RELEASE);
 }
 
@@ -23,6 +23,7 @@
 #include <vnet/devices/virtio/virtio_buffering.h>
 #include <vnet/gso/gro.h>
 #include <vnet/interface.h>
+#include <vlib/file.h>
 
 #define foreach_virtio_if_flag		\
   _(0, ADMIN_UP, "admin-up")		\
@@ -274,7 +275,9 @@ virtio_kick (vlib_main_t *vm, vnet_virtio_vring_t *vring, virtio_if_t *vif)
       u64 x = 1;
       int __clib_unused r;
 
-      r = write (vring->kick_fd, &x, sizeof (x));
+      if (vlib_file_queue_kick (vm, vring->kick_fd, VLIB_FILE_KICK_EVENTFD, 0,
+				0))
+	r = write (vring->kick_fd, &x, sizeof (x));
       vring->last_kick_avail_idx = vring->avail->idx;
     }
 }
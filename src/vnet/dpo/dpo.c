@@ -241,6 +241,30 @@ dpo_reset (dpo_id_t *dpo)
     dpo_copy(dpo, &tmp);
 }
 
+static void
+dpo_unlock_deferred (uword data)
+{
+    dpo_id_t dpo = {
+        .as_u64 = data,
+    };
+
+    dpo_unlock(&dpo);
+}
+
+void
+dpo_reset_deferred (dpo_id_t *dpo)
+{
+    dpo_id_t tmp = DPO_INVALID;
+    u64 old;
+
+    old = dpo->as_u64;
+    dpo->as_u64 = tmp.as_u64;
+
+    tmp.as_u64 = old;
+    if (dpo_id_is_valid(&tmp))
+        vlib_worker_defer_one_loop(dpo_unlock_deferred, old);
+}
+
 /**
  * \brief
  * Compare two Data-path objects
@@ -271,6 +271,18 @@ extern void dpo_set(dpo_id_t *dpo,
  */
 extern void dpo_reset(dpo_id_t *dpo);
 
+/**
+ * @brief reset a DPO ID, deferring the unlock
+ * The DPO ID is reset now, but the DPO object is unlocked only once
+ * each of the workers has been once around the track. Use this when
+ * the DPO has been removed from the data-plane, but packets in flight
+ * may still be using it.
+ *
+ * @param dpo
+ *  The DPO object to reset
+ */
+extern void dpo_reset_deferred(dpo_id_t *dpo);
+
 /**
  * @brief compare two DPOs for equality
  */
@@ -341,6 +341,55 @@ load_balance_set_fib_entry_flags (index_t lbi,
 }
 
 
+/*
+ * Objects the workers may still be reading once they have been replaced
+ * by a multipath update are released only after each worker has been
+ * once around the track.
+ */
+static void
+load_balance_urpf_unlock_deferred (uword data)
+{
+    fib_urpf_list_unlock(data);
+}
+
+static void
+load_balance_map_unlock_deferred (uword data)
+{
+    load_balance_map_unlock(data);
+}
+
+static void
+load_balance_buckets_free_deferred (uword data)
+{
+    dpo_id_t *buckets = (dpo_id_t *) data, *tmp_dpo;
+
+    vec_foreach(tmp_dpo, buckets)
+    {
+        dpo_reset(tmp_dpo);
+    }
+    vec_free(buckets);
+}
+
+static void
+load_balance_buckets_free (dpo_id_t *buckets, u32 n_buckets)
+{
+    dpo_id_t *old = NULL, invalid = DPO_INVALID;
+    u32 ii;
+
+    /*
+     * take over the buckets' locks in a private copy, then reset
+     * the originals without unlocking.
+     */
+    vec_add(old, buckets, n_buckets);
+    for (ii = 0; ii < n_buckets; ii++)
+    {
+        buckets[ii].as_u64 = invalid.as_u64;
+    }
+
+    vlib_worker_defer_one_loop(load_balance_buckets_free_deferred,
+                               pointer_to_uword(old));
+}
+
 void
 load_balance_set_urpf (index_t lbi,
 		       index_t urpf)
@@ -356,7 +405,7 @@ load_balance_set_urpf (index_t lbi,
     old = lb->lb_urpf;
     lb->lb_urpf = urpf;
 
-    fib_urpf_list_unlock(old);
+    vlib_worker_defer_one_loop(load_balance_urpf_unlock_deferred, old);
     fib_urpf_list_lock(urpf);
 }
 
@@ -544,6 +593,99 @@ load_balance_multipath_next_hop_fixup (const load_balance_path_t *nhs,
     return (NULL);
 }
 
+/*
+ * Lay out the paths over the buckets of a resilient load-balance, one
+ * path per bucket, in bucket order.
+ * Each path is given a share of the buckets in proportion to its normalised
+ * weight. A bucket that already forwards to one of the paths keeps it while
+ * that path is within its share, so a path change only moves the flows of the
+ * buckets of the paths that left or gave up buckets. The remaining buckets
+ * are dealt round-robin to the paths below their share.
+ */
+static load_balance_path_t *
+load_balance_resilient_layout (load_balance_t *lb,
+                               const load_balance_path_t *nhs,
+                               u32 n_buckets)
+{
+    load_balance_path_t *rnhs;
+    u32 *target, *count, *bucket_path;
+    u32 ii, jj, n_nhs, n_old, n_left, next;
+    u64 sum_weight;
+    dpo_id_t *old;
+
+    rnhs = NULL;
+    target = count = bucket_path = NULL;
+    n_nhs = vec_len(nhs);
+
+    sum_weight = 0;
+    for (ii = 0; ii < n_nhs; ii++)
+        sum_weight += nhs[ii].path_weight;
+
+    vec_validate(target, n_nhs - 1);
+    vec_validate(count, n_nhs - 1);
+    n_left = n_buckets;
+    for (ii = 0; ii < n_nhs; ii++)
+    {
+        target[ii] = ((u64) n_buckets * nhs[ii].path_weight) / sum_weight;
+        n_left -= target[ii];
+    }
+    for (ii = 0; n_left > 0; ii = (ii + 1) % n_nhs, n_left--)
+        target[ii]++;
+
+    vec_validate_init_empty(bucket_path, n_buckets - 1, ~0);
+
+    /*
+     * keep the buckets whose path remains
+     */
+    old = load_balance_get_buckets(lb);
+    n_old = clib_min(lb->lb_n_buckets, n_buckets);
+
+    for (ii = 0; ii < n_old; ii++)
+    {
+        for (jj = 0; jj < n_nhs; jj++)
+        {
+            if (count[jj] < target[jj] &&
+                0 == dpo_cmp(&old[ii], &nhs[jj].path_dpo))
+            {
+                bucket_path[ii] = jj;
+                count[jj]++;
+                break;
+            }
+        }
+    }
+
+    /*
+     * deal out the rest
+     */
+    next = 0;
+    for (ii = 0; ii < n_buckets; ii++)
+    {
+        if (~0 != bucket_path[ii])
+            continue;
+
+        while (count[next] >= target[next])
+            next = (next + 1) % n_nhs;
+
+        bucket_path[ii] = next;
+        count[next]++;
+        next = (next + 1) % n_nhs;
+    }
+
+    vec_validate(rnhs, n_buckets - 1);
+    for (ii = 0; ii < n_buckets; ii++)
+    {
+        rnhs[ii].path_index = nhs[bucket_path[ii]].path_index;
+        rnhs[ii].path_weight = 1;
+        dpo_copy(&rnhs[ii].path_dpo, &nhs[bucket_path[ii]].path_dpo);
+    }
+
+    vec_free(bucket_path);
+    vec_free(target);
+    vec_free(count);
+
+    return (rnhs);
+}
+
 /*
  * Fill in adjacencies in block based on corresponding
  * next hop adjacencies.
@@ -652,15 +794,22 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                                load_balance_flags_t flags)
 {
     load_balance_path_t *nh, *nhs, *fixed_nhs;
-    u32 sum_of_weights, n_buckets, ii;
+    u32 sum_of_weights, n_buckets;
     index_t lbmi, old_lbmi;
     load_balance_t *lb;
-    dpo_id_t *tmp_dpo;
 
     nhs = NULL;
 
     ASSERT(DPO_LOAD_BALANCE == dpo->dpoi_type);
     lb = load_balance_get(dpo->dpoi_index);
+
+    /*
+     * a map assumes the buckets of each path are contiguous, which those
+     * of a resilient load-balance are not
+     */
+    if (flags & LOAD_BALANCE_FLAG_RESILIENT)
+        flags &= ~LOAD_BALANCE_FLAG_USES_MAP;
+
     lb->lb_flags = flags;
     fixed_nhs = load_balance_multipath_next_hop_fixup(raw_nhs, lb->lb_proto);
     n_buckets =
@@ -671,6 +820,21 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                                          &sum_of_weights,
                                          multipath_next_hop_error_tolerance);
 
+    if (flags & LOAD_BALANCE_FLAG_RESILIENT)
+    {
+        load_balance_path_t *rnhs;
+
+        n_buckets = clib_max(n_buckets, LB_RESILIENT_N_BUCKETS);
+        rnhs = load_balance_resilient_layout(lb, nhs, n_buckets);
+
+        vec_foreach (nh, nhs)
+        {
+            dpo_reset(&nh->path_dpo);
+        }
+        vec_free(nhs);
+        nhs = rnhs;
+    }
+
     /*
      * Save the old load-balance map used, and get a new one if required.
      */
@@ -751,10 +915,8 @@ load_balance_multipath_update (const dpo_id_t *dpo,
 
                 CLIB_MEMORY_BARRIER();
 
-                for (ii = 0; ii < LB_NUM_INLINE_BUCKETS; ii++)
-                {
-                    dpo_reset(&lb->lb_buckets_inline[ii]);
-                }
+                load_balance_buckets_free(lb->lb_buckets_inline,
+                                          LB_NUM_INLINE_BUCKETS);
             }
             else
             {
@@ -776,7 +938,7 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                      * we are not crossing the threshold. We need a new bucket array to
                      * hold the increased number of choices.
                      */
-                    dpo_id_t *new_buckets, *old_buckets, *tmp_dpo;
+                    dpo_id_t *new_buckets, *old_buckets;
 
                     new_buckets = NULL;
                     old_buckets = load_balance_get_buckets(lb);
@@ -792,11 +954,9 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                     CLIB_MEMORY_BARRIER();
                     load_balance_set_n_buckets(lb, n_buckets);
 
-                    vec_foreach(tmp_dpo, old_buckets)
-                    {
-                        dpo_reset(tmp_dpo);
-                    }
-                    vec_free(old_buckets);
+                    vlib_worker_defer_one_loop(
+                        load_balance_buckets_free_deferred,
+                        pointer_to_uword(old_buckets));
                 }
             }
 
@@ -828,6 +988,8 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                  *       used).
                  *   3 - free the outline buckets
                  */
+                dpo_id_t *old_buckets;
+
                 load_balance_fill_buckets(lb, nhs,
                                           lb->lb_buckets_inline,
                                           n_buckets, flags);
@@ -835,11 +997,11 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                 load_balance_set_n_buckets(lb, n_buckets);
                 CLIB_MEMORY_BARRIER();
 
-                vec_foreach(tmp_dpo, lb->lb_buckets)
-                {
-                    dpo_reset(tmp_dpo);
-                }
-                vec_free(lb->lb_buckets);
+                old_buckets = lb->lb_buckets;
+                lb->lb_buckets = NULL;
+                vlib_worker_defer_one_loop(
+                    load_balance_buckets_free_deferred,
+                    pointer_to_uword(old_buckets));
             }
             else
             {
@@ -861,10 +1023,8 @@ load_balance_multipath_update (const dpo_id_t *dpo,
                 load_balance_fill_buckets(lb, nhs, buckets,
                                           n_buckets, flags);
 
-                for (ii = n_buckets; ii < old_n_buckets; ii++)
-                {
-                    dpo_reset(&buckets[ii]);
-                }
+                load_balance_buckets_free(&buckets[n_buckets],
+                                          old_n_buckets - n_buckets);
             }
         }
     }
@@ -876,7 +1036,7 @@ load_balance_multipath_update (const dpo_id_t *dpo,
     vec_free(nhs);
     vec_free(fixed_nhs);
 
-    load_balance_map_unlock(old_lbmi);
+    vlib_worker_defer_one_loop(load_balance_map_unlock_deferred, old_lbmi);
 }
 
 static void
@@ -55,6 +55,14 @@ extern load_balance_main_t load_balance_main;
  */
 #define LB_MAX_BUCKETS 8192
 
+/**
+ * The minimum number of buckets of a resilient load-balance. Each bucket
+ * keeps its path when others are added or removed, so the number of
+ * buckets does not change with the paths, and is large enough to follow
+ * the weights of a typical ECMP set.
+ */
+#define LB_RESILIENT_N_BUCKETS 256
+
 /**
  * The number of buckets that a load-balance object can have and still
  * fit in one cache-line
@@ -88,20 +96,23 @@ typedef struct load_balance_path_t_ {
 typedef enum load_balance_attr_t_ {
     LOAD_BALANCE_ATTR_USES_MAP = 0,
     LOAD_BALANCE_ATTR_STICKY = 1,
+    LOAD_BALANCE_ATTR_RESILIENT = 2,
 } load_balance_attr_t;
 
 #define LOAD_BALANCE_ATTR_NAMES  {                  \
     [LOAD_BALANCE_ATTR_USES_MAP] = "uses-map",      \
     [LOAD_BALANCE_ATTR_STICKY] = "sticky",          \
+    [LOAD_BALANCE_ATTR_RESILIENT] = "resilient",    \
 }
 
 #define FOR_EACH_LOAD_BALANCE_ATTR(_attr)                       \
-    for (_attr = 0; _attr <= LOAD_BALANCE_ATTR_STICKY; _attr++)
+    for (_attr = 0; _attr <= LOAD_BALANCE_ATTR_RESILIENT; _attr++)
 
 typedef enum load_balance_flags_t_ {
     LOAD_BALANCE_FLAG_NONE = 0,
     LOAD_BALANCE_FLAG_USES_MAP = (1 << 0),
     LOAD_BALANCE_FLAG_STICKY = (1 << 1),
+    LOAD_BALANCE_FLAG_RESILIENT = (1 << 2),
 } __attribute__((packed)) load_balance_flags_t;
 
 /**
@@ -747,12 +747,12 @@ lookup_dpo_ip6_inline (vlib_main_t * vm,
 	    }
 
 	    /* do src lookup */
-	    lbi0 = ip6_fib_table_fwding_lookup(
-					       fib_index0,
-					       input_addr0);
-	    lbi1 = ip6_fib_table_fwding_lookup(
-					       fib_index1,
-					       input_addr1);
+	    ip6_fib_table_fwding_lookup_x2(fib_index0,
+                                           fib_index1,
+                                           input_addr0,
+                                           input_addr1,
+                                           &lbi0,
+                                           &lbi1);
 	    lb0 = load_balance_get(lbi0);
 	    lb1 = load_balance_get(lbi1);
 
@@ -263,12 +263,16 @@ typedef struct fib_entry_src_collect_forwarding_ctx_t_
 
 /**
  * @brief Determine whether this FIB entry should use a load-balance MAP
- * to support PIC edge fast convergence
+ * to support PIC edge fast convergence, or resilient buckets
  */
 static load_balance_flags_t
 fib_entry_calc_lb_flags (fib_entry_src_collect_forwarding_ctx_t *ctx,
                          const fib_entry_src_t *esrc)
 {
+    if (esrc->fes_entry_flags & FIB_ENTRY_FLAG_RESILIENT)
+    {
+        return (LOAD_BALANCE_FLAG_RESILIENT);
+    }
     /**
      * We'll use a LB map if the path-list has multiple recursive paths.
      * recursive paths implies BGP, and hence scale.
@@ -757,8 +761,12 @@ fib_entry_src_action_uninstall (fib_entry_t *fib_entry)
 	    &fib_entry->fe_prefix,
 	    &fib_entry->fe_lb);
 
-	vlib_worker_wait_one_loop();
-	dpo_reset(&fib_entry->fe_lb);
+	/*
+	 * packets in flight on the workers may still be using the LB.
+	 * release it once they have all been round the track, rather
+	 * than waiting here for them to do so.
+	 */
+	dpo_reset_deferred(&fib_entry->fe_lb);
     }
 }
 
@@ -1596,6 +1604,11 @@ fib_entry_src_action_path_add (fib_entry_t *fib_entry,
 	esrc = fib_entry_src_find(fib_entry, source);
     }
 
+    /*
+     * resilience can be requested with any of the paths added
+     */
+    esrc->fes_entry_flags |= (flags & FIB_ENTRY_FLAG_RESILIENT);
+
     /*
      * we are no doubt modifying a path-list. If the path-list
      * is shared, and hence not modifiable, then the index returned
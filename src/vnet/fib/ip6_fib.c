@@ -26,6 +26,11 @@ ip6_fib_fwding_table_instance_t ip6_fib_fwding_table;
 u32 ip6_fib_table_nbuckets;
 uword ip6_fib_table_size;
 
+/* the lookup engine used by newly created tables */
+static ip6_fib_lookup_engine_t ip6_fib_default_lookup_engine;
+
+static const char *ip6_fib_lookup_engine_names[] = IP6_FIB_LOOKUP_ENGINES;
+
 typedef struct ip6_fib_hash_key_t_
 {
   ip6_address_t addr;
@@ -102,6 +107,18 @@ create_fib_with_table_id (u32 table_id,
 
     v6_fib->fib_entry_by_dst_address = hash_create_mem(2, sizeof(ip6_fib_hash_key_t), sizeof(fib_node_index_t));
 
+    /*
+     * link-local tables, one per interface, hold a handful of prefixes
+     * and would each pay for the mtrie's 64k slot root ply, so they keep
+     * the hash unless explicitly switched.
+     */
+    vec_validate(ip6_fib_fwding_table.mtrie_by_fib_index, fib_table->ft_index);
+    ip6_fib_fwding_table.mtrie_by_fib_index[fib_table->ft_index] =
+        (IP6_FIB_LOOKUP_ENGINE_MTRIE == ip6_fib_default_lookup_engine &&
+         !(flags & FIB_TABLE_FLAG_IP6_LL) ?
+         ip6_mtrie_alloc() :
+         NULL);
+
     /*
      * add the special entries into the new FIB
      */
@@ -185,6 +202,7 @@ ip6_fib_table_destroy (u32 fib_index)
     }
     vec_free (fib_table->ft_locks);
     vec_free(fib_table->ft_src_route_counts);
+    ip6_fib_table_set_lookup_engine(fib_index, IP6_FIB_LOOKUP_ENGINE_HASH);
     hash_free(pool_elt_at_index(ip6_main.v6_fibs, fib_index)->fib_entry_by_dst_address);
     pool_put_index(ip6_main.v6_fibs, fib_table->ft_index);
     pool_put(ip6_main.fibs, fib_table);
@@ -279,6 +297,20 @@ ip6_fib_table_get_index_for_sw_if_index (u32 sw_if_index)
     return (ip6_main.fib_index_by_sw_if_index[sw_if_index]);
 }
 
+static void
+ip6_fib_mtrie_free_deferred (uword data)
+{
+    ip6_mtrie_free(uword_to_pointer(data, ip6_mtrie_t *));
+}
+
+static void
+ip6_fib_vec_free_deferred (uword data)
+{
+    u8 *v = uword_to_pointer(data, u8 *);
+
+    vec_free(v);
+}
+
 static void
 compute_prefix_lengths_in_search_order (ip6_fib_fwding_table_instance_t *table)
 {
@@ -301,10 +333,51 @@ compute_prefix_lengths_in_search_order (ip6_fib_fwding_table_instance_t *table)
     table->prefix_lengths_in_search_order = prefix_lengths_in_search_order;
 
     /*
-     * let the workers go once round the track before we free the old set
+     * free the old set once the workers have been round the track
      */
-    vlib_worker_wait_one_loop();
-    vec_free(old);
+    vlib_worker_defer_one_loop(ip6_fib_vec_free_deferred,
+                               pointer_to_uword(old));
+}
+
+static void
+ip6_fib_table_mtrie_route_del (ip6_mtrie_t *mtrie,
+                               u32 fib_index,
+                               const ip6_address_t *addr,
+                               u32 len,
+                               const dpo_id_t *dpo)
+{
+    const fib_prefix_t pfx = {
+        .fp_proto = FIB_PROTOCOL_IP6,
+        .fp_len = len,
+        .fp_addr.ip6 = *addr,
+    };
+    const fib_prefix_t *cover_prefix;
+    const dpo_id_t *cover_dpo;
+    fib_node_index_t cover_index;
+
+    /*
+     * We need to pass the MTRIE the LB index and address length of the
+     * covering prefix, so it can fill the plys with the correct replacement
+     * for the entry being removed. The default route has no cover, its
+     * slots return to empty.
+     */
+    cover_index = (0 == len ?
+                   FIB_NODE_INDEX_INVALID :
+                   fib_table_get_less_specific(fib_index, &pfx));
+
+    if (FIB_NODE_INDEX_INVALID == cover_index)
+    {
+        ip6_mtrie_route_del(mtrie, addr, len, dpo->dpoi_index, 0, 0);
+    }
+    else
+    {
+        cover_prefix = fib_entry_get_prefix(cover_index);
+        cover_dpo = fib_entry_contribute_ip_forwarding(cover_index);
+
+        ip6_mtrie_route_del(mtrie, addr, len, dpo->dpoi_index,
+                            cover_prefix->fp_len,
+                            cover_dpo->dpoi_index);
+    }
 }
 
 void
@@ -329,6 +402,12 @@ ip6_fib_table_fwding_dpo_update (u32 fib_index,
 
     clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 1);
 
+    if (NULL != table->mtrie_by_fib_index[fib_index])
+    {
+        ip6_mtrie_route_add(table->mtrie_by_fib_index[fib_index],
+                            addr, len, dpo->dpoi_index);
+    }
+
     if (0 == table->dst_address_length_refcounts[len]++)
     {
         table->non_empty_dst_address_length_bitmap =
@@ -360,6 +439,12 @@ ip6_fib_table_fwding_dpo_remove (u32 fib_index,
 
     clib_bihash_add_del_24_8(&table->ip6_hash, &kv, 0);
 
+    if (NULL != table->mtrie_by_fib_index[fib_index])
+    {
+        ip6_fib_table_mtrie_route_del(table->mtrie_by_fib_index[fib_index],
+                                      fib_index, addr, len, dpo);
+    }
+
     /* refcount accounting */
     ASSERT (table->dst_address_length_refcounts[len] > 0);
     if (--table->dst_address_length_refcounts[len] == 0)
@@ -371,6 +456,111 @@ ip6_fib_table_fwding_dpo_remove (u32 fib_index,
     }
 }
 
+typedef struct ip6_fib_mtrie_build_ctx_t_
+{
+    ip6_mtrie_t *mtrie;
+    u32 fib_index;
+} ip6_fib_mtrie_build_ctx_t;
+
+static int
+ip6_fib_mtrie_build_walk (clib_bihash_kv_24_8_t *kv,
+                          void *arg)
+{
+    ip6_fib_mtrie_build_ctx_t *ctx = arg;
+    ip6_address_t addr;
+
+    if ((kv->key[2] >> 32) != ctx->fib_index)
+        return (BIHASH_WALK_CONTINUE);
+
+    addr.as_u64[0] = kv->key[0];
+    addr.as_u64[1] = kv->key[1];
+
+    ip6_mtrie_route_add(ctx->mtrie, &addr, kv->key[2] & 0xff, kv->value);
+
+    return (BIHASH_WALK_CONTINUE);
+}
+
+ip6_fib_lookup_engine_t
+ip6_fib_table_get_lookup_engine (u32 fib_index)
+{
+    return (NULL == ip6_fib_fwding_table.mtrie_by_fib_index[fib_index] ?
+            IP6_FIB_LOOKUP_ENGINE_HASH :
+            IP6_FIB_LOOKUP_ENGINE_MTRIE);
+}
+
+void
+ip6_fib_table_set_lookup_engine (u32 fib_index,
+                                 ip6_fib_lookup_engine_t engine)
+{
+    ip6_fib_fwding_table_instance_t *table;
+    ip6_mtrie_t *mtrie;
+
+    table = &ip6_fib_fwding_table;
+
+    if (engine == ip6_fib_table_get_lookup_engine(fib_index))
+        return;
+
+    switch (engine)
+    {
+    case IP6_FIB_LOOKUP_ENGINE_MTRIE:
+        {
+            ip6_fib_mtrie_build_ctx_t ctx = {
+                .mtrie = ip6_mtrie_alloc(),
+                .fib_index = fib_index,
+            };
+
+            /*
+             * populate the mtrie from the table's entries in the
+             * forwarding hash, then cutover. the workers see either
+             * the hash or the complete trie.
+             */
+            clib_bihash_foreach_key_value_pair_24_8(&table->ip6_hash,
+                                                    ip6_fib_mtrie_build_walk,
+                                                    &ctx);
+            clib_atomic_store_rel_n(&table->mtrie_by_fib_index[fib_index],
+                                    ctx.mtrie);
+            break;
+        }
+    case IP6_FIB_LOOKUP_ENGINE_HASH:
+        mtrie = table->mtrie_by_fib_index[fib_index];
+        clib_atomic_store_rel_n(&table->mtrie_by_fib_index[fib_index],
+                                NULL);
+
+        /*
+         * free the trie once the workers have been round the track
+         */
+        vlib_worker_defer_one_loop(ip6_fib_mtrie_free_deferred,
+                                   pointer_to_uword(mtrie));
+        break;
+    }
+}
+
+u8 *
+format_ip6_fib_lookup_engine (u8 * s, va_list * args)
+{
+    ip6_fib_lookup_engine_t engine = va_arg(*args, int);
+
+    return (format(s, "%s", ip6_fib_lookup_engine_names[engine]));
+}
+
+uword
+unformat_ip6_fib_lookup_engine (unformat_input_t * input,
+                                va_list * args)
+{
+    ip6_fib_lookup_engine_t *engine = va_arg(*args, ip6_fib_lookup_engine_t *);
+    ip6_fib_lookup_engine_t ii;
+
+    for (ii = 0; ii < ARRAY_LEN(ip6_fib_lookup_engine_names); ii++)
+    {
+        if (unformat(input, ip6_fib_lookup_engine_names[ii]))
+        {
+            *engine = ii;
+            return (1);
+        }
+    }
+    return (0);
+}
+
 void
 ip6_fib_table_walk (u32 fib_index,
                     fib_table_walk_fn_t fn,
@@ -487,6 +677,7 @@ u8 *
 format_ip6_fib_table_memory (u8 * s, va_list * args)
 {
     uword bytes_inuse;
+    u32 n_mtries;
 
     bytes_inuse = alloc_arena_next(&ip6_fib_fwding_table.ip6_hash);
 
@@ -494,6 +685,21 @@ format_ip6_fib_table_memory (u8 * s, va_list * args)
                "IPv6 unicast",
                pool_elts(ip6_main.fibs),
                bytes_inuse);
+
+    bytes_inuse = n_mtries = 0;
+    vec_foreach_pointer(mtrie, ip6_fib_fwding_table.mtrie_by_fib_index)
+    {
+        if (NULL != mtrie)
+        {
+            bytes_inuse += ip6_mtrie_memory_usage(mtrie);
+            n_mtries++;
+        }
+    }
+    if (n_mtries)
+        s = format(s, "%=30s %=6d %=12ld\n",
+                   "IPv6 unicast mtrie",
+                   n_mtries,
+                   bytes_inuse);
     return (s);
 }
 
@@ -505,14 +711,16 @@ ip6_fib_table_show (vlib_main_t *vm, fib_table_t *fib_table, int summary)
     fib_source_t source;
     u8 *s = NULL;
 
-    s = format(s, "%U, fib_index:%d, flow hash:[%U] epoch:%d flags:%U locks:[",
+    s = format(s, "%U, fib_index:%d, flow hash:[%U] epoch:%d flags:%U lookup:%U locks:[",
 	       format_fib_table_name, fib->index,
 	       FIB_PROTOCOL_IP6,
 	       fib->index,
 	       format_ip_flow_hash_config,
 	       fib_table->ft_flow_hash_config,
 	       fib_table->ft_epoch,
-	       format_fib_table_flags, fib_table->ft_flags);
+	       format_fib_table_flags, fib_table->ft_flags,
+	       format_ip6_fib_lookup_engine,
+	       ip6_fib_table_get_lookup_engine(fib->index));
 
     vec_foreach_index(source, fib_table->ft_locks)
     {
@@ -567,6 +775,7 @@ ip6_show_fib (vlib_main_t * vm,
     int table_id = -1, fib_index = ~0;
     int detail = 0;
     int hash = 0;
+    int mtrie = 0;
 
     verbose = 1;
     matching = 0;
@@ -587,6 +796,9 @@ ip6_show_fib (vlib_main_t * vm,
                  unformat (input, "memory"))
 	    hash = 1;
 
+	else if (unformat (input, "mtrie"))
+	    mtrie = 1;
+
 	else if (unformat (input, "%U/%d",
 			   unformat_ip6_address, &matching_address, &mask_len))
 	    matching = 1;
@@ -621,6 +833,19 @@ ip6_show_fib (vlib_main_t * vm,
         if (fib_table->ft_flags & FIB_TABLE_FLAG_IP6_LL)
             continue;
 
+	if (mtrie)
+	{
+	    if (IP6_FIB_LOOKUP_ENGINE_MTRIE ==
+		ip6_fib_table_get_lookup_engine(fib->index))
+		vlib_cli_output (vm, "%U, fib_index:%d, mtrie:\n%U",
+				 format_fib_table_name, fib->index,
+				 FIB_PROTOCOL_IP6, fib->index,
+				 format_ip6_mtrie,
+				 ip6_fib_fwding_table.mtrie_by_fib_index[fib->index],
+				 detail);
+	    continue;
+	}
+
 	ip6_fib_table_show(vm, fib_table, !verbose);
 	if (!verbose)
 	  continue;
@@ -734,10 +959,64 @@ ip6_show_fib (vlib_main_t * vm,
  ?*/
 VLIB_CLI_COMMAND (ip6_show_fib_command, static) = {
     .path = "show ip6 fib",
-    .short_help = "show ip6 fib [summary] [table <table-id>] [index <fib-id>] [<ip6-addr>[/<width>]] [detail]",
+    .short_help = "show ip6 fib [summary] [table <table-id>] [index <fib-id>] [<ip6-addr>[/<width>]] [mtrie] [detail]",
     .function = ip6_show_fib,
 };
 
+static clib_error_t *
+ip6_fib_set_lookup_engine (vlib_main_t * vm,
+                           unformat_input_t * input,
+                           vlib_cli_command_t * cmd)
+{
+    ip6_fib_lookup_engine_t engine;
+    u32 table_id, fib_index;
+    int have_engine = 0;
+
+    table_id = 0;
+
+    while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+	if (unformat (input, "table %d", &table_id))
+	    ;
+	else if (unformat (input, "%U",
+			   unformat_ip6_fib_lookup_engine, &engine))
+	    have_engine = 1;
+	else
+	    return clib_error_return (0, "unknown input '%U'",
+				      format_unformat_error, input);
+    }
+
+    if (!have_engine)
+	return clib_error_return (0, "specify a lookup engine");
+
+    fib_index = ip6_fib_index_from_table_id (table_id);
+
+    if (~0 == fib_index)
+	return clib_error_return (0, "no such table: %d", table_id);
+
+    ip6_fib_table_set_lookup_engine (fib_index, engine);
+
+    return (NULL);
+}
+
+/*?
+ * This command selects the data-structure used for forwarding lookups in
+ * an IPv6 table. The default 'hash' engine probes a hash table once per
+ * distinct prefix length present in the FIB. The 'mtrie' engine is a
+ * 16-8-...-8 stride trie whose lookup cost depends only on the length of
+ * the matched prefix, at the expense of more memory. The default engine
+ * for new tables is set with the 'fib-lookup-engine' option of the 'ip6'
+ * startup configuration section.
+ *
+ * @cliexpar
+ * @cliexcmd{set ip6 fib lookup-engine table 1 mtrie}
+ ?*/
+VLIB_CLI_COMMAND (ip6_fib_set_lookup_engine_command, static) = {
+    .path = "set ip6 fib lookup-engine",
+    .short_help = "set ip6 fib lookup-engine [table <table-id>] <hash|mtrie>",
+    .function = ip6_fib_set_lookup_engine,
+};
+
 static clib_error_t *
 ip6_config (vlib_main_t * vm, unformat_input_t * input)
 {
@@ -754,6 +1033,10 @@ ip6_config (vlib_main_t * vm, unformat_input_t * input)
 	;
       else if (unformat (input, "default-table-name %s", &default_name))
 	;
+      else if (unformat (input, "fib-lookup-engine %U",
+			 unformat_ip6_fib_lookup_engine,
+			 &ip6_fib_default_lookup_engine))
+	;
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, input);
@@ -22,6 +22,7 @@
 #include <vnet/fib/fib_table.h>
 #include <vnet/ip/lookup.h>
 #include <vnet/dpo/load_balance.h>
+#include <vnet/ip/ip6_mtrie.h>
 #include <vppinfra/bihash_24_8.h>
 #include <vppinfra/bihash_template.h>
 
@@ -31,6 +32,26 @@
 #define IP6_FIB_DEFAULT_HASH_NUM_BUCKETS (64 * 1024)
 #define IP6_FIB_DEFAULT_HASH_MEMORY_SIZE (32<<20)
 
+/**
+ * The data-structures that can be used for forwarding lookups in a table.
+ * All tables share the hash, a table using the mtrie also has its routes
+ * in an mtrie that serves its lookups.
+ */
+typedef enum ip6_fib_lookup_engine_t_
+{
+    IP6_FIB_LOOKUP_ENGINE_HASH,
+    IP6_FIB_LOOKUP_ENGINE_MTRIE,
+} ip6_fib_lookup_engine_t;
+
+#define IP6_FIB_LOOKUP_ENGINES {                 \
+    [IP6_FIB_LOOKUP_ENGINE_HASH] = "hash",       \
+    [IP6_FIB_LOOKUP_ENGINE_MTRIE] = "mtrie",     \
+}
+
+extern u8 *format_ip6_fib_lookup_engine(u8 * s, va_list * args);
+extern uword unformat_ip6_fib_lookup_engine(unformat_input_t * input,
+                                            va_list * args);
+
 /**
  * A representation the forwarding IP6 table
  */
@@ -43,6 +64,9 @@ typedef struct ip6_fib_fwding_table_instance_t_
   uword *non_empty_dst_address_length_bitmap;
   u8 *prefix_lengths_in_search_order;
   i32 dst_address_length_refcounts[129];
+
+  /* per-table mtrie, indexed by fib index. NULL if the table uses the hash */
+  ip6_mtrie_t **mtrie_by_fib_index;
 } ip6_fib_fwding_table_instance_t;
 
 /**
@@ -77,6 +101,13 @@ extern void ip6_fib_table_fwding_dpo_remove(u32 fib_index,
 					    u32 len,
 					    const dpo_id_t *dpo);
 
+/**
+ * @brief Set the data-structure used for forwarding lookups in a table
+ */
+extern void ip6_fib_table_set_lookup_engine(u32 fib_index,
+                                            ip6_fib_lookup_engine_t engine);
+extern ip6_fib_lookup_engine_t ip6_fib_table_get_lookup_engine(u32 fib_index);
+
 u32 ip6_fib_table_fwding_lookup_with_if_index(ip6_main_t * im,
 					      u32 sw_if_index,
 					      const ip6_address_t * dst);
@@ -91,8 +122,8 @@ extern void ip6_fib_table_walk(u32 fib_index,
                                void *ctx);
 
 always_inline u32
-ip6_fib_table_fwding_lookup (u32 fib_index,
-                             const ip6_address_t * dst)
+ip6_fib_table_fwding_hash_lookup (u32 fib_index,
+                                  const ip6_address_t * dst)
 {
     ip6_fib_fwding_table_instance_t *table;
     clib_bihash_kv_24_8_t kv, value;
@@ -128,6 +159,55 @@ ip6_fib_table_fwding_lookup (u32 fib_index,
     return 0;
 }
 
+always_inline const ip6_mtrie_t *
+ip6_fib_table_get_mtrie (u32 fib_index)
+{
+    return (ip6_fib_fwding_table.mtrie_by_fib_index[fib_index]);
+}
+
+always_inline u32
+ip6_fib_table_fwding_lookup (u32 fib_index,
+                             const ip6_address_t * dst)
+{
+    const ip6_mtrie_t *mtrie;
+
+    mtrie = ip6_fib_table_get_mtrie(fib_index);
+
+    if (NULL != mtrie)
+        return (ip6_mtrie_lookup(mtrie, dst));
+
+    return (ip6_fib_table_fwding_hash_lookup(fib_index, dst));
+}
+
+/**
+ * @brief Forwarding lookup of two addresses.
+ * When both tables use the mtrie the two trie walks are interleaved so
+ * that the memory accesses of one hide the latency of the other.
+ */
+always_inline void
+ip6_fib_table_fwding_lookup_x2 (u32 fib_index0,
+                                u32 fib_index1,
+                                const ip6_address_t * dst0,
+                                const ip6_address_t * dst1,
+                                u32 *lbi0,
+                                u32 *lbi1)
+{
+    const ip6_mtrie_t *mtrie0, *mtrie1;
+
+    mtrie0 = ip6_fib_table_get_mtrie(fib_index0);
+    mtrie1 = ip6_fib_table_get_mtrie(fib_index1);
+
+    if (PREDICT_TRUE(NULL != mtrie0 && NULL != mtrie1))
+    {
+        ip6_mtrie_lookup_x2(mtrie0, mtrie1, dst0, dst1, lbi0, lbi1);
+    }
+    else
+    {
+        *lbi0 = ip6_fib_table_fwding_lookup(fib_index0, dst0);
+        *lbi1 = ip6_fib_table_fwding_lookup(fib_index1, dst1);
+    }
+}
+
 /**
  * @brief Walk all entries in a sub-tree of the FIB table
  * N.B: This is NOT safe to deletes. If you need to delete walk the whole
@@ -82,6 +82,93 @@ VLIB_CLI_COMMAND (set_interface_feature_gso_command, static) = {
   .function = set_interface_feature_gso_command_fn,
 };
 
+static clib_error_t *
+set_interface_feature_gro_command_fn (vlib_main_t *vm,
+				      unformat_input_t *input,
+				      vlib_cli_command_t *cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  unformat_input_t _line_input, *line_input = &_line_input;
+  clib_error_t *error = 0;
+
+  u32 sw_if_index = ~0;
+  u8 enable = 1;
+
+  /* Get a line of input. */
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (line_input, "enable"))
+	enable = 1;
+      else if (unformat (line_input, "disable"))
+	enable = 0;
+      else
+	{
+	  error = unformat_parse_error (line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "Interface not specified...");
+      goto done;
+    }
+  int rv = vnet_sw_interface_gro_enable_disable (sw_if_index, enable);
+
+  switch (rv)
+    {
+    case VNET_API_ERROR_INVALID_VALUE:
+      error = clib_error_return (0, "interface type is not hardware");
+      break;
+    case VNET_API_ERROR_FEATURE_DISABLED:
+      error = clib_error_return (0, "interface should be ethernet interface");
+      break;
+    default:
+      ;
+    }
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+VLIB_CLI_COMMAND (set_interface_feature_gro_command, static) = {
+  .path = "set interface feature gro",
+  .short_help = "set interface feature gro <intfc> [enable | disable]",
+  .function = set_interface_feature_gro_command_fn,
+};
+
+static clib_error_t *
+show_gro_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  gso_main_t *gm = &gso_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 i;
+
+  vlib_cli_output (vm, "interfaces:");
+  clib_bitmap_foreach (i, gm->gro_input_enabled_by_sw_if_index)
+    vlib_cli_output (vm, "  %U", format_vnet_sw_if_index_name, vnm, i);
+
+  vec_foreach_index (i, gm->gro_input_flow_tables)
+    vlib_cli_output (vm, "thread %u: %U", i, gro_flow_table_format,
+		     gm->gro_input_flow_tables[i]);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_gro_command, static) = {
+  .path = "show gro",
+  .short_help = "show gro",
+  .function = show_gro_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -155,6 +155,9 @@ gro_validate_checksum (vlib_main_t * vm, vlib_buffer_t * b0,
 
   if (b0->flags & VNET_BUFFER_F_OFFLOAD)
     return VNET_BUFFER_F_L4_CHECKSUM_CORRECT;
+  /* already validated by the device */
+  if (b0->flags & VNET_BUFFER_F_L4_CHECKSUM_CORRECT)
+    return VNET_BUFFER_F_L4_CHECKSUM_CORRECT;
   vlib_buffer_advance (b0, gho0->l3_hdr_offset);
   if (is_ip4)
     flags = ip4_tcp_udp_validate_checksum (vm, b0);
@@ -393,6 +396,8 @@ gro_fixup_header (vlib_main_t *vm, vlib_buffer_t *b0, u32 ack_number, u8 is_l2)
       ip4->length =
 	clib_host_to_net_u16 (vlib_buffer_length_in_chain (vm, b0) -
 			      gho0.l3_hdr_offset);
+      /* keep the header valid for the receive path, output recomputes it */
+      ip4->checksum = ip4_header_checksum (ip4);
       vnet_buffer (b0)->l3_hdr_offset = (u8 *) ip4 - b0->data;
       b0->flags |= (VNET_BUFFER_F_GSO | VNET_BUFFER_F_IS_IP4 |
 		    VNET_BUFFER_F_L2_HDR_OFFSET_VALID |
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Receive side coalescing of TCP segments on the device-input feature arc,
+ * for drivers that can't do it themselves. In order segments of a flow are
+ * chained to the first one, within a frame and across frames, and handed to
+ * the next feature as a single GSO packet once the flow stops, a segment
+ * can't be merged or the flow timer expires.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vnet/feature/feature.h>
+#include <vnet/gso/gso.h>
+#include <vnet/gso/gro_func.h>
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 length;
+  u16 gso_size;
+  u8 is_gso;
+} gro_input_trace_t;
+
+static u8 *
+format_gro_input_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  gro_input_trace_t *t = va_arg (*args, gro_input_trace_t *);
+
+  s = format (s, "sw_if_index %u length %u", t->sw_if_index, t->length);
+  if (t->is_gso)
+    s = format (s, " gso_size %u", t->gso_size);
+
+  return s;
+}
+
+VLIB_NODE_FN (gro_input_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  gso_main_t *gm = &gso_main;
+  gro_flow_table_t *flow_table;
+  vlib_buffer_t *bufs[GRO_TO_VECTOR_SIZE (VLIB_FRAME_SIZE)], **b = bufs;
+  u32 to[GRO_TO_VECTOR_SIZE (VLIB_FRAME_SIZE)];
+  u16 nexts[GRO_TO_VECTOR_SIZE (VLIB_FRAME_SIZE)], *next = nexts;
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_to, n_left;
+
+  flow_table = vec_elt (gm->gro_input_flow_tables, vm->thread_index);
+  n_to = vnet_gro_inline (vm, flow_table, from, frame->n_vectors, to);
+
+  if (gro_flow_table_is_timeout (vm, flow_table))
+    {
+      n_to += vnet_gro_flow_table_flush (vm, flow_table, to + n_to);
+      gro_flow_table_set_timeout (vm, flow_table, GRO_FLOW_TABLE_FLUSH);
+    }
+
+  vlib_get_buffers (vm, to, bufs, n_to);
+
+  n_left = n_to;
+  while (n_left)
+    {
+      vnet_feature_next_u16 (next, b[0]);
+
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  gro_input_trace_t *t = vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+	  t->length = vlib_buffer_length_in_chain (vm, b[0]);
+	  t->is_gso = (b[0]->flags & VNET_BUFFER_F_GSO) != 0;
+	  t->gso_size = vnet_buffer2 (b[0])->gso_size;
+	}
+
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, to, nexts, n_to);
+
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (gro_input_node) = {
+  .name = "gro-input",
+  .vector_size = sizeof (u32),
+  .format_trace = format_gro_input_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "error-drop",
+  },
+};
+
+VNET_FEATURE_INIT (gro_input_node, static) = {
+  .arc_name = "device-input",
+  .node_name = "gro-input",
+  .runs_before = VNET_FEATURES ("ethernet-input"),
+};
+
+#ifndef CLIB_MARCH_VARIANT
+/**
+ * The flows of a thread that stops receiving would otherwise wait for the
+ * next frame. Expired flows are sent through gro-input, which passes the
+ * coalesced packets to the next feature.
+ */
+static uword
+gro_input_flush (vlib_main_t *vm, vlib_node_runtime_t *node,
+		 vlib_frame_t *frame)
+{
+  gso_main_t *gm = &gso_main;
+  gro_flow_table_t *flow_table;
+  u32 to[GRO_FLOW_TABLE_MAX_SIZE], n_to, *f_to;
+  vlib_frame_t *f;
+
+  flow_table = vec_elt (gm->gro_input_flow_tables, vm->thread_index);
+  if (flow_table->flow_table_size == 0 ||
+      !gro_flow_table_is_timeout (vm, flow_table))
+    return 0;
+
+  n_to = vnet_gro_flow_table_flush (vm, flow_table, to);
+  gro_flow_table_set_timeout (vm, flow_table, GRO_FLOW_TABLE_FLUSH);
+  if (n_to == 0)
+    return 0;
+
+  f = vlib_get_frame_to_node (vm, gro_input_node.index);
+  f_to = vlib_frame_vector_args (f);
+  vlib_buffer_copy_indices (f_to, to, n_to);
+  f->n_vectors = n_to;
+  vlib_put_frame_to_node (vm, gro_input_node.index, f);
+
+  return n_to;
+}
+
+VLIB_REGISTER_NODE (gro_input_flush_node) = {
+  .function = gro_input_flush,
+  .type = VLIB_NODE_TYPE_PRE_INPUT,
+  .name = "gro-input-flush",
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+#endif /* CLIB_MARCH_VARIANT */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
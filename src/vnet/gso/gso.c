@@ -41,6 +41,83 @@ vnet_sw_interface_gso_enable_disable (u32 sw_if_index, u8 enable)
   return (0);
 }
 
+/*
+ * Free the packets the threads still hold in their flow tables. Called
+ * before the flush node is disabled, nothing would send them on after.
+ */
+static void
+gro_input_flow_tables_free_flows (void)
+{
+  gso_main_t *gm = &gso_main;
+  vlib_main_t *vm = vlib_get_main ();
+  gro_flow_table_t *flow_table;
+  gro_flow_t *gro_flow;
+  u32 i, j;
+
+  vec_foreach_index (i, gm->gro_input_flow_tables)
+    {
+      flow_table = gm->gro_input_flow_tables[i];
+      for (j = 0; j < GRO_FLOW_TABLE_MAX_SIZE; j++)
+	{
+	  gro_flow = &flow_table->gro_flow[j];
+	  if (gro_flow->n_buffers == 0)
+	    continue;
+	  vlib_buffer_free_one (vm, gro_flow->buffer_index);
+	  gro_flow_table_reset_flow (flow_table, gro_flow);
+	}
+    }
+}
+
+int
+vnet_sw_interface_gro_enable_disable (u32 sw_if_index, u8 enable)
+{
+  gso_main_t *gm = &gso_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_sw_interface_t *sw;
+  vnet_hw_interface_t *hw;
+  u32 i;
+
+  sw = vnet_get_sw_interface_or_null (vnm, sw_if_index);
+  if (!sw || sw->type != VNET_SW_INTERFACE_TYPE_HARDWARE)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  hw = vnet_get_hw_interface (vnm, sw->hw_if_index);
+  if (hw->hw_class_index != ethernet_hw_interface_class.index)
+    return VNET_API_ERROR_FEATURE_DISABLED;
+
+  enable = enable != 0;
+  if (clib_bitmap_get (gm->gro_input_enabled_by_sw_if_index, sw_if_index) ==
+      enable)
+    return 0;
+
+  if (enable && !gm->gro_input_flow_tables)
+    {
+      vec_validate (gm->gro_input_flow_tables, vlib_num_workers ());
+      vec_foreach_index (i, gm->gro_input_flow_tables)
+	gro_flow_table_init (&gm->gro_input_flow_tables[i], 1 /* is_l2 */,
+			     gro_input_node.index);
+    }
+
+  gm->gro_input_enabled_by_sw_if_index = clib_bitmap_set (
+    gm->gro_input_enabled_by_sw_if_index, sw_if_index, enable);
+
+  vnet_feature_enable_disable ("device-input", "gro-input", sw_if_index,
+			       enable, 0, 0);
+
+  if (clib_bitmap_is_zero (gm->gro_input_enabled_by_sw_if_index))
+    gro_input_flow_tables_free_flows ();
+
+  /* flush the flows of idle threads while any interface coalesces */
+  foreach_vlib_main ()
+    vlib_node_set_state (
+      this_vlib_main, gro_input_flush_node.index,
+      clib_bitmap_is_zero (gm->gro_input_enabled_by_sw_if_index) ?
+	VLIB_NODE_STATE_DISABLED :
+	VLIB_NODE_STATE_POLLING);
+
+  return 0;
+}
+
 static clib_error_t *
 gso_init (vlib_main_t * vm)
 {
@@ -18,6 +18,7 @@
 
 #include <vnet/vnet.h>
 #include <vnet/gso/hdr_offset_parser.h>
+#include <vnet/gso/gro.h>
 #include <vnet/ip/ip_psh_cksum.h>
 
 typedef struct
@@ -25,11 +26,19 @@ typedef struct
   vlib_main_t *vlib_main;
   vnet_main_t *vnet_main;
   u16 msg_id_base;
+
+  /* per-thread flow tables of the gro-input feature */
+  gro_flow_table_t **gro_input_flow_tables;
+  /* interfaces the gro-input feature is enabled on */
+  uword *gro_input_enabled_by_sw_if_index;
 } gso_main_t;
 
 extern gso_main_t gso_main;
+extern vlib_node_registration_t gro_input_node;
+extern vlib_node_registration_t gro_input_flush_node;
 
 int vnet_sw_interface_gso_enable_disable (u32 sw_if_index, u8 enable);
+int vnet_sw_interface_gro_enable_disable (u32 sw_if_index, u8 enable);
 u32 gso_segment_buffer (vlib_main_t *vm, vnet_interface_per_thread_data_t *ptd,
 			u32 bi, vlib_buffer_t *b, generic_header_offset_t *gho,
 			u32 n_bytes_b, u8 is_l2, u8 is_ip6);
@@ -17,13 +17,61 @@
 #include <vnet/vnet.h>
 #include <vnet/hash/hash.h>
 #include <vlib/threads.h>
+#include <vlib/stats/stats.h>
 #include <vnet/feature/feature.h>
 
+/*
+ * Rebalancing. Each thread samples one packet in HANDOFF_SAMPLE_INTERVAL
+ * into a space-saving sketch of the heaviest flows (by hash). Once a
+ * second the main thread moves the heavy flows of the workers loaded above
+ * the mean to the least loaded workers, through a table of redirected
+ * hashes per interface. Redirected flows may be reordered when they move,
+ * so this is enabled per interface.
+ */
+#define HANDOFF_SAMPLE_INTERVAL	    16
+#define HANDOFF_N_HEAVY_HITTERS	    32
+#define HANDOFF_N_REDIRECTS	    256
+/* samples needed to consider moving a flow */
+#define HANDOFF_HEAVY_HITTER_MIN    64
+/* intervals a redirected flow stays redirected while not heavy */
+#define HANDOFF_REDIRECT_MAX_AGE    8
+/* load above the mean from which a worker sheds flows, in percent */
+#define HANDOFF_REBALANCE_TOLERANCE 10
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 hash;
+  u32 count;
+} handoff_heavy_hitter_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  handoff_heavy_hitter_t heavy_hitters[HANDOFF_N_HEAVY_HITTERS];
+  u32 n_samples;
+  u32 sample_countdown;
+  /* set by the main thread to have the sketch cleared */
+  volatile u8 clear;
+} handoff_per_thread_t;
+
+typedef struct
+{
+  u32 hash;
+  u16 worker;
+  u8 valid;
+  /* intervals since the flow was last seen heavy, main thread only */
+  u8 age;
+} handoff_redirect_t;
+
 typedef struct
 {
   vnet_hash_fn_t hash_fn;
   uword *workers_bitmap;
   u32 *workers;
+  u8 rebalance;
+  /* HANDOFF_N_REDIRECTS entries indexed by hash, if rebalancing */
+  handoff_redirect_t *redirects;
 } per_inteface_handoff_data_t;
 
 typedef struct
@@ -36,6 +84,18 @@ typedef struct
 
   /* Worker handoff index */
   u32 frame_queue_index;
+
+  handoff_per_thread_t *per_thread;
+
+  /* packets handed off to each worker */
+  vlib_simple_counter_main_t worker_counters;
+
+  /* rebalancing, main thread */
+  u32 n_rebalance;
+  u32 rebalance_process_index;
+  u32 imbalance_gauge;
+  u64 *last_worker_counts;
+  u64 *worker_load;
 } handoff_main_t;
 
 extern handoff_main_t handoff_main;
@@ -83,6 +143,38 @@ format_worker_handoff_trace (u8 * s, va_list * args)
   return s;
 }
 
+static_always_inline void
+worker_handoff_sample (handoff_per_thread_t *ptd, u32 sw_if_index, u32 hash)
+{
+  handoff_heavy_hitter_t *hh, *min = ptd->heavy_hitters;
+
+  if (PREDICT_FALSE (ptd->clear))
+    {
+      clib_memset (ptd->heavy_hitters, 0, sizeof (ptd->heavy_hitters));
+      ptd->n_samples = 0;
+      ptd->clear = 0;
+    }
+
+  ptd->n_samples++;
+
+  for (hh = ptd->heavy_hitters;
+       hh < ptd->heavy_hitters + HANDOFF_N_HEAVY_HITTERS; hh++)
+    {
+      if (hh->count && hh->hash == hash && hh->sw_if_index == sw_if_index)
+	{
+	  hh->count++;
+	  return;
+	}
+      if (hh->count < min->count)
+	min = hh;
+    }
+
+  /* replace the least counted flow, inheriting its count */
+  min->sw_if_index = sw_if_index;
+  min->hash = hash;
+  min->count++;
+}
+
 static void
 worker_handoff_trace_frame (vlib_main_t *vm, vlib_node_runtime_t *node,
 			    vlib_buffer_t **bufs, u16 *threads, u32 n_vectors)
@@ -112,6 +204,8 @@ VLIB_NODE_FN (worker_handoff_node) (vlib_main_t * vm,
 				    vlib_frame_t * frame)
 {
   handoff_main_t *hm = &handoff_main;
+  handoff_per_thread_t *ptd =
+    vec_elt_at_index (hm->per_thread, vm->thread_index);
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
   u32 n_enq, n_left_from, *from;
   u16 thread_indices[VLIB_FRAME_SIZE], *ti;
@@ -126,7 +220,8 @@ VLIB_NODE_FN (worker_handoff_node) (vlib_main_t * vm,
   while (n_left_from > 0)
     {
       per_inteface_handoff_data_t *ihd0;
-      u32 sw_if_index0, hash, index0;
+      handoff_redirect_t *redirects, *r;
+      u32 sw_if_index0, hash, index0, worker0;
       void *data;
 
       sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
@@ -144,7 +239,27 @@ VLIB_NODE_FN (worker_handoff_node) (vlib_main_t * vm,
       else
 	index0 = hash % vec_len (ihd0->workers);
 
-      ti[0] = hm->first_worker_index + ihd0->workers[index0];
+      worker0 = ihd0->workers[index0];
+
+      redirects = __atomic_load_n (&ihd0->redirects, __ATOMIC_ACQUIRE);
+      if (PREDICT_FALSE (redirects != 0))
+	{
+	  r = redirects + (hash & (HANDOFF_N_REDIRECTS - 1));
+	  if (r->valid && r->hash == hash)
+	    worker0 = r->worker;
+
+	  if (--ptd->sample_countdown == 0)
+	    {
+	      ptd->sample_countdown = HANDOFF_SAMPLE_INTERVAL;
+	      worker_handoff_sample (ptd, sw_if_index0, hash);
+	    }
+
+	  /* the worker load is only needed to rebalance */
+	  vlib_increment_simple_counter (&hm->worker_counters,
+					 vm->thread_index, worker0, 1);
+	}
+
+      ti[0] = hm->first_worker_index + worker0;
 
       /* next */
       n_left_from -= 1;
@@ -182,6 +297,243 @@ VLIB_REGISTER_NODE (worker_handoff_node) = {
 
 #ifndef CLIB_MARCH_VARIANT
 
+static void
+handoff_redirects_free_deferred (uword data)
+{
+  handoff_redirect_t *redirects = uword_to_pointer (data, handoff_redirect_t *);
+  vec_free (redirects);
+}
+
+static void
+handoff_redirects_swap (per_inteface_handoff_data_t *d,
+			handoff_redirect_t *redirects)
+{
+  handoff_redirect_t *old = d->redirects;
+
+  __atomic_store_n (&d->redirects, redirects, __ATOMIC_RELEASE);
+  if (old)
+    vlib_worker_defer_one_loop (handoff_redirects_free_deferred,
+				pointer_to_uword (old));
+}
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 hash;
+  u64 n_packets;
+} handoff_elephant_t;
+
+static int
+handoff_elephant_sort (void *a1, void *a2)
+{
+  handoff_elephant_t *e1 = a1, *e2 = a2;
+
+  if (e1->n_packets == e2->n_packets)
+    return 0;
+  return e1->n_packets < e2->n_packets ? 1 : -1;
+}
+
+static u32
+handoff_least_loaded_worker (per_inteface_handoff_data_t *d, u64 *load)
+{
+  u32 *w, best = d->workers[0];
+
+  vec_foreach (w, d->workers)
+    if (load[w[0]] < load[best])
+      best = w[0];
+
+  return best;
+}
+
+/*
+ * Measure the load of the workers over the last interval, and move the
+ * heavy flows of the workers loaded above the mean.
+ */
+static void
+handoff_rebalance (vlib_main_t *vm)
+{
+  handoff_main_t *hm = &handoff_main;
+  handoff_elephant_t *elephants = 0, *e;
+  handoff_redirect_t **new_redirects = 0, *r;
+  per_inteface_handoff_data_t *d;
+  handoff_heavy_hitter_t *hh;
+  handoff_per_thread_t *ptd;
+  u64 total = 0, max = 0, mean, *load, count;
+  u32 i, cur, dst;
+
+  vec_validate (hm->last_worker_counts, hm->num_workers - 1);
+  vec_validate (hm->worker_load, hm->num_workers - 1);
+  load = hm->worker_load;
+
+  for (i = 0; i < hm->num_workers; i++)
+    {
+      count = vlib_get_simple_counter (&hm->worker_counters, i);
+      load[i] = count - hm->last_worker_counts[i];
+      hm->last_worker_counts[i] = count;
+      total += load[i];
+      max = clib_max (max, load[i]);
+    }
+
+  mean = total / hm->num_workers;
+  vlib_stats_set_gauge (hm->imbalance_gauge, mean ? max * 100 / mean : 100);
+
+  /* the flows heavier than a slot of the sketch on average */
+  vec_foreach (ptd, hm->per_thread)
+    {
+      for (hh = ptd->heavy_hitters;
+	   hh < ptd->heavy_hitters + HANDOFF_N_HEAVY_HITTERS; hh++)
+	{
+	  if (hh->count < HANDOFF_HEAVY_HITTER_MIN ||
+	      (u64) hh->count * HANDOFF_N_HEAVY_HITTERS < ptd->n_samples ||
+	      hh->sw_if_index >= vec_len (hm->if_data) ||
+	      !hm->if_data[hh->sw_if_index].rebalance)
+	    continue;
+
+	  vec_add2 (elephants, e, 1);
+	  e->sw_if_index = hh->sw_if_index;
+	  e->hash = hh->hash;
+	  e->n_packets = (u64) hh->count * HANDOFF_SAMPLE_INTERVAL;
+	}
+      ptd->clear = 1;
+    }
+
+  vec_sort_with_function (elephants, handoff_elephant_sort);
+
+  /* work on copies of the tables, swapped in at the end */
+  vec_validate (new_redirects, vec_len (hm->if_data) - 1);
+  vec_foreach_index (i, hm->if_data)
+    {
+      d = hm->if_data + i;
+      if (!d->rebalance)
+	continue;
+      new_redirects[i] = vec_dup (d->redirects);
+      vec_foreach (r, new_redirects[i])
+	if (r->valid)
+	  r->age++;
+    }
+
+  vec_foreach (e, elephants)
+    {
+      d = hm->if_data + e->sw_if_index;
+      r = new_redirects[e->sw_if_index] +
+	  (e->hash & (HANDOFF_N_REDIRECTS - 1));
+
+      if (r->valid && r->hash == e->hash)
+	{
+	  r->age = 0;
+	  cur = r->worker;
+	}
+      else if (is_pow2 (vec_len (d->workers)))
+	cur = d->workers[e->hash & (vec_len (d->workers) - 1)];
+      else
+	cur = d->workers[e->hash % vec_len (d->workers)];
+
+      if (load[cur] * 100 <= mean * (100 + HANDOFF_REBALANCE_TOLERANCE))
+	continue;
+
+      dst = handoff_least_loaded_worker (d, load);
+      if (load[dst] + e->n_packets >= load[cur])
+	continue;
+
+      load[cur] -= clib_min (load[cur], e->n_packets);
+      load[dst] += e->n_packets;
+      r->hash = e->hash;
+      r->worker = dst;
+      r->valid = 1;
+      r->age = 0;
+    }
+
+  vec_foreach_index (i, hm->if_data)
+    {
+      d = hm->if_data + i;
+      if (!d->rebalance)
+	continue;
+
+      vec_foreach (r, new_redirects[i])
+	if (r->valid && r->age > HANDOFF_REDIRECT_MAX_AGE)
+	  r->valid = 0;
+
+      if (memcmp (new_redirects[i], d->redirects,
+		  HANDOFF_N_REDIRECTS * sizeof (r[0])))
+	handoff_redirects_swap (d, new_redirects[i]);
+      else
+	vec_free (new_redirects[i]);
+    }
+
+  vec_free (new_redirects);
+  vec_free (elephants);
+}
+
+static uword
+handoff_rebalance_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
+			   vlib_frame_t *f)
+{
+  handoff_main_t *hm = &handoff_main;
+
+  while (1)
+    {
+      if (hm->n_rebalance)
+	vlib_process_wait_for_event_or_clock (vm, 1.0);
+      else
+	vlib_process_wait_for_event (vm);
+      vlib_process_get_events (vm, 0);
+
+      if (hm->n_rebalance)
+	handoff_rebalance (vm);
+    }
+  return 0;
+}
+
+VLIB_REGISTER_NODE (handoff_rebalance_process_node) = {
+  .function = handoff_rebalance_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "handoff-rebalance-process",
+};
+
+static void
+handoff_set_rebalance (per_inteface_handoff_data_t *d, int enable)
+{
+  handoff_main_t *hm = &handoff_main;
+  handoff_redirect_t *redirects = 0;
+
+  if (d->rebalance == (enable != 0))
+    return;
+
+  d->rebalance = enable != 0;
+
+  if (enable)
+    {
+      if (hm->imbalance_gauge == 0)
+	hm->imbalance_gauge = vlib_stats_add_gauge ("/net/handoff/imbalance");
+      vec_validate_aligned (redirects, HANDOFF_N_REDIRECTS - 1,
+			    CLIB_CACHE_LINE_BYTES);
+      hm->n_rebalance++;
+      vlib_process_signal_event (vlib_get_main (),
+				 handoff_rebalance_process_node.index, 0, 0);
+    }
+  else
+    hm->n_rebalance--;
+
+  handoff_redirects_swap (d, redirects);
+}
+
+int
+interface_handoff_set_rebalance (vlib_main_t *vm, u32 sw_if_index,
+				 int enable)
+{
+  handoff_main_t *hm = &handoff_main;
+  per_inteface_handoff_data_t *d;
+
+  if (sw_if_index >= vec_len (hm->if_data) ||
+      vec_len (hm->if_data[sw_if_index].workers) == 0)
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  d = vec_elt_at_index (hm->if_data, sw_if_index);
+  handoff_set_rebalance (d, enable);
+
+  return 0;
+}
+
 int
 interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
 				  uword *bitmap, u8 is_sym, int is_l4,
@@ -212,6 +564,9 @@ interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
   vec_validate (hm->if_data, sw_if_index);
   d = vec_elt_at_index (hm->if_data, sw_if_index);
 
+  /* the workers change, so do the redirected flows */
+  handoff_set_rebalance (d, 0);
+
   vec_free (d->workers);
   vec_free (d->workers_bitmap);
 
@@ -254,7 +609,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 				  unformat_input_t * input,
 				  vlib_cli_command_t * cmd)
 {
-  u32 sw_if_index = ~0, is_sym = 0, is_l4 = 0;
+  u32 sw_if_index = ~0, is_sym = 0, is_l4 = 0, rebalance = 0;
   int enable_disable = 1;
   uword *bitmap = 0;
   int rv = 0;
@@ -274,6 +629,8 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 	is_sym = 0;
       else if (unformat (input, "l4"))
 	is_l4 = 1;
+      else if (unformat (input, "rebalance"))
+	rebalance = 1;
       else
 	break;
     }
@@ -286,6 +643,8 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 
   rv = interface_handoff_enable_disable (vm, sw_if_index, bitmap, is_sym,
 					 is_l4, enable_disable);
+  if (rv == 0 && enable_disable && rebalance)
+    rv = interface_handoff_set_rebalance (vm, sw_if_index, 1);
 
   switch (rv)
     {
@@ -315,10 +674,48 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 VLIB_CLI_COMMAND (set_interface_handoff_command, static) = {
   .path = "set interface handoff",
   .short_help = "set interface handoff <interface-name> workers <workers-list>"
-		" [symmetrical|asymmetrical]",
+		" [symmetrical|asymmetrical] [l4] [rebalance] [disable]",
   .function = set_interface_handoff_command_fn,
 };
 
+static clib_error_t *
+show_interface_handoff_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				   vlib_cli_command_t *cmd)
+{
+  handoff_main_t *hm = &handoff_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  per_inteface_handoff_data_t *d;
+  handoff_redirect_t *r;
+  u32 i;
+
+  for (i = 0; i < hm->num_workers; i++)
+    vlib_cli_output (vm, "worker %u: %llu packets handed off, %llu last "
+		     "interval", i,
+		     vlib_get_simple_counter (&hm->worker_counters, i),
+		     i < vec_len (hm->worker_load) ? hm->worker_load[i] : 0);
+
+  vec_foreach (d, hm->if_data)
+    {
+      if (vec_len (d->workers) == 0)
+	continue;
+      vlib_cli_output (vm, "%U: workers %U%s", format_vnet_sw_if_index_name,
+		       vnm, d - hm->if_data, format_bitmap_list,
+		       d->workers_bitmap, d->rebalance ? " rebalance" : "");
+      vec_foreach (r, d->redirects)
+	if (r->valid)
+	  vlib_cli_output (vm, "  hash 0x%08x -> worker %u", r->hash,
+			   r->worker);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_interface_handoff_command, static) = {
+  .path = "show interface handoff",
+  .short_help = "show interface handoff",
+  .function = show_interface_handoff_command_fn,
+};
+
 clib_error_t *
 handoff_init (vlib_main_t * vm)
 {
@@ -345,6 +742,21 @@ handoff_init (vlib_main_t * vm)
 
   hm->frame_queue_index = ~0;
 
+  /* the worker threads are not started yet, size for all of them */
+  vec_validate_aligned (hm->per_thread,
+			vlib_get_thread_main ()->n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
+  for (u32 i = 0; i < vec_len (hm->per_thread); i++)
+    hm->per_thread[i].sample_countdown = HANDOFF_SAMPLE_INTERVAL;
+
+  hm->worker_counters.name = "handoff-workers";
+  hm->worker_counters.stat_segment_name = "/net/handoff/workers";
+  if (hm->num_workers)
+    {
+      vlib_validate_simple_counter (&hm->worker_counters,
+				    hm->num_workers - 1);
+    }
+
   return 0;
 }
 
@@ -1486,6 +1486,7 @@ set_hw_interface_change_rx_mode (vnet_main_t * vnm, u32 hw_if_index,
 			VNET_DEV_PORT_CFG_RXQ_INTR_MODE_ENABLE,
 	.queue_id = queue_id_valid ? queue_id : 0,
 	.all_queues = queue_id_valid ? 0 : 1,
+	.adaptive_mode = mode == VNET_HW_IF_RX_MODE_ADAPTIVE,
       };
 
       if ((rv = vnet_dev_port_cfg_change_req_validate (vm, port, &req)))
@@ -473,6 +473,12 @@ set_root_leaf (ip4_mtrie_16_t *m, const ip4_mtrie_set_unset_leaf_args_t *a)
     }
 }
 
+static void
+ply_free_deferred (uword ply_index)
+{
+  pool_put_index (ip4_ply_pool, ply_index);
+}
+
 static uword
 unset_leaf (const ip4_mtrie_set_unset_leaf_args_t *a,
 	    ip4_mtrie_8_ply_t *old_ply, u32 dst_address_byte_index)
@@ -522,7 +528,9 @@ unset_leaf (const ip4_mtrie_set_unset_leaf_args_t *a,
 	  ASSERT (old_ply->n_non_empty_leafs >= 0);
 	  if (old_ply->n_non_empty_leafs == 0 && dst_address_byte_index > 0)
 	    {
-	      pool_put (ip4_ply_pool, old_ply);
+	      /* Workers may still be walking it; free once they are not. */
+	      vlib_worker_defer_one_loop (ply_free_deferred,
+					  old_ply - ip4_ply_pool);
 	      /* Old ply was deleted. */
 	      return 1;
 	    }
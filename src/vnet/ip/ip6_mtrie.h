@@ -0,0 +1,248 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * ip/ip6_mtrie.h: ip6 mtrie fib
+ *
+ * A 16-8-8-...-8 stride multiway trie for IPv6 longest prefix match.
+ * It follows the design of the IPv4 mtrie (see ip4_mtrie.h): a 64k slot
+ * root PLY indexed by the first 16 bits of the address, followed by
+ * 256 slot PLYs, one per subsequent address byte. The number of memory
+ * accesses per lookup is bounded by the length of the longest prefix in
+ * the table: 1 + ((len - 16) / 8), rounded up, and is independent of the
+ * number of distinct prefix lengths present.
+ */
+
+#ifndef included_ip_ip6_mtrie_h
+#define included_ip_ip6_mtrie_h
+
+#include <vppinfra/cache.h>
+#include <vppinfra/vector.h>
+#include <vnet/ip/ip6_packet.h>	/* for ip6_address_t */
+
+/* ip6 fib leafs:
+   1 + 2*adj_index for terminal leaves.
+   0 + 2*next_ply_index for non-terminals, i.e. PLYs
+   1 => empty (adjacency index of zero is special miss adjacency). */
+typedef u32 ip6_mtrie_leaf_t;
+
+#define IP6_MTRIE_LEAF_EMPTY (1 + 2 * 0)
+
+/**
+ * @brief the 16 way stride that is the top PLY of the mtrie
+ */
+#define IP6_MTRIE_PLY_16_SIZE (1 << 16)
+typedef struct ip6_mtrie_16_ply_t_
+{
+  /**
+   * The leaves/slots/buckets to be filed with leafs
+   */
+  ip6_mtrie_leaf_t leaves[IP6_MTRIE_PLY_16_SIZE];
+
+  /**
+   * Prefix length for terminal leaves.
+   */
+  u8 dst_address_bits_of_leaves[IP6_MTRIE_PLY_16_SIZE];
+} ip6_mtrie_16_ply_t;
+
+/**
+ * @brief One 8 bit stride ply of the mtrie.
+ */
+typedef struct ip6_mtrie_8_ply_t_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /**
+   * The leaves/slots/buckets to be filed with leafs
+   */
+  ip6_mtrie_leaf_t leaves[256];
+
+  /**
+   * Prefix length for leaves/ply.
+   */
+  u8 dst_address_bits_of_leaves[256];
+
+  /**
+   * Number of non-empty leafs (whether terminal or not).
+   */
+  i32 n_non_empty_leafs;
+
+  /**
+   * The length of the ply's covering prefix. Also a measure of its depth
+   * If a leaf in a slot has a mask length longer than this then it is
+   * 'non-empty'. Otherwise it is the value of the cover.
+   */
+  i32 dst_address_bits_base;
+} ip6_mtrie_8_ply_t;
+
+STATIC_ASSERT (0 == sizeof (ip6_mtrie_8_ply_t) % CLIB_CACHE_LINE_BYTES,
+	       "IP6 Mtrie ply cache line");
+
+/**
+ * @brief The mutiway-TRIE with a 16-8-...-8 stride.
+ * The root ply is large (320k), so unlike the IPv4 mtrie it is not
+ * embedded in the FIB; a table that uses the mtrie allocates one.
+ */
+typedef struct ip6_mtrie_t_
+{
+  ip6_mtrie_16_ply_t root_ply;
+} ip6_mtrie_t;
+
+/**
+ * @brief Allocate and initialise an mtrie
+ */
+ip6_mtrie_t *ip6_mtrie_alloc (void);
+
+/**
+ * @brief Free an mtrie and all the plys it still references
+ */
+void ip6_mtrie_free (ip6_mtrie_t *m);
+
+/**
+ * @brief Add a route/entry to the mtrie
+ */
+void ip6_mtrie_route_add (ip6_mtrie_t *m, const ip6_address_t *dst_address,
+			  u32 dst_address_length, u32 adj_index);
+
+/**
+ * @brief remove a route/entry to the mtrie
+ */
+void ip6_mtrie_route_del (ip6_mtrie_t *m, const ip6_address_t *dst_address,
+			  u32 dst_address_length, u32 adj_index,
+			  u32 cover_address_length, u32 cover_adj_index);
+
+/**
+ * @brief return the memory used by the table
+ */
+uword ip6_mtrie_memory_usage (ip6_mtrie_t *m);
+
+/**
+ * @brief Format/display the contents of the mtrie
+ */
+format_function_t format_ip6_mtrie;
+
+/**
+ * @brief A global pool of 8bit stride plys
+ */
+extern ip6_mtrie_8_ply_t *ip6_ply_pool;
+
+/**
+ * Is the leaf terminal (i.e. an LB index) or non-terminal (i.e. a PLY index)
+ */
+always_inline u32
+ip6_mtrie_leaf_is_terminal (ip6_mtrie_leaf_t n)
+{
+  return n & 1;
+}
+
+/**
+ * From the stored slot value extract the LB index value
+ */
+always_inline u32
+ip6_mtrie_leaf_get_adj_index (ip6_mtrie_leaf_t n)
+{
+  ASSERT (ip6_mtrie_leaf_is_terminal (n));
+  return n >> 1;
+}
+
+/**
+ * @brief Lookup step number 1.  Processes 2 bytes of 16 byte ip6 address.
+ */
+always_inline ip6_mtrie_leaf_t
+ip6_mtrie_lookup_step_one (const ip6_mtrie_t *m,
+			   const ip6_address_t *dst_address)
+{
+  return (m->root_ply.leaves[dst_address->as_u16[0]]);
+}
+
+/**
+ * @brief Lookup step.  Processes 1 byte of 16 byte ip6 address.
+ */
+always_inline ip6_mtrie_leaf_t
+ip6_mtrie_lookup_step (ip6_mtrie_leaf_t current_leaf,
+		       const ip6_address_t *dst_address,
+		       u32 dst_address_byte_index)
+{
+  ip6_mtrie_8_ply_t *ply;
+
+  if (!ip6_mtrie_leaf_is_terminal (current_leaf))
+    {
+      ply = ip6_ply_pool + (current_leaf >> 1);
+      return (ply->leaves[dst_address->as_u8[dst_address_byte_index]]);
+    }
+
+  return current_leaf;
+}
+
+/**
+ * @brief Prefetch the slot the next lookup step will read.
+ */
+always_inline void
+ip6_mtrie_lookup_prefetch (ip6_mtrie_leaf_t current_leaf,
+			   const ip6_address_t *dst_address,
+			   u32 dst_address_byte_index)
+{
+  if (!ip6_mtrie_leaf_is_terminal (current_leaf))
+    {
+      ip6_mtrie_8_ply_t *ply = ip6_ply_pool + (current_leaf >> 1);
+      clib_prefetch_load (
+	&ply->leaves[dst_address->as_u8[dst_address_byte_index]]);
+    }
+}
+
+/**
+ * @brief Full longest prefix match; returns the LB index
+ */
+always_inline u32
+ip6_mtrie_lookup (const ip6_mtrie_t *m, const ip6_address_t *dst_address)
+{
+  ip6_mtrie_leaf_t leaf;
+  u32 i;
+
+  leaf = ip6_mtrie_lookup_step_one (m, dst_address);
+
+  for (i = 2; !ip6_mtrie_leaf_is_terminal (leaf); i++)
+    leaf = ip6_mtrie_lookup_step (leaf, dst_address, i);
+
+  return (ip6_mtrie_leaf_get_adj_index (leaf));
+}
+
+/**
+ * @brief Longest prefix match for two addresses.
+ * The walks proceed in lock-step so that the ply accesses of one
+ * address overlap with the (prefetched) accesses of the other.
+ */
+always_inline void
+ip6_mtrie_lookup_x2 (const ip6_mtrie_t *m0, const ip6_mtrie_t *m1,
+		     const ip6_address_t *dst0, const ip6_address_t *dst1,
+		     u32 *lb0, u32 *lb1)
+{
+  ip6_mtrie_leaf_t leaf0, leaf1;
+  u32 i;
+
+  leaf0 = ip6_mtrie_lookup_step_one (m0, dst0);
+  leaf1 = ip6_mtrie_lookup_step_one (m1, dst1);
+
+  for (i = 2; !(ip6_mtrie_leaf_is_terminal (leaf0) &&
+		ip6_mtrie_leaf_is_terminal (leaf1));
+       i++)
+    {
+      ip6_mtrie_lookup_prefetch (leaf1, dst1, i);
+      leaf0 = ip6_mtrie_lookup_step (leaf0, dst0, i);
+      ip6_mtrie_lookup_prefetch (leaf0, dst0, i + 1);
+      leaf1 = ip6_mtrie_lookup_step (leaf1, dst1, i);
+    }
+
+  *lb0 = ip6_mtrie_leaf_get_adj_index (leaf0);
+  *lb1 = ip6_mtrie_leaf_get_adj_index (leaf1);
+}
+
+#endif /* included_ip_ip6_mtrie_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -247,6 +247,7 @@ vnet_ip_route_cmd (vlib_main_t * vm,
 {
   unformat_input_t _line_input, *line_input = &_line_input;
   u32 table_id, is_del, fib_index, payload_proto;
+  fib_entry_flag_t eflags = FIB_ENTRY_FLAG_NONE;
   dpo_id_t dpo = DPO_INVALID, *dpos = NULL;
   fib_route_path_t *rpaths = NULL, rpath;
   fib_prefix_t *prefixs = NULL, pfx;
@@ -299,6 +300,8 @@ vnet_ip_route_cmd (vlib_main_t * vm,
 	is_del = 1;
       else if (unformat (line_input, "add"))
 	is_del = 0;
+      else if (unformat (line_input, "resilient"))
+	eflags |= FIB_ENTRY_FLAG_RESILIENT;
       else
 	{
 	  error = unformat_parse_error (line_input);
@@ -386,8 +389,7 @@ vnet_ip_route_cmd (vlib_main_t * vm,
 	      else
 		fib_table_entry_path_add2 (fib_index,
 					   &rpfx,
-					   FIB_SOURCE_CLI,
-					   FIB_ENTRY_FLAG_NONE, rpaths);
+					   FIB_SOURCE_CLI, eflags, rpaths);
 
 	      fib_prefix_increment (&prefixs[i]);
 	    }
@@ -606,6 +608,10 @@ VLIB_CLI_COMMAND (vlib_cli_show_ip6_command, static) = {
  * second path, 1/4 following the first path:
  * @cliexcmd{ip route add 7.0.0.1/32 via 6.0.0.1 GigabitEthernet2/0/0 weight 1}
  * @cliexcmd{ip route add 7.0.0.1/32 via 6.0.0.2 GigabitEthernet2/0/0 weight 3}
+ * To keep the flows of the remaining paths on their path when paths are
+ * added or removed, for stateful devices behind the ECMP set, make the
+ * route resilient when adding its paths:
+ * @cliexcmd{ip route add 7.0.0.1/32 via 6.0.0.1 GigabitEthernet2/0/0 resilient}
  * To add a route to a particular FIB table (VRF), use:
  * @cliexcmd{ip route add 172.16.24.0/24 table 7 via GigabitEthernet2/0/0}
  * To add a route to drop the traffic:
@@ -614,7 +620,7 @@ VLIB_CLI_COMMAND (vlib_cli_show_ip6_command, static) = {
 VLIB_CLI_COMMAND (ip_route_command, static) = {
   .path = "ip route",
   .short_help = "ip route [add|del] [count <n>] <dst-ip-addr>/<width> [table "
-		"<table-id>] via [next-hop-address] [next-hop-interface] "
+		"<table-id>] [resilient] via [next-hop-address] [next-hop-interface] "
 		"[next-hop-table <value>] [weight <value>] [preference "
 		"<value>] [udp-encap <value>] [ip4-lookup-in-table <value>] "
 		"[ip6-lookup-in-table <value>] [mpls-lookup-in-table <value>] "
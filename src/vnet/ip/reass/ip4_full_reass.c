@@ -27,6 +27,7 @@
 #include <vppinfra/fifo.h>
 #include <vppinfra/bihash_16_8.h>
 #include <vnet/ip/reass/ip4_full_reass.h>
+#include <vnet/ip/reass/ip_full_reass_holes.h>
 #include <stddef.h>
 
 #define MSEC_PER_SEC 1000
@@ -69,6 +70,7 @@ typedef enum
   IP4_REASS_RC_INTERNAL_ERROR,
   IP4_REASS_RC_NO_BUF,
   IP4_REASS_RC_HANDOFF,
+  IP4_REASS_RC_INCONSISTENT_LENGTH,
 } ip4_full_reass_rc_t;
 
 typedef struct
@@ -128,6 +130,8 @@ typedef struct
   ip4_full_reass_key_t key;
   // time when last packet was received
   f64 last_heard;
+  // time when first packet was received
+  f64 first_heard;
   // internal id of this reassembly
   u64 id;
   // buffer index of first buffer in this reassembly context
@@ -151,16 +155,26 @@ typedef struct
   // thread which received fragment with offset 0 and which sends out the
   // completed reassembly
   clib_thread_index_t sendout_thread_index;
+  // the datagram can never complete - its buffers are gone and further
+  // fragments are dropped until the context times out
+  bool is_abandoned;
+  // blocks of payload received, must be last as it's cleared lazily
+  ip_full_reass_holes_t holes;
 } ip4_full_reass_t;
 
 typedef struct
 {
+  // arena of max_reass_n contexts, allocated up front
   ip4_full_reass_t *pool;
   u32 reass_n;
   u32 id_counter;
   // for pacing the main thread timeouts
   u32 last_id;
   clib_spinlock_t lock;
+  // completed reassemblies and the time they took
+  u64 n_reassembled;
+  f64 latency_sum;
+  f64 latency_max;
 } ip4_full_reass_per_thread_t;
 
 typedef struct
@@ -476,6 +490,19 @@ ip4_full_reass_drop_all (vlib_main_t *vm, vlib_node_runtime_t *node,
   vec_free (to_free);
 }
 
+/* Drop what was collected of a datagram that can never complete, but keep
+ * the context so the rest of its fragments are dropped until it times out,
+ * rather than each starting a new reassembly. */
+always_inline void
+ip4_full_reass_abandon (vlib_main_t *vm, vlib_node_runtime_t *node,
+			ip4_full_reass_t *reass)
+{
+  ip4_full_reass_drop_all (vm, node, reass);
+  reass->first_bi = ~0;
+  reass->data_len = 0;
+  reass->is_abandoned = true;
+}
+
 always_inline void
 sanitize_reass_buffers_add_missing (vlib_main_t *vm, ip4_full_reass_t *reass,
 				    u32 *bi0)
@@ -540,6 +567,7 @@ ip4_full_reass_init (ip4_full_reass_t * reass)
   reass->data_len = 0;
   reass->next_index = ~0;
   reass->error_next_index = ~0;
+  ip_full_reass_holes_init (&reass->holes);
 }
 
 always_inline ip4_full_reass_t *
@@ -569,8 +597,9 @@ again:
 
       if (now > reass->last_heard + rm->timeout)
 	{
-	  vlib_node_increment_counter (vm, node->node_index,
-				       IP4_ERROR_REASS_TIMEOUT, 1);
+	  if (!reass->is_abandoned)
+	    vlib_node_increment_counter (vm, node->node_index,
+					 IP4_ERROR_REASS_TIMEOUT, 1);
 	  ip4_full_reass_drop_all (vm, node, reass);
 	  ip4_full_reass_free (rm, rt, reass);
 	  reass = NULL;
@@ -579,7 +608,9 @@ again:
 
   if (reass)
     {
-      reass->last_heard = now;
+      // let an abandoned reassembly time out
+      if (!reass->is_abandoned)
+	reass->last_heard = now;
       return reass;
     }
 
@@ -590,8 +621,9 @@ again:
     }
   else
     {
+      // the arena is allocated up front, this doesn't grow the pool
       pool_get (rt->pool, reass);
-      clib_memset (reass, 0, sizeof (*reass));
+      clib_memset (reass, 0, STRUCT_OFFSET_OF (ip4_full_reass_t, holes));
       reass->id = ((u64) vm->thread_index * 1000000000) + rt->id_counter;
       reass->memory_owner_thread_index = vm->thread_index;
       ++rt->id_counter;
@@ -602,7 +634,7 @@ again:
   clib_memcpy_fast (&reass->key, &kv->kv.key, sizeof (reass->key));
   kv->v.reass_index = (reass - rt->pool);
   kv->v.memory_owner_thread_index = vm->thread_index;
-  reass->last_heard = now;
+  reass->last_heard = reass->first_heard = now;
 
   int rv = clib_bihash_add_del_16_8 (&rm->hash, &kv->kv, 2);
   if (rv)
@@ -823,6 +855,11 @@ ip4_full_reass_finalize (vlib_main_t * vm, vlib_node_runtime_t * node,
 			       IP4_ERROR_REASS_FRAGMENTS_REASSEMBLED,
 			       reass->fragments_n);
 
+  f64 latency = vlib_time_now (vm) - reass->first_heard;
+  ++rt->n_reassembled;
+  rt->latency_sum += latency;
+  rt->latency_max = clib_max (rt->latency_max, latency);
+
   *error0 = IP4_ERROR_NONE;
   ip4_full_reass_free (rm, rt, reass);
   reass = NULL;
@@ -947,6 +984,21 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   fvnb->ip.reass.range_first = fragment_first;
   fvnb->ip.reass.range_last = fragment_last;
   fvnb->ip.reass.next_range_bi = ~0;
+  if (PREDICT_FALSE (reass->is_abandoned))
+    {
+      *next0 = IP4_FULL_REASS_NEXT_DROP;
+      *error0 = IP4_ERROR_REASS_ABANDONED;
+      return IP4_REASS_RC_OK;
+    }
+  // a datagram has one end and no fragment goes beyond it
+  if (~0 != reass->last_packet_octet ?
+	(fragment_last > reass->last_packet_octet ||
+	 (!more_fragments && fragment_last != reass->last_packet_octet)) :
+	(!more_fragments && reass->holes.n_words &&
+	 fragment_last / 8 < reass->holes.last_block))
+    {
+      return IP4_REASS_RC_INCONSISTENT_LENGTH;
+    }
   if (!more_fragments)
     {
       reass->last_packet_octet = fragment_last;
@@ -960,6 +1012,8 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
 	{
 	  return rc;
 	}
+      ip_full_reass_holes_add (&reass->holes, fragment_first, fragment_last,
+			       !more_fragments);
       if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
 	{
 	  ip4_full_reass_add_trace (vm, node, reass, *bi0, RANGE_NEW, 0, ~0);
@@ -972,6 +1026,20 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   reass->min_fragment_length =
     clib_min (clib_net_to_host_u16 (fip->length),
 	      fvnb->ip.reass.estimated_mtu);
+  if (ip_full_reass_holes_covered (&reass->holes, fragment_first,
+				   fragment_last))
+    {
+      // nothing new in this fragment, no need to look at the ranges
+      ++reass->fragments_n;
+      if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  ip4_full_reass_add_trace (vm, node, reass, *bi0, RANGE_OVERLAP, 0,
+				    ~0);
+	}
+      *next0 = IP4_FULL_REASS_NEXT_DROP;
+      *error0 = IP4_ERROR_REASS_DUPLICATE_FRAGMENT;
+      return IP4_REASS_RC_OK;
+    }
   while (~0 != candidate_range_bi)
     {
       vlib_buffer_t *candidate_b = vlib_get_buffer (vm, candidate_range_bi);
@@ -1120,6 +1188,8 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   ++reass->fragments_n;
   if (consumed)
     {
+      ip_full_reass_holes_add (&reass->holes, fragment_first, fragment_last,
+			       !more_fragments);
       if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
 	{
 	  ip4_full_reass_add_trace (vm, node, reass, *bi0, RANGE_NEW, 0, ~0);
@@ -1144,7 +1214,16 @@ ip4_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
       if (consumed)
 	{
 	  *bi0 = ~0;
-	  if (reass->fragments_n > rm->max_reass_len)
+	  /* Each hole takes at least one more fragment, so give up as soon
+	   * as the holes can't all be filled within the limit, rather than
+	   * when the limit is hit. The fragment that completes a datagram
+	   * may go one beyond the limit. n fragments leave at most n + 1
+	   * holes, which saves counting them while far from the limit. */
+	  if (2 * reass->fragments_n > rm->max_reass_len &&
+	      reass->fragments_n +
+		  ip_full_reass_holes_count (&reass->holes,
+					     reass->last_packet_octet) >
+		rm->max_reass_len + 1)
 	    {
 	      rc = IP4_REASS_RC_TOO_MANY_FRAGMENTS;
 	    }
@@ -1259,6 +1338,7 @@ ip4_full_reass_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	{
 	  clib_thread_index_t handoff_thread_idx;
 	  u32 counter = ~0;
+	  bool abandon = false;
 	  switch (ip4_full_reass_update (vm, node, rm, rt, reass, &bi0, &next0,
 					 &error0, CUSTOM == type,
 					 &handoff_thread_idx))
@@ -1274,6 +1354,13 @@ ip4_full_reass_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      break;
 	    case IP4_REASS_RC_TOO_MANY_FRAGMENTS:
 	      counter = IP4_ERROR_REASS_FRAGMENT_CHAIN_TOO_LONG;
+	      abandon = true;
+	      break;
+	    case IP4_REASS_RC_INCONSISTENT_LENGTH:
+	      // this fragment isn't part of the reassembly, drop it with it
+	      next0 = IP4_FULL_REASS_NEXT_DROP;
+	      error0 = IP4_ERROR_REASS_MALFORMED_PACKET;
+	      ip4_full_reass_abandon (vm, node, reass);
 	      break;
 	    case IP4_REASS_RC_NO_BUF:
 	      counter = IP4_ERROR_REASS_NO_BUF;
@@ -1295,8 +1382,15 @@ ip4_full_reass_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  if (~0 != counter)
 	    {
 	      vlib_node_increment_counter (vm, node->node_index, counter, 1);
-	      ip4_full_reass_drop_all (vm, node, reass);
-	      ip4_full_reass_free (rm, rt, reass);
+	      if (abandon)
+		{
+		  ip4_full_reass_abandon (vm, node, reass);
+		}
+	      else
+		{
+		  ip4_full_reass_drop_all (vm, node, reass);
+		  ip4_full_reass_free (rm, rt, reass);
+		}
 	      goto next_packet;
 	    }
 	}
@@ -1517,6 +1611,24 @@ ip4_full_reass_set_params (u32 timeout_ms, u32 max_reassemblies,
   ip4_full_reass_main.expire_walk_interval_ms = expire_walk_interval_ms;
 }
 
+/* Contexts are only ever taken from the per-thread arena in the data path,
+ * so it's allocated for max_reass_n of them up front. It's not shrunk, as
+ * the contexts in use may be anywhere in it. */
+static void
+ip4_full_reass_alloc_arenas (void)
+{
+  ip4_full_reass_main_t *rm = &ip4_full_reass_main;
+  ip4_full_reass_per_thread_t *rt;
+
+  vec_foreach (rt, rm->per_thread_data)
+    {
+      clib_spinlock_lock (&rt->lock);
+      if (pool_max_len (rt->pool) < rm->max_reass_n)
+	pool_alloc (rt->pool, rm->max_reass_n - vec_len (rt->pool));
+      clib_spinlock_unlock (&rt->lock);
+    }
+}
+
 vnet_api_error_t
 ip4_full_reass_set (u32 timeout_ms, u32 max_reassemblies,
 		    u32 max_reassembly_length, u32 expire_walk_interval_ms)
@@ -1524,6 +1636,7 @@ ip4_full_reass_set (u32 timeout_ms, u32 max_reassemblies,
   u32 old_nbuckets = ip4_full_reass_get_nbuckets ();
   ip4_full_reass_set_params (timeout_ms, max_reassemblies,
 			     max_reassembly_length, expire_walk_interval_ms);
+  ip4_full_reass_alloc_arenas ();
   vlib_process_signal_event (ip4_full_reass_main.vlib_main,
 			     ip4_full_reass_main.ip4_full_reass_expire_node_idx,
 			     IP4_EVENT_CONFIG_CHANGED, 0);
@@ -1582,7 +1695,6 @@ ip4_full_reass_init_function (vlib_main_t * vm)
   vec_foreach (rt, rm->per_thread_data)
   {
     clib_spinlock_init (&rt->lock);
-    pool_alloc (rt->pool, rm->max_reass_n);
   }
 
   node = vlib_get_node_by_name (vm, (u8 *) "ip4-full-reassembly-expire-walk");
@@ -1593,6 +1705,7 @@ ip4_full_reass_init_function (vlib_main_t * vm)
 			     IP4_REASS_MAX_REASSEMBLIES_DEFAULT,
 			     IP4_REASS_MAX_REASSEMBLY_LENGTH_DEFAULT,
 			     IP4_REASS_EXPIRE_WALK_INTERVAL_DEFAULT_MS);
+  ip4_full_reass_alloc_arenas ();
 
   nbuckets = ip4_full_reass_get_nbuckets ();
   clib_bihash_init_16_8 (&rm->hash, "ip4-dr", nbuckets, nbuckets * 1024);
@@ -1677,19 +1790,21 @@ ip4_full_reass_walk_expired (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      rt->last_id = end;
 	    }
 
+	  u32 n_timeouts = 0;
 	  pool_foreach_stepping_index (index, beg, end, rt->pool)
 	  {
 	    reass = pool_elt_at_index (rt->pool, index);
 	    if (now > reass->last_heard + rm->timeout)
 	      {
 		vec_add1 (pool_indexes_to_free, index);
+		// an abandoned reassembly was accounted for when abandoned
+		n_timeouts += !reass->is_abandoned;
 	      }
 	  }
 
-	  if (vec_len (pool_indexes_to_free))
+	  if (n_timeouts)
 	    vlib_node_increment_counter (vm, node->node_index,
-					 IP4_ERROR_REASS_TIMEOUT,
-					 vec_len (pool_indexes_to_free));
+					 IP4_ERROR_REASS_TIMEOUT, n_timeouts);
 	  int *i;
           vec_foreach (i, pool_indexes_to_free)
           {
@@ -1792,6 +1907,11 @@ show_ip4_reass (vlib_main_t * vm,
   for (thread_index = 0; thread_index < nthreads; ++thread_index)
     {
       ip4_full_reass_per_thread_t *rt = &rm->per_thread_data[thread_index];
+      u32 reass_n, n_abandoned = 0;
+      uword arena_bytes;
+      u64 n_bytes = 0, n_reassembled;
+      f64 latency_sum, latency_max;
+
       clib_spinlock_lock (&rt->lock);
       if (details)
 	{
@@ -1799,8 +1919,27 @@ show_ip4_reass (vlib_main_t * vm,
             vlib_cli_output (vm, "%U", format_ip4_reass, vm, reass);
           }
 	}
-      sum_reass_n += rt->reass_n;
+      pool_foreach (reass, rt->pool)
+	{
+	  n_bytes += reass->data_len;
+	  n_abandoned += reass->is_abandoned;
+	}
+      reass_n = rt->reass_n;
+      arena_bytes = pool_max_len (rt->pool) * sizeof (rt->pool[0]);
+      n_reassembled = rt->n_reassembled;
+      latency_sum = rt->latency_sum;
+      latency_max = rt->latency_max;
       clib_spinlock_unlock (&rt->lock);
+
+      vlib_cli_output (
+	vm,
+	"Thread %u: %u reassemblies (%u abandoned), arena %U, "
+	"%lu bytes buffered, %lu completed, latency avg %.1fus max %.1fus",
+	thread_index, reass_n, n_abandoned, format_memory_size, arena_bytes,
+	n_bytes, n_reassembled,
+	n_reassembled ? latency_sum * 1e6 / n_reassembled : 0,
+	latency_max * 1e6);
+      sum_reass_n += reass_n;
     }
   vlib_cli_output (vm, "---------------------");
   vlib_cli_output (vm, "Current full IP4 reassemblies count: %lu\n",
@@ -25,6 +25,7 @@
 #include <vnet/ip/ip.h>
 #include <vppinfra/bihash_48_8.h>
 #include <vnet/ip/reass/ip6_full_reass.h>
+#include <vnet/ip/reass/ip_full_reass_holes.h>
 #include <vnet/ip/ip6_inlines.h>
 
 #define MSEC_PER_SEC 1000
@@ -46,6 +47,7 @@ typedef enum
   IP6_FULL_REASS_RC_HANDOFF,
   IP6_FULL_REASS_RC_INVALID_FRAG_LEN,
   IP6_FULL_REASS_RC_OVERLAP,
+  IP6_FULL_REASS_RC_INCONSISTENT_LENGTH,
 } ip6_full_reass_rc_t;
 
 typedef struct
@@ -108,6 +110,8 @@ typedef struct
   ip6_full_reass_key_t key;
   // time when last packet was received
   f64 last_heard;
+  // time when first packet was received
+  f64 first_heard;
   // internal id of this reassembly
   u64 id;
   // buffer index of first buffer in this reassembly context
@@ -131,16 +135,26 @@ typedef struct
   // thread which received fragment with offset 0 and which sends out the
   // completed reassembly
   u32 sendout_thread_index;
+  // the datagram can never complete - its buffers are gone and further
+  // fragments are dropped until the context times out
+  bool is_abandoned;
+  // blocks of payload received, must be last as it's cleared lazily
+  ip_full_reass_holes_t holes;
 } ip6_full_reass_t;
 
 typedef struct
 {
+  // arena of max_reass_n contexts, allocated up front
   ip6_full_reass_t *pool;
   u32 reass_n;
   u32 id_counter;
   // for pacing the main thread timeouts
   u32 last_id;
   clib_spinlock_t lock;
+  // completed reassemblies and the time they took
+  u64 n_reassembled;
+  f64 latency_sum;
+  f64 latency_max;
 } ip6_full_reass_per_thread_t;
 
 typedef struct
@@ -495,6 +509,20 @@ ip6_full_reass_drop_all (vlib_main_t *vm, vlib_node_runtime_t *node,
   vec_free (to_free);
 }
 
+/* Drop what was collected of a datagram that can never complete, but keep
+ * the context so the rest of its fragments are dropped until it times out,
+ * rather than each starting a new reassembly. */
+always_inline void
+ip6_full_reass_abandon (vlib_main_t *vm, vlib_node_runtime_t *node,
+			ip6_full_reass_t *reass, u32 *n_left_to_next,
+			u32 **to_next)
+{
+  ip6_full_reass_drop_all (vm, node, reass, n_left_to_next, to_next);
+  reass->first_bi = ~0;
+  reass->data_len = 0;
+  reass->is_abandoned = true;
+}
+
 always_inline void
 sanitize_reass_buffers_add_missing (vlib_main_t *vm, ip6_full_reass_t *reass,
 				    u32 *bi0)
@@ -621,8 +649,9 @@ again:
 
       if (now > reass->last_heard + rm->timeout)
 	{
-	  vlib_node_increment_counter (vm, node->node_index,
-				       IP6_ERROR_REASS_TIMEOUT, 1);
+	  if (!reass->is_abandoned)
+	    vlib_node_increment_counter (vm, node->node_index,
+					 IP6_ERROR_REASS_TIMEOUT, 1);
 	  ip6_full_reass_on_timeout (vm, node, reass, icmp_bi, n_left_to_next,
 				     to_next);
 	  ip6_full_reass_free (rm, rt, reass);
@@ -632,7 +661,9 @@ again:
 
   if (reass)
     {
-      reass->last_heard = now;
+      // let an abandoned reassembly time out
+      if (!reass->is_abandoned)
+	reass->last_heard = now;
       return reass;
     }
 
@@ -643,8 +674,9 @@ again:
     }
   else
     {
+      // the arena is allocated up front, this doesn't grow the pool
       pool_get (rt->pool, reass);
-      clib_memset (reass, 0, sizeof (*reass));
+      clib_memset (reass, 0, STRUCT_OFFSET_OF (ip6_full_reass_t, holes));
       reass->id = ((u64) vm->thread_index * 1000000000) + rt->id_counter;
       ++rt->id_counter;
       reass->first_bi = ~0;
@@ -653,12 +685,13 @@ again:
       reass->next_index = ~0;
       reass->error_next_index = ~0;
       reass->memory_owner_thread_index = vm->thread_index;
+      ip_full_reass_holes_init (&reass->holes);
       ++rt->reass_n;
     }
 
   kv->v.reass_index = (reass - rt->pool);
   kv->v.memory_owner_thread_index = vm->thread_index;
-  reass->last_heard = now;
+  reass->last_heard = reass->first_heard = now;
 
   if (!skip_bihash)
     {
@@ -924,6 +957,11 @@ ip6_full_reass_finalize (vlib_main_t * vm, vlib_node_runtime_t * node,
 			       IP6_ERROR_REASS_FRAGMENTS_REASSEMBLED,
 			       reass->fragments_n);
 
+  f64 latency = vlib_time_now (vm) - reass->first_heard;
+  ++rt->n_reassembled;
+  rt->latency_sum += latency;
+  rt->latency_max = clib_max (rt->latency_max, latency);
+
   ip6_full_reass_free (rm, rt, reass);
   reass = NULL;
 free_buffers_and_return:
@@ -1003,6 +1041,21 @@ ip6_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
   fvnb->ip.reass.range_first = fragment_first;
   fvnb->ip.reass.range_last = fragment_last;
   fvnb->ip.reass.next_range_bi = ~0;
+  if (PREDICT_FALSE (reass->is_abandoned))
+    {
+      *next0 = IP6_FULL_REASSEMBLY_NEXT_DROP;
+      *error0 = IP6_ERROR_REASS_ABANDONED;
+      return IP6_FULL_REASS_RC_OK;
+    }
+  // a datagram has one end and no fragment goes beyond it
+  if (~0 != reass->last_packet_octet ?
+	(fragment_last > reass->last_packet_octet ||
+	 (!more_fragments && fragment_last != reass->last_packet_octet)) :
+	(!more_fragments && reass->holes.n_words &&
+	 fragment_last / 8 < reass->holes.last_block))
+    {
+      return IP6_FULL_REASS_RC_INCONSISTENT_LENGTH;
+    }
   if (!more_fragments)
     {
       reass->last_packet_octet = fragment_last;
@@ -1067,6 +1120,8 @@ ip6_full_reass_update (vlib_main_t *vm, vlib_node_runtime_t *node,
 check_if_done_maybe:
   if (consumed)
     {
+      ip_full_reass_holes_add (&reass->holes, fragment_first, fragment_last,
+			       !more_fragments);
       if (PREDICT_FALSE (fb->flags & VLIB_BUFFER_IS_TRACED))
 	{
 	  ip6_full_reass_add_trace (vm, node, reass, *bi0, frag_hdr, RANGE_NEW,
@@ -1105,7 +1160,16 @@ check_if_done_maybe:
       if (consumed)
 	{
 	  *bi0 = ~0;
-	  if (reass->fragments_n > rm->max_reass_len)
+	  /* Each hole takes at least one more fragment, so give up as soon
+	   * as the holes can't all be filled within the limit, rather than
+	   * when the limit is hit. The fragment that completes a datagram
+	   * may go one beyond the limit. n fragments leave at most n + 1
+	   * holes, which saves counting them while far from the limit. */
+	  if (2 * reass->fragments_n > rm->max_reass_len &&
+	      reass->fragments_n +
+		  ip_full_reass_holes_count (&reass->holes,
+					     reass->last_packet_octet) >
+		rm->max_reass_len + 1)
 	    {
 	      return IP6_FULL_REASS_RC_TOO_MANY_FRAGMENTS;
 	    }
@@ -1322,6 +1386,7 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    {
 	      u32 handoff_thread_idx;
 	      u32 counter = ~0;
+	      bool abandon = false;
 	      switch (ip6_full_reass_update (
 		vm, node, rm, rt, reass, &bi0, &next0, &error0, frag_hdr,
 		is_custom_app, &handoff_thread_idx, skip_bihash))
@@ -1337,6 +1402,14 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		  break;
 		case IP6_FULL_REASS_RC_TOO_MANY_FRAGMENTS:
 		  counter = IP6_ERROR_REASS_FRAGMENT_CHAIN_TOO_LONG;
+		  abandon = true;
+		  break;
+		case IP6_FULL_REASS_RC_INCONSISTENT_LENGTH:
+		  // this fragment isn't part of the reassembly, drop it with it
+		  next0 = IP6_FULL_REASSEMBLY_NEXT_DROP;
+		  error0 = IP6_ERROR_REASS_INVALID_FRAG_LEN;
+		  ip6_full_reass_abandon (vm, node, reass, &n_left_to_next,
+					  &to_next);
 		  break;
 		case IP6_FULL_REASS_RC_NO_BUF:
 		  counter = IP6_ERROR_REASS_NO_BUF;
@@ -1345,7 +1418,12 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		  counter = IP6_ERROR_REASS_INVALID_FRAG_LEN;
 		  break;
 		case IP6_FULL_REASS_RC_OVERLAP:
-		  counter = IP6_ERROR_REASS_OVERLAPPING_FRAGMENT;
+		  /* RFC 5722: the whole datagram is discarded, including the
+		   * fragments yet to come */
+		  next0 = IP6_FULL_REASSEMBLY_NEXT_DROP;
+		  error0 = IP6_ERROR_REASS_OVERLAPPING_FRAGMENT;
+		  ip6_full_reass_abandon (vm, node, reass, &n_left_to_next,
+					  &to_next);
 		  break;
 		case IP6_FULL_REASS_RC_INTERNAL_ERROR:
 		  counter = IP6_ERROR_REASS_INTERNAL_ERROR;
@@ -1364,9 +1442,17 @@ ip6_full_reassembly_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		{
 		  vlib_node_increment_counter (vm, node->node_index, counter,
 					       1);
-		  ip6_full_reass_drop_all (vm, node, reass, &n_left_to_next,
-					   &to_next);
-		  ip6_full_reass_free (rm, rt, reass);
+		  if (abandon)
+		    {
+		      ip6_full_reass_abandon (vm, node, reass, &n_left_to_next,
+					      &to_next);
+		    }
+		  else
+		    {
+		      ip6_full_reass_drop_all (vm, node, reass,
+					       &n_left_to_next, &to_next);
+		      ip6_full_reass_free (rm, rt, reass);
+		    }
 		  goto next_packet;
 		  break;
 		}
@@ -1608,6 +1694,24 @@ ip6_full_reass_set_params (u32 timeout_ms, u32 max_reassemblies,
   ip6_full_reass_main.expire_walk_interval_ms = expire_walk_interval_ms;
 }
 
+/* Contexts are only ever taken from the per-thread arena in the data path,
+ * so it's allocated for max_reass_n of them up front. It's not shrunk, as
+ * the contexts in use may be anywhere in it. */
+static void
+ip6_full_reass_alloc_arenas (void)
+{
+  ip6_full_reass_main_t *rm = &ip6_full_reass_main;
+  ip6_full_reass_per_thread_t *rt;
+
+  vec_foreach (rt, rm->per_thread_data)
+    {
+      clib_spinlock_lock (&rt->lock);
+      if (pool_max_len (rt->pool) < rm->max_reass_n)
+	pool_alloc (rt->pool, rm->max_reass_n - vec_len (rt->pool));
+      clib_spinlock_unlock (&rt->lock);
+    }
+}
+
 vnet_api_error_t
 ip6_full_reass_set (u32 timeout_ms, u32 max_reassemblies,
 		    u32 max_reassembly_length, u32 expire_walk_interval_ms)
@@ -1615,6 +1719,7 @@ ip6_full_reass_set (u32 timeout_ms, u32 max_reassemblies,
   u32 old_nbuckets = ip6_full_reass_get_nbuckets ();
   ip6_full_reass_set_params (timeout_ms, max_reassemblies,
 			     max_reassembly_length, expire_walk_interval_ms);
+  ip6_full_reass_alloc_arenas ();
   vlib_process_signal_event (ip6_full_reass_main.vlib_main,
 			     ip6_full_reass_main.ip6_full_reass_expire_node_idx,
 			     IP6_EVENT_CONFIG_CHANGED, 0);
@@ -1673,7 +1778,6 @@ ip6_full_reass_init_function (vlib_main_t * vm)
   vec_foreach (rt, rm->per_thread_data)
   {
     clib_spinlock_init (&rt->lock);
-    pool_alloc (rt->pool, rm->max_reass_n);
   }
 
   node = vlib_get_node_by_name (vm, (u8 *) "ip6-full-reassembly-expire-walk");
@@ -1684,6 +1788,7 @@ ip6_full_reass_init_function (vlib_main_t * vm)
 			     IP6_FULL_REASS_MAX_REASSEMBLIES_DEFAULT,
 			     IP6_FULL_REASS_MAX_REASSEMBLY_LENGTH_DEFAULT,
 			     IP6_FULL_REASS_EXPIRE_WALK_INTERVAL_DEFAULT_MS);
+  ip6_full_reass_alloc_arenas ();
 
   nbuckets = ip6_full_reass_get_nbuckets ();
   clib_bihash_init_48_8 (&rm->hash, "ip6-full-reass", nbuckets,
@@ -1793,7 +1898,9 @@ ip6_full_reass_walk_expired (vlib_main_t *vm, vlib_node_runtime_t *node,
             ip6_full_reass_t *reass = pool_elt_at_index (rt->pool, i[0]);
             u32 icmp_bi = ~0;
 
-	    reass_timeout_cnt += reass->fragments_n;
+	    // an abandoned reassembly was accounted for when abandoned
+	    if (!reass->is_abandoned)
+	      reass_timeout_cnt += reass->fragments_n;
 	    ip6_full_reass_on_timeout (vm, node, reass, &icmp_bi,
 				       &n_left_to_next, &to_next);
 	    if (~0 != icmp_bi)
@@ -1921,6 +2028,11 @@ show_ip6_full_reass (vlib_main_t * vm, unformat_input_t * input,
   for (thread_index = 0; thread_index < nthreads; ++thread_index)
     {
       ip6_full_reass_per_thread_t *rt = &rm->per_thread_data[thread_index];
+      u32 reass_n, n_abandoned = 0;
+      uword arena_bytes;
+      u64 n_bytes = 0, n_reassembled;
+      f64 latency_sum, latency_max;
+
       clib_spinlock_lock (&rt->lock);
       if (details)
 	{
@@ -1928,8 +2040,27 @@ show_ip6_full_reass (vlib_main_t * vm, unformat_input_t * input,
             vlib_cli_output (vm, "%U", format_ip6_full_reass, vm, reass);
           }
 	}
-      sum_reass_n += rt->reass_n;
+      pool_foreach (reass, rt->pool)
+	{
+	  n_bytes += reass->data_len;
+	  n_abandoned += reass->is_abandoned;
+	}
+      reass_n = rt->reass_n;
+      arena_bytes = pool_max_len (rt->pool) * sizeof (rt->pool[0]);
+      n_reassembled = rt->n_reassembled;
+      latency_sum = rt->latency_sum;
+      latency_max = rt->latency_max;
       clib_spinlock_unlock (&rt->lock);
+
+      vlib_cli_output (
+	vm,
+	"Thread %u: %u reassemblies (%u abandoned), arena %U, "
+	"%lu bytes buffered, %lu completed, latency avg %.1fus max %.1fus",
+	thread_index, reass_n, n_abandoned, format_memory_size, arena_bytes,
+	n_bytes, n_reassembled,
+	n_reassembled ? latency_sum * 1e6 / n_reassembled : 0,
+	latency_max * 1e6);
+      sum_reass_n += reass_n;
     }
   vlib_cli_output (vm, "---------------------");
   vlib_cli_output (vm, "Current IP6 reassemblies count: %lu\n",
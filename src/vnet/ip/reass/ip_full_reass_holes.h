@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+/**
+ * @file
+ * @brief Hole tracking for IPv4 and IPv6 full reassembly.
+ *
+ * The payload of a datagram being reassembled is tracked as a bitmap of
+ * the 8 octet blocks fragments are made of. The bitmap is embedded in the
+ * reassembly context, so it costs no allocation, and it is cleared lazily,
+ * a word at a time as fragments reach it, so starting a reassembly is
+ * O(1). It answers whether a fragment brings anything new without walking
+ * the buffer chains, and how many holes are left, which bounds the number
+ * of fragments still needed to complete the datagram.
+ */
+
+#ifndef __included_ip_full_reass_holes_h__
+#define __included_ip_full_reass_holes_h__
+
+#include <vppinfra/clib.h>
+
+/* a datagram's payload is at most 64k, in blocks of 8 octets */
+#define IP_FULL_REASS_N_BLOCKS	    (65536 / 8)
+#define IP_FULL_REASS_N_BLOCK_WORDS (IP_FULL_REASS_N_BLOCKS / 64)
+
+typedef struct
+{
+  /* words at and beyond this one have not been cleared yet */
+  u16 n_words;
+  /* highest block received */
+  u16 last_block;
+  /* one bit per block received */
+  u64 blocks[IP_FULL_REASS_N_BLOCK_WORDS];
+} ip_full_reass_holes_t;
+
+always_inline void
+ip_full_reass_holes_init (ip_full_reass_holes_t *h)
+{
+  h->n_words = 0;
+  h->last_block = 0;
+}
+
+/* bits [first, last] of a word, 0 <= first <= last < 64 */
+always_inline u64
+ip_full_reass_holes_mask (u32 first, u32 last)
+{
+  return (~0ULL >> (63 - last)) & (~0ULL << first);
+}
+
+/**
+ * @brief whether all the blocks of octets [first, last] were received
+ */
+always_inline int
+ip_full_reass_holes_covered (const ip_full_reass_holes_t *h, u32 first,
+			     u32 last)
+{
+  u32 fb = first / 8, lb = last / 8;
+  u32 fw = fb / 64, lw = lb / 64, w;
+  u64 mask;
+
+  if (lw >= h->n_words)
+    return 0;
+
+  for (w = fw; w <= lw; w++)
+    {
+      mask = ip_full_reass_holes_mask (w == fw ? fb % 64 : 0,
+				       w == lw ? lb % 64 : 63);
+      if ((h->blocks[w] & mask) != mask)
+	return 0;
+    }
+  return 1;
+}
+
+/**
+ * @brief mark the blocks of a fragment of octets [first, last] received
+ *
+ * Only the last fragment of a datagram may end part way into a block,
+ * anything else ending so does not complete its last block.
+ */
+always_inline void
+ip_full_reass_holes_add (ip_full_reass_holes_t *h, u32 first, u32 last,
+			 int is_last_fragment)
+{
+  u32 fb = first / 8, lb, fw, lw, w;
+
+  if (is_last_fragment || 7 == last % 8)
+    lb = last / 8;
+  else if (last / 8 > fb)
+    lb = last / 8 - 1;
+  else
+    return;
+
+  fw = fb / 64;
+  lw = lb / 64;
+
+  while (h->n_words <= lw)
+    h->blocks[h->n_words++] = 0;
+
+  for (w = fw; w <= lw; w++)
+    h->blocks[w] |= ip_full_reass_holes_mask (w == fw ? fb % 64 : 0,
+					      w == lw ? lb % 64 : 63);
+
+  h->last_block = clib_max (h->last_block, lb);
+}
+
+/**
+ * @brief number of holes left in a datagram
+ *
+ * @param last_octet the last octet of the datagram, ~0 while unknown, in
+ * which case everything past the highest block received is one hole.
+ */
+always_inline u32
+ip_full_reass_holes_count (const ip_full_reass_holes_t *h, u32 last_octet)
+{
+  u32 lb, lw, w, n_holes = 0;
+  u64 x, carry = 1;
+
+  if (~0 == last_octet)
+    {
+      lb = h->last_block;
+      n_holes = 1;
+    }
+  else
+    lb = last_octet / 8;
+  lw = lb / 64;
+
+  /* a hole starts at a clear bit following a set one, or at block 0 */
+  for (w = 0; w <= lw; w++)
+    {
+      x = w < h->n_words ? h->blocks[w] : 0;
+      if (w == lw)
+	x |= ~ip_full_reass_holes_mask (0, lb % 64);
+      n_holes += count_set_bits (~x & ((x << 1) | carry));
+      carry = x >> 63;
+    }
+
+  return n_holes;
+}
+
+#endif /* __included_ip_full_reass_holes_h__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -1223,7 +1223,7 @@ esp_decrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      vnet_crypto_async_frame_is_full (async_frames[async_op]))
 	    {
 	      async_frames[async_op] =
-		vnet_crypto_async_get_frame (vm, async_op);
+		vnet_crypto_async_get_open_frame (vm, async_op);
 	      if (PREDICT_FALSE (!async_frames[async_op]))
 		{
 		  err = ESP_DECRYPT_ERROR_NO_AVAIL_FRAME;
@@ -1296,8 +1296,15 @@ esp_decrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  vnet_crypto_async_free_frame (vm, *async_frame);
 	  continue;
 	}
-      if (vnet_crypto_async_submit_open_frame (vm, *async_frame) < 0)
+      if (vnet_crypto_async_submit_or_hold_frame (vm, *async_frame) < 0)
 	{
+	  /* a frame held by an earlier call may not fit */
+	  if (n_noop + (*async_frame)->n_elts > VLIB_FRAME_SIZE)
+	    {
+	      vlib_buffer_enqueue_to_next (vm, node, noop_bi, noop_nexts,
+					   n_noop);
+	      n_noop = 0;
+	    }
 	  n_noop += esp_async_recycle_failed_submit (
 	    vm, *async_frame, node, ESP_DECRYPT_ERROR_CRYPTO_ENGINE_ERROR,
 	    IPSEC_SA_ERROR_CRYPTO_ENGINE_ERROR, n_noop, noop_bi, noop_nexts,
@@ -495,6 +495,7 @@ ipsec_init (vlib_main_t * vm)
   im->fp_spd_ipv6_in_is_enabled = 0;
 
   im->fp_lookup_hash_buckets = IPSEC_FP_HASH_LOOKUP_HASH_BUCKETS;
+  im->fp_flow_cache_size = IPSEC_FP_FLOW_CACHE_DEFAULT_SIZE;
 
   return 0;
 }
@@ -510,6 +511,8 @@ ipsec_config (vlib_main_t *vm, unformat_input_t *input)
   u32 ipsec4_out_spd_hash_num_buckets;
   u32 ipsec4_in_spd_hash_num_buckets;
   u32 ipsec_spd_fp_num_buckets;
+  u32 fp_flow_cache_size;
+  ipsec_per_thread_data_t *ptd;
   bool fp_spd_ip4_enabled = false;
   bool fp_spd_ip6_enabled = false;
   u32 handoff_queue_size;
@@ -553,6 +556,13 @@ ipsec_config (vlib_main_t *vm, unformat_input_t *input)
 	  im->fp_lookup_hash_buckets = 1ULL
 				       << max_log2 (ipsec_spd_fp_num_buckets);
 	}
+      else if (unformat (input, "spd-fast-path-flow-cache-entries %u",
+			 &fp_flow_cache_size))
+	{
+	  /* per-thread, a power of 2 >= input, 0 to disable */
+	  im->fp_flow_cache_size =
+	    fp_flow_cache_size ? 1ULL << max_log2 (fp_flow_cache_size) : 0;
+	}
       else if (unformat (input, "ipv4-outbound-spd-flow-cache on"))
 	im->output_flow_cache_flag = im->fp_spd_ipv4_out_is_enabled ? 0 : 1;
       else if (unformat (input, "ipv4-outbound-spd-flow-cache off"))
@@ -636,6 +646,11 @@ ipsec_config (vlib_main_t *vm, unformat_input_t *input)
     pool_alloc_aligned (im->fp_ip6_lookup_hashes_pool,
 			IPSEC_FP_IP6_HASHES_POOL_SIZE, CLIB_CACHE_LINE_BYTES);
 
+  if ((fp_spd_ip4_enabled || fp_spd_ip6_enabled) && im->fp_flow_cache_size)
+    vec_foreach (ptd, im->ptd)
+      vec_validate_aligned (ptd->fp_flow_cache, im->fp_flow_cache_size - 1,
+			    CLIB_CACHE_LINE_BYTES);
+
   return 0;
 }
 
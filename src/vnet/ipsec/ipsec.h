@@ -130,6 +130,26 @@ typedef struct
   const u8 icv_size;
 } ipsec_main_integ_alg_t;
 
+/**
+ * @brief Entry of the per-thread fast path SPD flow cache
+ *
+ * Remembers the outcome of a fast path SPD lookup for a 5-tuple, including
+ * the lack of a match. The entry is valid for as long as the SPD is at the
+ * epoch the entry was filled at.
+ */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* the lookup key, for ipv4 only the last two words are used */
+  u64 key[5];
+  u32 epoch;
+  /* INDEX_INVALID when no policy matched */
+  u32 policy_index;
+  u8 is_outbound;
+} ipsec_fp_flow_cache_entry_t;
+
+#define IPSEC_FP_FLOW_CACHE_DEFAULT_SIZE 4096
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -139,6 +159,13 @@ typedef struct
   vnet_crypto_op_t *chained_integ_ops;
   vnet_crypto_op_chunk_t *chunks;
   vnet_crypto_async_frame_t **async_frames;
+
+  /* fast path SPD flow cache, a power of 2 number of entries */
+  ipsec_fp_flow_cache_entry_t *fp_flow_cache;
+  u64 fp_flow_cache_hits;
+  u64 fp_flow_cache_misses;
+  /* cpu clocks spent in the fast path lookups of the misses */
+  u64 fp_lookup_clocks;
 } ipsec_per_thread_data_t;
 
 typedef struct
@@ -159,6 +186,10 @@ typedef struct
   /* pool of fast path mask types */
   ipsec_fp_mask_type_entry_t *fp_mask_types;
   u32 fp_lookup_hash_buckets; /* number of buckets should be power of two */
+  /* entries of the per-thread fast path flow cache, 0 when disabled */
+  u32 fp_flow_cache_size;
+  /* last epoch given to a fast path SPD */
+  u32 fp_flow_cache_epoch;
 
   /* hash tables of UDP port registrations */
   uword *udp_port_registrations;
@@ -497,6 +497,8 @@ ipsec_spd_show_all (vlib_main_t * vm, ipsec_main_t * im)
     {
       vlib_cli_output (vm, "%U", format_ipsec_in_spd_flow_cache);
     }
+  if (vec_len (im->ptd) && im->ptd[0].fp_flow_cache)
+    vlib_cli_output (vm, "%U", format_ipsec_fp_flow_cache);
 }
 
 static void
@@ -807,8 +809,17 @@ clear_ipsec_counters_command_fn (vlib_main_t * vm,
 				 unformat_input_t * input,
 				 vlib_cli_command_t * cmd)
 {
+  ipsec_main_t *im = &ipsec_main;
+  ipsec_per_thread_data_t *ptd;
+
   vlib_clear_combined_counters (&ipsec_spd_policy_counters);
   vlib_clear_combined_counters (&ipsec_sa_counters);
+  vec_foreach (ptd, im->ptd)
+    {
+      ptd->fp_flow_cache_hits = 0;
+      ptd->fp_flow_cache_misses = 0;
+      ptd->fp_lookup_clocks = 0;
+    }
   for (int i = 0; i < IPSEC_SA_N_ERRORS; i++)
     vlib_clear_simple_counters (&ipsec_sa_err_counters[i]);
 
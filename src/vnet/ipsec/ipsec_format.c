@@ -403,6 +403,35 @@ format_ipsec_in_spd_flow_cache (u8 *s, va_list *args)
   return (s);
 }
 
+u8 *
+format_ipsec_fp_flow_cache (u8 *s, va_list *args)
+{
+  ipsec_main_t *im = &ipsec_main;
+  ipsec_per_thread_data_t *ptd;
+  u64 n_lookups;
+
+  s = format (s, "\nspd-fast-path-flow-cache-entries: %u per thread",
+	      im->fp_flow_cache_size);
+
+  vec_foreach (ptd, im->ptd)
+    {
+      n_lookups = ptd->fp_flow_cache_hits + ptd->fp_flow_cache_misses;
+      if (n_lookups == 0)
+	continue;
+
+      s = format (s,
+		  "\n thread %u: lookups %lu hits %lu (%.1f%%) "
+		  "clocks/miss %.1f",
+		  ptd - im->ptd, n_lookups, ptd->fp_flow_cache_hits,
+		  100.0 * ptd->fp_flow_cache_hits / n_lookups,
+		  ptd->fp_flow_cache_misses ?
+		    (f64) ptd->fp_lookup_clocks / ptd->fp_flow_cache_misses :
+		    0.0);
+    }
+
+  return (s);
+}
+
 u8 *
 format_ipsec_key (u8 * s, va_list * args)
 {
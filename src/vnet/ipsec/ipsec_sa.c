@@ -297,6 +297,12 @@ ipsec_sa_update (u32 id, u16 src_port, u16 dst_port, const tunnel_t *tun,
       (ip_address_cmp (&tun->t_src, &sa->tunnel.t_src) != 0 ||
        ip_address_cmp (&tun->t_dst, &sa->tunnel.t_dst) != 0))
     {
+      ipsec_spd_t *spd;
+
+      /* the cached inbound lookups depend on the tunnel endpoints */
+      pool_foreach (spd, im->spds)
+	ipsec_fp_flow_cache_new_epoch (&spd->fp_spd);
+
       /* if the source IP is updated for an inbound SA under a tunnel protect,
        we need to update the tun_protect DB with the new src IP */
       if (ipsec_sa_is_set_IS_INBOUND (sa) &&
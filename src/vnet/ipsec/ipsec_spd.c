@@ -121,6 +121,7 @@ ipsec_add_del_spd (vlib_main_t * vm, u32 spd_id, int is_add)
       fp_spd->ip4_in_lookup_hash_idx = INDEX_INVALID;
       fp_spd->ip6_out_lookup_hash_idx = INDEX_INVALID;
       fp_spd->ip6_in_lookup_hash_idx = INDEX_INVALID;
+      ipsec_fp_flow_cache_new_epoch (fp_spd);
 
       if (im->fp_spd_ipv4_out_is_enabled)
 	{
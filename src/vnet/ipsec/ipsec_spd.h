@@ -65,6 +65,8 @@ typedef struct
   u32 ip4_out_lookup_hash_idx; /* fp ip4 lookup hash out index in the pool */
   u32 ip6_in_lookup_hash_idx;  /* fp ip6 lookup hash in index in the pool */
   u32 ip4_in_lookup_hash_idx;  /* fp ip4 lookup hash in index in the pool */
+  /* changes with every policy update, validates the flow cache entries */
+  u32 flow_cache_epoch;
 } ipsec_spd_fp_t;
 
 /**
@@ -94,6 +96,7 @@ extern u8 *format_ipsec_spd (u8 * s, va_list * args);
 
 extern u8 *format_ipsec_out_spd_flow_cache (u8 *s, va_list *args);
 extern u8 *format_ipsec_in_spd_flow_cache (u8 *s, va_list *args);
+extern u8 *format_ipsec_fp_flow_cache (u8 *s, va_list *args);
 
 #endif /* __IPSEC_SPD_H__ */
 
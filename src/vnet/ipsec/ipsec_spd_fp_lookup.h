@@ -209,429 +209,291 @@ single_rule_in_match_5tuple (ipsec_policy_t *policy, ipsec_fp_5tuple_t *match)
   return (1);
 }
 
+/**
+ * @brief lookup of a burst of n packets in the fast path SPD
+ *
+ * The mask types are probed one after the other for the whole burst, in
+ * stages: the keys are masked and their buckets prefetched, then the
+ * key/value pages are prefetched and finally searched. The policy with the
+ * highest priority is kept for each packet.
+ *
+ * Inbound bursts share the policy type of their first tuple.
+ **/
 static_always_inline u32
-ipsec_fp_in_ip6_policy_match_n (void *spd_fp, ipsec_fp_5tuple_t *tuples,
-				ipsec_policy_t **policies, u32 n)
+ipsec_fp_policy_lookup_n (ipsec_spd_fp_t *pspd_fp, ipsec_fp_5tuple_t *tuples,
+			  ipsec_policy_t **policies, u32 *ids, u32 n,
+			  u8 is_ipv6, u8 is_outbound)
 {
+  ipsec_main_t *im = &ipsec_main;
   u32 last_priority[n];
-  u32 i = 0;
-  u32 counter = 0;
+  u64 hashes[n];
+  clib_bihash_kv_40_8_t kv6[is_ipv6 ? n : 1], result6;
+  clib_bihash_kv_16_8_t kv4[is_ipv6 ? 1 : n], result4;
+  clib_bihash_40_8_t *h6 = 0;
+  clib_bihash_16_8_t *h4 = 0;
+  ipsec_fp_lookup_value_t *result_val;
   ipsec_fp_mask_type_entry_t *mte;
-  ipsec_fp_mask_id_t *mti;
-  ipsec_fp_5tuple_t *match = tuples;
+  ipsec_fp_mask_id_t *mti, *mask_type_ids;
   ipsec_policy_t *policy;
-  u32 n_left = n;
-  clib_bihash_kv_40_8_t kv;
-  /* result of the lookup */
-  clib_bihash_kv_40_8_t result;
-  ipsec_fp_lookup_value_t *result_val =
-    (ipsec_fp_lookup_value_t *) &result.value;
   u64 *pkey, *pmatch, *pmask;
-  ipsec_main_t *im = &ipsec_main;
-  ipsec_spd_fp_t *pspd_fp = (ipsec_spd_fp_t *) spd_fp;
-  ipsec_fp_mask_id_t *mask_type_ids = pspd_fp->fp_mask_ids[match->action];
-  clib_bihash_40_8_t *bihash_table = pool_elt_at_index (
-    im->fp_ip6_lookup_hashes_pool, pspd_fp->ip6_in_lookup_hash_idx);
+  u32 *policy_id, i, counter = 0;
+  int res;
+
+  if (is_outbound)
+    mask_type_ids =
+      pspd_fp->fp_mask_ids[is_ipv6 ? IPSEC_SPD_POLICY_IP6_OUTBOUND :
+				     IPSEC_SPD_POLICY_IP4_OUTBOUND];
+  else
+    mask_type_ids = pspd_fp->fp_mask_ids[tuples->action];
+
+  if (is_ipv6)
+    h6 = pool_elt_at_index (im->fp_ip6_lookup_hashes_pool,
+			    is_outbound ? pspd_fp->ip6_out_lookup_hash_idx :
+					  pspd_fp->ip6_in_lookup_hash_idx);
+  else
+    h4 = pool_elt_at_index (im->fp_ip4_lookup_hashes_pool,
+			    is_outbound ? pspd_fp->ip4_out_lookup_hash_idx :
+					  pspd_fp->ip4_in_lookup_hash_idx);
 
   /* clear the list of matched policies pointers */
   clib_memset (policies, 0, n * sizeof (*policies));
   clib_memset (last_priority, 0, n * sizeof (u32));
-  n_left = n;
-  while (n_left)
+
+  vec_foreach (mti, mask_type_ids)
     {
-      vec_foreach (mti, mask_type_ids)
+      mte = im->fp_mask_types + mti->mask_type_idx;
+      /* only the inbound masks have an action */
+      if ((mte->mask.action == 0) != is_outbound)
+	continue;
+
+      /* stage 1: mask the keys and prefetch their buckets */
+      for (i = 0; i < n; i++)
 	{
-	  mte = im->fp_mask_types + mti->mask_type_idx;
-	  if (mte->mask.action == 0)
-	    continue;
+	  if (is_ipv6)
+	    {
+	      pmatch = (u64 *) tuples[i].kv_40_8.key;
+	      pmask = (u64 *) mte->mask.kv_40_8.key;
+	      pkey = kv6[i].key;
+
+	      pkey[0] = pmatch[0] & pmask[0];
+	      pkey[1] = pmatch[1] & pmask[1];
+	      pkey[2] = pmatch[2] & pmask[2];
+	      pkey[3] = pmatch[3] & pmask[3];
+	      pkey[4] = pmatch[4] & pmask[4];
+
+	      hashes[i] = clib_bihash_hash_40_8 (kv6 + i);
+	      clib_bihash_prefetch_bucket_40_8 (h6, hashes[i]);
+	    }
+	  else
+	    {
+	      pmatch = (u64 *) tuples[i].kv_16_8.key;
+	      pmask = (u64 *) mte->mask.kv_16_8.key;
+	      pkey = kv4[i].key;
 
-	  pmatch = (u64 *) match->kv_40_8.key;
-	  pmask = (u64 *) mte->mask.kv_40_8.key;
-	  pkey = (u64 *) kv.key;
+	      pkey[0] = pmatch[0] & pmask[0];
+	      pkey[1] = pmatch[1] & pmask[1];
 
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey = *pmatch & *pmask;
+	      hashes[i] = clib_bihash_hash_16_8 (kv4 + i);
+	      clib_bihash_prefetch_bucket_16_8 (h4, hashes[i]);
+	    }
+	}
 
-	  int res =
-	    clib_bihash_search_inline_2_40_8 (bihash_table, &kv, &result);
-	  /* lookup the hash by each packet in the burst for this mask. */
+      /* stage 2: prefetch the key/value pages */
+      if (n > 1)
+	for (i = 0; i < n; i++)
+	  {
+	    if (is_ipv6)
+	      clib_bihash_prefetch_data_40_8 (h6, hashes[i]);
+	    else
+	      clib_bihash_prefetch_data_16_8 (h4, hashes[i]);
+	  }
+
+      /* stage 3: search, find the policy with highest priority */
+      for (i = 0; i < n; i++)
+	{
+	  if (is_ipv6)
+	    {
+	      res = clib_bihash_search_inline_2_with_hash_40_8 (
+		h6, hashes[i], kv6 + i, &result6);
+	      result_val = (ipsec_fp_lookup_value_t *) &result6.value;
+	    }
+	  else
+	    {
+	      res = clib_bihash_search_inline_2_with_hash_16_8 (
+		h4, hashes[i], kv4 + i, &result4);
+	      result_val = (ipsec_fp_lookup_value_t *) &result4.value;
+	    }
 
-	  if (res == 0)
+	  if (res != 0)
+	    continue;
+
+	  /* the policies sharing a key are sorted by priority */
+	  vec_foreach (policy_id, result_val->fp_policies_ids)
 	    {
-	      /* There is a hit in the hash table. */
-	      /* Find the policy with highest priority. */
-	      /* Store the lookup results in a dedicated array. */
+	      policy = im->policies + *policy_id;
 
-	      if (vec_len (result_val->fp_policies_ids) > 1)
-		{
-		  u32 *policy_id;
-		  vec_foreach (policy_id, result_val->fp_policies_ids)
-		    {
-		      policy = im->policies + *policy_id;
-
-		      if (single_rule_in_match_5tuple (policy, match))
-			{
-			  if (last_priority[i] < policy->priority)
-			    {
-			      last_priority[i] = policy->priority;
-			      if (policies[i] == 0)
-				counter++;
-			      policies[i] = policy;
-			    }
-			  break;
-			}
-		    }
-		}
-	      else
+	      if (is_outbound ?
+		    single_rule_out_match_5tuple (policy, tuples + i) :
+		    single_rule_in_match_5tuple (policy, tuples + i))
 		{
-		  u32 *policy_id;
-		  ASSERT (vec_len (result_val->fp_policies_ids) == 1);
-		  policy_id = result_val->fp_policies_ids;
-		  policy = im->policies + *policy_id;
-		  if ((last_priority[i] < policy->priority) &&
-		      (single_rule_in_match_5tuple (policy, match)))
+		  if (last_priority[i] < policy->priority)
 		    {
 		      last_priority[i] = policy->priority;
 		      if (policies[i] == 0)
 			counter++;
 		      policies[i] = policy;
+		      ids[i] = *policy_id;
 		    }
+		  break;
 		}
 	    }
 	}
-
-      i++;
-      n_left--;
-      match++;
     }
+
   return counter;
 }
 
-static_always_inline u32
-ipsec_fp_in_ip4_policy_match_n (void *spd_fp, ipsec_fp_5tuple_t *tuples,
-				ipsec_policy_t **policies, u32 n)
-
+static_always_inline u64
+ipsec_fp_flow_cache_hash (ipsec_fp_5tuple_t *match, u8 is_ipv6)
 {
-  u32 last_priority[n];
-  u32 i = 0;
-  u32 counter = 0;
-  ipsec_fp_mask_type_entry_t *mte;
-  ipsec_fp_mask_id_t *mti;
-  ipsec_fp_5tuple_t *match = tuples;
-  ipsec_policy_t *policy;
-  u32 n_left = n;
-  clib_bihash_kv_16_8_t kv;
-  /* result of the lookup */
-  clib_bihash_kv_16_8_t result;
-  ipsec_fp_lookup_value_t *result_val =
-    (ipsec_fp_lookup_value_t *) &result.value;
-  u64 *pkey, *pmatch, *pmask;
-  ipsec_main_t *im = &ipsec_main;
-  ipsec_spd_fp_t *pspd_fp = (ipsec_spd_fp_t *) spd_fp;
-  ipsec_fp_mask_id_t *mask_type_ids = pspd_fp->fp_mask_ids[match->action];
-  clib_bihash_16_8_t *bihash_table = pool_elt_at_index (
-    im->fp_ip4_lookup_hashes_pool, pspd_fp->ip4_in_lookup_hash_idx);
-
-  /* clear the list of matched policies pointers */
-  clib_memset (policies, 0, n * sizeof (*policies));
-  clib_memset (last_priority, 0, n * sizeof (u32));
-  n_left = n;
-  while (n_left)
-    {
-      vec_foreach (mti, mask_type_ids)
-	{
-	  mte = im->fp_mask_types + mti->mask_type_idx;
-	  if (mte->mask.action == 0)
-	    continue;
-	  pmatch = (u64 *) match->kv_16_8.key;
-	  pmask = (u64 *) mte->mask.kv_16_8.key;
-	  pkey = (u64 *) kv.key;
-
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey = *pmatch & *pmask;
+  if (is_ipv6)
+    return clib_bihash_hash_40_8 (&match->kv_40_8);
+  return clib_bihash_hash_16_8 (&match->kv_16_8);
+}
 
-	  int res =
-	    clib_bihash_search_inline_2_16_8 (bihash_table, &kv, &result);
-	  /* lookup the hash by each packet in the burst for this mask. */
+static_always_inline int
+ipsec_fp_flow_cache_entry_match (ipsec_fp_flow_cache_entry_t *e, u32 epoch,
+				 ipsec_fp_5tuple_t *match, u8 is_ipv6,
+				 u8 is_outbound)
+{
+  u64 *key = match->kv_40_8.key;
 
-	  if (res == 0)
-	    {
-	      /* There is a hit in the hash table. */
-	      /* Find the policy with highest priority. */
-	      /* Store the lookup results in a dedicated array. */
+  if (e->epoch != epoch || e->is_outbound != is_outbound)
+    return 0;
 
-	      if (vec_len (result_val->fp_policies_ids) > 1)
-		{
-		  u32 *policy_id;
-		  vec_foreach (policy_id, result_val->fp_policies_ids)
-		    {
-		      policy = im->policies + *policy_id;
-
-		      if (single_rule_in_match_5tuple (policy, match))
-			{
-			  if (last_priority[i] < policy->priority)
-			    {
-			      last_priority[i] = policy->priority;
-			      if (policies[i] == 0)
-				counter++;
-			      policies[i] = policy;
-			    }
-			  break;
-			}
-		    }
-		}
-	      else
-		{
-		  u32 *policy_id;
-		  ASSERT (vec_len (result_val->fp_policies_ids) == 1);
-		  policy_id = result_val->fp_policies_ids;
-		  policy = im->policies + *policy_id;
-		  if ((last_priority[i] < policy->priority) &&
-		      (single_rule_in_match_5tuple (policy, match)))
-		    {
-		      last_priority[i] = policy->priority;
-		      if (policies[i] == 0)
-			counter++;
-		      policies[i] = policy;
-		    }
-		}
-	    }
-	}
+  /* is_ipv6 is part of the last word */
+  if (is_ipv6)
+    return ((e->key[0] ^ key[0]) | (e->key[1] ^ key[1]) |
+	    (e->key[2] ^ key[2]) | (e->key[3] ^ key[3]) |
+	    (e->key[4] ^ key[4])) == 0;
 
-      i++;
-      n_left--;
-      match++;
-    }
-  return counter;
+  return ((e->key[3] ^ key[3]) | (e->key[4] ^ key[4])) == 0;
 }
 
-/**
- * @brief function handler to perform lookup in fastpath SPD
- * for inbound traffic burst of n packets
- **/
-
-static_always_inline u32
-ipsec_fp_in_policy_match_n (void *spd_fp, u8 is_ipv6,
-			    ipsec_fp_5tuple_t *tuples,
-			    ipsec_policy_t **policies, u32 n)
+static_always_inline void
+ipsec_fp_flow_cache_entry_fill (ipsec_fp_flow_cache_entry_t *e, u32 epoch,
+				ipsec_fp_5tuple_t *match, u8 is_ipv6,
+				u8 is_outbound, u32 policy_index)
 {
-  if (is_ipv6)
-    return ipsec_fp_in_ip6_policy_match_n (spd_fp, tuples, policies, n);
-  else
-    return ipsec_fp_in_ip4_policy_match_n (spd_fp, tuples, policies, n);
+  u64 *key = match->kv_40_8.key;
+
+  e->key[0] = is_ipv6 ? key[0] : 0;
+  e->key[1] = is_ipv6 ? key[1] : 0;
+  e->key[2] = is_ipv6 ? key[2] : 0;
+  e->key[3] = key[3];
+  e->key[4] = key[4];
+  e->epoch = epoch;
+  e->policy_index = policy_index;
+  e->is_outbound = is_outbound;
 }
 
+/**
+ * @brief lookup of a burst of n packets through the per-thread flow cache
+ *
+ * The packets missing the cache are looked up together in the fast path
+ * SPD and their outcome, a match or not, is cached.
+ **/
 static_always_inline u32
-ipsec_fp_out_ip6_policy_match_n (void *spd_fp, ipsec_fp_5tuple_t *tuples,
-				 ipsec_policy_t **policies, u32 *ids, u32 n)
-
+ipsec_fp_policy_match_n (ipsec_spd_fp_t *pspd_fp, ipsec_fp_5tuple_t *tuples,
+			 ipsec_policy_t **policies, u32 *ids, u32 n,
+			 u8 is_ipv6, u8 is_outbound)
 {
-  u32 last_priority[n];
-  u32 i = 0;
-  u32 counter = 0;
-  ipsec_fp_mask_type_entry_t *mte;
-  ipsec_fp_mask_id_t *mti;
-  ipsec_fp_5tuple_t *match = tuples;
-  ipsec_policy_t *policy;
-
-  u32 n_left = n;
-  clib_bihash_kv_40_8_t kv;
-  /* result of the lookup */
-  clib_bihash_kv_40_8_t result;
-  ipsec_fp_lookup_value_t *result_val =
-    (ipsec_fp_lookup_value_t *) &result.value;
-  u64 *pkey, *pmatch, *pmask;
   ipsec_main_t *im = &ipsec_main;
-  ipsec_spd_fp_t *pspd_fp = (ipsec_spd_fp_t *) spd_fp;
-  ipsec_fp_mask_id_t *mask_type_ids =
-    pspd_fp->fp_mask_ids[IPSEC_SPD_POLICY_IP6_OUTBOUND];
-  clib_bihash_40_8_t *bihash_table = pool_elt_at_index (
-    im->fp_ip6_lookup_hashes_pool, pspd_fp->ip6_out_lookup_hash_idx);
+  ipsec_per_thread_data_t *ptd;
+  ipsec_fp_flow_cache_entry_t *fc, *e[n];
+  ipsec_fp_5tuple_t miss_tuples[n];
+  ipsec_policy_t *miss_policies[n];
+  u32 miss_ids[n], misses[n];
+  u32 i, j, mask, n_misses = 0, counter = 0;
+  u32 epoch = pspd_fp->flow_cache_epoch;
+  u64 t0;
+
+  ptd = vec_elt_at_index (im->ptd, vlib_get_thread_index ());
+  fc = ptd->fp_flow_cache;
+
+  if (PREDICT_FALSE (fc == 0))
+    return ipsec_fp_policy_lookup_n (pspd_fp, tuples, policies, ids, n,
+				     is_ipv6, is_outbound);
+
+  mask = vec_len (fc) - 1;
+  for (i = 0; i < n; i++)
+    {
+      e[i] = fc + (ipsec_fp_flow_cache_hash (tuples + i, is_ipv6) & mask);
+      clib_prefetch_load (e[i]);
+    }
 
-  /*clear the list of matched policies pointers */
-  clib_memset (policies, 0, n * sizeof (*policies));
-  clib_memset (last_priority, 0, n * sizeof (u32));
-  n_left = n;
-  while (n_left)
+  for (i = 0; i < n; i++)
     {
-      vec_foreach (mti, mask_type_ids)
+      if (ipsec_fp_flow_cache_entry_match (e[i], epoch, tuples + i, is_ipv6,
+					   is_outbound))
 	{
-	  mte = im->fp_mask_types + mti->mask_type_idx;
-	  if (mte->mask.action != 0)
-	    continue;
-
-	  pmatch = (u64 *) match->kv_40_8.key;
-	  pmask = (u64 *) mte->mask.kv_40_8.key;
-	  pkey = (u64 *) kv.key;
-
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey = *pmatch & *pmask;
-
-	  int res =
-	    clib_bihash_search_inline_2_40_8 (bihash_table, &kv, &result);
-	  /* lookup the hash by each packet in the burst for this mask. */
-
-	  if (res == 0)
+	  if (e[i]->policy_index == INDEX_INVALID)
+	    policies[i] = 0;
+	  else
 	    {
-	      /* There is a hit in the hash table. */
-	      /* Find the policy with highest priority. */
-	      /* Store the lookup results in a dedicated array. */
-
-	      if (vec_len (result_val->fp_policies_ids) > 1)
-		{
-		  u32 *policy_id;
-		  vec_foreach (policy_id, result_val->fp_policies_ids)
-		    {
-		      policy = im->policies + *policy_id;
-
-		      if (single_rule_out_match_5tuple (policy, match))
-			{
-			  if (last_priority[i] < policy->priority)
-			    {
-			      last_priority[i] = policy->priority;
-			      if (policies[i] == 0)
-				counter++;
-			      policies[i] = policy;
-			      ids[i] = *policy_id;
-			    }
-			  break;
-			}
-		    }
-		}
-	      else
-		{
-		  u32 *policy_id;
-		  ASSERT (vec_len (result_val->fp_policies_ids) == 1);
-		  policy_id = result_val->fp_policies_ids;
-		  policy = im->policies + *policy_id;
-		  if (single_rule_out_match_5tuple (policy, match))
-		    {
-		      if (last_priority[i] < policy->priority)
-			{
-			  last_priority[i] = policy->priority;
-			  if (policies[i] == 0)
-			    counter++;
-			  policies[i] = policy;
-			  ids[i] = *policy_id;
-			}
-		    }
-		}
+	      policies[i] = im->policies + e[i]->policy_index;
+	      ids[i] = e[i]->policy_index;
+	      counter++;
 	    }
 	}
-      n_left--;
-      match++;
-      i++;
+      else
+	{
+	  misses[n_misses] = i;
+	  miss_tuples[n_misses] = tuples[i];
+	  n_misses++;
+	}
     }
-  return counter;
-}
 
-static_always_inline u32
-ipsec_fp_out_ip4_policy_match_n (void *spd_fp, ipsec_fp_5tuple_t *tuples,
-				 ipsec_policy_t **policies, u32 *ids, u32 n)
+  ptd->fp_flow_cache_hits += n - n_misses;
+  if (n_misses == 0)
+    return counter;
 
-{
-  u32 last_priority[n];
-  u32 i = 0;
-  u32 counter = 0;
-  ipsec_fp_mask_type_entry_t *mte;
-  ipsec_fp_mask_id_t *mti;
-  ipsec_fp_5tuple_t *match = tuples;
-  ipsec_policy_t *policy;
+  t0 = clib_cpu_time_now ();
+  counter += ipsec_fp_policy_lookup_n (pspd_fp, miss_tuples, miss_policies,
+				       miss_ids, n_misses, is_ipv6, is_outbound);
+  ptd->fp_lookup_clocks += clib_cpu_time_now () - t0;
+  ptd->fp_flow_cache_misses += n_misses;
 
-  u32 n_left = n;
-  clib_bihash_kv_16_8_t kv;
-  /* result of the lookup */
-  clib_bihash_kv_16_8_t result;
-  ipsec_fp_lookup_value_t *result_val =
-    (ipsec_fp_lookup_value_t *) &result.value;
-  u64 *pkey, *pmatch, *pmask;
-  ipsec_main_t *im = &ipsec_main;
-  ipsec_spd_fp_t *pspd_fp = (ipsec_spd_fp_t *) spd_fp;
-  ipsec_fp_mask_id_t *mask_type_ids =
-    pspd_fp->fp_mask_ids[IPSEC_SPD_POLICY_IP4_OUTBOUND];
-  clib_bihash_16_8_t *bihash_table = pool_elt_at_index (
-    im->fp_ip4_lookup_hashes_pool, pspd_fp->ip4_out_lookup_hash_idx);
-
-  /* clear the list of matched policies pointers */
-  clib_memset (policies, 0, n * sizeof (*policies));
-  clib_memset (last_priority, 0, n * sizeof (u32));
-  n_left = n;
-  while (n_left)
+  for (j = 0; j < n_misses; j++)
     {
-      vec_foreach (mti, mask_type_ids)
-	{
-	  mte = im->fp_mask_types + mti->mask_type_idx;
-	  if (mte->mask.action != 0)
-	    continue;
-
-	  pmatch = (u64 *) match->kv_16_8.key;
-	  pmask = (u64 *) mte->mask.kv_16_8.key;
-	  pkey = (u64 *) kv.key;
-
-	  *pkey++ = *pmatch++ & *pmask++;
-	  *pkey = *pmatch & *pmask;
+      i = misses[j];
+      policies[i] = miss_policies[j];
+      if (policies[i])
+	ids[i] = miss_ids[j];
+      ipsec_fp_flow_cache_entry_fill (e[i], epoch, tuples + i, is_ipv6,
+				      is_outbound,
+				      policies[i] ? ids[i] : INDEX_INVALID);
+    }
 
-	  int res =
-	    clib_bihash_search_inline_2_16_8 (bihash_table, &kv, &result);
-	  /* lookup the hash by each packet in the burst for this mask. */
+  return counter;
+}
 
-	  if (res == 0)
-	    {
-	      /* There is a hit in the hash table. */
-	      /* Find the policy with highest priority. */
-	      /* Store the lookup results in a dedicated array. */
+/**
+ * @brief function handler to perform lookup in fastpath SPD
+ * for inbound traffic burst of n packets
+ **/
 
-	      if (vec_len (result_val->fp_policies_ids) > 1)
-		{
-		  u32 *policy_id;
-		  vec_foreach (policy_id, result_val->fp_policies_ids)
-		    {
-		      policy = im->policies + *policy_id;
-
-		      if (single_rule_out_match_5tuple (policy, match))
-			{
-			  if (last_priority[i] < policy->priority)
-			    {
-			      last_priority[i] = policy->priority;
-			      if (policies[i] == 0)
-				counter++;
-			      policies[i] = policy;
-			      ids[i] = *policy_id;
-			    }
-			  break;
-			}
-		    }
-		}
-	      else
-		{
-		  u32 *policy_id;
-		  ASSERT (vec_len (result_val->fp_policies_ids) == 1);
-		  policy_id = result_val->fp_policies_ids;
-		  policy = im->policies + *policy_id;
-		  if ((last_priority[i] < policy->priority) &&
-		      (single_rule_out_match_5tuple (policy, match)))
-		    {
-		      last_priority[i] = policy->priority;
-		      if (policies[i] == 0)
-			counter++;
-		      policies[i] = policy;
-		      ids[i] = *policy_id;
-		    }
-		}
-	    }
-	}
+static_always_inline u32
+ipsec_fp_in_policy_match_n (void *spd_fp, u8 is_ipv6,
+			    ipsec_fp_5tuple_t *tuples,
+			    ipsec_policy_t **policies, u32 n)
+{
+  u32 ids[n];
 
-      i++;
-      n_left--;
-      match++;
-    }
-  return counter;
+  if (is_ipv6)
+    return ipsec_fp_policy_match_n (spd_fp, tuples, policies, ids, n, 1, 0);
+  else
+    return ipsec_fp_policy_match_n (spd_fp, tuples, policies, ids, n, 0, 0);
 }
 
 /**
@@ -647,9 +509,9 @@ ipsec_fp_out_policy_match_n (void *spd_fp, u8 is_ipv6,
 
 {
   if (is_ipv6)
-    return ipsec_fp_out_ip6_policy_match_n (spd_fp, tuples, policies, ids, n);
+    return ipsec_fp_policy_match_n (spd_fp, tuples, policies, ids, n, 1, 1);
   else
-    return ipsec_fp_out_ip4_policy_match_n (spd_fp, tuples, policies, ids, n);
+    return ipsec_fp_policy_match_n (spd_fp, tuples, policies, ids, n, 0, 1);
 }
 
 #endif /* !IPSEC_SPD_FP_LOOKUP_H */
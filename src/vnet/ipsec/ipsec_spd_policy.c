@@ -908,12 +908,38 @@ ipsec_fp_ip4_del_policy (ipsec_main_t *im, ipsec_spd_fp_t *fp_spd,
   return -1;
 }
 
+void
+ipsec_fp_flow_cache_new_epoch (void *fp_spd)
+{
+  ipsec_main_t *im = &ipsec_main;
+  ipsec_per_thread_data_t *ptd;
+
+  /*
+   * Epochs are unique across the SPDs, so an entry filled for a deleted SPD
+   * can't match the one reusing its slot. On roll over all the entries are
+   * reset, as for the ipv4 flow cache.
+   */
+  if (++im->fp_flow_cache_epoch == 0)
+    {
+      vec_foreach (ptd, im->ptd)
+	if (ptd->fp_flow_cache)
+	  clib_memset_u8 (ptd->fp_flow_cache, 0,
+			  vec_len (ptd->fp_flow_cache) *
+			    sizeof (ptd->fp_flow_cache[0]));
+      im->fp_flow_cache_epoch = 1;
+    }
+
+  ((ipsec_spd_fp_t *) fp_spd)->flow_cache_epoch = im->fp_flow_cache_epoch;
+}
+
 int
 ipsec_fp_add_del_policy (void *fp_spd, ipsec_policy_t *policy, int is_add,
 			 u32 *stat_index)
 {
   ipsec_main_t *im = &ipsec_main;
 
+  ipsec_fp_flow_cache_new_epoch (fp_spd);
+
   if (is_add)
     if (policy->is_ipv6)
       return ipsec_fp_ip6_add_policy (im, (ipsec_spd_fp_t *) fp_spd, policy,
@@ -188,6 +188,11 @@ typedef union
 int ipsec_fp_add_del_policy (void *fp_spd, ipsec_policy_t *policy, int is_add,
 			     u32 *stat_index);
 
+/**
+ *  @brief invalidate the flow cache entries of a fast path SPD
+ */
+void ipsec_fp_flow_cache_new_epoch (void *fp_spd);
+
 static_always_inline int
 ipsec_policy_is_equal (ipsec_policy_t *p1, ipsec_policy_t *p2)
 {
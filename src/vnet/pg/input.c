@@ -55,6 +55,7 @@
 #include <vnet/udp/udp_packet.h>
 #include <vnet/devices/devices.h>
 #include <vnet/gso/gro_func.h>
+#include <vnet/flow/flow.h>
 
 static int
 validate_buffer_data2 (vlib_buffer_t * b, pg_stream_t * s,
@@ -1546,6 +1547,71 @@ pg_input_trace (pg_main_t * pg,
   return n_trace - n_trace0 - n_trace1;
 }
 
+static_always_inline int
+pg_input_flow_match (vnet_flow_t *f, ip4_header_t *ip4)
+{
+  vnet_flow_ip4_n_tuple_t *t = &f->ip4_n_tuple;
+  udp_header_t *udp;
+
+  /* the ip4 flow is a prefix of the ip4 n-tuple one */
+  if ((ip4->src_address.as_u32 & t->src_addr.mask.as_u32) !=
+	(t->src_addr.addr.as_u32 & t->src_addr.mask.as_u32) ||
+      (ip4->dst_address.as_u32 & t->dst_addr.mask.as_u32) !=
+	(t->dst_addr.addr.as_u32 & t->dst_addr.mask.as_u32))
+    return 0;
+
+  if (t->protocol.mask && ip4->protocol != t->protocol.prot)
+    return 0;
+
+  if (f->type != VNET_FLOW_TYPE_IP4_N_TUPLE ||
+      (t->src_port.mask == 0 && t->dst_port.mask == 0))
+    return 1;
+
+  if (ip4->protocol != IP_PROTOCOL_TCP && ip4->protocol != IP_PROTOCOL_UDP)
+    return 0;
+
+  udp = ip4_next_header (ip4);
+  return ((clib_net_to_host_u16 (udp->src_port) & t->src_port.mask) ==
+	    (t->src_port.port & t->src_port.mask) &&
+	  (clib_net_to_host_u16 (udp->dst_port) & t->dst_port.mask) ==
+	    (t->dst_port.port & t->dst_port.mask));
+}
+
+/* emulate a NIC marking the packets of the flows enabled on it */
+static_always_inline void
+pg_input_set_flow_marks (vlib_main_t *vm, pg_interface_t *pi, u32 next_index,
+			 u32 *buffers, u32 n_buffers)
+{
+  for (int i = 0; i < n_buffers; i++)
+    {
+      vlib_buffer_t *b0 = vlib_get_buffer (vm, buffers[i]);
+      ip4_header_t *ip4;
+      u32 *flow_index;
+
+      b0->flow_id = 0;
+
+      if (VNET_DEVICE_INPUT_NEXT_IP4_INPUT == next_index)
+	ip4 = vlib_buffer_get_current (b0);
+      else
+	{
+	  ethernet_header_t *eh = vlib_buffer_get_current (b0);
+	  if (eh->type != clib_host_to_net_u16 (ETHERNET_TYPE_IP4))
+	    continue;
+	  ip4 = (ip4_header_t *) (eh + 1);
+	}
+
+      vec_foreach (flow_index, pi->flows)
+	{
+	  vnet_flow_t *f = vnet_get_flow (*flow_index);
+	  if (pg_input_flow_match (f, ip4))
+	    {
+	      b0->flow_id = f->mark_flow_id;
+	      break;
+	    }
+	}
+    }
+}
+
 static_always_inline void
 fill_buffer_offload_flags (vlib_main_t *vm, u32 next_index, u32 *buffers,
 			   u32 n_buffers, u32 buffer_oflags, int gso_enabled,
@@ -1757,6 +1823,9 @@ pg_generate_packets (vlib_node_runtime_t * node,
 				     pi->gso_size);
 	}
 
+      if (PREDICT_FALSE (vec_len (pi->flows)))
+	pg_input_set_flow_marks (vm, pi, s->next_index, to_next, n_this_frame);
+
       n_trace = vlib_get_trace_count (vm, node);
       if (PREDICT_FALSE (n_trace > 0))
 	{
@@ -393,6 +393,9 @@ typedef struct
   pg_interface_mode_t mode;
 
   mac_address_t *allowed_mcast_macs;
+
+  /* vnet flows enabled on the interface, their marks are set on input */
+  u32 *flows;
 } pg_interface_t;
 
 /* Per VLIB node data. */
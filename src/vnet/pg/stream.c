@@ -43,6 +43,7 @@
 #include <vnet/ip/ip.h>
 #include <vnet/mpls/mpls.h>
 #include <vnet/devices/devices.h>
+#include <vnet/flow/flow.h>
 
 /* Mark stream active or inactive. */
 void
@@ -145,6 +146,43 @@ pg_interface_admin_up_down (vnet_main_t * vnm, u32 hw_if_index, u32 flags)
   return 0;
 }
 
+/*
+ * Flows are matched in software on input (see pg_input_set_flow_marks),
+ * which makes pg a stand-in for NICs that mark packets.
+ */
+static int
+pg_flow_ops_fn (vnet_main_t *vnm, vnet_flow_dev_op_t op, u32 dev_instance,
+		u32 flow_index, uword *private_data)
+{
+  pg_main_t *pg = &pg_main;
+  pg_interface_t *pi = pool_elt_at_index (pg->interfaces, dev_instance);
+  vnet_flow_t *f = vnet_get_flow (flow_index);
+  u32 pos;
+
+  switch (op)
+    {
+    case VNET_FLOW_DEV_OP_ADD_FLOW:
+      if (f->type != VNET_FLOW_TYPE_IP4 &&
+	  f->type != VNET_FLOW_TYPE_IP4_N_TUPLE)
+	return VNET_FLOW_ERROR_NOT_SUPPORTED;
+      if (f->actions != VNET_FLOW_ACTION_MARK)
+	return VNET_FLOW_ERROR_NOT_SUPPORTED;
+      vec_add1 (pi->flows, flow_index);
+      *private_data = flow_index;
+      return 0;
+
+    case VNET_FLOW_DEV_OP_DEL_FLOW:
+      pos = vec_search (pi->flows, flow_index);
+      if (pos == ~0)
+	return VNET_FLOW_ERROR_NO_SUCH_ENTRY;
+      vec_del1 (pi->flows, pos);
+      return 0;
+
+    default:
+      return VNET_FLOW_ERROR_NOT_SUPPORTED;
+    }
+}
+
 static int
 pg_mac_address_cmp (const mac_address_t * m1, const mac_address_t * m2)
 {
@@ -185,6 +223,7 @@ VNET_DEVICE_CLASS (pg_dev_class) = {
   .format_tx_trace = format_pg_output_trace,
   .admin_up_down_function = pg_interface_admin_up_down,
   .mac_addr_add_del_function = pg_add_del_mac_address,
+  .flow_ops_function = pg_flow_ops_fn,
 };
 
 static u8 *
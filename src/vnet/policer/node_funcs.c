@@ -400,8 +400,15 @@ policer_classify_inline (vlib_main_t * vm,
 			 vlib_frame_t * frame,
 			 policer_classify_table_id_t tid)
 {
-  u32 n_left_from, *from, *to_next;
-  policer_classify_next_index_t next_index;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  vnet_classify_per_thread_data_t *ptd =
+    vec_elt_at_index (vnet_classify_main.per_thread_data, vm->thread_index);
+  vnet_classify_entry_t **entries = ptd->entries;
+  u32 *table_indices = ptd->table_indices;
+  u32 *hit_table_indices = ptd->hit_table_indices;
+  const u8 **headers = ptd->headers;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left_from, *from, i;
   policer_classify_main_t *pcm = &policer_classify_main;
   vnet_classify_main_t *vcm = pcm->vnet_classify_main;
   f64 now = vlib_time_now (vm);
@@ -418,240 +425,93 @@ policer_classify_inline (vlib_main_t * vm,
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left_from);
 
-  /* First pass: compute hashes */
-  while (n_left_from > 2)
-    {
-      vlib_buffer_t *b0, *b1;
-      u32 bi0, bi1;
-      u8 *h0, *h1;
-      u32 sw_if_index0, sw_if_index1;
-      u32 table_index0, table_index1;
-      vnet_classify_table_t *t0, *t1;
-
-      /* Prefetch next iteration */
-      {
-	vlib_buffer_t *p1, *p2;
-
-	p1 = vlib_get_buffer (vm, from[1]);
-	p2 = vlib_get_buffer (vm, from[2]);
-
-	vlib_prefetch_buffer_header (p1, STORE);
-	clib_prefetch_store (p1->data);
-	vlib_prefetch_buffer_header (p2, STORE);
-	clib_prefetch_store (p2->data);
-      }
-
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = b0->data;
-
-      bi1 = from[1];
-      b1 = vlib_get_buffer (vm, bi1);
-      h1 = b1->data;
-
-      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-      table_index0 =
-	pcm->classify_table_index_by_sw_if_index[tid][sw_if_index0];
-
-      sw_if_index1 = vnet_buffer (b1)->sw_if_index[VLIB_RX];
-      table_index1 =
-	pcm->classify_table_index_by_sw_if_index[tid][sw_if_index1];
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-
-      t1 = pool_elt_at_index (vcm->tables, table_index1);
-
-      vnet_buffer (b0)->l2_classify.hash =
-	vnet_classify_hash_packet (t0, (u8 *) h0);
-
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      vnet_buffer (b1)->l2_classify.hash =
-	vnet_classify_hash_packet (t1, (u8 *) h1);
-
-      vnet_classify_prefetch_bucket (t1, vnet_buffer (b1)->l2_classify.hash);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-
-      vnet_buffer (b1)->l2_classify.table_index = table_index1;
-
-      from += 2;
-      n_left_from -= 2;
-    }
-
-  while (n_left_from > 0)
+  /* First pass: gather the headers and the table each packet starts at */
+  for (i = 0; i < n_left_from; i++)
     {
-      vlib_buffer_t *b0;
-      u32 bi0;
-      u8 *h0;
       u32 sw_if_index0;
-      u32 table_index0;
-      vnet_classify_table_t *t0;
 
-      bi0 = from[0];
-      b0 = vlib_get_buffer (vm, bi0);
-      h0 = b0->data;
+      if (PREDICT_TRUE (i + 2 < n_left_from))
+	{
+	  vlib_prefetch_buffer_header (bufs[i + 2], STORE);
+	  clib_prefetch_store (bufs[i + 2]->data);
+	}
 
-      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-      table_index0 =
+      headers[i] = bufs[i]->data;
+      sw_if_index0 = vnet_buffer (bufs[i])->sw_if_index[VLIB_RX];
+      table_indices[i] =
 	pcm->classify_table_index_by_sw_if_index[tid][sw_if_index0];
-
-      t0 = pool_elt_at_index (vcm->tables, table_index0);
-      vnet_buffer (b0)->l2_classify.hash =
-	vnet_classify_hash_packet (t0, (u8 *) h0);
-
-      vnet_buffer (b0)->l2_classify.table_index = table_index0;
-      vnet_classify_prefetch_bucket (t0, vnet_buffer (b0)->l2_classify.hash);
-
-      from++;
-      n_left_from--;
     }
 
-  next_index = node->cached_next_index;
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
+  /* Second pass: look the whole frame up, walking the table chains */
+  hits = vnet_classify_find_entries_inline (table_indices, headers,
+					    n_left_from, now,
+					    1 /* walk_chain */, entries,
+					    hit_table_indices);
 
-  while (n_left_from > 0)
+  /* Third pass: police the hits */
+  b = bufs;
+  next = nexts;
+  for (i = 0; i < n_left_from; i++, b++, next++)
     {
-      u32 n_left_to_next;
+      vnet_classify_entry_t *e0 = entries[i];
+      vnet_classify_table_t *t0 = 0;
+      u32 next0;
+      u8 act0;
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      /* Not enough load/store slots to dual loop... */
-      while (n_left_from > 0 && n_left_to_next > 0)
+      if (tid == POLICER_CLASSIFY_TABLE_L2)
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-	  u32 table_index0;
-	  vnet_classify_table_t *t0;
-	  vnet_classify_entry_t *e0;
-	  u32 hash0;
-	  u8 *h0;
-	  u8 act0;
-
-	  /* Stride 3 seems to work best */
-	  if (PREDICT_TRUE (n_left_from > 3))
-	    {
-	      vlib_buffer_t *p1 = vlib_get_buffer (vm, from[3]);
-	      vnet_classify_table_t *tp1;
-	      u32 table_index1;
-	      u32 phash1;
-
-	      table_index1 = vnet_buffer (p1)->l2_classify.table_index;
-
-	      if (PREDICT_TRUE (table_index1 != ~0))
-		{
-		  tp1 = pool_elt_at_index (vcm->tables, table_index1);
-		  phash1 = vnet_buffer (p1)->l2_classify.hash;
-		  vnet_classify_prefetch_entry (tp1, phash1);
-		}
-	    }
-
-	  /* Speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  h0 = b0->data;
-	  table_index0 = vnet_buffer (b0)->l2_classify.table_index;
-	  e0 = 0;
-	  t0 = 0;
-
-	  if (tid == POLICER_CLASSIFY_TABLE_L2)
-	    {
-	      /* Feature bitmap update and determine the next node */
-	      next0 = vnet_l2_feature_next (b0, pcm->feat_next_node_index,
-					    L2INPUT_FEAT_POLICER_CLAS);
-	    }
-	  else
-	    vnet_get_config_data (pcm->vnet_config_main[tid],
-				  &b0->current_config_index, &next0,
-				  /* # bytes of config data */ 0);
+	  /* Feature bitmap update and determine the next node */
+	  next0 = vnet_l2_feature_next (b[0], pcm->feat_next_node_index,
+					L2INPUT_FEAT_POLICER_CLAS);
+	}
+      else
+	vnet_get_config_data (pcm->vnet_config_main[tid],
+			      &b[0]->current_config_index, &next0,
+			      /* # bytes of config data */ 0);
 
-	  vnet_buffer (b0)->l2_classify.opaque_index = ~0;
+      vnet_buffer (b[0])->l2_classify.opaque_index = ~0;
 
-	  if (PREDICT_TRUE (table_index0 != ~0))
-	    {
-	      hash0 = vnet_buffer (b0)->l2_classify.hash;
-	      t0 = pool_elt_at_index (vcm->tables, table_index0);
-	      e0 = vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
+      if (PREDICT_TRUE (hit_table_indices[i] != ~0))
+	t0 = pool_elt_at_index (vcm->tables, hit_table_indices[i]);
 
-	      if (e0)
-		{
-		  act0 = vnet_policer_police (vm, b0, e0->next_index,
-					      time_in_policer_periods,
-					      e0->opaque_index, false);
-		  if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-		    {
-		      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-		      b0->error = node->errors[POLICER_CLASSIFY_ERROR_DROP];
-		    }
-		  hits++;
-		}
-	      else
-		{
-		  while (1)
-		    {
-		      if (PREDICT_TRUE (t0->next_table_index != ~0))
-			{
-			  t0 = pool_elt_at_index (vcm->tables,
-						  t0->next_table_index);
-			}
-		      else
-			{
-			  next0 = (t0->miss_next_index < n_next_nodes) ?
-			    t0->miss_next_index : next0;
-			  misses++;
-			  break;
-			}
-
-		      hash0 = vnet_classify_hash_packet (t0, (u8 *) h0);
-		      e0 =
-			vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
-		      if (e0)
-			{
-			  act0 = vnet_policer_police (vm, b0, e0->next_index,
-						      time_in_policer_periods,
-						      e0->opaque_index, false);
-			  if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
-			    {
-			      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-			      b0->error =
-				node->errors[POLICER_CLASSIFY_ERROR_DROP];
-			    }
-			  hits++;
-			  chain_hits++;
-			  break;
-			}
-		    }
-		}
-	    }
-	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-			     && (b0->flags & VLIB_BUFFER_IS_TRACED)))
+      if (e0)
+	{
+	  act0 = vnet_policer_police (vm, b[0], e0->next_index,
+				      time_in_policer_periods,
+				      e0->opaque_index, false);
+	  if (PREDICT_FALSE (act0 == QOS_ACTION_DROP))
 	    {
-	      policer_classify_trace_t *t =
-		vlib_add_trace (vm, node, b0, sizeof (*t));
-	      t->sw_if_index = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-	      t->next_index = next0;
-	      t->table_index = t0 ? t0 - vcm->tables : ~0;
-	      t->offset = (e0 && t0) ? vnet_classify_get_offset (t0, e0) : ~0;
-	      t->policer_index = e0 ? e0->next_index : ~0;
+	      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
+	      b[0]->error = node->errors[POLICER_CLASSIFY_ERROR_DROP];
 	    }
+	  chain_hits += (hit_table_indices[i] != table_indices[i]);
+	}
+      else if (t0)
+	{
+	  next0 = (t0->miss_next_index < n_next_nodes) ?
+		    t0->miss_next_index : next0;
+	  misses++;
+	}
 
-	  /* Verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
+			 && (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  policer_classify_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+	  t->next_index = next0;
+	  t->table_index = hit_table_indices[i];
+	  t->offset = (e0 && t0) ? vnet_classify_get_offset (t0, e0) : ~0;
+	  t->policer_index = e0 ? e0->next_index : ~0;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      next[0] = next0;
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
   vlib_node_increment_counter (vm, node->node_index,
 			       POLICER_CLASSIFY_ERROR_MISS, misses);
   vlib_node_increment_counter (vm, node->node_index,
@@ -66,6 +66,14 @@ typedef enum
 // The lock field should be used for a spin-lock on the struct. Alternatively,
 // a thread index field is provided so that policed packets may be handed
 // off to a single worker thread.
+//
+// A distributed policer is policed on whichever thread receives the packet.
+// Each thread then owns a policer_slice_t holding a slice of the tokens,
+// which it tops up from the shared buckets below (under the lock field)
+// when it runs short. The shared buckets are refilled over time exactly as
+// for a thread-bound policer. At most one quantum per thread is held in the
+// slices, so the long-term rate is exact and the burst can exceed the
+// configured one by at most (n_threads - 1) quanta.
 
 #define POLICER_TICKS_PER_PERIOD_SHIFT 17
 #define POLICER_TICKS_PER_PERIOD       (1 << POLICER_TICKS_PER_PERIOD_SHIFT)
@@ -78,7 +86,8 @@ typedef struct
   u32 scale;			// power-of-2 shift amount for lower rates
   qos_action_type_en action[3];
   ip_dscp_t mark_dscp[3];
-  u8 pad[2];
+  u8 distributed;		// police on every thread from token slices
+  u8 lock;			// protects the buckets of a distributed policer
 
   // Fields are marked as 2R if they are only used for a 2-rate policer,
   // and MOD if they are modified as part of the update operation.
@@ -99,16 +108,68 @@ typedef struct
 
 STATIC_ASSERT_SIZEOF (policer_t, CLIB_CACHE_LINE_BYTES);
 
-static inline policer_result_e
-vnet_police_packet (policer_t *policer, u32 packet_length,
-		    policer_result_e packet_color, u64 time)
+// Per-thread token slice of a distributed policer.
+typedef struct
 {
-  u64 n_periods;
-  u64 current_tokens, extended_tokens;
-  policer_result_e result;
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 current_bucket;
+  u32 extended_bucket;
+  u32 current_quantum;		// tokens taken from the shared buckets
+  u32 extended_quantum;		// at each refill of the slice
+  u64 last_refill_time;
+  u32 n_refills;		// refills taken under the policer lock
+  u8 current_empty;		// shared current bucket empty at last refill
+  u8 extended_empty;		// shared extended bucket empty at last refill
+} policer_slice_t;
 
-  // Scale packet length to support a wide range of speeds
-  packet_length = packet_length << policer->scale;
+// Determine the color of a packet given the tokens available, and debit
+// the tokens accordingly. The packet length is already scaled.
+static_always_inline policer_result_e
+vnet_police_classify (policer_t *policer, u64 *current_tokens,
+		      u64 *extended_tokens, u32 packet_length,
+		      policer_result_e packet_color)
+{
+  if (policer->single_rate)
+    {
+      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
+	  && (*current_tokens >= packet_length))
+	{
+	  *current_tokens -= packet_length;
+	  *extended_tokens -= packet_length;
+	  return POLICE_CONFORM;
+	}
+      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
+	       && (*extended_tokens >= packet_length))
+	{
+	  *extended_tokens -= packet_length;
+	  return POLICE_EXCEED;
+	}
+      return POLICE_VIOLATE;
+    }
+
+  // Two-rate policer
+  if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
+      || (*extended_tokens < packet_length))
+    return POLICE_VIOLATE;
+
+  if ((policer->color_aware && (packet_color == POLICE_EXCEED))
+      || (*current_tokens < packet_length))
+    {
+      *extended_tokens -= packet_length;
+      return POLICE_EXCEED;
+    }
+
+  *current_tokens -= packet_length;
+  *extended_tokens -= packet_length;
+  return POLICE_CONFORM;
+}
+
+// Add the tokens accrued since the last update to the policer's buckets.
+static_always_inline void
+vnet_police_refill (policer_t *policer, u64 time, u64 *current_tokens,
+		    u64 *extended_tokens)
+{
+  u64 n_periods;
 
   // Compute the number of policer periods that have passed since the last
   // operation.
@@ -129,89 +190,111 @@ vnet_police_packet (policer_t *policer, u32 packet_length,
   // packet. This constraint on tokens_per_period lets the ucode omit
   // code to dynamically check for or prevent the overflow.
 
-  if (policer->single_rate)
-    {
+  // Compute number of tokens for this time period
+  *current_tokens =
+    policer->current_bucket + n_periods * policer->cir_tokens_per_period;
+  if (*current_tokens > policer->current_limit)
+    *current_tokens = policer->current_limit;
 
-      // Compute number of tokens for this time period
-      current_tokens =
-	policer->current_bucket + n_periods * policer->cir_tokens_per_period;
-      if (current_tokens > policer->current_limit)
-	{
-	  current_tokens = policer->current_limit;
-	}
+  // A single rate policer fills both buckets at the committed rate
+  *extended_tokens =
+    policer->extended_bucket +
+    n_periods * (policer->single_rate ? policer->cir_tokens_per_period :
+					policer->pir_tokens_per_period);
+  if (*extended_tokens > policer->extended_limit)
+    *extended_tokens = policer->extended_limit;
+}
 
-      extended_tokens =
-	policer->extended_bucket + n_periods * policer->cir_tokens_per_period;
-      if (extended_tokens > policer->extended_limit)
-	{
-	  extended_tokens = policer->extended_limit;
-	}
+static inline policer_result_e
+vnet_police_packet (policer_t *policer, u32 packet_length,
+		    policer_result_e packet_color, u64 time)
+{
+  u64 current_tokens, extended_tokens;
+  policer_result_e result;
 
-      // Determine color
+  // Scale packet length to support a wide range of speeds
+  packet_length = packet_length << policer->scale;
 
-      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
-	  && (current_tokens >= packet_length))
-	{
-	  policer->current_bucket = current_tokens - packet_length;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_CONFORM;
-	}
-      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
-	       && (extended_tokens >= packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_EXCEED;
-	}
-      else
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens;
-	  result = POLICE_VIOLATE;
-	}
+  vnet_police_refill (policer, time, &current_tokens, &extended_tokens);
 
-    }
-  else
-    {
-      // Two-rate policer
-
-      // Compute number of tokens for this time period
-      current_tokens =
-	policer->current_bucket + n_periods * policer->cir_tokens_per_period;
-      extended_tokens =
-	policer->extended_bucket + n_periods * policer->pir_tokens_per_period;
-      if (current_tokens > policer->current_limit)
-	{
-	  current_tokens = policer->current_limit;
-	}
-      if (extended_tokens > policer->extended_limit)
-	{
-	  extended_tokens = policer->extended_limit;
-	}
+  result = vnet_police_classify (policer, &current_tokens, &extended_tokens,
+				 packet_length, packet_color);
 
-      // Determine color
+  policer->current_bucket = current_tokens;
+  policer->extended_bucket = extended_tokens;
+
+  return result;
+}
+
+// Hand the slice's unused tokens back to the shared buckets and take a
+// fresh quantum from them. Within a policer period the shared buckets only
+// grow by the tokens other slices hand back, so a bucket a refill found
+// empty is not refilled again until the next period. If the slice is only
+// short of tokens in such buckets, the packet is classified from what the
+// slice holds, e.g. as exceed once the committed tokens are used up.
+static_always_inline void
+vnet_police_slice_refill (policer_t *policer, policer_slice_t *slice,
+			  u32 packet_length, u64 time)
+{
+  u64 current_tokens, extended_tokens;
+  u32 take;
+
+  if (slice->last_refill_time == time &&
+      (slice->current_bucket >= packet_length || slice->current_empty) &&
+      (slice->extended_bucket >= packet_length || slice->extended_empty))
+    return;
+  slice->last_refill_time = time;
+
+  while (clib_atomic_test_and_set (&policer->lock))
+    CLIB_PAUSE ();
+
+  vnet_police_refill (policer, time, &current_tokens, &extended_tokens);
+
+  current_tokens += slice->current_bucket;
+  if (current_tokens > policer->current_limit)
+    current_tokens = policer->current_limit;
+  extended_tokens += slice->extended_bucket;
+  if (extended_tokens > policer->extended_limit)
+    extended_tokens = policer->extended_limit;
+
+  take = clib_min (current_tokens, slice->current_quantum);
+  slice->current_bucket = take;
+  policer->current_bucket = current_tokens - take;
+
+  take = clib_min (extended_tokens, slice->extended_quantum);
+  slice->extended_bucket = take;
+  policer->extended_bucket = extended_tokens - take;
+
+  slice->current_empty = policer->current_bucket == 0;
+  slice->extended_empty = policer->extended_bucket == 0;
+  slice->n_refills++;
+
+  clib_atomic_release (&policer->lock);
+}
+
+static inline policer_result_e
+vnet_police_packet_distributed (policer_t *policer, policer_slice_t *slice,
+				u32 packet_length,
+				policer_result_e packet_color, u64 time)
+{
+  u64 current_tokens, extended_tokens;
+  policer_result_e result;
+
+  packet_length = packet_length << policer->scale;
+
+  if (PREDICT_FALSE (slice->current_bucket < packet_length ||
+		     slice->extended_bucket < packet_length))
+    vnet_police_slice_refill (policer, slice, packet_length, time);
+
+  current_tokens = slice->current_bucket;
+  extended_tokens = slice->extended_bucket;
+
+  result = vnet_police_classify (policer, &current_tokens, &extended_tokens,
+				 packet_length, packet_color);
+
+  slice->current_bucket = current_tokens;
+  slice->extended_bucket = extended_tokens;
 
-      if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
-	  || (extended_tokens < packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens;
-	  result = POLICE_VIOLATE;
-	}
-      else if ((policer->color_aware && (packet_color == POLICE_EXCEED))
-	       || (current_tokens < packet_length))
-	{
-	  policer->current_bucket = current_tokens;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_EXCEED;
-	}
-      else
-	{
-	  policer->current_bucket = current_tokens - packet_length;
-	  policer->extended_bucket = extended_tokens - packet_length;
-	  result = POLICE_CONFORM;
-	}
-    }
   return result;
 }
 
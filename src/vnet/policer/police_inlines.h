@@ -72,6 +72,16 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 
   pol = &pm->policers[policer_index];
 
+  if (pol->distributed)
+    {
+      /* police on this thread from its own slice of the tokens */
+      len = vlib_buffer_length_in_chain (vm, b);
+      col = vnet_police_packet_distributed (
+	pol, vec_elt_at_index (pm->slices[policer_index], vm->thread_index),
+	len, packet_color, time_in_policer_periods);
+      goto done;
+    }
+
   if (handoff)
     {
       if (PREDICT_FALSE (pol->thread_index == CLIB_INVALID_THREAD_INDEX))
@@ -90,6 +100,8 @@ vnet_policer_police (vlib_main_t *vm, vlib_buffer_t *b, u32 policer_index,
 
   len = vlib_buffer_length_in_chain (vm, b);
   col = vnet_police_packet (pol, len, packet_color, time_in_policer_periods);
+
+done:
   act = pol->action[col];
   vlib_increment_combined_counter (&policer_counters[col], vm->thread_index,
 				   policer_index, 1, len);
@@ -18,6 +18,7 @@
 #include <vnet/policer/police_inlines.h>
 #include <vnet/classify/vnet_classify.h>
 #include <vnet/ip/ip_packet.h>
+#include <vnet/ethernet/ethernet.h>
 
 vnet_policer_main_t vnet_policer_main;
 
@@ -49,6 +50,64 @@ vlib_combined_counter_main_t policer_counters[] = {
   },
 };
 
+/*
+ * Size the per-thread slices of a distributed policer. A quantum of half
+ * the burst spread over the threads bounds the tokens held by the threads,
+ * while a couple of full-size frames keeps a thread from returning to the
+ * shared buckets for every packet.
+ */
+static void
+policer_slices_init (vnet_policer_main_t *pm, u32 policer_index)
+{
+  policer_t *policer = &pm->policers[policer_index];
+  u32 n_threads = vlib_get_n_threads ();
+  policer_slice_t *slice;
+  u32 cq, eq, min;
+
+  min = (2 * ETHERNET_MAX_PACKET_BYTES) << policer->scale;
+  cq = clib_max (policer->current_limit / (2 * n_threads), min);
+  eq = clib_max (policer->extended_limit / (2 * n_threads), min);
+
+  vec_validate (pm->slices, policer_index);
+  vec_validate_aligned (pm->slices[policer_index], n_threads - 1,
+			CLIB_CACHE_LINE_BYTES);
+
+  vec_foreach (slice, pm->slices[policer_index])
+    {
+      slice->current_bucket = 0;
+      slice->extended_bucket = 0;
+      slice->current_quantum = clib_min (cq, policer->current_limit);
+      slice->extended_quantum = clib_min (eq, policer->extended_limit);
+      slice->last_refill_time = 0;
+      slice->n_refills = 0;
+      slice->current_empty = 0;
+      slice->extended_empty = 0;
+    }
+}
+
+static void
+policer_slices_free (vnet_policer_main_t *pm, u32 policer_index)
+{
+  policer_t *policer = &pm->policers[policer_index];
+  policer_slice_t *slice;
+
+  if (policer_index >= vec_len (pm->slices))
+    return;
+
+  /* the tokens the threads hold go back to the shared buckets */
+  vec_foreach (slice, pm->slices[policer_index])
+    {
+      policer->current_bucket =
+	clib_min ((u64) policer->current_bucket + slice->current_bucket,
+		  policer->current_limit);
+      policer->extended_bucket =
+	clib_min ((u64) policer->extended_bucket + slice->extended_bucket,
+		  policer->extended_limit);
+    }
+
+  vec_free (pm->slices[policer_index]);
+}
+
 int
 policer_add (vlib_main_t *vm, const u8 *name, const qos_pol_cfg_params_st *cfg,
 	     u32 *policer_index)
@@ -119,6 +178,7 @@ policer_del (vlib_main_t *vm, u32 policer_index)
     }
 
   /* free policer */
+  policer_slices_free (pm, policer_index);
   hash_unset_mem (pm->policer_index_by_name, policer->name);
   vec_free (policer->name);
   pool_put_index (pm->policers, policer_index);
@@ -136,6 +196,7 @@ policer_update (vlib_main_t *vm, u32 policer_index,
   qos_pol_cfg_params_st *cp;
   uword *p;
   u8 *name;
+  u8 distributed;
   int rv;
   int i;
 
@@ -164,6 +225,7 @@ policer_update (vlib_main_t *vm, u32 policer_index,
     }
 
   name = policer->name;
+  distributed = policer->distributed;
 
   clib_memcpy (cp, cfg, sizeof (*cp));
   clib_memcpy (policer, &test_policer, sizeof (*policer));
@@ -171,6 +233,13 @@ policer_update (vlib_main_t *vm, u32 policer_index,
   policer->name = name;
   policer->thread_index = ~0;
 
+  if (distributed)
+    {
+      /* the quanta follow the new burst sizes */
+      policer_slices_init (pm, policer_index);
+      policer->distributed = 1;
+    }
+
   for (i = 0; i < NUM_POLICE_RESULTS; i++)
     vlib_zero_combined_counter (&policer_counters[i], policer_index);
 
@@ -191,6 +260,39 @@ policer_reset (vlib_main_t *vm, u32 policer_index)
   policer->current_bucket = policer->current_limit;
   policer->extended_bucket = policer->extended_limit;
 
+  if (policer->distributed)
+    policer_slices_init (pm, policer_index);
+
+  return 0;
+}
+
+int
+policer_distribute (u32 policer_index, bool enable)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  policer_t *policer;
+
+  if (pool_is_free_index (pm->policers, policer_index))
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  policer = &pm->policers[policer_index];
+
+  if (enable == policer->distributed)
+    return 0;
+
+  if (enable)
+    {
+      /* the slices start empty, all tokens stay in the shared buckets */
+      policer_slices_init (pm, policer_index);
+      policer->thread_index = ~0;
+      policer->distributed = 1;
+    }
+  else
+    {
+      policer->distributed = 0;
+      policer_slices_free (pm, policer_index);
+    }
+
   return 0;
 }
 
@@ -212,10 +314,12 @@ policer_bind_worker (u32 policer_index, u32 worker, bool bind)
 	  return VNET_API_ERROR_INVALID_WORKER;
 	}
 
+      policer_distribute (policer_index, 0);
       policer->thread_index = vlib_get_worker_thread_index (worker);
     }
   else
     {
+      policer_distribute (policer_index, 0);
       policer->thread_index = ~0;
     }
   return 0;
@@ -278,6 +382,19 @@ format_policer_instance (u8 * s, va_list * va)
 	      i->current_limit,
 	      i->current_bucket, i->extended_limit, i->extended_bucket);
   s = format (s, "last update %llu\n", i->last_update_time);
+  if (i->distributed)
+    {
+      policer_slice_t *slice;
+
+      s = format (s, "distributed, per-thread cur/ext bkt:");
+      vec_foreach (slice, pm->slices[policer_index])
+	s = format (s, " %u/%u", slice->current_bucket,
+		    slice->extended_bucket);
+      s = format (s, "\nper-thread refills:");
+      vec_foreach (slice, pm->slices[policer_index])
+	s = format (s, " %u", slice->n_refills);
+      s = format (s, "\n");
+    }
   s = format (s, "conform %llu packets, %llu bytes\n",
 	      counts[POLICE_CONFORM].packets, counts[POLICE_CONFORM].bytes);
   s = format (s, "exceed %llu packets, %llu bytes\n",
@@ -707,6 +824,7 @@ policer_bind_command_fn (vlib_main_t *vm, unformat_input_t *input,
   clib_error_t *error = NULL;
   vnet_policer_main_t *pm = &vnet_policer_main;
   u8 bind = 1;
+  u8 distributed = 0;
   u8 *name = 0;
   u32 worker = ~0;
   u32 policer_index = ~0;
@@ -725,6 +843,8 @@ policer_bind_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	;
       else if (unformat (line_input, "unbind"))
 	bind = 0;
+      else if (unformat (line_input, "distributed"))
+	distributed = 1;
       else if (unformat (line_input, "%d", &worker))
 	;
       else
@@ -735,7 +855,7 @@ policer_bind_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	}
     }
 
-  if (bind && ~0 == worker)
+  if (bind && ~0 == worker && !distributed)
     {
       error = clib_error_return (0, "specify worker to bind to: `%U'",
 				 format_unformat_error, line_input);
@@ -751,7 +871,12 @@ policer_bind_command_fn (vlib_main_t *vm, unformat_input_t *input,
 
       rv = VNET_API_ERROR_NO_SUCH_ENTRY;
       if (~0 != policer_index)
-	rv = policer_bind_worker (policer_index, worker, bind);
+	{
+	  if (bind && distributed)
+	    rv = policer_distribute (policer_index, 1);
+	  else
+	    rv = policer_bind_worker (policer_index, worker, bind);
+	}
 
       if (rv)
 	error = clib_error_return (0, "failed: `%d'", rv);
@@ -919,7 +1044,8 @@ VLIB_CLI_COMMAND (policer_del_command, static) = {
 
 VLIB_CLI_COMMAND (policer_bind_command, static) = {
   .path = "policer bind",
-  .short_help = "policer bind [unbind] [name <name> | index <index>] <worker>",
+  .short_help = "policer bind [unbind] [name <name> | index <index>] "
+		"<worker> | distributed",
   .function = policer_bind_command_fn,
 };
 
@@ -2242,6 +2242,17 @@ session_config_fn (vlib_main_t * vm, unformat_input_t * input)
 	smm->port_allocator_min_src_port = tmp;
       else if (unformat (input, "max-src-port %d", &tmp))
 	smm->port_allocator_max_src_port = tmp;
+      else if (unformat (input, "rss-steering"))
+	smm->rss_steering = 1;
+      else if (unformat (input, "rss-key %U", unformat_hex_string,
+			 &smm->rss_key))
+	;
+      else if (unformat (input, "rss-reta-size %d", &tmp))
+	{
+	  if (!is_pow2 (tmp))
+	    return clib_error_return (0, "rss-reta-size must be a power of 2");
+	  smm->rss_reta_size = tmp;
+	}
       else if (unformat (input, "enable rt-backend rule-table"))
 	{
 	  smm->rt_engine_type = RT_BACKEND_ENGINE_RULE_TABLE;
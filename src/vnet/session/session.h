@@ -28,6 +28,9 @@ typedef struct session_wrk_stats_
   u32 errors[SESSION_N_ERRORS];
 } session_wrk_stats_t;
 
+/** Max fifo chunks a tx burst is copied from without a fifo peek */
+#define SESSION_TX_MAX_FIFO_SEGS 32
+
 typedef struct session_tx_context_
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -49,6 +52,12 @@ typedef struct session_tx_context_
   /** Vector of tx buffer free lists */
   u32 *tx_buffers;
   vlib_buffer_t **transport_pending_bufs;
+
+  /** Fifo data of a peek burst and copy position within it */
+  svm_fifo_seg_t *tx_segs;
+  u32 n_tx_segs;
+  u32 tx_seg_index;
+  u32 tx_seg_offset;
 } session_tx_context_t;
 
 typedef struct session_evt_elt
@@ -294,6 +303,12 @@ typedef struct session_main_
   u16 port_allocator_min_src_port;
   u16 port_allocator_max_src_port;
 
+  /** Choose source ports so that RSS steers the return traffic of active
+   *  opens to the thread hinted by the app */
+  u8 rss_steering;
+  u8 *rss_key;
+  u32 rss_reta_size;
+
   /** Preallocate session config parameter */
   u32 preallocated_sessions;
 
@@ -972,14 +972,61 @@ session_tx_fill_dma_transfers_tail (session_worker_t *wrk,
   return len_write;
 }
 
+/**
+ * Look up the fifo chunks holding the data of a peek burst once, so that
+ * filling the buffers is a plain copy from the chunks instead of a fifo
+ * peek, with its head and tail loads and chunk lookup, per buffer. The
+ * data is still copied into the buffers, they never point at fifo memory.
+ */
+always_inline void
+session_tx_get_fifo_segs (session_tx_context_t *ctx)
+{
+  u32 n_segs = SESSION_TX_MAX_FIFO_SEGS;
+  int n_bytes;
+
+  vec_validate (ctx->tx_segs, SESSION_TX_MAX_FIFO_SEGS - 1);
+  n_bytes = svm_fifo_segments (ctx->s->tx_fifo, ctx->sp.tx_offset,
+			       ctx->tx_segs, &n_segs, ctx->max_len_to_snd);
+  ctx->n_tx_segs = n_bytes > 0 ? n_segs : 0;
+  ctx->tx_seg_index = 0;
+  ctx->tx_seg_offset = 0;
+}
+
+always_inline int
+session_tx_copy_from_fifo_segs (session_tx_context_t *ctx, u32 len, u8 *dst)
+{
+  svm_fifo_seg_t *seg;
+  u32 n_copied = 0, n;
+
+  while (n_copied < len && ctx->tx_seg_index < ctx->n_tx_segs)
+    {
+      seg = &ctx->tx_segs[ctx->tx_seg_index];
+      n = clib_min (seg->len - ctx->tx_seg_offset, len - n_copied);
+      clib_memcpy_fast (dst + n_copied, seg->data + ctx->tx_seg_offset, n);
+      n_copied += n;
+      ctx->tx_seg_offset += n;
+      if (ctx->tx_seg_offset == seg->len)
+	{
+	  ctx->tx_seg_index += 1;
+	  ctx->tx_seg_offset = 0;
+	}
+    }
+
+  /* burst spans more chunks than were looked up */
+  if (PREDICT_FALSE (n_copied < len))
+    n_copied += svm_fifo_peek (ctx->s->tx_fifo, ctx->sp.tx_offset + n_copied,
+			       len - n_copied, dst + n_copied);
+
+  return n_copied;
+}
+
 always_inline int
 session_tx_copy_data (session_worker_t *wrk, session_tx_context_t *ctx,
 		      vlib_buffer_t *b, u32 len_to_deq, u8 *data0)
 {
   int n_bytes_read;
   if (PREDICT_TRUE (!wrk->dma_enabled))
-    n_bytes_read =
-      svm_fifo_peek (ctx->s->tx_fifo, ctx->sp.tx_offset, len_to_deq, data0);
+    n_bytes_read = session_tx_copy_from_fifo_segs (ctx, len_to_deq, data0);
   else
     n_bytes_read = session_tx_fill_dma_transfers (wrk, ctx, b);
   return n_bytes_read;
@@ -991,8 +1038,7 @@ session_tx_copy_data_tail (session_worker_t *wrk, session_tx_context_t *ctx,
 {
   int n_bytes_read;
   if (PREDICT_TRUE (!wrk->dma_enabled))
-    n_bytes_read =
-      svm_fifo_peek (ctx->s->tx_fifo, ctx->sp.tx_offset, len_to_deq, data);
+    n_bytes_read = session_tx_copy_from_fifo_segs (ctx, len_to_deq, data);
   else
     n_bytes_read =
       session_tx_fill_dma_transfers_tail (wrk, ctx, b, len_to_deq, data);
@@ -1519,6 +1565,9 @@ session_tx_fifo_read_and_snd_i (session_worker_t * wrk,
   ctx->left_to_snd = ctx->max_len_to_snd;
   n_left = ctx->n_segs_per_evt;
 
+  if (peek_data && PREDICT_TRUE (!wrk->dma_enabled))
+    session_tx_get_fifo_segs (ctx);
+
   vec_validate (ctx->transport_pending_bufs, n_left);
 
   while (n_left >= 4)
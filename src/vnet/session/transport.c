@@ -16,6 +16,9 @@
 #include <vnet/session/transport.h>
 #include <vnet/session/session.h>
 #include <vnet/fib/fib.h>
+#include <vnet/dev/dev_funcs.h>
+#include <vnet/interface/rx_queue_funcs.h>
+#include <vppinfra/vector/toeplitz.h>
 
 /**
  * Per-type vector of transport protocol virtual function tables
@@ -40,6 +43,13 @@ typedef struct transport_main_
   u16 port_allocator_max_src_port;
   u8 lcl_endpts_cleanup_pending;
   clib_spinlock_t local_endpoints_lock;
+
+  /* rss steering of active opens */
+  clib_toeplitz_hash_key_t *rss_key;
+  u32 rss_reta_size;
+  u32 *rss_queue_threads;
+  u32 rss_n_steered;
+  u32 rss_n_not_steered;
 } transport_main_t;
 
 static transport_main_t tp_main;
@@ -235,6 +245,8 @@ format_transport_state (u8 *s, va_list *args)
   s =
     format (s, " min_lcl_port: %u max_lcl_port: %u\n",
 	    tm->port_allocator_min_src_port, tm->port_allocator_max_src_port);
+  if (tm->rss_key)
+    s = format (s, " rss steering: reta size %u\n", tm->rss_reta_size);
 
   s = format (s, "state:\n");
   s = format (s, " lcl ports alloced: %u\n lcl ports freelist: %u \n",
@@ -243,6 +255,9 @@ format_transport_state (u8 *s, va_list *args)
   s =
     format (s, " port_alloc_max_tries: %u\n lcl_endpts_cleanup_pending: %u\n",
 	    tm->port_alloc_max_tries, tm->lcl_endpts_cleanup_pending);
+  if (tm->rss_key)
+    s = format (s, " rss steered: %u not steered: %u\n", tm->rss_n_steered,
+		tm->rss_n_not_steered);
   return s;
 }
 
@@ -623,10 +638,140 @@ transport_share_local_endpoint (u8 proto, u32 fib_index,
     }
 }
 
+static session_error_t
+transport_find_interface_for_remote (u32 *sw_if_index,
+				     transport_endpoint_t *rmt)
+{
+  fib_node_index_t fei;
+  fib_prefix_t prefix;
+
+  /* Find a FIB path to the destination */
+  clib_memcpy_fast (&prefix.fp_addr, &rmt->ip, sizeof (rmt->ip));
+  prefix.fp_proto = rmt->is_ip4 ? FIB_PROTOCOL_IP4 : FIB_PROTOCOL_IP6;
+  prefix.fp_len = rmt->is_ip4 ? 32 : 128;
+
+  ASSERT (rmt->fib_index != ENDPOINT_INVALID_INDEX);
+  fei = fib_table_lookup (rmt->fib_index, &prefix);
+
+  /* Couldn't find route to destination. Bail out. */
+  if (fei == FIB_NODE_INDEX_INVALID)
+    return SESSION_E_NOROUTE;
+
+  *sw_if_index = fib_entry_get_resolving_interface (fei);
+  if (*sw_if_index == ENDPOINT_INVALID_INDEX)
+    return SESSION_E_NOINTF;
+
+  return 0;
+}
+
+/**
+ * Build the rx queue to thread map of the interface the return traffic of
+ * an active open comes in on.
+ *
+ * @return number of rx queues, 0 if the traffic can't be steered
+ */
+static u32
+transport_rss_queue_threads (transport_endpoint_cfg_t *rmt)
+{
+  transport_main_t *tm = &tp_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = rmt->peer.sw_if_index;
+  vnet_hw_interface_t *hw;
+  vnet_dev_port_t *port;
+
+  vec_reset_length (tm->rss_queue_threads);
+
+  if (sw_if_index == ENDPOINT_INVALID_INDEX &&
+      transport_find_interface_for_remote (&sw_if_index,
+					   (transport_endpoint_t *) rmt))
+    return 0;
+
+  hw = vnet_get_sup_hw_interface (vnm, sw_if_index);
+
+  if ((port = vnet_dev_get_port_from_hw_if_index (hw->hw_if_index)))
+    {
+      foreach_vnet_dev_port_rx_queue (q, port)
+	{
+	  vec_validate_init_empty (tm->rss_queue_threads, q->queue_id, ~0);
+	  tm->rss_queue_threads[q->queue_id] = q->rx_thread_index;
+	}
+    }
+  else
+    {
+      u32 *qi;
+      vec_foreach (qi, hw->rx_queue_indices)
+	{
+	  vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, *qi);
+	  vec_validate_init_empty (tm->rss_queue_threads, rxq->queue_id, ~0);
+	  tm->rss_queue_threads[rxq->queue_id] = rxq->thread_index;
+	}
+    }
+
+  /* rss spreads over queues 0 to n - 1 */
+  if (vec_len (tm->rss_queue_threads) < 2 ||
+      vec_search (tm->rss_queue_threads, ~0) != ~0)
+    return 0;
+
+  return vec_len (tm->rss_queue_threads);
+}
+
+/**
+ * Toeplitz hash the NIC computes over the return traffic of an active open,
+ * i.e., with the remote endpoint as the source.
+ */
+u32
+transport_rss_hash (transport_endpoint_cfg_t *rmt, ip46_address_t *lcl_addr,
+		    u16 lcl_port)
+{
+  transport_main_t *tm = &tp_main;
+  u8 data[2 * sizeof (ip6_address_t) + 4], *d = data;
+  u32 addr_len;
+
+  if (rmt->is_ip4)
+    {
+      addr_len = sizeof (ip4_address_t);
+      clib_memcpy_fast (d, &rmt->ip.ip4, addr_len);
+      clib_memcpy_fast (d + addr_len, &lcl_addr->ip4, addr_len);
+    }
+  else
+    {
+      addr_len = sizeof (ip6_address_t);
+      clib_memcpy_fast (d, &rmt->ip.ip6, addr_len);
+      clib_memcpy_fast (d + addr_len, &lcl_addr->ip6, addr_len);
+    }
+  d += 2 * addr_len;
+  clib_memcpy_fast (d, &rmt->port, 2);
+  clib_memcpy_fast (d + 2, &lcl_port, 2);
+
+  return clib_toeplitz_hash (tm->rss_key, data, 2 * addr_len + 4);
+}
+
+/**
+ * Thread RSS steers the return traffic of an active open to. Assumes the
+ * default redirection table, which spreads the hash values round-robin
+ * over the rx queues.
+ */
+static u32
+transport_rss_thread (transport_endpoint_cfg_t *rmt, ip46_address_t *lcl_addr,
+		      u16 lcl_port)
+{
+  transport_main_t *tm = &tp_main;
+  u32 hash;
+
+  hash = transport_rss_hash (rmt, lcl_addr, lcl_port);
+  hash &= tm->rss_reta_size - 1;
+
+  return tm->rss_queue_threads[hash % vec_len (tm->rss_queue_threads)];
+}
+
 /**
  * Allocate local port and add if successful add entry to local endpoint
  * table to mark the pair as used.
  *
+ * If rss steering is enabled and the connect hints a thread, ports the
+ * NIC would not steer the return traffic to that thread are skipped for
+ * the first half of the tries.
+ *
  * @return port in net order or -1 if port cannot be allocated
  */
 int
@@ -636,13 +781,17 @@ transport_alloc_local_port (u8 proto, ip46_address_t *lcl_addr,
   transport_main_t *tm = &tp_main;
   u16 min = tm->port_allocator_min_src_port;
   u16 max = tm->port_allocator_max_src_port;
-  int tries, limit, port = -1;
+  int tries, limit, port = -1, steer_tries = 0;
 
   limit = max - min;
 
   /* Only support active opens from one of ctrl threads */
   ASSERT (vlib_get_thread_index () <= transport_cl_thread ());
 
+  if (tm->rss_key && (rmt->transport_flags & TRANSPORT_CFG_F_THREAD_HINT) &&
+      transport_rss_queue_threads (rmt))
+    steer_tries = limit / 2;
+
   /* Search for first free slot */
   for (tries = 0; tries < limit; tries++)
     {
@@ -657,6 +806,10 @@ transport_alloc_local_port (u8 proto, ip46_address_t *lcl_addr,
 	    }
 	}
 
+      if (tries < steer_tries &&
+	  transport_rss_thread (rmt, lcl_addr, port) != rmt->thread_hint)
+	continue;
+
       if (!transport_endpoint_mark_used (proto, rmt->fib_index, lcl_addr,
 					 port))
 	break;
@@ -673,6 +826,13 @@ transport_alloc_local_port (u8 proto, ip46_address_t *lcl_addr,
     }
 
   tm->port_alloc_max_tries = clib_max (tm->port_alloc_max_tries, tries);
+  if (steer_tries)
+    {
+      if (tries < steer_tries)
+	tm->rss_n_steered++;
+      else
+	tm->rss_n_not_steered++;
+    }
 
   return port;
 }
@@ -725,27 +885,11 @@ transport_find_local_ip_for_remote (u32 *sw_if_index,
 				    transport_endpoint_t *rmt,
 				    ip46_address_t *lcl_addr)
 {
-  fib_node_index_t fei;
-  fib_prefix_t prefix;
-
-  if (*sw_if_index == ENDPOINT_INVALID_INDEX)
-    {
-      /* Find a FIB path to the destination */
-      clib_memcpy_fast (&prefix.fp_addr, &rmt->ip, sizeof (rmt->ip));
-      prefix.fp_proto = rmt->is_ip4 ? FIB_PROTOCOL_IP4 : FIB_PROTOCOL_IP6;
-      prefix.fp_len = rmt->is_ip4 ? 32 : 128;
-
-      ASSERT (rmt->fib_index != ENDPOINT_INVALID_INDEX);
-      fei = fib_table_lookup (rmt->fib_index, &prefix);
+  session_error_t error;
 
-      /* Couldn't find route to destination. Bail out. */
-      if (fei == FIB_NODE_INDEX_INVALID)
-	return SESSION_E_NOROUTE;
-
-      *sw_if_index = fib_entry_get_resolving_interface (fei);
-      if (*sw_if_index == ENDPOINT_INVALID_INDEX)
-	return SESSION_E_NOINTF;
-    }
+  if (*sw_if_index == ENDPOINT_INVALID_INDEX &&
+      (error = transport_find_interface_for_remote (sw_if_index, rmt)))
+    return error;
 
   clib_memset (lcl_addr, 0, sizeof (*lcl_addr));
   return transport_get_interface_ip (*sw_if_index, rmt->is_ip4, lcl_addr);
@@ -1041,6 +1185,19 @@ transport_init (void)
   tm->port_allocator_min_src_port = smm->port_allocator_min_src_port;
   tm->port_allocator_max_src_port = smm->port_allocator_max_src_port;
 
+  if (smm->rss_steering && !tm->rss_key)
+    {
+      if (smm->rss_key &&
+	  vec_len (smm->rss_key) < 2 * sizeof (ip6_address_t) + 8)
+	clib_warning ("rss key too short, using the default one");
+      else
+	tm->rss_key = clib_toeplitz_hash_key_init (smm->rss_key,
+						   vec_len (smm->rss_key));
+      if (!tm->rss_key)
+	tm->rss_key = clib_toeplitz_hash_key_init (0, 0);
+      tm->rss_reta_size = smm->rss_reta_size ? smm->rss_reta_size : 128;
+    }
+
   clib_bihash_init_24_8 (&tm->local_endpoints_table, "local endpoints table",
 			 smm->local_endpoints_table_buckets,
 			 smm->local_endpoints_table_memory);
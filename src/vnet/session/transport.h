@@ -255,6 +255,8 @@ void transport_share_local_endpoint (u8 proto, u32 fib_index,
 				     ip46_address_t *lcl_ip, u16 port);
 int transport_release_local_endpoint (u8 proto, u32 fib_index,
 				      ip46_address_t *lcl_ip, u16 port);
+u32 transport_rss_hash (transport_endpoint_cfg_t *rmt,
+			ip46_address_t *lcl_addr, u16 lcl_port);
 u16 transport_port_alloc_max_tries ();
 u32 transport_port_local_in_use ();
 void transport_clear_stats ();
@@ -216,6 +216,8 @@ typedef enum transport_endpt_cfg_flags_
 {
   TRANSPORT_CFG_F_CONNECTED = 1 << 0,
   TRANSPORT_CFG_F_UNIDIRECTIONAL = 1 << 1,
+  /* thread_hint is valid */
+  TRANSPORT_CFG_F_THREAD_HINT = 1 << 2,
 } transport_endpt_cfg_flags_t;
 
 /* clang-format off */
@@ -227,6 +229,7 @@ typedef enum transport_endpt_cfg_flags_
   _ (u16, mss)           						\
   _ (u8, dscp) \
   _ (u8, transport_flags)						\
+  _ (u16, thread_hint)							\
 /* clang-format on */
 
 typedef struct transport_endpoint_pair_
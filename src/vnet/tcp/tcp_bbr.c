@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2025 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * BBR congestion control
+ *
+ * Model based congestion control that estimates the bottleneck bandwidth
+ * and the round-trip propagation delay from the delivery rate samples of
+ * the byte tracker and paces at, and bounds inflight to, a multiple of
+ * their product. Random loss does not reduce the model, but, as in BBRv2,
+ * loss above a threshold bounds the inflight data.
+ */
+
+#include <vnet/tcp/tcp.h>
+#include <vnet/tcp/tcp_inlines.h>
+
+#define BBR_HIGH_GAIN		2.885	/* 2/ln(2) */
+#define BBR_DRAIN_GAIN		(1 / BBR_HIGH_GAIN)
+#define BBR_CWND_GAIN		2.0
+#define BBR_PACING_MARGIN	0.99
+#define BBR_FULL_BW_THRESH	1.25
+#define BBR_FULL_BW_ROUNDS	3
+#define BBR_PROBE_RTT_TIME	200	/* ms */
+#define BBR_MIN_CWND_SEGS	4
+#define BBR_CYCLE_LEN		8
+#define BBR_BETA		0.7
+
+typedef enum bbr_mode_
+{
+  BBR_MODE_STARTUP,
+  BBR_MODE_DRAIN,
+  BBR_MODE_PROBE_BW,
+  BBR_MODE_PROBE_RTT,
+} bbr_mode_e;
+
+typedef enum bbr_flag_
+{
+  BBR_F_FULL_BW = 1 << 0,	/**< Bottleneck bandwidth reached */
+  BBR_F_ROUND_START = 1 << 1,	/**< Current ack starts a round */
+  BBR_F_PROBE_RTT_ROUND = 1 << 2, /**< Round elapsed in probe-rtt */
+  BBR_F_IDLE_RESTART = 1 << 3,	/**< Restarting after app idle */
+} bbr_flag_e;
+
+typedef struct bbr_cfg_
+{
+  u32 min_rtt_win;		/**< Min rtt filter window (ms) */
+  u32 bw_win_rounds;		/**< Max bw filter window (rounds) */
+  f64 loss_thresh;		/**< Loss rate that bounds inflight */
+} bbr_cfg_t;
+
+static bbr_cfg_t bbr_cfg = {
+  .min_rtt_win = 10000,
+  .bw_win_rounds = 10,
+  .loss_thresh = 0.02,
+};
+
+typedef struct bbr_data_
+{
+  /** time (in sec) when the current gain cycle phase started */
+  f64 cycle_stamp;
+
+  /** windowed max filter of delivery rate, split in two slots that
+   *  each cover half of the window (bytes/s) */
+  u64 max_bw[2];
+
+  /** bw of the last round that grew by @ref BBR_FULL_BW_THRESH */
+  u64 full_bw;
+
+  /** min rtt (in us) and timestamp (in ms) when it was measured */
+  u32 min_rtt_us;
+  u32 min_rtt_stamp;
+
+  /** timestamp (in ms) when probe-rtt may end, or 0 */
+  u32 probe_rtt_done_stamp;
+
+  /** bytes delivered, low 32 bits, when the next round starts */
+  u32 next_round_delivered;
+
+  /** max inflight before loss exceeded the threshold, or ~0 */
+  u32 inflight_hi;
+
+  /** cwnd before recovery or probe-rtt */
+  u32 prior_cwnd;
+
+  u8 mode;
+  u8 cycle_idx;
+  u8 full_bw_cnt;
+  u8 slot_rounds;
+  u8 flags;
+} __clib_packed bbr_data_t;
+
+STATIC_ASSERT (sizeof (bbr_data_t) <= TCP_CC_DATA_SZ, "bbr data len");
+
+static const f64 bbr_pacing_gain[BBR_CYCLE_LEN] = {
+  1.25, 0.75, 1, 1, 1, 1, 1, 1
+};
+
+static inline u64
+bbr_bw (bbr_data_t *bd)
+{
+  return clib_max (bd->max_bw[0], bd->max_bw[1]);
+}
+
+static inline u32
+bbr_min_cwnd (tcp_connection_t *tc)
+{
+  return BBR_MIN_CWND_SEGS * tc->snd_mss;
+}
+
+static inline f64
+bbr_pacing_gain_get (bbr_data_t *bd)
+{
+  switch (bd->mode)
+    {
+    case BBR_MODE_STARTUP:
+      return BBR_HIGH_GAIN;
+    case BBR_MODE_DRAIN:
+      return BBR_DRAIN_GAIN;
+    case BBR_MODE_PROBE_BW:
+      if (bd->flags & BBR_F_IDLE_RESTART)
+	return 1;
+      return bbr_pacing_gain[bd->cycle_idx];
+    default:
+      return 1;
+    }
+}
+
+/**
+ * Estimated bandwidth-delay product scaled by gain. Falls back to the
+ * initial window until the first bandwidth and rtt samples.
+ */
+static u32
+bbr_bdp (tcp_connection_t *tc, bbr_data_t *bd, f64 gain)
+{
+  u64 bw = bbr_bw (bd);
+
+  if (!bw || bd->min_rtt_us == ~0)
+    return tcp_initial_cwnd (tc);
+
+  return clib_min ((f64) bw * bd->min_rtt_us * 1e-6 * gain, (f64) ~0U);
+}
+
+static void
+bbr_save_cwnd (tcp_connection_t *tc, bbr_data_t *bd)
+{
+  if (bd->mode != BBR_MODE_PROBE_RTT && !tcp_in_cong_recovery (tc))
+    bd->prior_cwnd = tc->cwnd;
+  else
+    bd->prior_cwnd = clib_max (bd->prior_cwnd, tc->cwnd);
+}
+
+static void
+bbr_update_round (tcp_connection_t *tc, bbr_data_t *bd, tcp_rate_sample_t *rs)
+{
+  bd->flags &= ~BBR_F_ROUND_START;
+  if ((i32) ((u32) rs->prior_delivered - bd->next_round_delivered) < 0)
+    return;
+
+  bd->next_round_delivered = tc->delivered;
+  bd->flags |= BBR_F_ROUND_START;
+  bd->slot_rounds++;
+}
+
+static void
+bbr_update_bw (bbr_data_t *bd, tcp_rate_sample_t *rs)
+{
+  u64 bw;
+
+  if (rs->interval_time <= 0)
+    return;
+
+  /* Age the filter, one slot every half window */
+  if ((bd->flags & BBR_F_ROUND_START)
+      && bd->slot_rounds >= clib_max (bbr_cfg.bw_win_rounds / 2, 1))
+    {
+      bd->max_bw[1] = bd->max_bw[0];
+      bd->max_bw[0] = 0;
+      bd->slot_rounds = 0;
+    }
+
+  bw = rs->delivered / rs->interval_time;
+
+  /* App limited samples underestimate the bw unless they exceed it */
+  if ((rs->flags & TCP_BTS_IS_APP_LIMITED) && bw < bbr_bw (bd))
+    return;
+
+  bd->max_bw[0] = clib_max (bd->max_bw[0], bw);
+}
+
+/**
+ * Bound inflight if the loss rate of the sample exceeds the threshold and
+ * let the bound grow back while probing for bandwidth.
+ */
+static void
+bbr_update_loss_bound (tcp_connection_t *tc, bbr_data_t *bd,
+		       tcp_rate_sample_t *rs)
+{
+  if (!rs->tx_in_flight)
+    return;
+
+  if (bbr_cfg.loss_thresh > 0
+      && rs->lost > bbr_cfg.loss_thresh * rs->tx_in_flight)
+    {
+      bd->inflight_hi = clib_max (rs->tx_in_flight * BBR_BETA,
+				  bbr_min_cwnd (tc));
+      /* Startup stops growing once loss is high */
+      bd->flags |= BBR_F_FULL_BW;
+      return;
+    }
+
+  if (bd->inflight_hi != ~0 && bd->mode == BBR_MODE_PROBE_BW
+      && bbr_pacing_gain_get (bd) > 1 && rs->tx_in_flight >= bd->inflight_hi)
+    bd->inflight_hi += rs->delivered;
+}
+
+static void
+bbr_check_full_bw (bbr_data_t *bd, tcp_rate_sample_t *rs)
+{
+  u64 bw;
+
+  if ((bd->flags & BBR_F_FULL_BW) || !(bd->flags & BBR_F_ROUND_START)
+      || (rs->flags & TCP_BTS_IS_APP_LIMITED))
+    return;
+
+  bw = bbr_bw (bd);
+  if (bw >= bd->full_bw * BBR_FULL_BW_THRESH)
+    {
+      bd->full_bw = bw;
+      bd->full_bw_cnt = 0;
+      return;
+    }
+
+  if (++bd->full_bw_cnt >= BBR_FULL_BW_ROUNDS)
+    bd->flags |= BBR_F_FULL_BW;
+}
+
+static void
+bbr_enter_probe_bw (tcp_connection_t *tc, bbr_data_t *bd)
+{
+  bd->mode = BBR_MODE_PROBE_BW;
+  /* Start in a random cruise phase so flows don't probe in lockstep */
+  bd->cycle_idx = 2 + clib_cpu_time_now () % (BBR_CYCLE_LEN - 2);
+  bd->cycle_stamp = tcp_time_now_us (tc->c_thread_index);
+}
+
+static void
+bbr_update_cycle (tcp_connection_t *tc, bbr_data_t *bd, tcp_rate_sample_t *rs)
+{
+  f64 now, gain;
+  u32 inflight;
+  u8 elapsed;
+
+  if (bd->mode != BBR_MODE_PROBE_BW)
+    return;
+
+  now = tcp_time_now_us (tc->c_thread_index);
+  elapsed = now - bd->cycle_stamp > bd->min_rtt_us * 1e-6;
+  inflight = tcp_flight_size (tc);
+  gain = bbr_pacing_gain[bd->cycle_idx];
+
+  if (gain > 1)
+    {
+      /* Probe until a min rtt passed and either the queue built up or
+       * the path started dropping */
+      if (!elapsed || (!rs->lost && inflight < bbr_bdp (tc, bd, gain)))
+	return;
+    }
+  else if (gain < 1)
+    {
+      /* Drain until the queue is gone */
+      if (!elapsed && inflight > bbr_bdp (tc, bd, 1))
+	return;
+    }
+  else if (!elapsed)
+    return;
+
+  bd->cycle_idx = (bd->cycle_idx + 1) % BBR_CYCLE_LEN;
+  bd->cycle_stamp = now;
+}
+
+static void
+bbr_check_drain (tcp_connection_t *tc, bbr_data_t *bd)
+{
+  if (bd->mode == BBR_MODE_STARTUP && (bd->flags & BBR_F_FULL_BW))
+    bd->mode = BBR_MODE_DRAIN;
+
+  if (bd->mode == BBR_MODE_DRAIN
+      && tcp_flight_size (tc) <= bbr_bdp (tc, bd, 1))
+    bbr_enter_probe_bw (tc, bd);
+}
+
+static void
+bbr_exit_probe_rtt (tcp_connection_t *tc, bbr_data_t *bd)
+{
+  tc->cwnd = clib_max (tc->cwnd, bd->prior_cwnd);
+  if (bd->flags & BBR_F_FULL_BW)
+    bbr_enter_probe_bw (tc, bd);
+  else
+    bd->mode = BBR_MODE_STARTUP;
+}
+
+static void
+bbr_update_min_rtt (tcp_connection_t *tc, bbr_data_t *bd,
+		    tcp_rate_sample_t *rs)
+{
+  u32 now = tcp_time_tstamp (tc->c_thread_index), rtt_us;
+  u8 expired;
+
+  expired = now - bd->min_rtt_stamp > bbr_cfg.min_rtt_win;
+  if (rs->rtt_time > 0)
+    {
+      rtt_us = clib_max (rs->rtt_time * 1e6, 1);
+      if (rtt_us <= bd->min_rtt_us || expired)
+	{
+	  bd->min_rtt_us = rtt_us;
+	  bd->min_rtt_stamp = now;
+	}
+    }
+
+  if (expired && bd->mode != BBR_MODE_PROBE_RTT
+      && !(bd->flags & BBR_F_IDLE_RESTART))
+    {
+      bbr_save_cwnd (tc, bd);
+      bd->mode = BBR_MODE_PROBE_RTT;
+      bd->probe_rtt_done_stamp = 0;
+    }
+
+  if (bd->mode != BBR_MODE_PROBE_RTT)
+    return;
+
+  if (!bd->probe_rtt_done_stamp)
+    {
+      /* Wait for inflight to drop to min cwnd before the timer starts */
+      if (tcp_flight_size (tc) > bbr_min_cwnd (tc))
+	return;
+      bd->probe_rtt_done_stamp = clib_max (now + BBR_PROBE_RTT_TIME, 1);
+      bd->flags &= ~BBR_F_PROBE_RTT_ROUND;
+      bd->next_round_delivered = tc->delivered;
+      return;
+    }
+
+  if (bd->flags & BBR_F_ROUND_START)
+    bd->flags |= BBR_F_PROBE_RTT_ROUND;
+
+  if ((bd->flags & BBR_F_PROBE_RTT_ROUND)
+      && (i32) (now - bd->probe_rtt_done_stamp) >= 0)
+    {
+      bd->min_rtt_stamp = now;
+      bbr_exit_probe_rtt (tc, bd);
+    }
+}
+
+static void
+bbr_update_model (tcp_connection_t *tc, bbr_data_t *bd, tcp_rate_sample_t *rs)
+{
+  bbr_update_round (tc, bd, rs);
+  bbr_update_bw (bd, rs);
+  bbr_update_loss_bound (tc, bd, rs);
+  bbr_update_cycle (tc, bd, rs);
+  bbr_check_full_bw (bd, rs);
+  bbr_check_drain (tc, bd);
+  bbr_update_min_rtt (tc, bd, rs);
+
+  if (rs->delivered)
+    bd->flags &= ~BBR_F_IDLE_RESTART;
+}
+
+/**
+ * Grow cwnd towards the target inflight, i.e., the bdp scaled by the cwnd
+ * gain and bounded by the loss derived inflight limit.
+ */
+static void
+bbr_set_cwnd (tcp_connection_t *tc, bbr_data_t *bd, tcp_rate_sample_t *rs)
+{
+  u32 target, min_cwnd = bbr_min_cwnd (tc);
+
+  target = bbr_bdp (tc, bd, BBR_CWND_GAIN) + 3 * tc->snd_mss;
+  target = clib_min (target, bd->inflight_hi);
+
+  if (bd->flags & BBR_F_FULL_BW)
+    tc->cwnd = clib_min (tc->cwnd + rs->delivered, target);
+  else if (tc->cwnd < target || tc->delivered < tcp_initial_cwnd (tc))
+    tc->cwnd += rs->delivered;
+
+  /* Constrained by tx fifo, can't grow further */
+  tc->cwnd = clib_min (tc->cwnd, clib_max (tc->tx_fifo_size, min_cwnd));
+  tc->cwnd = clib_max (tc->cwnd, min_cwnd);
+
+  if (bd->mode == BBR_MODE_PROBE_RTT)
+    tc->cwnd = clib_min (tc->cwnd, min_cwnd);
+}
+
+static void
+bbr_rcv_ack (tcp_connection_t *tc, tcp_rate_sample_t *rs)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  bbr_update_model (tc, bd, rs);
+  bbr_set_cwnd (tc, bd, rs);
+}
+
+static void
+bbr_rcv_cong_ack (tcp_connection_t *tc, tcp_cc_ack_t ack_type,
+		  tcp_rate_sample_t *rs)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  /* Output is governed by prr while in recovery, so only keep the model
+   * up to date */
+  bbr_update_model (tc, bd, rs);
+}
+
+static void
+bbr_congestion (tcp_connection_t *tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  bbr_save_cwnd (tc, bd);
+
+  /* Don't back off multiplicatively, prr only reduces to the loss bound */
+  tc->ssthresh = clib_max (clib_min (tc->cwnd, bd->inflight_hi),
+			   bbr_min_cwnd (tc));
+}
+
+static void
+bbr_loss (tcp_connection_t *tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  bbr_save_cwnd (tc, bd);
+  tc->cwnd = tcp_loss_wnd (tc);
+}
+
+static void
+bbr_recovered (tcp_connection_t *tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  tc->cwnd = clib_max (tc->cwnd, bd->prior_cwnd);
+  tc->cwnd = clib_max (clib_min (tc->cwnd, bd->inflight_hi),
+		       bbr_min_cwnd (tc));
+}
+
+static void
+bbr_undo_recovery (tcp_connection_t *tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  /* Loss was spurious so it should not bound inflight */
+  if (bd->inflight_hi != ~0)
+    bd->inflight_hi = clib_max (bd->inflight_hi, tc->prev_cwnd);
+}
+
+static void
+bbr_event (tcp_connection_t *tc, tcp_cc_event_t evt)
+{
+  bbr_data_t *bd;
+
+  if (evt != TCP_CC_EVT_START_TX)
+    return;
+
+  /* App was idle so don't probe, the bw estimate is stale */
+  bd = (bbr_data_t *) tcp_cc_data (tc);
+  bd->flags |= BBR_F_IDLE_RESTART;
+}
+
+static u64
+bbr_get_pacing_rate (tcp_connection_t *tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+  u64 bw = bbr_bw (bd);
+  f64 srtt;
+
+  if (bw)
+    return clib_max (bbr_pacing_gain_get (bd) * bw * BBR_PACING_MARGIN, 1);
+
+  /* No bw sample yet, pace the initial window at the startup gain */
+  srtt = clib_min ((f64) tc->srtt * TCP_TICK, tc->mrtt_us);
+  if (srtt <= 0)
+    srtt = 1;
+  return BBR_HIGH_GAIN * tc->cwnd / srtt;
+}
+
+static void
+bbr_conn_init (tcp_connection_t *tc)
+{
+  bbr_data_t *bd = (bbr_data_t *) tcp_cc_data (tc);
+
+  clib_memset (bd, 0, sizeof (*bd));
+  bd->mode = BBR_MODE_STARTUP;
+  bd->min_rtt_us = ~0;
+  bd->min_rtt_stamp = tcp_time_tstamp (tc->c_thread_index);
+  bd->inflight_hi = ~0;
+  bd->next_round_delivered = tc->delivered;
+
+  tc->ssthresh = 0x7FFFFFFFU;
+  tc->cwnd = tcp_initial_cwnd (tc);
+
+  /* The model is built from delivery rate samples */
+  tc->cfg_flags |= TCP_CFG_F_RATE_SAMPLE;
+}
+
+static uword
+bbr_unformat_config (unformat_input_t *input)
+{
+  u32 min_rtt_win, bw_win_rounds, loss_thresh;
+
+  if (!input)
+    return 0;
+
+  unformat_skip_white_space (input);
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "min-rtt-window %u", &min_rtt_win))
+	bbr_cfg.min_rtt_win = min_rtt_win;
+      else if (unformat (input, "bw-window %u", &bw_win_rounds))
+	{
+	  if (bw_win_rounds < 2 || bw_win_rounds > 255)
+	    return 0;
+	  bbr_cfg.bw_win_rounds = bw_win_rounds;
+	}
+      else if (unformat (input, "loss-thresh %u", &loss_thresh))
+	{
+	  if (loss_thresh > 100)
+	    return 0;
+	  bbr_cfg.loss_thresh = loss_thresh / 100.0;
+	}
+      else if (unformat (input, "no-loss-bound"))
+	bbr_cfg.loss_thresh = 0;
+      else
+	return 0;
+    }
+  return 1;
+}
+
+const static tcp_cc_algorithm_t tcp_bbr = {
+  .name = "bbr",
+  .unformat_cfg = bbr_unformat_config,
+  .init = bbr_conn_init,
+  .rcv_ack = bbr_rcv_ack,
+  .rcv_cong_ack = bbr_rcv_cong_ack,
+  .congestion = bbr_congestion,
+  .loss = bbr_loss,
+  .recovered = bbr_recovered,
+  .undo_recovery = bbr_undo_recovery,
+  .event = bbr_event,
+  .get_pacing_rate = bbr_get_pacing_rate,
+};
+
+clib_error_t *
+bbr_init (vlib_main_t *vm)
+{
+  clib_error_t *error = 0;
+
+  tcp_cc_algo_register (TCP_CC_BBR, &tcp_bbr);
+
+  return error;
+}
+
+VLIB_INIT_FUNCTION (bbr_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -545,6 +545,186 @@ stat_segment_version (void)
   return stat_segment_version_r (sm);
 }
 
+/* true if n elements at p are within the mapped segment */
+static bool
+stat_segment_delta_in_segment (stat_client_main_t *sm, void *p, u64 n,
+			       u32 elt_size)
+{
+  char *csh = (char *) sm->shared_header;
+  return p && (char *) p + n * elt_size <= csh + sm->memory_size;
+}
+
+/*
+ * Copy the whole snapshot, when starting or after falling more than a ring
+ * behind the collector.
+ */
+static int
+stat_segment_delta_copy (stat_segment_delta_t *d, vlib_stats_delta_ring_t *r,
+			 stat_client_main_t *sm)
+{
+  vlib_stats_delta_snapshot_t *snapshot, *s;
+  stat_segment_delta_entry_t *e;
+  u64 generation, head, n_values, *values;
+  u64 max_time = sm->timeout ? _time_now_nsec () + sm->timeout : 0;
+  u32 i, n_entries;
+
+retry:
+  if (max_time && _time_now_nsec () >= max_time)
+    return -1;
+
+  generation = __atomic_load_n (&r->generation, __ATOMIC_ACQUIRE);
+  if (generation & 1)
+    goto retry;
+
+  head = r->head;
+  snapshot = stat_segment_adjust (sm, (void *) r->snapshot);
+  n_entries = snapshot ? vec_len (snapshot) : 0;
+  if (!stat_segment_delta_in_segment (sm, snapshot, n_entries,
+				      sizeof (snapshot[0])))
+    goto retry;
+
+  vec_foreach (e, d->entries)
+    {
+      e->n_values = e->n_indices = 0;
+      vec_reset_length (e->values);
+    }
+  if (n_entries)
+    vec_validate (d->entries, n_entries - 1);
+
+  for (i = 0; i < n_entries; i++)
+    {
+      s = snapshot + i;
+      e = d->entries + i;
+      e->n_values = s->n_values;
+      e->n_indices = s->n_indices;
+      n_values = (u64) s->n_values * s->n_indices;
+      if (n_values == 0)
+	continue;
+      values = stat_segment_adjust (sm, s->values);
+      if (!stat_segment_delta_in_segment (sm, values, n_values,
+					  sizeof (values[0])))
+	goto retry;
+      vec_add (e->values, values, n_values);
+    }
+
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  if (__atomic_load_n (&r->generation, __ATOMIC_RELAXED) != generation)
+    goto retry;
+
+  d->head = head;
+  d->synced = true;
+  d->resynced = true;
+  vec_reset_length (d->changes);
+  return 0;
+}
+
+static void
+stat_segment_delta_apply (stat_segment_delta_t *d,
+			  vlib_stats_delta_record_t *rec)
+{
+  stat_segment_delta_entry_t *e;
+  stat_segment_delta_change_t *c;
+  u32 vi = rec->vector_index;
+
+  vec_validate (d->entries, rec->entry_index);
+  e = d->entries + rec->entry_index;
+
+  if (vi == VLIB_STATS_DELTA_RESET_INDEX)
+    {
+      e->n_values = rec->value[0];
+      e->n_indices = 0;
+      vec_reset_length (e->values);
+    }
+  else
+    {
+      if (e->n_values == 0)
+	return;
+      if (vi >= e->n_indices)
+	{
+	  vec_validate (e->values, (vi + 1) * e->n_values - 1);
+	  e->n_indices = vi + 1;
+	}
+      e->values[vi * e->n_values] = rec->value[0];
+      if (e->n_values == 2)
+	e->values[vi * 2 + 1] = rec->value[1];
+    }
+
+  vec_add2 (d->changes, c, 1);
+  c->entry_index = rec->entry_index;
+  c->vector_index = vi;
+}
+
+/*
+ * Bring d up to date with the delta export of the segment. Returns 0 on
+ * success, -1 if the export is disabled or the collector didn't finish an
+ * update within the timeout.
+ */
+int
+stat_segment_delta_sync_r (stat_segment_delta_t *d, stat_client_main_t *sm)
+{
+  vlib_stats_delta_ring_t *r;
+  vlib_stats_delta_record_t *records, rec;
+  u64 pos, head, seq;
+
+  ASSERT (sm->shared_header);
+  r = stat_segment_adjust (sm, (void *) sm->shared_header->delta_ring);
+  if (r == 0)
+    return -1;
+
+  head = __atomic_load_n (&r->head, __ATOMIC_ACQUIRE);
+  if (!d->synced || head - d->head > r->n_records)
+    return stat_segment_delta_copy (d, r, sm);
+
+  records = stat_segment_adjust (sm, r->records);
+  if (!stat_segment_delta_in_segment (sm, records, r->n_records,
+				      sizeof (records[0])))
+    return -1;
+
+  d->resynced = false;
+  vec_reset_length (d->changes);
+
+  for (pos = d->head; pos < head; pos++)
+    {
+      vlib_stats_delta_record_t *slot = records + (pos & (r->n_records - 1));
+
+      seq = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+      rec.entry_index = slot->entry_index;
+      rec.vector_index = slot->vector_index;
+      rec.value[0] = slot->value[0];
+      rec.value[1] = slot->value[1];
+      __atomic_thread_fence (__ATOMIC_ACQUIRE);
+
+      /* overwritten by the collector, which lapped us while reading */
+      if (seq != pos + 1 ||
+	  __atomic_load_n (&slot->seq, __ATOMIC_RELAXED) != seq)
+	return stat_segment_delta_copy (d, r, sm);
+
+      stat_segment_delta_apply (d, &rec);
+    }
+
+  d->head = head;
+  return 0;
+}
+
+int
+stat_segment_delta_sync (stat_segment_delta_t *d)
+{
+  stat_client_main_t *sm = &stat_client_main;
+  return stat_segment_delta_sync_r (d, sm);
+}
+
+void
+stat_segment_delta_free (stat_segment_delta_t *d)
+{
+  stat_segment_delta_entry_t *e;
+
+  vec_foreach (e, d->entries)
+    vec_free (e->values);
+  vec_free (d->entries);
+  vec_free (d->changes);
+  clib_memset (d, 0, sizeof (*d));
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
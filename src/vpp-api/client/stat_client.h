@@ -91,6 +91,44 @@ typedef struct
   uint64_t epoch;
 } stat_segment_access_t;
 
+/*
+ * Copy of the counters published by the delta export, kept up to date by
+ * stat_segment_delta_sync. Values are summed over the threads, n_values per
+ * index: one for simple counters and scalars, packets and bytes for combined
+ * counters.
+ */
+typedef struct
+{
+  uint32_t n_values;
+  uint32_t n_indices;
+  uint64_t *values;
+} stat_segment_delta_entry_t;
+
+typedef struct
+{
+  uint32_t entry_index;
+  /* VLIB_STATS_DELTA_RESET_INDEX if the entry was (re)created */
+  uint32_t vector_index;
+} stat_segment_delta_change_t;
+
+typedef struct
+{
+  /* next record to apply */
+  uint64_t head;
+  bool synced;
+  /* the last sync copied the whole snapshot, changes is empty */
+  bool resynced;
+  /* indexed by directory entry */
+  stat_segment_delta_entry_t *entries;
+  /* values changed by the last sync */
+  stat_segment_delta_change_t *changes;
+} stat_segment_delta_t;
+
+int stat_segment_delta_sync_r (stat_segment_delta_t *d,
+			       stat_client_main_t *sm);
+int stat_segment_delta_sync (stat_segment_delta_t *d);
+void stat_segment_delta_free (stat_segment_delta_t *d);
+
 static inline uint64_t
 _time_now_nsec (void)
 {
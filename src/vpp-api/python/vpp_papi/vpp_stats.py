@@ -289,6 +289,142 @@ class VPPStats:
             result[cnt] = self.__getitem__(cnt, blocking)
         return result
 
+    @property
+    def delta_ring(self):
+        """Get pointer of the delta export ring, 0 if disabled"""
+        return self.shared_headerfmt.unpack_from(self.statseg)[5]
+
+    def delta(self):
+        """Returns a local copy of the counters kept by the delta export"""
+        if not self.connected:
+            self.connect()
+        return StatsDelta(self)
+
+
+class StatsDelta:
+    """Counters summed over the threads, updated from the delta export
+
+    Mirrors stat_segment_delta_sync() of the C stat client: sync() applies
+    the records written since the previous call, or copies the whole
+    snapshot on the first call and when the collector lapped the reader.
+    """
+
+    RING_FMT = Struct("QQQPP")
+    RECORD_FMT = Struct("QIIQQ")
+    SNAPSHOT_FMT = Struct("IIP")
+    RESET_INDEX = 0xFFFFFFFF
+    MAX_RETRIES = 1000
+
+    def __init__(self, stats):
+        self.stats = stats
+        self.head = 0
+        self.synced = False
+        # the last sync copied the whole snapshot, changes is empty
+        self.resynced = False
+        # entry index -> [values per index, flat list of values]
+        self.entries = {}
+        # (entry index, vector index) changed by the last sync
+        self.changes = []
+
+    def _ring(self):
+        ring = self.stats.delta_ring
+        if not ring:
+            raise IOError("Delta export not enabled")
+        return self.RING_FMT.unpack_from(self.stats.statseg, ring - self.stats.base)
+
+    def _copy(self):
+        statseg = self.stats.statseg
+        base = self.stats.base
+        for _ in range(self.MAX_RETRIES):
+            _, head, generation, snapshot, _ = self._ring()
+            if generation & 1:
+                continue
+            entries = {}
+            if snapshot:
+                offset = snapshot - base
+                for i in range(get_vec_len(self.stats, offset)):
+                    n_values, n_indices, values = self.SNAPSHOT_FMT.unpack_from(
+                        statseg, offset + i * self.SNAPSHOT_FMT.size
+                    )
+                    n = n_values * n_indices
+                    entries[i] = [
+                        n_values,
+                        list(Struct("%dQ" % n).unpack_from(statseg, values - base))
+                        if n
+                        else [],
+                    ]
+            if self._ring()[2] != generation:
+                continue
+            self.entries = entries
+            self.head = head
+            self.synced = True
+            self.resynced = True
+            self.changes = []
+            return
+        raise IOError("Delta export snapshot kept changing")
+
+    def _apply(self, entry_index, vector_index, v0, v1):
+        entry = self.entries.setdefault(entry_index, [0, []])
+        if vector_index == self.RESET_INDEX:
+            entry[0] = v0
+            entry[1] = []
+        else:
+            n_values = entry[0]
+            if n_values == 0:
+                return
+            values = entry[1]
+            if len(values) < (vector_index + 1) * n_values:
+                values.extend([0] * ((vector_index + 1) * n_values - len(values)))
+            values[vector_index * n_values] = v0
+            if n_values == 2:
+                values[vector_index * 2 + 1] = v1
+        self.changes.append((entry_index, vector_index))
+
+    def sync(self):
+        """Bring the copy up to date with the segment"""
+        n_records, head, _, _, records = self._ring()
+        if not self.synced or head - self.head > n_records:
+            return self._copy()
+
+        statseg = self.stats.statseg
+        offset = records - self.stats.base
+        self.resynced = False
+        self.changes = []
+        for pos in range(self.head, head):
+            slot = offset + (pos & (n_records - 1)) * self.RECORD_FMT.size
+            seq, entry_index, vector_index, v0, v1 = self.RECORD_FMT.unpack_from(
+                statseg, slot
+            )
+            # overwritten by the collector, which lapped us while reading
+            if (
+                seq != pos + 1
+                or self.RECORD_FMT.unpack_from(statseg, slot)[0] != seq
+            ):
+                return self._copy()
+            self._apply(entry_index, vector_index, v0, v1)
+        self.head = head
+
+    def pending(self):
+        """Records written since the last sync, and the ring size"""
+        n_records, head, _, _, _ = self._ring()
+        return head - self.head, n_records
+
+    def index(self, name):
+        """Directory index of a counter"""
+        if self.stats.last_epoch != self.stats.epoch:
+            self.stats.refresh()
+        for i, path in self.stats.directory_by_idx.items():
+            if path == name:
+                return i
+        raise KeyError(name)
+
+    def get(self, name):
+        """Values of a counter: one per index, (packets, bytes) if combined"""
+        n_values, values = self.entries.get(self.index(name), [0, []])
+        if n_values == 2:
+            return list(zip(values[0::2], values[1::2]))
+        return list(values)
+
 
 class StatsLock:
     """Stat segment optimistic locking"""
@@ -102,6 +102,69 @@ stat_poll_loop (u8 ** patterns)
     }
 }
 
+/*
+ * Print the counters matching the patterns which changed on each update of
+ * the segment, from the delta export.
+ */
+static int
+stat_delta_loop (u8 ** patterns)
+{
+  stat_client_main_t *sm = &stat_client_main;
+  stat_segment_delta_t d = {};
+  stat_segment_delta_change_t *c;
+  stat_segment_delta_entry_t *e;
+  uword *matching = 0;
+  u32 *stats = 0;
+  u64 epoch = 0, *v;
+  char *name;
+  int i;
+
+  while (1)
+    {
+      /* directory changed, match the patterns again */
+      if (sm->shared_header->epoch != epoch)
+	{
+	  vec_free (stats);
+	  stats = stat_segment_ls (patterns);
+	  clib_bitmap_zero (matching);
+	  for (i = 0; i < vec_len (stats); i++)
+	    matching = clib_bitmap_set (matching, stats[i], 1);
+	  epoch = sm->current_epoch;
+	}
+
+      if (stat_segment_delta_sync (&d))
+	{
+	  fformat (stderr, "Delta export not enabled (statseg "
+			   "delta-ring-size) or lost connection to VPP...\n");
+	  break;
+	}
+
+      vec_foreach (c, d.changes)
+	{
+	  if (c->vector_index == VLIB_STATS_DELTA_RESET_INDEX ||
+	      !clib_bitmap_get (matching, c->entry_index))
+	    continue;
+	  if ((name = stat_segment_index_to_name (c->entry_index)) == 0)
+	    continue;
+	  e = d.entries + c->entry_index;
+	  v = e->values + c->vector_index * e->n_values;
+	  if (e->n_values == 2)
+	    fformat (stdout, "[%d]: %llu packets, %llu bytes %s\n",
+		     c->vector_index, v[0], v[1], name);
+	  else
+	    fformat (stdout, "[%d]: %llu %s\n", c->vector_index, v[0], name);
+	  free (name);
+	}
+
+      sleep (1);
+    }
+
+  stat_segment_delta_free (&d);
+  vec_free (stats);
+  clib_bitmap_free (matching);
+  return -1;
+}
+
 enum stat_client_cmd_e
 {
   STAT_CLIENT_CMD_UNKNOWN,
@@ -109,6 +172,7 @@ enum stat_client_cmd_e
   STAT_CLIENT_CMD_POLL,
   STAT_CLIENT_CMD_DUMP,
   STAT_CLIENT_CMD_TIGHTPOLL,
+  STAT_CLIENT_CMD_DELTAS,
 };
 
 #ifdef CLIB_SANITIZE_ADDR
@@ -155,6 +219,10 @@ main (int argc, char **argv)
 	{
 	  cmd = STAT_CLIENT_CMD_TIGHTPOLL;
 	}
+      else if (unformat (a, "deltas"))
+	{
+	  cmd = STAT_CLIENT_CMD_DELTAS;
+	}
       else if (unformat (a, "%s", &pattern))
 	{
 	  vec_add1 (patterns, pattern);
@@ -162,7 +230,7 @@ main (int argc, char **argv)
       else
 	{
 	  fformat (stderr,
-		   "%s: usage [socket-name <name>] [ls|dump|poll] <patterns> ...\n",
+		   "%s: usage [socket-name <name>] [ls|dump|poll|deltas] <patterns> ...\n",
 		   argv[0]);
 	  exit (1);
 	}
@@ -268,9 +336,15 @@ reconnect:
 	}
       break;
 
+    case STAT_CLIENT_CMD_DELTAS:
+      stat_delta_loop (patterns);
+      stat_segment_disconnect ();
+      goto reconnect;
+      break;
+
     default:
       fformat (stderr,
-	       "%s: usage [socket-name <name>] [ls|dump|poll] <patterns> ...\n",
+	       "%s: usage [socket-name <name>] [ls|dump|poll|deltas] <patterns> ...\n",
 	       argv[0]);
     }
 
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#ifndef __clib_chacha20_h__
+#define __clib_chacha20_h__
+
+#include <vppinfra/clib.h>
+#include <vppinfra/vector.h>
+#include <vppinfra/string.h>
+
+/*
+ * ChaCha20 as specified in RFC 8439 (256-bit key, 96-bit nonce and 32-bit
+ * block counter).
+ *
+ * The state is kept transposed: word i of the state of each of the blocks
+ * computed together is in lane n of vector i. The lanes are independent,
+ * so they may hold consecutive blocks of one stream, or blocks of as many
+ * different streams (keys and nonces), which is what multi-buffer
+ * processing of short packets needs.
+ */
+
+#if defined(CLIB_HAVE_VEC512)
+#define CLIB_CHACHA20_N_LANES 16
+typedef u32x16 clib_chacha20_u32xn;
+#elif defined(CLIB_HAVE_VEC256)
+#define CLIB_CHACHA20_N_LANES 8
+typedef u32x8 clib_chacha20_u32xn;
+#else
+#define CLIB_CHACHA20_N_LANES 4
+typedef u32x4 clib_chacha20_u32xn;
+#endif
+
+#define CLIB_CHACHA20_KEY_LEN	32
+#define CLIB_CHACHA20_NONCE_LEN 12
+#define CLIB_CHACHA20_BLOCK_LEN 64
+
+/* "expand 32-byte k" */
+static const u32 _clib_chacha20_const[4] = { 0x61707865, 0x3320646e,
+					     0x79622d32, 0x6b206574 };
+
+static_always_inline clib_chacha20_u32xn
+_clib_chacha20_rotl (clib_chacha20_u32xn x, const int n)
+{
+  return (x << n) | (x >> (32 - n));
+}
+
+static_always_inline void
+_clib_chacha20_quarter_round (clib_chacha20_u32xn *x, int a, int b, int c,
+			      int d)
+{
+  x[a] += x[b];
+  x[d] = _clib_chacha20_rotl (x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = _clib_chacha20_rotl (x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = _clib_chacha20_rotl (x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = _clib_chacha20_rotl (x[b] ^ x[c], 7);
+}
+
+static_always_inline void
+_clib_chacha20_transpose4 (u32x4 *a)
+{
+  u32x4 t0 = u32x4_shuffle2 (a[0], a[1], 0, 4, 1, 5);
+  u32x4 t1 = u32x4_shuffle2 (a[0], a[1], 2, 6, 3, 7);
+  u32x4 t2 = u32x4_shuffle2 (a[2], a[3], 0, 4, 1, 5);
+  u32x4 t3 = u32x4_shuffle2 (a[2], a[3], 2, 6, 3, 7);
+
+  a[0] = u32x4_shuffle2 (t0, t2, 0, 1, 4, 5);
+  a[1] = u32x4_shuffle2 (t0, t2, 2, 3, 6, 7);
+  a[2] = u32x4_shuffle2 (t1, t3, 0, 1, 4, 5);
+  a[3] = u32x4_shuffle2 (t1, t3, 2, 3, 6, 7);
+}
+
+/*
+ * Compute the blocks of all lanes of state s and store the keystream of
+ * lane n to out + n * 64.
+ */
+static_always_inline void
+clib_chacha20_blocks (const clib_chacha20_u32xn s[16], u8 *out)
+{
+  clib_chacha20_u32xn x[16];
+
+  for (int i = 0; i < 16; i++)
+    x[i] = s[i];
+
+  for (int r = 0; r < 10; r++)
+    {
+      /* column round */
+      _clib_chacha20_quarter_round (x, 0, 4, 8, 12);
+      _clib_chacha20_quarter_round (x, 1, 5, 9, 13);
+      _clib_chacha20_quarter_round (x, 2, 6, 10, 14);
+      _clib_chacha20_quarter_round (x, 3, 7, 11, 15);
+      /* diagonal round */
+      _clib_chacha20_quarter_round (x, 0, 5, 10, 15);
+      _clib_chacha20_quarter_round (x, 1, 6, 11, 12);
+      _clib_chacha20_quarter_round (x, 2, 7, 8, 13);
+      _clib_chacha20_quarter_round (x, 3, 4, 9, 14);
+    }
+
+  for (int i = 0; i < 16; i++)
+    x[i] += s[i];
+
+  /* back from words per vector to blocks per vector */
+#if CLIB_CHACHA20_N_LANES == 16
+  u32x16_transpose (x);
+  for (int n = 0; n < 16; n++)
+    *(u32x16u *) (out + n * 64) = x[n];
+#elif CLIB_CHACHA20_N_LANES == 8
+  u32x8_transpose (x);
+  u32x8_transpose (x + 8);
+  for (int n = 0; n < 8; n++)
+    {
+      *(u32x8u *) (out + n * 64) = x[n];
+      *(u32x8u *) (out + n * 64 + 32) = x[n + 8];
+    }
+#else
+  for (int i = 0; i < 16; i += 4)
+    {
+      _clib_chacha20_transpose4 (x + i);
+      for (int n = 0; n < 4; n++)
+	*(u32x4u *) (out + n * 64 + i * 4) = x[i + n];
+    }
+#endif
+}
+
+static_always_inline void
+clib_chacha20_lane_init (clib_chacha20_u32xn s[16], int lane, const u8 *key,
+			 const u8 *nonce, u32 counter)
+{
+  for (int i = 0; i < 8; i++)
+    s[4 + i][lane] = clib_mem_unaligned (key + 4 * i, u32);
+  s[12][lane] = counter;
+  for (int i = 0; i < 3; i++)
+    s[13 + i][lane] = clib_mem_unaligned (nonce + 4 * i, u32);
+}
+
+static_always_inline void
+clib_chacha20_state_init (clib_chacha20_u32xn s[16])
+{
+  for (int i = 0; i < 4; i++)
+    s[i] = (clib_chacha20_u32xn){} + _clib_chacha20_const[i];
+}
+
+static_always_inline void
+clib_chacha20_xor (u8 *dst, const u8 *src, const u8 *ks, u32 len)
+{
+  for (; len >= 16; len -= 16, dst += 16, src += 16, ks += 16)
+    *(u8x16u *) dst = *(u8x16u *) src ^ *(u8x16u *) ks;
+  for (u32 i = 0; i < len; i++)
+    dst[i] = src[i] ^ ks[i];
+}
+
+/*
+ * Single stream: the lanes hold consecutive blocks, which are buffered as
+ * keystream and consumed by clib_chacha20_transform ().
+ */
+typedef struct
+{
+  clib_chacha20_u32xn s[16];
+  u8 ks[CLIB_CHACHA20_N_LANES * CLIB_CHACHA20_BLOCK_LEN];
+  u32 ks_off;
+} clib_chacha20_ctx_t;
+
+static_always_inline void
+_clib_chacha20_refill (clib_chacha20_ctx_t *ctx)
+{
+  clib_chacha20_blocks (ctx->s, ctx->ks);
+  ctx->s[12] += CLIB_CHACHA20_N_LANES;
+  ctx->ks_off = 0;
+}
+
+static_always_inline void
+clib_chacha20_init (clib_chacha20_ctx_t *ctx, const u8 *key, const u8 *nonce,
+		    u32 counter)
+{
+  clib_chacha20_state_init (ctx->s);
+  for (int n = 0; n < CLIB_CHACHA20_N_LANES; n++)
+    clib_chacha20_lane_init (ctx->s, n, key, nonce, counter + n);
+  ctx->ks_off = sizeof (ctx->ks);
+}
+
+/* next n (<= 64) bytes of keystream, consumed */
+static_always_inline u8 *
+clib_chacha20_keystream (clib_chacha20_ctx_t *ctx, u32 n)
+{
+  u8 *ks;
+
+  if (ctx->ks_off == sizeof (ctx->ks))
+    _clib_chacha20_refill (ctx);
+
+  ks = ctx->ks + ctx->ks_off;
+  ctx->ks_off += n;
+  return ks;
+}
+
+static_always_inline void
+clib_chacha20_transform (clib_chacha20_ctx_t *ctx, const u8 *src, u8 *dst,
+			 u32 len)
+{
+  u32 n;
+
+  /* finish the keystream left by the previous call */
+  if (ctx->ks_off < sizeof (ctx->ks))
+    {
+      n = clib_min (len, sizeof (ctx->ks) - ctx->ks_off);
+      clib_chacha20_xor (dst, src, ctx->ks + ctx->ks_off, n);
+      ctx->ks_off += n;
+      src += n;
+      dst += n;
+      len -= n;
+    }
+
+  while (len)
+    {
+      _clib_chacha20_refill (ctx);
+      n = clib_min (len, sizeof (ctx->ks));
+      clib_chacha20_xor (dst, src, ctx->ks, n);
+      ctx->ks_off = n;
+      src += n;
+      dst += n;
+      len -= n;
+    }
+}
+
+static_always_inline void
+clib_chacha20 (const u8 *key, const u8 *nonce, u32 counter, const u8 *src,
+	       u8 *dst, u32 len)
+{
+  clib_chacha20_ctx_t ctx;
+  clib_chacha20_init (&ctx, key, nonce, counter);
+  clib_chacha20_transform (&ctx, src, dst, len);
+}
+
+#endif /* __clib_chacha20_h__ */
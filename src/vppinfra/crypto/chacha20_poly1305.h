@@ -0,0 +1,248 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#ifndef __clib_chacha20_poly1305_h__
+#define __clib_chacha20_poly1305_h__
+
+#include <vppinfra/crypto/chacha20.h>
+#include <vppinfra/crypto/poly1305.h>
+
+/*
+ * ChaCha20-Poly1305 AEAD as specified in RFC 8439.
+ *
+ * clib_chacha20_poly1305_mb () processes a batch of independent messages,
+ * one per vector lane of the ChaCha20 kernel. A lane takes the next
+ * message of the batch as soon as it is done with one, so the lanes stay
+ * busy when the messages differ in length. Poly1305 is computed per lane,
+ * as the keystream of each block is consumed.
+ *
+ * The streaming context (clib_chacha20_poly1305_init (), _update () and
+ * _final ()) is for messages in several pieces, e.g. buffer chains.
+ */
+
+typedef enum
+{
+  CLIB_CHACHA20_POLY1305_OP_ENCRYPT,
+  CLIB_CHACHA20_POLY1305_OP_DECRYPT,
+} clib_chacha20_poly1305_op_t;
+
+typedef struct
+{
+  const u8 *key;   /* 32 bytes */
+  const u8 *nonce; /* 12 bytes */
+  const u8 *aad;
+  const u8 *src;
+  u8 *dst;
+  u8 *tag; /* written on encrypt, checked on decrypt */
+  u32 len;
+  u16 aad_len;
+  u8 tag_len;
+  /* decrypt: set when the tag does not match */
+  u8 bad_tag;
+} clib_chacha20_poly1305_msg_t;
+
+static_always_inline void
+_clib_chacha20_poly1305_pad16 (clib_poly1305_ctx *p, u32 len)
+{
+  static const u8 zeros[16] = {};
+
+  if (len & 15)
+    clib_poly1305_update (p, zeros, 16 - (len & 15));
+}
+
+static_always_inline void
+_clib_chacha20_poly1305_mac_aad (clib_poly1305_ctx *p, const u8 *poly_key,
+				 const u8 *aad, u32 aad_len)
+{
+  clib_poly1305_init (p, poly_key);
+  clib_poly1305_update (p, aad, aad_len);
+  _clib_chacha20_poly1305_pad16 (p, aad_len);
+}
+
+static_always_inline void
+_clib_chacha20_poly1305_mac_final (clib_poly1305_ctx *p, u64 aad_len,
+				   u64 len, u8 *tag)
+{
+  u64 lengths[2] = { aad_len, len };
+
+  _clib_chacha20_poly1305_pad16 (p, len);
+  clib_poly1305_update (p, (u8 *) lengths, sizeof (lengths));
+  clib_poly1305_final (p, tag);
+}
+
+/* returns non-zero if the first n bytes of a and b differ */
+static_always_inline int
+_clib_chacha20_poly1305_tag_cmp (const u8 *a, const u8 *b, u32 n)
+{
+  u8 diff = 0;
+
+  for (u32 i = 0; i < n; i++)
+    diff |= a[i] ^ b[i];
+  return diff != 0;
+}
+
+static_always_inline void
+_clib_chacha20_poly1305_msg_done (clib_chacha20_poly1305_msg_t *m,
+				  clib_poly1305_ctx *p,
+				  clib_chacha20_poly1305_op_t op)
+{
+  u8 tag[16];
+
+  _clib_chacha20_poly1305_mac_final (p, m->aad_len, m->len, tag);
+
+  if (op == CLIB_CHACHA20_POLY1305_OP_ENCRYPT)
+    clib_memcpy_fast (m->tag, tag, m->tag_len);
+  else
+    m->bad_tag = _clib_chacha20_poly1305_tag_cmp (m->tag, tag, m->tag_len);
+}
+
+static_always_inline void
+clib_chacha20_poly1305_mb (clib_chacha20_poly1305_msg_t *msgs, u32 n_msgs,
+			   clib_chacha20_poly1305_op_t op)
+{
+  const int n_lanes = CLIB_CHACHA20_N_LANES;
+  clib_chacha20_u32xn s[16];
+  u8 ks[CLIB_CHACHA20_N_LANES * CLIB_CHACHA20_BLOCK_LEN];
+  clib_chacha20_poly1305_msg_t *lane_msg[CLIB_CHACHA20_N_LANES];
+  clib_poly1305_ctx lane_poly[CLIB_CHACHA20_N_LANES];
+  u32 lane_off[CLIB_CHACHA20_N_LANES];
+  u32 next = 0, n_active = 0;
+
+  clib_chacha20_state_init (s);
+
+  /* block 0 of a message is its Poly1305 key, the payload starts with
+   * block 1 */
+  for (int n = 0; n < n_lanes; n++)
+    {
+      lane_msg[n] = 0;
+      if (next < n_msgs)
+	{
+	  clib_chacha20_poly1305_msg_t *m = msgs + next++;
+	  clib_chacha20_lane_init (s, n, m->key, m->nonce, 0);
+	  lane_msg[n] = m;
+	  lane_off[n] = ~0;
+	  n_active++;
+	}
+    }
+
+  while (n_active)
+    {
+      clib_chacha20_blocks (s, ks);
+      s[12] += 1;
+
+      for (int n = 0; n < n_lanes; n++)
+	{
+	  clib_chacha20_poly1305_msg_t *m = lane_msg[n];
+	  clib_poly1305_ctx *p = lane_poly + n;
+	  u8 *k = ks + n * CLIB_CHACHA20_BLOCK_LEN;
+	  u32 len;
+
+	  if (!m)
+	    continue;
+
+	  if (lane_off[n] == ~0)
+	    {
+	      _clib_chacha20_poly1305_mac_aad (p, k, m->aad, m->aad_len);
+	      lane_off[n] = 0;
+	    }
+	  else
+	    {
+	      len = clib_min (m->len - lane_off[n], CLIB_CHACHA20_BLOCK_LEN);
+	      if (op == CLIB_CHACHA20_POLY1305_OP_ENCRYPT)
+		{
+		  clib_chacha20_xor (m->dst + lane_off[n], m->src + lane_off[n],
+				     k, len);
+		  clib_poly1305_update (p, m->dst + lane_off[n], len);
+		}
+	      else
+		{
+		  clib_poly1305_update (p, m->src + lane_off[n], len);
+		  clib_chacha20_xor (m->dst + lane_off[n], m->src + lane_off[n],
+				     k, len);
+		}
+	      lane_off[n] += len;
+	    }
+
+	  if (lane_off[n] < m->len)
+	    continue;
+
+	  _clib_chacha20_poly1305_msg_done (m, p, op);
+
+	  /* the lane moves on to the next message */
+	  if (next < n_msgs)
+	    {
+	      m = msgs + next++;
+	      clib_chacha20_lane_init (s, n, m->key, m->nonce, 0);
+	      lane_msg[n] = m;
+	      lane_off[n] = ~0;
+	    }
+	  else
+	    {
+	      lane_msg[n] = 0;
+	      n_active--;
+	    }
+	}
+    }
+}
+
+typedef struct
+{
+  clib_chacha20_ctx_t cc;
+  clib_poly1305_ctx poly;
+  u32 aad_len;
+  u32 len;
+} clib_chacha20_poly1305_ctx_t;
+
+static_always_inline void
+clib_chacha20_poly1305_init (clib_chacha20_poly1305_ctx_t *ctx, const u8 *key,
+			     const u8 *nonce, const u8 *aad, u32 aad_len)
+{
+  clib_chacha20_init (&ctx->cc, key, nonce, 0);
+  _clib_chacha20_poly1305_mac_aad (
+    &ctx->poly, clib_chacha20_keystream (&ctx->cc, CLIB_CHACHA20_BLOCK_LEN),
+    aad, aad_len);
+  ctx->aad_len = aad_len;
+  ctx->len = 0;
+}
+
+static_always_inline void
+clib_chacha20_poly1305_update (clib_chacha20_poly1305_ctx_t *ctx,
+			       const u8 *src, u8 *dst, u32 len,
+			       clib_chacha20_poly1305_op_t op)
+{
+  if (op == CLIB_CHACHA20_POLY1305_OP_DECRYPT)
+    clib_poly1305_update (&ctx->poly, src, len);
+  clib_chacha20_transform (&ctx->cc, src, dst, len);
+  if (op == CLIB_CHACHA20_POLY1305_OP_ENCRYPT)
+    clib_poly1305_update (&ctx->poly, dst, len);
+  ctx->len += len;
+}
+
+static_always_inline void
+clib_chacha20_poly1305_final (clib_chacha20_poly1305_ctx_t *ctx, u8 *tag)
+{
+  _clib_chacha20_poly1305_mac_final (&ctx->poly, ctx->aad_len, ctx->len, tag);
+}
+
+/* single message, returns 0 if the tag checks (always on encrypt) */
+static_always_inline int
+clib_chacha20_poly1305 (const u8 *key, const u8 *nonce, const u8 *aad,
+			u32 aad_len, const u8 *src, u8 *dst, u32 len, u8 *tag,
+			u32 tag_len, clib_chacha20_poly1305_op_t op)
+{
+  clib_chacha20_poly1305_ctx_t ctx;
+  u8 t[16];
+
+  clib_chacha20_poly1305_init (&ctx, key, nonce, aad, aad_len);
+  clib_chacha20_poly1305_update (&ctx, src, dst, len, op);
+  clib_chacha20_poly1305_final (&ctx, t);
+
+  if (op == CLIB_CHACHA20_POLY1305_OP_DECRYPT)
+    return _clib_chacha20_poly1305_tag_cmp (tag, t, tag_len);
+
+  clib_memcpy_fast (tag, t, tag_len);
+  return 0;
+}
+
+#endif /* __clib_chacha20_poly1305_h__ */
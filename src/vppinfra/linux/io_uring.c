@@ -0,0 +1,172 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <vppinfra/mem.h>
+#include <vppinfra/linux/io_uring.h>
+
+static int
+io_uring_setup_syscall (u32 entries, struct io_uring_params *p)
+{
+  return syscall (__NR_io_uring_setup, entries, p);
+}
+
+static int
+io_uring_enter_syscall (int fd, u32 to_submit, u32 min_complete, u32 flags,
+			void *arg, uword argsz)
+{
+  return syscall (__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		  arg, argsz);
+}
+
+__clib_export clib_error_t *
+clib_io_uring_init (clib_io_uring_t *r, u32 n_entries)
+{
+  struct io_uring_params p = {};
+  clib_error_t *err = 0;
+  void *sq, *cq;
+
+  clib_memset_u8 (r, 0, sizeof (*r));
+  r->fd = -1;
+
+  r->fd = io_uring_setup_syscall (n_entries, &p);
+  if (r->fd < 0)
+    return clib_error_return_unix (0, "io_uring_setup");
+
+  /* the poll loop waits for completions with a timeout */
+  if ((p.features & IORING_FEAT_EXT_ARG) == 0)
+    {
+      err = clib_error_return (0, "io_uring doesn't support extended "
+				  "arguments, kernel too old");
+      goto error;
+    }
+
+  r->features = p.features;
+  r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof (u32);
+  r->cq_ring_size =
+    p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    r->sq_ring_size = r->cq_ring_size =
+      clib_max (r->sq_ring_size, r->cq_ring_size);
+
+  sq = mmap (0, r->sq_ring_size, PROT_READ | PROT_WRITE,
+	     MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+  if (sq == MAP_FAILED)
+    {
+      err = clib_error_return_unix (0, "mmap (sq ring)");
+      goto error;
+    }
+  r->sq_ring = sq;
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    cq = sq;
+  else
+    {
+      cq = mmap (0, r->cq_ring_size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+      if (cq == MAP_FAILED)
+	{
+	  err = clib_error_return_unix (0, "mmap (cq ring)");
+	  goto error;
+	}
+      r->cq_ring = cq;
+    }
+
+  r->sqes_size = p.sq_entries * sizeof (struct io_uring_sqe);
+  r->sqes = mmap (0, r->sqes_size, PROT_READ | PROT_WRITE,
+		  MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+  if (r->sqes == MAP_FAILED)
+    {
+      r->sqes = 0;
+      err = clib_error_return_unix (0, "mmap (sqes)");
+      goto error;
+    }
+
+  r->sq_head = sq + p.sq_off.head;
+  r->sq_tail = sq + p.sq_off.tail;
+  r->sq_flags = sq + p.sq_off.flags;
+  r->sq_array = sq + p.sq_off.array;
+  r->sq_mask = *(u32 *) (sq + p.sq_off.ring_mask);
+  r->sq_entries = *(u32 *) (sq + p.sq_off.ring_entries);
+
+  r->cq_head = cq + p.cq_off.head;
+  r->cq_tail = cq + p.cq_off.tail;
+  r->cq_mask = *(u32 *) (cq + p.cq_off.ring_mask);
+  r->cqes = cq + p.cq_off.cqes;
+
+  return 0;
+
+error:
+  clib_io_uring_free (r);
+  return err;
+}
+
+__clib_export void
+clib_io_uring_free (clib_io_uring_t *r)
+{
+  if (r->sqes)
+    munmap (r->sqes, r->sqes_size);
+  if (r->cq_ring)
+    munmap (r->cq_ring, r->cq_ring_size);
+  if (r->sq_ring)
+    munmap (r->sq_ring, r->sq_ring_size);
+  if (r->fd >= 0)
+    close (r->fd);
+  clib_memset_u8 (r, 0, sizeof (*r));
+  r->fd = -1;
+}
+
+/**
+ * @brief Submit the pending sqes and optionally wait for completions
+ *
+ * @param wait_nr number of completions to wait for, 0 to only submit
+ * @param timeout_ns upper bound of the wait, negative to wait forever
+ *
+ * @returns number of sqes submitted, or -1 with errno set. A wait which
+ *          times out is not an error.
+ */
+__clib_export int
+clib_io_uring_enter (clib_io_uring_t *r, u32 wait_nr, i64 timeout_ns)
+{
+  struct __kernel_timespec ts;
+  struct io_uring_getevents_arg arg = {};
+  u32 to_submit, flags = 0;
+  int rv;
+
+  if (r->sq_pending)
+    {
+      __atomic_store_n (r->sq_tail, *r->sq_tail + r->sq_pending,
+			__ATOMIC_RELEASE);
+      r->sq_pending = 0;
+    }
+
+  /* includes what a previous, partial, submit left behind */
+  to_submit = *r->sq_tail - __atomic_load_n (r->sq_head, __ATOMIC_ACQUIRE);
+
+  if (wait_nr)
+    {
+      flags |= IORING_ENTER_GETEVENTS;
+      if (timeout_ns >= 0)
+	{
+	  ts.tv_sec = timeout_ns / 1000000000;
+	  ts.tv_nsec = timeout_ns % 1000000000;
+	  arg.ts = pointer_to_uword (&ts);
+	}
+    }
+  else if (to_submit == 0)
+    return 0;
+
+  flags |= IORING_ENTER_EXT_ARG;
+  rv = io_uring_enter_syscall (r->fd, to_submit, wait_nr, flags, &arg,
+			       sizeof (arg));
+
+  if (rv < 0 && errno == ETIME)
+    return 0;
+
+  return rv;
+}
@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2025 Cisco Systems, Inc.
+ */
+
+/*
+ * Minimal io_uring ring, driven through the raw system calls. Only what
+ * a single thread needs to queue requests and reap their completions from
+ * its own dispatch loop is provided.
+ */
+
+#ifndef included_vppinfra_linux_io_uring_h
+#define included_vppinfra_linux_io_uring_h
+
+#include <vppinfra/clib.h>
+#include <vppinfra/error.h>
+#include <linux/io_uring.h>
+
+typedef struct
+{
+  int fd;
+  u32 features;
+
+  /* submission queue */
+  u32 *sq_head;
+  u32 *sq_tail;
+  u32 *sq_flags;
+  u32 *sq_array;
+  u32 sq_mask;
+  u32 sq_entries;
+  /* sqes filled since the last submit */
+  u32 sq_pending;
+  struct io_uring_sqe *sqes;
+
+  /* completion queue */
+  u32 *cq_head;
+  u32 *cq_tail;
+  u32 cq_mask;
+  struct io_uring_cqe *cqes;
+
+  void *sq_ring;
+  uword sq_ring_size;
+  void *cq_ring;
+  uword cq_ring_size;
+  uword sqes_size;
+} clib_io_uring_t;
+
+clib_error_t *clib_io_uring_init (clib_io_uring_t *r, u32 n_entries);
+void clib_io_uring_free (clib_io_uring_t *r);
+int clib_io_uring_enter (clib_io_uring_t *r, u32 wait_nr, i64 timeout_ns);
+
+/**
+ * @brief Get a free submission queue entry
+ *
+ * @returns zeroed sqe, or 0 if the submission queue is full
+ */
+static_always_inline struct io_uring_sqe *
+clib_io_uring_get_sqe (clib_io_uring_t *r)
+{
+  u32 head = __atomic_load_n (r->sq_head, __ATOMIC_ACQUIRE);
+  u32 tail = *r->sq_tail + r->sq_pending;
+  struct io_uring_sqe *sqe;
+
+  if (tail - head >= r->sq_entries)
+    return 0;
+
+  sqe = r->sqes + (tail & r->sq_mask);
+  clib_memset_u8 (sqe, 0, sizeof (*sqe));
+  r->sq_array[tail & r->sq_mask] = tail & r->sq_mask;
+  r->sq_pending++;
+  return sqe;
+}
+
+static_always_inline u32
+clib_io_uring_n_pending (clib_io_uring_t *r)
+{
+  return r->sq_pending;
+}
+
+/**
+ * @brief Next completion, without entering the kernel
+ *
+ * @returns cqe, or 0 if there is none. It must be released with
+ *          clib_io_uring_cqe_seen ().
+ */
+static_always_inline struct io_uring_cqe *
+clib_io_uring_peek_cqe (clib_io_uring_t *r)
+{
+  u32 head = *r->cq_head;
+
+  if (head == __atomic_load_n (r->cq_tail, __ATOMIC_ACQUIRE))
+    return 0;
+
+  return r->cqes + (head & r->cq_mask);
+}
+
+static_always_inline void
+clib_io_uring_cqe_seen (clib_io_uring_t *r)
+{
+  __atomic_store_n (r->cq_head, *r->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* included_vppinfra_linux_io_uring_h */
@@ -0,0 +1,339 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2025 Cisco Systems, Inc.
+ */
+
+#include <vppinfra/format.h>
+#include <vppinfra/test/test.h>
+#include <vppinfra/crypto/chacha20_poly1305.h>
+
+/* RFC8439 A.1 TV1, all zero key and nonce, counter 0 */
+static const u8 tv1_keystream[64] = {
+  0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90, 0x40, 0x5d, 0x6a, 0xe5, 0x53,
+  0x86, 0xbd, 0x28, 0xbd, 0xd2, 0x19, 0xb8, 0xa0, 0x8d, 0xed, 0x1a, 0xa8, 0x36,
+  0xef, 0xcc, 0x8b, 0x77, 0x0d, 0xc7, 0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48,
+  0x8d, 0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37, 0x6a, 0x43, 0xb8, 0xf4,
+  0x15, 0x18, 0xa1, 0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86,
+};
+
+/* RFC8439 2.8.2 */
+static const u8 tc1_key[32] = {
+  0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a,
+  0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92, 0x93, 0x94, 0x95,
+  0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+};
+
+static const u8 tc1_nonce[12] = { 0x07, 0x00, 0x00, 0x00, 0x40, 0x41,
+				  0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+
+static const u8 tc1_aad[12] = { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1,
+				0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+
+static const char tc1_pt[] = "Ladies and Gentlemen of the class of '99: If I "
+			     "could offer you only one tip for the future, "
+			     "sunscreen would be it.";
+
+static const u8 tc1_ct[114] = {
+  0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53,
+  0xef, 0x7e, 0xc2, 0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2,
+  0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6, 0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67,
+  0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b, 0x1a, 0x71, 0xde, 0x0a,
+  0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36, 0x92,
+  0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09,
+  0x1b, 0x58, 0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80,
+  0x8b, 0x48, 0x31, 0xd7, 0xbc, 0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d,
+  0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b, 0x61, 0x16,
+};
+
+static const u8 tc1_tag[16] = { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09,
+				0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb,
+				0xd0, 0x60, 0x06, 0x91 };
+
+/*
+ * Key 00..1f, nonce 40..4b, aad a0.. and plaintext byte j of case i
+ * (j * 7 + i) & 0xff. Lengths around the block and vector boundaries.
+ */
+const static struct
+{
+  u32 len;
+  u16 aad_len;
+  u8 tag[16];
+} test_cases[] = {
+  { .len = 0, .aad_len = 0,
+    .tag = { 0x2f, 0xee, 0xb4, 0x56, 0xec, 0x81, 0x0a, 0xe0, 0x69, 0x85, 0x0c, 0x4c, 0x40, 0xc1, 0x95, 0xc9 } },
+  { .len = 1, .aad_len = 8,
+    .tag = { 0x13, 0x6b, 0x70, 0x97, 0x9a, 0xbe, 0x59, 0xe8, 0x40, 0x2f, 0xd6, 0x79, 0x50, 0xc6, 0xb1, 0x48 } },
+  { .len = 15, .aad_len = 12,
+    .tag = { 0x06, 0xae, 0x38, 0x7e, 0x06, 0xe0, 0xd3, 0x9c, 0x65, 0x3c, 0x1c, 0xbc, 0x2c, 0xed, 0x2c, 0xd8 } },
+  { .len = 16, .aad_len = 16,
+    .tag = { 0x5c, 0xfd, 0x99, 0xa6, 0xc7, 0x1b, 0x1d, 0x1e, 0x0e, 0x01, 0x62, 0xa6, 0xdd, 0x23, 0xb4, 0x7f } },
+  { .len = 63, .aad_len = 3,
+    .tag = { 0xcb, 0x14, 0xda, 0x42, 0xde, 0xc3, 0x18, 0x44, 0x7b, 0x58, 0xe2, 0x0c, 0x54, 0x4e, 0x62, 0xa1 } },
+  { .len = 64, .aad_len = 0,
+    .tag = { 0xcd, 0xdc, 0xda, 0xbd, 0xd7, 0x09, 0x15, 0x1a, 0xa7, 0xe7, 0x0a, 0xdc, 0xc6, 0x6c, 0xa5, 0xa9 } },
+  { .len = 65, .aad_len = 8,
+    .tag = { 0x4a, 0x0d, 0x18, 0x08, 0xef, 0x5d, 0x99, 0x01, 0x79, 0x9e, 0x39, 0xfa, 0x3b, 0x0f, 0xa0, 0xdd } },
+  { .len = 127, .aad_len = 12,
+    .tag = { 0x30, 0xc5, 0x4a, 0x81, 0x9e, 0xe2, 0xfa, 0x88, 0x8c, 0xfd, 0xc6, 0x6a, 0xe3, 0xcd, 0xfe, 0x78 } },
+  { .len = 128, .aad_len = 16,
+    .tag = { 0x4f, 0x02, 0xa8, 0x4a, 0x84, 0xf0, 0x1c, 0x40, 0x42, 0xe5, 0x12, 0x0f, 0x8a, 0x00, 0xa1, 0xab } },
+  { .len = 200, .aad_len = 3,
+    .tag = { 0x77, 0x11, 0x15, 0xe6, 0x62, 0x32, 0xbe, 0xcb, 0xfb, 0xf2, 0x22, 0xb8, 0xec, 0x8d, 0x79, 0x06 } },
+  { .len = 255, .aad_len = 0,
+    .tag = { 0xce, 0x75, 0xeb, 0xd3, 0x99, 0xdf, 0x8d, 0x89, 0x9f, 0x97, 0xe5, 0xc3, 0x80, 0xad, 0x82, 0x2a } },
+  { .len = 256, .aad_len = 8,
+    .tag = { 0xf2, 0x38, 0x0d, 0x2f, 0xd8, 0xed, 0x15, 0xae, 0x84, 0xd6, 0x0d, 0x2e, 0x4d, 0x12, 0x25, 0x8e } },
+  { .len = 511, .aad_len = 12,
+    .tag = { 0xc0, 0xa2, 0xde, 0xc8, 0x06, 0x73, 0x29, 0xe4, 0xb6, 0x96, 0x88, 0xf1, 0x22, 0xaf, 0x43, 0xae } },
+  { .len = 512, .aad_len = 16,
+    .tag = { 0xdc, 0x6e, 0xb7, 0xa6, 0x77, 0xcd, 0x99, 0x95, 0x2c, 0xd0, 0x86, 0x35, 0xb9, 0xbc, 0x02, 0x2a } },
+  { .len = 1000, .aad_len = 3,
+    .tag = { 0x5d, 0xc5, 0xe3, 0xc1, 0x90, 0xa1, 0x75, 0x70, 0x10, 0x5a, 0x57, 0x00, 0xe1, 0xc0, 0x95, 0x07 } },
+  { .len = 1023, .aad_len = 0,
+    .tag = { 0xb2, 0xf9, 0x7b, 0x16, 0x76, 0xb0, 0x02, 0x87, 0x6e, 0x40, 0x7e, 0xbc, 0xae, 0x45, 0x81, 0xd6 } },
+  { .len = 1024, .aad_len = 8,
+    .tag = { 0x9a, 0x62, 0x1d, 0x4c, 0xe0, 0xae, 0x1b, 0x0f, 0xaf, 0x57, 0x87, 0x28, 0x52, 0x97, 0x58, 0xa6 } },
+  { .len = 1025, .aad_len = 12,
+    .tag = { 0x41, 0x44, 0x91, 0x17, 0x2a, 0x8d, 0x9a, 0x07, 0xe0, 0x91, 0x92, 0xe3, 0x77, 0x3d, 0x49, 0x95 } },
+  { .len = 1472, .aad_len = 16,
+    .tag = { 0xa8, 0x90, 0xc9, 0x96, 0x33, 0x5f, 0xf7, 0x15, 0xab, 0x92, 0x71, 0x46, 0x91, 0x55, 0x48, 0xb9 } },
+  { .len = 2048, .aad_len = 3,
+    .tag = { 0x1e, 0xbf, 0x7f, 0xa2, 0x73, 0x29, 0x6f, 0x49, 0xe9, 0xa2, 0xe6, 0xad, 0x33, 0x5c, 0xdd, 0x81 } },
+  { .len = 9000, .aad_len = 0,
+    .tag = { 0x05, 0x41, 0xf2, 0x99, 0xff, 0x1f, 0x4b, 0x3f, 0xa6, 0xf2, 0xd4, 0x40, 0xc6, 0x4a, 0xca, 0x47 } },
+};
+
+#define MAX_TEST_LEN 9000
+
+static void
+test_case_init (u32 i, u8 *key, u8 *nonce, u8 *aad, u8 *pt)
+{
+  for (int j = 0; j < 32; j++)
+    key[j] = j;
+  for (int j = 0; j < 12; j++)
+    nonce[j] = 0x40 + j;
+  for (int j = 0; j < 16; j++)
+    aad[j] = 0xa0 + j;
+  for (int j = 0; j < test_cases[i].len; j++)
+    pt[j] = (j * 7 + i) & 0xff;
+}
+
+static clib_error_t *
+test_clib_chacha20 (clib_error_t *err)
+{
+  u8 zero[64] = {}, out[sizeof (tc1_ct)];
+
+  clib_chacha20 (zero, zero, 0, zero, out, 64);
+  if (memcmp (out, tv1_keystream, 64) != 0)
+    err = clib_error_return (err,
+			     "\ntest:     RFC8439 A.1 TV1"
+			     "\nexp out:  %U"
+			     "\ncalc out: %U\n",
+			     format_hexdump, tv1_keystream, 64, format_hexdump,
+			     out, 64);
+
+  /* the AEAD payload is encrypted starting with block 1 */
+  clib_chacha20 (tc1_key, tc1_nonce, 1, (u8 *) tc1_pt, out, sizeof (out));
+  if (memcmp (out, tc1_ct, sizeof (out)) != 0)
+    err = clib_error_return (err,
+			     "\ntest:     RFC8439 2.8.2 keystream"
+			     "\nexp out:  %U"
+			     "\ncalc out: %U\n",
+			     format_hexdump, tc1_ct, sizeof (out),
+			     format_hexdump, out, sizeof (out));
+  return err;
+}
+
+REGISTER_TEST (clib_chacha20) = {
+  .name = "clib_chacha20",
+  .fn = test_clib_chacha20,
+};
+
+static clib_error_t *
+test_clib_chacha20_poly1305 (clib_error_t *err)
+{
+  clib_chacha20_poly1305_msg_t msgs[ARRAY_LEN (test_cases)];
+  clib_chacha20_poly1305_ctx_t ctx;
+  u8 key[32], nonce[12], aad[16], tag[16];
+  u8 *pt = test_mem_alloc (MAX_TEST_LEN);
+  u8 *ct = test_mem_alloc (MAX_TEST_LEN);
+  u8 *out = test_mem_alloc (MAX_TEST_LEN);
+  u8 *mb_pt = test_mem_alloc (ARRAY_LEN (test_cases) * MAX_TEST_LEN);
+  u8 *mb_ct = test_mem_alloc (ARRAY_LEN (test_cases) * MAX_TEST_LEN);
+  u8 *mb_out = test_mem_alloc (ARRAY_LEN (test_cases) * MAX_TEST_LEN);
+  u8 mb_tag[ARRAY_LEN (test_cases)][16];
+
+  /* RFC8439 2.8.2 */
+  clib_chacha20_poly1305 (tc1_key, tc1_nonce, tc1_aad, sizeof (tc1_aad),
+			  (u8 *) tc1_pt, ct, sizeof (tc1_ct), tag, 16,
+			  CLIB_CHACHA20_POLY1305_OP_ENCRYPT);
+  if (memcmp (ct, tc1_ct, sizeof (tc1_ct)) != 0 ||
+      memcmp (tag, tc1_tag, 16) != 0)
+    err = clib_error_return (err,
+			     "\ntest:     RFC8439 2.8.2 encrypt"
+			     "\nexp tag:  %U"
+			     "\ncalc tag: %U\n",
+			     format_hexdump, tc1_tag, 16, format_hexdump, tag,
+			     16);
+
+  if (clib_chacha20_poly1305 (tc1_key, tc1_nonce, tc1_aad, sizeof (tc1_aad),
+			      tc1_ct, out, sizeof (tc1_ct), (u8 *) tc1_tag, 16,
+			      CLIB_CHACHA20_POLY1305_OP_DECRYPT) ||
+      memcmp (out, tc1_pt, sizeof (tc1_ct)) != 0)
+    err = clib_error_return (err, "\ntest:     RFC8439 2.8.2 decrypt\n");
+
+  FOREACH_ARRAY_ELT (tc, test_cases)
+    {
+      u32 i = tc - test_cases;
+      u32 off, n;
+
+      test_case_init (i, key, nonce, aad, pt);
+
+      /* single message */
+      clib_chacha20_poly1305 (key, nonce, aad, tc->aad_len, pt, ct, tc->len,
+			      tag, 16, CLIB_CHACHA20_POLY1305_OP_ENCRYPT);
+      if (memcmp (tag, tc->tag, 16) != 0)
+	err = clib_error_return (err,
+				 "\ntest:     single, len %u aad_len %u"
+				 "\nexp tag:  %U"
+				 "\ncalc tag: %U\n",
+				 tc->len, tc->aad_len, format_hexdump, tc->tag,
+				 16, format_hexdump, tag, 16);
+
+      if (clib_chacha20_poly1305 (key, nonce, aad, tc->aad_len, ct, out,
+				  tc->len, tag, 16,
+				  CLIB_CHACHA20_POLY1305_OP_DECRYPT) ||
+	  memcmp (out, pt, tc->len) != 0)
+	err = clib_error_return (err,
+				 "\ntest:     single decrypt, len %u aad_len %u\n",
+				 tc->len, tc->aad_len);
+
+      /* streaming, in pieces which do not end on block boundaries */
+      clib_chacha20_poly1305_init (&ctx, key, nonce, aad, tc->aad_len);
+      for (off = 0, n = 1; off < tc->len; off += n, n = n * 3 + 5)
+	clib_chacha20_poly1305_update (&ctx, pt + off, out + off,
+				       clib_min (n, tc->len - off),
+				       CLIB_CHACHA20_POLY1305_OP_ENCRYPT);
+      clib_chacha20_poly1305_final (&ctx, tag);
+      if (memcmp (tag, tc->tag, 16) != 0 || memcmp (out, ct, tc->len) != 0)
+	err = clib_error_return (err,
+				 "\ntest:     streaming, len %u aad_len %u"
+				 "\nexp tag:  %U"
+				 "\ncalc tag: %U\n",
+				 tc->len, tc->aad_len, format_hexdump, tc->tag,
+				 16, format_hexdump, tag, 16);
+
+      clib_memcpy_fast (mb_pt + i * MAX_TEST_LEN, pt, tc->len);
+    }
+
+  /* all test cases in one batch, encrypt */
+  FOREACH_ARRAY_ELT (tc, test_cases)
+    {
+      u32 i = tc - test_cases;
+      msgs[i] = (clib_chacha20_poly1305_msg_t){
+	.key = key,
+	.nonce = nonce,
+	.aad = aad,
+	.src = mb_pt + i * MAX_TEST_LEN,
+	.dst = mb_ct + i * MAX_TEST_LEN,
+	.tag = mb_tag[i],
+	.len = tc->len,
+	.aad_len = tc->aad_len,
+	.tag_len = 16,
+      };
+    }
+
+  clib_chacha20_poly1305_mb (msgs, ARRAY_LEN (msgs),
+			     CLIB_CHACHA20_POLY1305_OP_ENCRYPT);
+
+  FOREACH_ARRAY_ELT (tc, test_cases)
+    {
+      u32 i = tc - test_cases;
+      if (memcmp (mb_tag[i], tc->tag, 16) != 0)
+	err = clib_error_return (err,
+				 "\ntest:     multi-buffer, len %u aad_len %u"
+				 "\nexp tag:  %U"
+				 "\ncalc tag: %U\n",
+				 tc->len, tc->aad_len, format_hexdump, tc->tag,
+				 16, format_hexdump, mb_tag[i], 16);
+    }
+
+  /* and decrypt, with the tag of every other message corrupted */
+  FOREACH_ARRAY_ELT (m, msgs)
+    {
+      u32 i = m - msgs;
+      m->src = mb_ct + i * MAX_TEST_LEN;
+      m->dst = mb_out + i * MAX_TEST_LEN;
+      if (i & 1)
+	mb_tag[i][i % 16] ^= 1;
+    }
+
+  clib_chacha20_poly1305_mb (msgs, ARRAY_LEN (msgs),
+			     CLIB_CHACHA20_POLY1305_OP_DECRYPT);
+
+  FOREACH_ARRAY_ELT (m, msgs)
+    {
+      u32 i = m - msgs;
+      if (m->bad_tag != (i & 1) ||
+	  memcmp (m->dst, mb_pt + i * MAX_TEST_LEN, m->len) != 0)
+	err = clib_error_return (
+	  err,
+	  "\ntest:     multi-buffer decrypt, len %u aad_len %u bad_tag %u\n",
+	  m->len, m->aad_len, m->bad_tag);
+    }
+
+  return err;
+}
+
+void __test_perf_fn
+perftest_mb_1472byte (test_perf_t *tp)
+{
+  u32 n = tp->n_ops;
+  clib_chacha20_poly1305_msg_t *msgs = test_mem_alloc (n * sizeof (msgs[0]));
+  u8 *src = test_mem_alloc_and_fill_inc_u8 (n * 1472, 0, 0);
+  u8 *dst = test_mem_alloc (n * 1472);
+  u8 *key = test_mem_alloc_and_fill_inc_u8 (32, 0, 0);
+  u8 *nonce = test_mem_alloc_and_fill_inc_u8 (12, 0, 0);
+  u8 *tag = test_mem_alloc (n * 16);
+
+  for (int i = 0; i < n; i++)
+    msgs[i] = (clib_chacha20_poly1305_msg_t){
+      .key = key,
+      .nonce = nonce,
+      .src = src + i * 1472,
+      .dst = dst + i * 1472,
+      .tag = tag + i * 16,
+      .len = 1472,
+      .tag_len = 16,
+    };
+
+  test_perf_event_enable (tp);
+  clib_chacha20_poly1305_mb (msgs, n, CLIB_CHACHA20_POLY1305_OP_ENCRYPT);
+  test_perf_event_disable (tp);
+}
+
+void __test_perf_fn
+perftest_byte (test_perf_t *tp)
+{
+  u32 n = tp->n_ops;
+  u8 *src = test_mem_alloc_and_fill_inc_u8 (n, 0, 0);
+  u8 *dst = test_mem_alloc (n);
+  u8 *key = test_mem_alloc_and_fill_inc_u8 (32, 0, 0);
+  u8 *nonce = test_mem_alloc_and_fill_inc_u8 (12, 0, 0);
+  u8 *tag = test_mem_alloc (16);
+
+  test_perf_event_enable (tp);
+  clib_chacha20_poly1305 (key, nonce, 0, 0, src, dst, n, tag, 16,
+			  CLIB_CHACHA20_POLY1305_OP_ENCRYPT);
+  test_perf_event_disable (tp);
+}
+
+REGISTER_TEST (clib_chacha20_poly1305) = {
+  .name = "clib_chacha20_poly1305",
+  .fn = test_clib_chacha20_poly1305,
+  .perf_tests = PERF_TESTS (
+    { .name = "multi-buffer (1472 bytes)", .n_ops = 64,
+      .fn = perftest_mb_1472byte },
+    { .name = "variable size (per byte)",
+      .n_ops = 16384,
+      .fn = perftest_byte }),
+};
@@ -27,3 +27,17 @@ class TestBuffers(VppAsfTestCase):
         if error:
             self.logger.critical(error)
             self.assertNotIn("failed", error)
+
+    def test_buffer_pool_speed(self):
+        """Buffer Pool Alloc/Free Across Threads"""
+        reply = self.vapi.cli("test buffer-pool speed iterations 1000")
+
+        self.logger.info(reply)
+        self.assertIn("ticks/buffer", reply)
+
+    def test_buffer_pool_depot(self):
+        """Buffer Pool Big Allocations Drain the Depot"""
+        reply = self.vapi.cli("test buffer-pool depot")
+
+        self.logger.info(reply)
+        self.assertIn("ok", reply)
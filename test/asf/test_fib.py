@@ -1,5 +1,7 @@
 #!/usr/bin/env python3
 
+import re
+import time
 import unittest
 
 from asfframework import VppAsfTestCase, VppTestRunner, tag_fixme_vpp_workers
@@ -38,11 +40,143 @@ class TestFIB(VppAsfTestCase):
         self.logger.info(self.vapi.cli("sh fib path-list 10000"))
         self.logger.info(self.vapi.cli("sh fib walk"))
         self.logger.info(self.vapi.cli("sh fib uRPF"))
+        self.logger.info(self.vapi.cli("sh ip6 fib 2001::1"))
+
+        # switching the default table's lookup engine back and forth
+        self.vapi.cli("set ip6 fib lookup-engine mtrie")
+        self.assertIn("lookup:mtrie", self.vapi.cli("sh ip6 fib table 0 summary"))
+        self.assertIn("plies", self.vapi.cli("sh ip6 fib mtrie"))
+        self.vapi.cli("set ip6 fib lookup-engine hash")
+        self.assertIn("lookup:hash", self.vapi.cli("sh ip6 fib table 0 summary"))
+        self.assertNotIn("plies", self.vapi.cli("sh ip6 fib mtrie"))
 
         if error:
             self.logger.critical(error)
         self.assertNotIn("Failed", error)
 
 
+class TestFIBDeferredReclaim(VppAsfTestCase):
+    """FIB Deferred Reclaim Test Case"""
+
+    vpp_worker_count = 2
+
+    def memory_in_use(self, show, name):
+        r = self.vapi.cli("show %s memory" % show)
+        m = re.search(r"^\s*%s\s+\d+\s+(\d+)\s*/" % re.escape(name), r, re.M)
+        self.assertIsNotNone(m, "%s missing from %s memory" % (name, show))
+        return int(m.group(1))
+
+    def deferred_reclaims(self):
+        r = self.vapi.cli("show threads")
+        m = re.search(r"deferred reclaims: pending (\d+), run (\d+)", r)
+        self.assertIsNotNone(m)
+        return int(m.group(1)), int(m.group(2))
+
+    def wait_for_reclaims(self, n_runs):
+        for _ in range(50):
+            pending, runs = self.deferred_reclaims()
+            if pending == 0:
+                break
+            time.sleep(0.1)
+        self.assertEqual(pending, 0)
+        self.assertGreater(runs, n_runs)
+        return runs
+
+    def test_fib_deferred_reclaim(self):
+        """Load-balance buckets, maps and uRPF lists released once workers pass"""
+        self.vapi.cli("create loopback interface")
+        self.vapi.cli("set interface state loop0 up")
+        self.vapi.cli("set interface ip address loop0 10.10.10.1/24")
+
+        urpf = self.memory_in_use("fib", "uRPF-list")
+        lb = self.memory_in_use("dpo", "load-balance")
+        lbm = self.memory_in_use("dpo", "Load-Balance Map")
+        _, n_runs = self.deferred_reclaims()
+
+        # growing and shrinking the path set replaces the route's buckets
+        # and uRPF list, the old ones are released after a grace period
+        nhs = ["10.10.10.%u" % i for i in range(2, 12)]
+        for nh in nhs:
+            self.vapi.cli("ip route add 1.1.1.0/24 via %s loop0" % nh)
+        for nh in nhs:
+            self.vapi.cli("ip route del 1.1.1.0/24 via %s loop0" % nh)
+
+        n_runs = self.wait_for_reclaims(n_runs)
+        self.assertEqual(self.memory_in_use("fib", "uRPF-list"), urpf)
+        self.assertEqual(self.memory_in_use("dpo", "load-balance"), lb)
+
+        # routes sharing a popular path-list of more than one recursive
+        # path use a load-balance map, dropping a path replaces it
+        self.vapi.cli("ip route add 1.1.1.1/32 via 10.10.10.2 loop0")
+        self.vapi.cli("ip route add 1.1.1.2/32 via 10.10.10.3 loop0")
+        pfxs = ["2.2.2.%u/32" % i for i in range(1, 71)]
+        for pfx in pfxs:
+            self.vapi.cli(
+                "ip route add %s via 1.1.1.1 resolve-via-host "
+                "via 1.1.1.2 resolve-via-host" % pfx
+            )
+        self.assertGreater(self.memory_in_use("dpo", "Load-Balance Map"), lbm)
+
+        for pfx in pfxs:
+            self.vapi.cli("ip route del %s via 1.1.1.2 resolve-via-host" % pfx)
+        n_runs = self.wait_for_reclaims(n_runs)
+        self.assertEqual(self.memory_in_use("dpo", "Load-Balance Map"), lbm)
+
+        for pfx in pfxs:
+            self.vapi.cli("ip route del %s via 1.1.1.1 resolve-via-host" % pfx)
+        self.vapi.cli("ip route del 1.1.1.1/32 via 10.10.10.2 loop0")
+        self.vapi.cli("ip route del 1.1.1.2/32 via 10.10.10.3 loop0")
+        self.wait_for_reclaims(n_runs)
+
+        # and nothing is leaked
+        self.assertEqual(self.memory_in_use("fib", "uRPF-list"), urpf)
+        self.assertEqual(self.memory_in_use("dpo", "load-balance"), lb)
+        self.assertEqual(self.memory_in_use("dpo", "Load-Balance Map"), lbm)
+
+        self.vapi.cli("set interface state loop0 down")
+        self.vapi.cli("delete loopback interface intfc loop0")
+
+
+class TestFIBIp6Mtrie(VppAsfTestCase):
+    """FIB IPv6 mtrie lookup engine Test Case"""
+
+    extra_vpp_config = ["ip6", "{", "fib-lookup-engine", "mtrie", "}"]
+
+    def n_plies(self):
+        m = re.search(r"(\d+) plies", self.vapi.cli("show ip6 fib mtrie"))
+        self.assertIsNotNone(m)
+        return int(m.group(1))
+
+    def test_fib_ip6_mtrie(self):
+        """IPv6 mtrie lookup engine"""
+        self.assertIn("lookup:mtrie", self.vapi.cli("show ip6 fib table 0 summary"))
+
+        # link-local tables keep the hash
+        self.vapi.cli("create loopback interface")
+        self.vapi.cli("set interface state loop0 up")
+        self.vapi.cli("enable ip6 interface loop0")
+        ll = self.vapi.cli("show ip6-ll summary")
+        self.assertIn("IP6-link-local:loop0", ll)
+        self.assertIn("lookup:hash", ll)
+        self.assertNotIn("lookup:mtrie", ll)
+
+        # a /64 is held in the plies below the 16 bit root
+        n_plies = self.n_plies()
+        self.vapi.cli("ip route add 2001:db8:1::/64 via loop0")
+        self.assertEqual(self.n_plies(), n_plies + 6)
+        self.vapi.cli("ip route del 2001:db8:1::/64 via loop0")
+        self.assertEqual(self.n_plies(), n_plies)
+
+        # the engine of an existing table can be switched
+        self.vapi.cli("set ip6 fib lookup-engine hash")
+        self.assertIn("lookup:hash", self.vapi.cli("show ip6 fib table 0 summary"))
+        self.vapi.cli("set ip6 fib lookup-engine mtrie")
+        self.assertIn("lookup:mtrie", self.vapi.cli("show ip6 fib table 0 summary"))
+
+        self.vapi.cli("disable ip6 interface loop0")
+        self.vapi.cli("set interface state loop0 down")
+        self.vapi.cli("delete loopback interface intfc loop0")
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
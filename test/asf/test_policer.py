@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 # Copyright (c) 2021 Graphiant, Inc.
 
+import re
 import unittest
 
 from asfframework import VppAsfTestCase, VppTestRunner
@@ -19,6 +20,13 @@ EIR_LOW = 7500  # EIR in kbps, below test rate
 
 NUM_PKTS = 20000
 
+# Traffic filling several slices of a distributed policer per period
+FAST_RATE = 4000000  # kbps
+FAST_BURST = 10  # ms
+FAST_CIR_OK = 4250000
+FAST_CIR_LOW = 3500000
+FAST_NUM_PKTS = 10000
+
 CBURST = 100000  # Committed burst in bytes
 EBURST = 200000  # Excess burst in bytes
 
@@ -27,7 +35,7 @@ class TestPolicer(VppAsfTestCase):
     """Policer Test Case"""
 
     def run_policer_test(
-        self, type, cir, cb, eir, eb, rate=8000, burst=10000, colour=0
+        self, type, cir, cb, eir, eb, rate=8000, burst=10000, colour=0, threads=1
     ):
         """
         Configure a Policer and push traffic through it.
@@ -52,12 +60,22 @@ class TestPolicer(VppAsfTestCase):
         )
         policer.add_vpp_config()
 
+        if threads > 1:
+            self.vapi.cli(f"policer bind index {policer.policer_index} distributed")
+
         error = self.vapi.cli(
             f"test policing index {policer.policer_index} rate {rate} "
-            f"burst {burst} colour {colour}"
+            f"burst {burst} colour {colour} threads {threads}"
         )
 
         stats = policer.get_stats()
+        if threads > 1:
+            # refills of the slices, each one takes the policer lock
+            r = self.vapi.cli(f"show policer index {policer.policer_index}")
+            m = re.search(r"per-thread refills:([ \d]+)", r)
+            stats["refills"] = sum(int(n) for n in m.group(1).split())
+            # the test starts at time 0, in policer periods
+            stats["periods"] = int(re.search(r"last update (\d+)", r).group(1))
         policer.remove_vpp_config()
 
         return stats
@@ -122,5 +140,88 @@ class TestPolicer(VppAsfTestCase):
         self.assertEqual(stats["violate_packets"], NUM_PKTS)
 
 
+class TestPolicerDistributed(VppAsfTestCase):
+    """Distributed Policer Test Case"""
+
+    vpp_worker_count = 2
+
+    run_policer_test = TestPolicer.run_policer_test
+
+    def test_policer_distributed_1r2c(self):
+        """Single rate, 2 colour policer shared by the workers"""
+        threads = self.vpp_worker_count + 1
+
+        stats = self.run_policer_test("1R2C", CIR_OK, CBURST, 0, 0, threads=threads)
+        self.assertEqual(stats["conform_packets"], NUM_PKTS)
+
+        # the threads together get about the share a single thread gets,
+        # the tokens are only taken from the shared buckets in slices
+        single = self.run_policer_test("1R2C", CIR_LOW, CBURST, 0, 0)
+        stats = self.run_policer_test("1R2C", CIR_LOW, CBURST, 0, 0, threads=threads)
+        self.assertAlmostEqual(
+            stats["conform_packets"],
+            single["conform_packets"],
+            delta=single["conform_packets"] * 0.02,
+        )
+        self.assertEqual(stats["exceed_packets"], 0)
+        self.assertGreater(stats["violate_packets"], 0)
+
+    def test_policer_distributed_burst(self):
+        """Distributed policer with frames larger than a slice"""
+        threads = self.vpp_worker_count + 1
+
+        # a frame of a thread needs several slices of tokens per policer
+        # period, all of them conform while the shared buckets hold tokens
+        stats = self.run_policer_test(
+            "1R3C",
+            FAST_CIR_OK,
+            CBURST,
+            0,
+            EBURST,
+            rate=FAST_RATE,
+            burst=FAST_BURST,
+            threads=threads,
+        )
+        self.assertEqual(stats["conform_packets"], FAST_NUM_PKTS)
+
+        stats = self.run_policer_test(
+            "1R3C",
+            FAST_CIR_LOW,
+            CBURST,
+            0,
+            EBURST,
+            rate=FAST_RATE,
+            burst=FAST_BURST,
+            threads=threads,
+        )
+        self.assertLess(stats["conform_packets"], FAST_NUM_PKTS)
+        self.assertGreater(stats["conform_packets"], FAST_NUM_PKTS * 0.8)
+        self.assertGreater(stats["exceed_packets"], 0)
+        self.assertGreater(stats["violate_packets"], 0)
+
+    def test_policer_distributed_exceed(self):
+        """Distributed policer between the committed and peak rates"""
+        threads = self.vpp_worker_count + 1
+
+        # once the committed tokens of a period are used up the packets
+        # exceed from the slice, without taking the lock for each of them.
+        # A slice refills its committed tokens once per period, and its
+        # peak ones once per quantum, which outlasts a period at this rate.
+        stats = self.run_policer_test(
+            "2R3C",
+            FAST_CIR_LOW,
+            CBURST,
+            FAST_CIR_OK,
+            EBURST,
+            rate=FAST_RATE,
+            burst=FAST_BURST,
+            threads=threads,
+        )
+        self.assertGreater(stats["conform_packets"], 0)
+        self.assertGreater(stats["exceed_packets"], 0)
+        self.assertEqual(stats["violate_packets"], 0)
+        self.assertLessEqual(stats["refills"], 3 * stats["periods"])
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
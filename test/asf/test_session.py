@@ -402,6 +402,35 @@ class TestSessionUnitTests(VppAsfTestCase):
         self.vapi.session_enable_disable(is_enable=0)
 
 
+class TestSessionRssSteering(VppAsfTestCase):
+    """Session RSS Steering Test Case"""
+
+    vpp_worker_count = 2
+    extra_vpp_config = ["session", "{", "rss-steering", "}"]
+
+    def setUp(self):
+        super(TestSessionRssSteering, self).setUp()
+        self.vapi.session_enable_disable(is_enable=1)
+
+    def tearDown(self):
+        super(TestSessionRssSteering, self).tearDown()
+        self.vapi.session_enable_disable(is_enable=0)
+
+    def test_session_rss_steering(self):
+        """Active open ports steered to the hinted thread"""
+        error = self.vapi.cli("test session rss")
+
+        if error:
+            self.logger.critical(error)
+        self.assertNotIn("failed", error)
+
+        # the unit test hints each of the three threads for 8 ports of
+        # each of the 8 verification tuples
+        r = self.vapi.cli("show session transport")
+        self.assertIn("rss steering: reta size 128", r)
+        self.assertIn("rss steered: 192 not steered: 0", r)
+
+
 @tag_fixme_vpp_workers
 class TestSessionRuleTableTests(VppAsfTestCase):
     """Session Rule Table Tests Case"""
@@ -142,6 +142,41 @@ class TesVhostInterface(VppAsfTestCase):
         self.logger.info("Deleting VirtualEthernet")
         vhost_if.remove_vpp_config()
 
+    def test_vhost_dma(self):
+        """Vhost User interface with DMA copy offload"""
+
+        has_dma = "No active DMA backends" not in self.vapi.cli(
+            "show dma backends"
+        )
+
+        # create and delete a few times, the DMA config goes with the
+        # interface and the copies fall back to the cpu without a backend
+        for i in range(3):
+            r = self.vapi.cli(
+                "create vhost-user socket /tmp/sock_dma server "
+                "use-dma dma-threshold 32"
+            )
+            name = r.strip()
+            self.assertIn("VirtualEthernet", name)
+
+            r = self.vapi.cli("show vhost-user %s" % name)
+            self.assertIn("socket filename /tmp/sock_dma", r)
+            if has_dma:
+                # copies below the minimum threshold are never offloaded
+                self.assertIn("DMA copy offload threshold 64", r)
+            else:
+                self.assertNotIn("DMA copy offload", r)
+
+            self.vapi.cli("set interface state %s up" % name)
+            self.vapi.cli("delete vhost-user %s" % name)
+            self.assertNotIn(name, self.vapi.cli("show interface"))
+
+        # an interface without the option never uses DMA
+        r = self.vapi.cli("create vhost-user socket /tmp/sock_dma server")
+        name = r.strip()
+        self.assertNotIn("DMA copy offload", self.vapi.cli("show vhost-user"))
+        self.vapi.cli("delete vhost-user %s" % name)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -1623,5 +1623,20 @@ class TestACLplugin(VppTestCase):
         self.logger.info("ACLP_TEST_FINISH_0315")
 
 
+@unittest.skipIf("acl" in config.excluded_plugins, "Exclude ACL plugin tests")
+@tag_fixme_vpp_workers
+class TestACLpluginCompiled(TestACLplugin):
+    """ACL plugin Test Case with the compiled lookup"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestACLpluginCompiled, cls).setUpClass()
+        cls.vapi.cli("set acl-plugin use-compiled-acl-matching 1")
+
+    def show_commands_at_teardown(self):
+        super(TestACLpluginCompiled, self).show_commands_at_teardown()
+        self.logger.info(self.vapi.ppcli("show acl-plugin tables compiled"))
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -3,7 +3,7 @@
 import socket
 import unittest
 
-from asfframework import VppTestRunner
+from asfframework import VppAsfTestCase, VppTestRunner
 from scapy.packet import Raw
 
 from scapy.layers.l2 import Ether
@@ -1001,5 +1001,16 @@ class TestClassifierPunt(TestClassifier):
         self.assertEqual(r.ip6_table_index, 0xFFFFFFFF)
 
 
+class TestClassifierBatch(VppAsfTestCase):
+    """Classifier Batch Lookup Test Case"""
+
+    def test_classify_batch(self):
+        """Batch lookup gives the same results as per-packet lookup"""
+        reply = self.vapi.cli("test classify batch sessions 1000 tables 3 rounds 10")
+        self.logger.info(reply)
+        self.assertNotIn("differ", reply)
+        self.assertNotIn("failed", reply)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -254,6 +254,81 @@ class TestGRO(VppTestCase):
             self.assertEqual(rx[TCP].ack, (2 * i + 1))
             i += 1
 
+    def test_gro_input(self):
+        """GRO on device input test"""
+
+        self.vapi.feature_gro_enable_disable(
+            sw_if_index=self.pg0.sw_if_index, enable_disable=1
+        )
+
+        #
+        # Segments received on pg0 are coalesced before routing, so pg2
+        # transmits them as GSO packets. The second batch is flushed
+        # by the flow timer.
+        #
+        p = []
+        s = 0
+        for n in range(0, 88):
+            p.append(
+                (
+                    Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+                    / IP(src=self.pg0.remote_ip4, dst=self.pg2.remote_ip4, flags="DF")
+                    / TCP(sport=1234, dport=4321, seq=s, ack=n, flags="A")
+                    / Raw(b"\xa5" * 1460)
+                )
+            )
+            s += 1460
+
+        rxs = self.send_and_expect(self.pg0, p, self.pg2, n_rx=2)
+
+        i = 0
+        for rx in rxs:
+            i += 1
+            self.assertEqual(rx[Ether].src, self.pg2.local_mac)
+            self.assertEqual(rx[Ether].dst, self.pg2.remote_mac)
+            self.assertEqual(rx[IP].src, self.pg0.remote_ip4)
+            self.assertEqual(rx[IP].dst, self.pg2.remote_ip4)
+            self.assertEqual(rx[IP].len, 64280)  # 1460 * 44 + 40 < 65536
+            self.assertEqual(rx[IP].ttl, 63)
+            self.assertEqual(rx[TCP].sport, 1234)
+            self.assertEqual(rx[TCP].dport, 4321)
+            self.assertEqual(rx[TCP].ack, (44 * i - 1))
+
+        #
+        # Segments with a PSH flag end the coalesced packet
+        #
+        p[43][TCP].flags = "AP"
+        p[-1][TCP].flags = "AP"
+        rxs = self.send_and_expect(self.pg0, p, self.pg2, n_rx=2)
+        for rx in rxs:
+            self.assertEqual(rx[IP].len, 64280)
+
+        self.assertIn("pg0", self.vapi.cli("show gro"))
+
+        self.vapi.feature_gro_enable_disable(
+            sw_if_index=self.pg0.sw_if_index, enable_disable=0
+        )
+
+        #
+        # Nothing is coalesced once disabled
+        #
+        p = []
+        s = 0
+        for n in range(0, 10):
+            p.append(
+                (
+                    Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+                    / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4, flags="DF")
+                    / TCP(sport=1234, dport=4321, seq=s, ack=n, flags="A")
+                    / Raw(b"\xa5" * 1460)
+                )
+            )
+            s += 1460
+
+        rxs = self.send_and_expect(self.pg0, p, self.pg1, n_rx=10)
+        for rx in rxs:
+            self.assertEqual(rx[IP].len, 1500)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+
+import unittest
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether
+from scapy.packet import Raw
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+
+NUM_PKTS = 67
+
+
+class TestInterfaceHandoff(VppTestCase):
+    """Interface worker handoff"""
+
+    vpp_worker_count = 2
+
+    def setUp(self):
+        super(TestInterfaceHandoff, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.pkts = [
+            (
+                Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+                / IP(src="10.0.0.%u" % (i + 1), dst=self.pg1.remote_ip4)
+                / UDP(sport=1234, dport=1234)
+                / Raw(b"\xa5" * 100)
+            )
+            for i in range(NUM_PKTS)
+        ]
+
+    def tearDown(self):
+        self.vapi.cli("set interface handoff pg0 workers 0-1 disable")
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestInterfaceHandoff, self).tearDown()
+
+    def handed_off(self):
+        counters = self.statistics.get_counter("/net/handoff/workers")
+        return [sum(t[w] for t in counters) for w in range(self.vpp_worker_count)]
+
+    def test_handoff_rebalance(self):
+        """Handoff worker counters with rebalance"""
+
+        # without rebalance, the worker load is not counted
+        self.vapi.cli("set interface handoff pg0 workers 0-1")
+        before = self.handed_off()
+        self.send_and_expect(self.pg0, self.pkts, self.pg1, worker=0)
+        self.assertEqual(self.handed_off(), before)
+
+        # with rebalance, every packet is counted against its worker
+        self.vapi.cli("set interface handoff pg0 workers 0-1 rebalance")
+        self.assertIn("rebalance", self.vapi.cli("show interface handoff"))
+        self.send_and_expect(self.pg0, self.pkts, self.pg1, worker=0)
+        after = self.handed_off()
+        self.assertEqual(sum(after) - sum(before), NUM_PKTS)
+
+        # the flows are spread over both workers
+        for w in range(self.vpp_worker_count):
+            self.assertGreater(after[w], before[w])
+
+        show = self.vapi.cli("show interface handoff")
+        for w in range(self.vpp_worker_count):
+            self.assertIn("worker %u: %u packets handed off" % (w, after[w]), show)
+
+        # once disabled the counters stay put
+        self.vapi.cli("set interface handoff pg0 workers 0-1")
+        self.send_and_expect(self.pg0, self.pkts, self.pg1, worker=0)
+        self.assertEqual(self.handed_off(), after)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""HQoS scheduler tests"""
+
+import time
+import unittest
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+from framework import VppTestCase
+from asfframework import VppTestRunner, tag_run_solo
+from config import config
+from vpp_papi import VppEnum
+from vpp_qos import VppQosRecord
+from vpp_sub_interface import VppDot1QSubint
+
+# IP TOS of a precedence 5 (EF) and a precedence 1 (CS1) packet
+TOS_EF = 0xB8
+TOS_CS1 = 0x20
+
+
+class TestHQoS(VppTestCase):
+    """HQoS Test Case"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestHQoS, cls).setUpClass()
+        cls.create_pg_interfaces(range(2))
+
+        for i in cls.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    @classmethod
+    def tearDownClass(cls):
+        for i in cls.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestHQoS, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestHQoS, self).setUp()
+        self.qos_record = VppQosRecord(
+            self, self.pg0, VppEnum.vl_api_qos_source_t.QOS_API_SOURCE_IP
+        ).add_vpp_config()
+
+    def tearDown(self):
+        self.vapi.cli("hqos port pg1 del")
+        self.qos_record.remove_vpp_config()
+        super(TestHQoS, self).tearDown()
+
+    def create_stream(self, tos, n_pkts, size=100):
+        return [
+            (
+                Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac)
+                / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4, tos=tos)
+                / UDP(sport=1234, dport=i)
+                / Raw(b"\xa5" * size)
+            )
+            for i in range(n_pkts)
+        ]
+
+    def add_hierarchy(self, pipe_args="", port_args=""):
+        self.vapi.cli("hqos port pg1 %s" % port_args)
+        self.vapi.cli("hqos subport pg1 id 0")
+        self.vapi.cli("hqos pipe pg1 subport 0 id 1 %s" % pipe_args)
+        self.vapi.cli("hqos map pg1 pipe 1")
+
+    def test_hqos_priority(self):
+        """HQoS strict priority between traffic classes"""
+
+        self.add_hierarchy()
+        self.logger.info(self.vapi.cli("show hqos pg1 verbose"))
+
+        #
+        # low priority packets sent first, in the same frame as the high
+        # priority ones, leave last
+        #
+        stream = []
+        for lo, hi in zip(
+            self.create_stream(TOS_CS1, 16), self.create_stream(TOS_EF, 16)
+        ):
+            stream += [lo, hi]
+
+        rxs = self.send_and_expect(self.pg0, stream, self.pg1)
+        tos = [rx[IP].tos for rx in rxs]
+        self.assertEqual(tos, [TOS_EF] * 16 + [TOS_CS1] * 16)
+
+        self.assertEqual(
+            32, self.statistics.get_err_counter("/err/hqos-output/packets queued")
+        )
+
+        #
+        # the TC map moves the high priority packets to the lowest TC
+        #
+        self.vapi.cli("hqos tc-map pg1 qos %d tc 3" % TOS_EF)
+        self.vapi.cli("hqos tc-map pg1 qos %d tc 0" % TOS_CS1)
+
+        rxs = self.send_and_expect(self.pg0, stream, self.pg1)
+        tos = [rx[IP].tos for rx in rxs]
+        self.assertEqual(tos, [TOS_CS1] * 16 + [TOS_EF] * 16)
+
+        #
+        # not mapped, not queued
+        #
+        self.vapi.cli("hqos map pg1 del")
+        self.send_and_expect(self.pg0, stream, self.pg1)
+        self.assertEqual(
+            64, self.statistics.get_err_counter("/err/hqos-output/packets queued")
+        )
+
+    def test_hqos_shaping(self):
+        """HQoS shaping and tail drop"""
+
+        #
+        # a pipe shaped to 8kbps with a 1536 byte burst, i.e. a packet of
+        # 1000 bytes a second after the first two
+        #
+        self.add_hierarchy(
+            pipe_args="rate 8 kbps burst 1536", port_args="queue-size 16"
+        )
+
+        self.pg0.add_stream(self.create_stream(TOS_CS1, 40, size=958))
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        rxs = self.pg1.get_capture(2)
+        for rx in rxs:
+            self.assertEqual(len(rx[IP]), 1000)
+
+        self.assertEqual(
+            24, self.statistics.get_err_counter("/err/hqos-output/queue full drops")
+        )
+        self.assertIn("throttled", self.vapi.cli("show hqos pg1 verbose"))
+
+        #
+        # a packet trickles out every second
+        #
+        self.sleep(1.5)
+        self.assertIn(
+            self.statistics.get_err_counter("/err/hqos-sched/packets transmitted"),
+            [3, 4],
+        )
+
+        #
+        # the queued packets are freed with the port
+        #
+        self.vapi.cli("hqos port pg1 del")
+        self.assertNotIn("pg1", self.vapi.cli("show hqos"))
+
+
+@tag_run_solo
+@unittest.skipUnless(config.extended, "part of extended tests")
+class TestHQoSThroughput(VppTestCase):
+    """HQoS Throughput Test Case"""
+
+    N_PIPES = 4096
+    N_VLANS = 16
+    N_PKTS = 8192
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestHQoSThroughput, cls).setUpClass()
+        cls.create_pg_interfaces(range(2))
+
+        for i in cls.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        cls.sub_interfaces = [
+            VppDot1QSubint(cls, cls.pg1, 100 + v) for v in range(cls.N_VLANS)
+        ]
+        for s in cls.sub_interfaces:
+            s.admin_up()
+            s.config_ip4()
+            s.resolve_arp()
+
+    @classmethod
+    def tearDownClass(cls):
+        for s in cls.sub_interfaces:
+            s.unconfig_ip4()
+            s.remove_vpp_config()
+        for i in cls.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestHQoSThroughput, cls).tearDownClass()
+
+    def test_hqos_throughput(self):
+        """HQoS throughput with 16k leaf queues"""
+
+        #
+        # one subport per VLAN, the pipes shared out over the subports, and
+        # a VLAN's packets queued to one of its subport's pipes
+        #
+        self.vapi.cli("hqos port pg1 tcs 4 queue-size 64")
+        for v in range(self.N_VLANS):
+            self.vapi.cli("hqos subport pg1 id %d rate 10 gbps" % v)
+        for p in range(self.N_PIPES):
+            self.vapi.cli(
+                "hqos pipe pg1 subport %d id %d rate 100 mbps"
+                % (p % self.N_VLANS, p)
+            )
+        for v, s in enumerate(self.sub_interfaces):
+            self.vapi.cli("hqos map %s pipe %d" % (s.name, v))
+
+        stream = []
+        for n in range(self.N_PKTS):
+            s = self.sub_interfaces[n % self.N_VLANS]
+            stream.append(
+                Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac)
+                / IP(src=self.pg0.remote_ip4, dst=s.remote_ip4)
+                / UDP(sport=1234, dport=n & 0xFFFF)
+                / Raw(b"\xa5" * 64)
+            )
+
+        self.vapi.cli("clear runtime")
+        start = time.time()
+        rxs = self.send_and_expect(self.pg0, stream, self.pg1)
+        elapsed = time.time() - start
+        self.assertEqual(len(rxs), self.N_PKTS)
+
+        self.logger.info(
+            "HQoS: %d packets in %.3fs, %.0f pps through pg"
+            % (self.N_PKTS, elapsed, self.N_PKTS / elapsed)
+        )
+        self.logger.info(self.vapi.cli("show runtime hqos-output hqos-sched"))
+        self.logger.info(self.vapi.cli("show hqos pg1"))
+
+        self.vapi.cli("hqos port pg1 del")
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
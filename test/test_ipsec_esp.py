@@ -765,6 +765,48 @@ class TestIpsecEspAsync(TemplateIpsecEsp):
         self.p_async.sa.remove_vpp_config()
         self.vapi.ipsec_set_async_mode(async_enable=False)
 
+    def test_dual_stream_batched(self):
+        """Alternating SAs with async frame batching"""
+        p = self.params[self.p_sync.addr_type]
+        self.vapi.ipsec_set_async_mode(async_enable=True)
+        self.vapi.cli("set crypto async batching depth 1 deadline 100")
+
+        pkts = [
+            (
+                Ether(src=self.pg1.remote_mac, dst=self.pg1.local_mac)
+                / IP(src=self.pg1.remote_ip4, dst=self.p_sync.remote_tun_if_host)
+                / UDP(sport=4444, dport=4444)
+                / Raw(b"0x0" * 200)
+            ),
+            (
+                Ether(src=self.pg1.remote_mac, dst=self.pg1.local_mac)
+                / IP(src=self.pg1.remote_ip4, dst=p.remote_tun_if_host)
+                / UDP(sport=4444, dport=4444)
+                / Raw(b"0x0" * 200)
+            ),
+        ]
+        pkts *= 1023
+
+        rxs = self.send_and_expect(self.pg1, pkts, self.pg0)
+        self.assertEqual(len(rxs), len(pkts))
+
+        # held frames must not reorder the packets of a SA
+        last_seq = {}
+        for rx in rxs:
+            spi = rx[ESP].spi
+            self.assertIn(spi, (p.vpp_tun_spi, self.p_sync.vpp_tun_spi))
+            self.assertGreater(rx[ESP].seq, last_seq.get(spi, 0))
+            last_seq[spi] = rx[ESP].seq
+
+        self.logger.info(self.vapi.cli("show crypto async status"))
+        self.vapi.cli("set crypto async batching disable")
+
+        self.p_sync.spd.remove_vpp_config()
+        self.p_sync.sa.remove_vpp_config()
+        self.p_async.spd.remove_vpp_config()
+        self.p_async.sa.remove_vpp_config()
+        self.vapi.ipsec_set_async_mode(async_enable=False)
+
     def test_sync_async_noop_stream(self):
         """Alternating SAs sync/async/noop"""
         p = self.params[self.p_sync.addr_type]
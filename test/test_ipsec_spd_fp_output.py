@@ -1,3 +1,4 @@
+import re
 import socket
 import unittest
 import ipaddress
@@ -1414,5 +1415,97 @@ class IPSec6SpdTestCaseMultiple(SpdFastPathIPv6Outbound):
         self.verify_policy_match(pkt_count, policy_22)
 
 
+class IPSec4SpdTestCaseFlowCache(SpdFastPathOutbound):
+    """ IPSec/IPv4 outbound: Policy mode test case with fast path \
+        (flow cache)"""
+
+    def fp_flow_cache_stats(self):
+        # (lookups, hits) of the main thread, as 'show ipsec spd' has them
+        r = self.vapi.cli("show ipsec spd")
+        self.assertIn("spd-fast-path-flow-cache-entries: 4096 per thread", r)
+        m = re.search(r"thread 0: lookups (\d+) hits (\d+)", r)
+        if not m:
+            return (0, 0)
+        return (int(m.group(1)), int(m.group(2)))
+
+    def send_stream(self, packets):
+        self.pg0.add_stream(packets)
+        self.pg0.enable_capture()
+        self.pg1.enable_capture()
+        self.pg_start()
+
+    def test_ipsec_spd_fp_flow_cache(self):
+        # In this test case, the same flow is sent several times through
+        # the outbound SPD. The flow cache serves the lookups once it holds
+        # the flow, and adding or removing a policy invalidates it.
+        self.create_interfaces(2)
+        pkt_count = 5
+        self.spd_create_and_intf_add(1, [self.pg1])
+        self.vapi.cli("clear ipsec counters")
+        self.assertEqual(self.fp_flow_cache_stats(), (0, 0))
+
+        policy_0 = self.spd_add_rem_policy(  # outbound, priority 5
+            1,
+            self.pg0,
+            self.pg1,
+            socket.IPPROTO_UDP,
+            is_out=1,
+            priority=5,
+            policy_type="bypass",
+        )
+        packets = self.create_stream(self.pg0, self.pg1, pkt_count)
+
+        # the first burst fills the cache, the second one hits it
+        self.send_stream(packets)
+        capture = self.pg1.get_capture(pkt_count)
+        self.verify_capture(self.pg0, self.pg1, capture)
+        lookups, hits = self.fp_flow_cache_stats()
+        self.assertEqual(lookups, pkt_count)
+
+        self.send_stream(packets)
+        self.pg1.get_capture(pkt_count)
+        self.assertEqual(
+            self.fp_flow_cache_stats(), (lookups + pkt_count, hits + pkt_count)
+        )
+        self.verify_policy_match(2 * pkt_count, policy_0)
+
+        # a higher priority policy must not be hidden by the cached match
+        policy_1 = self.spd_add_rem_policy(  # outbound, priority 10
+            1,
+            self.pg0,
+            self.pg1,
+            socket.IPPROTO_UDP,
+            is_out=1,
+            priority=10,
+            policy_type="discard",
+        )
+        lookups, hits = self.fp_flow_cache_stats()
+        self.send_stream(packets)
+        self.pg1.assert_nothing_captured()
+        self.verify_policy_match(2 * pkt_count, policy_0)
+        self.verify_policy_match(pkt_count, policy_1)
+        self.assertLess(self.fp_flow_cache_stats()[1], hits + pkt_count)
+
+        # and the removed policy must not be matched from the cache
+        self.spd_add_rem_policy(  # outbound, priority 10
+            1,
+            self.pg0,
+            self.pg1,
+            socket.IPPROTO_UDP,
+            is_out=1,
+            priority=10,
+            policy_type="discard",
+            remove=True,
+        )
+        self.send_stream(packets)
+        capture = self.pg1.get_capture(pkt_count)
+        self.verify_capture(self.pg0, self.pg1, capture)
+        self.verify_policy_match(3 * pkt_count, policy_0)
+
+        # the counters are reset with the other ipsec counters
+        self.vapi.cli("clear ipsec counters")
+        self.assertEqual(self.fp_flow_cache_stats(), (0, 0))
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -1,3 +1,4 @@
+import re
 import unittest
 
 from scapy.layers.l2 import Ether
@@ -352,6 +353,98 @@ class TestMemif(VppTestCase):
         remote_memif.remove_vpp_config()
         remote_socket.remove_vpp_config()
 
+    def _memif_input_state(self):
+        # the state column of show runtime is cut to "interrupt wa"
+        r = self.vapi.cli("show runtime")
+        m = re.search(r"^\s*memif-input\s+(polling|interrupt)", r, re.M)
+        self.assertIsNotNone(m)
+        return m.group(1)
+
+    def _memif_input_switches(self):
+        r = self.vapi.cli("show node adaptive-mode")
+        m = re.search(r"^\s*\d+\s+memif-input\s+\S+\s+[\d.]+\s+(\d+)", r, re.M)
+        self.assertIsNotNone(m)
+        return int(m.group(1))
+
+    def test_memif_adaptive_mode(self):
+        """Memif adaptive rx-mode switches"""
+
+        memif = VppMemif(
+            self,
+            VppEnum.vl_api_memif_role_t.MEMIF_ROLE_API_SLAVE,
+            VppEnum.vl_api_memif_mode_t.MEMIF_MODE_API_ETHERNET,
+        )
+
+        remote_socket = VppSocketFilename(
+            self.remote_test, 1, "%s/memif.sock" % self.tempdir
+        )
+        remote_socket.add_vpp_config()
+
+        remote_memif = VppMemif(
+            self.remote_test,
+            VppEnum.vl_api_memif_role_t.MEMIF_ROLE_API_MASTER,
+            VppEnum.vl_api_memif_mode_t.MEMIF_MODE_API_ETHERNET,
+            socket_id=1,
+        )
+
+        memif.add_vpp_config()
+        memif.config_ip4()
+        memif.admin_up()
+        self.vapi.sw_interface_set_rx_mode(
+            sw_if_index=memif.sw_if_index,
+            mode=VppEnum.vl_api_rx_mode_t.RX_MODE_API_ADAPTIVE,
+        )
+
+        remote_memif.add_vpp_config()
+        remote_memif.config_ip4()
+        remote_memif.admin_up()
+
+        self.assertTrue(memif.wait_for_link_up(5))
+        self.assertTrue(remote_memif.wait_for_link_up(5))
+
+        route = VppIpRoute(
+            self.remote_test,
+            self.pg0._local_ip4_subnet,
+            24,
+            [VppRoutePath(memif.ip_prefix.network_address, 0xFFFFFFFF)],
+            register=False,
+        )
+        route.add_vpp_config()
+
+        # a long busy-poll budget keeps the node polling while it is checked
+        self.vapi.cli(
+            "set node adaptive-mode poll-threshold 10 interrupt-threshold 5 "
+            "busy-poll-usec 3000000"
+        )
+
+        # idle, the node waits for interrupts
+        self.assertEqual(self._memif_input_state(), "interrupt")
+
+        # the echo replies arrive on the memif, back to back bursts switch
+        # the node to polling
+        packet_num = 10
+        for _ in range(2):
+            pkts = self._create_icmp(self.pg0, remote_memif, packet_num)
+            self.pg0.add_stream(pkts)
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+            self.pg0.get_capture(packet_num, timeout=2)
+        self.assertEqual(self._memif_input_state(), "polling")
+
+        # and once the budget has run out it is back in interrupt mode
+        for _ in range(20):
+            if self._memif_input_state() != "polling":
+                break
+            self.sleep(0.5)
+        self.assertEqual(self._memif_input_state(), "interrupt")
+        self.assertGreaterEqual(self._memif_input_switches(), 2)
+
+        self.vapi.cli(
+            "set node adaptive-mode poll-threshold 10 interrupt-threshold 5 "
+            "busy-poll-usec 50"
+        )
+        route.remove_vpp_config()
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
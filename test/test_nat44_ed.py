@@ -2560,6 +2560,76 @@ class TestNAT44ED(VppTestCase):
             in_if.unconfig()
             out_if.unconfig()
 
+    def test_flow_offload(self):
+        """NAT44ED flow offload"""
+
+        self.nat_add_address(self.nat_addr)
+        self.nat_add_inside_interface(self.pg0)
+        self.nat_add_outside_interface(self.pg1)
+        self.vapi.cli("nat44 flow-offload enable packets 1 age 0 max-flows 1024")
+
+        p_in = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            / UDP(sport=self.udp_port_in, dport=20)
+        )
+
+        def send_in2out():
+            capture = self.send_and_expect(self.pg0, p_in * 5, self.pg1)
+            for c in capture:
+                self.assertEqual(c[IP].src, self.nat_addr)
+            return capture[0][UDP].sport
+
+        # the first burst creates the session, the next requests the offload
+        send_in2out()
+        port_out = send_in2out()
+        p_out = (
+            Ether(src=self.pg1.remote_mac, dst=self.pg1.local_mac)
+            / IP(src=self.pg1.remote_ip4, dst=self.nat_addr)
+            / UDP(sport=20, dport=port_out)
+        )
+
+        def send_out2in():
+            capture = self.send_and_expect(self.pg1, p_out * 5, self.pg0)
+            for c in capture:
+                self.assertEqual(c[IP].dst, self.pg0.remote_ip4)
+                self.assertEqual(c[UDP].dport, self.udp_port_in)
+
+        send_out2in()
+        self.virtual_sleep(0.5, "wait for the flows to be installed")
+
+        reply = self.vapi.cli("show nat44 flow-offload")
+        self.assertIn("active 2 installed 2 failed 0", reply)
+        self.assertIn("mark hits 0 ", reply)
+
+        # the marked packets skip the session lookup
+        send_in2out()
+        send_out2in()
+        reply = self.vapi.cli("show nat44 flow-offload")
+        self.assertIn("mark hits 10 misses 0", reply)
+
+        # the flows go away with the session
+        self.vapi.nat44_del_session(
+            address=self.pg0.remote_ip4,
+            port=self.udp_port_in,
+            protocol=IP_PROTOS.udp,
+            flags=(
+                self.config_flags.NAT_IS_INSIDE
+                | self.config_flags.NAT_IS_EXT_HOST_VALID
+            ),
+            ext_host_address=self.pg1.remote_ip4,
+            ext_host_port=20,
+        )
+        self.virtual_sleep(0.5, "wait for the flows to be removed")
+        reply = self.vapi.cli("show nat44 flow-offload")
+        self.assertIn("active 0 installed 2 failed 0 removed 2", reply)
+
+        # and the traffic falls back to the session lookup
+        send_in2out()
+        self.vapi.cli("nat44 flow-offload disable")
+        reply = self.vapi.cli("show nat44 flow-offload")
+        self.assertIn("disabled", reply)
+
     def test_delete_interface(self):
         """NAT44ED delete nat interface"""
 
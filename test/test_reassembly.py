@@ -266,6 +266,46 @@ class TestIPv4Reassembly(VppTestCase):
         self.dst_if.get_capture(1)
         self.assert_error_counter_equal(error_cnt_str, error_cnt + 1)
 
+    def test_abandoned(self):
+        """fragments of an abandoned reassembly are dropped early"""
+
+        too_long_str = "/err/ip4-full-reassembly-feature/reass_fragment_chain_too_long"
+        abandoned_str = "/err/ip4-full-reassembly-feature/reass_abandoned"
+
+        too_long = self.statistics.get_err_counter(too_long_str)
+        abandoned = self.statistics.get_err_counter(abandoned_str)
+
+        self.vapi.ip_reassembly_set(
+            timeout_ms=100,
+            max_reassemblies=1000,
+            max_reassembly_length=3,
+            expire_walk_interval_ms=50,
+        )
+
+        p = (
+            Ether(dst=self.src_if.local_mac, src=self.src_if.remote_mac)
+            / IP(id=1002, src=self.src_if.remote_ip4, dst=self.dst_if.remote_ip4)
+            / UDP(sport=1234, dport=5678)
+            / Raw(b"X" * 1000)
+        )
+        # every other fragment first, leaving too many holes to fill
+        frags = fragment_rfc791(p, 200)
+        frags = frags[::2] + frags[1::2]
+
+        self.pg_enable_capture()
+        self.src_if.add_stream(frags)
+        self.pg_start()
+
+        self.dst_if.assert_nothing_captured()
+        self.assert_error_counter_equal(too_long_str, too_long + 1)
+        self.assertGreater(self.statistics.get_err_counter(abandoned_str), abandoned)
+
+        # the abandoned context is freed on timeout like any other
+        self.virtual_sleep(0.25)
+        self.assertIn(
+            "reassemblies count: 0", self.vapi.ppcli("show ip4-full-reassembly")
+        )
+
     def test_5737(self):
         """fragment length + ip header size > 65535"""
         self.vapi.cli("clear errors")
@@ -169,5 +169,96 @@ class StatsClientTestCase(VppTestCase):
         print("AFTER", before, self.statistics.get_counter("/mem/statseg/used"))
 
 
+class StatsDeltaTestCase(VppTestCase):
+    """Test the delta export of the stats segment"""
+
+    @classmethod
+    def setUpConstants(cls):
+        cls.extra_vpp_statseg_config = "update-interval 0.05 delta-ring-size 256"
+        super(StatsDeltaTestCase, cls).setUpConstants()
+
+    def setUp(self):
+        super(StatsDeltaTestCase, self).setUp()
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    def tearDown(self):
+        super(StatsDeltaTestCase, self).tearDown()
+        for i in self.pg_interfaces:
+            i.unconfig()
+            i.admin_down()
+
+    def send(self, count):
+        p = [
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            for i in range(count)
+        ]
+        self.send_and_expect(self.pg0, p, self.pg1)
+        # let the collector publish the new values
+        self.sleep(0.2)
+
+    def rx_packets(self):
+        rx = self.statistics.get_counter("/if/rx")
+        return sum(t[self.pg0.sw_if_index]["packets"] for t in rx)
+
+    def test_delta_counter_change(self):
+        """Delta export records a counter change"""
+        delta = self.statistics.delta()
+        delta.sync()
+        self.assertTrue(delta.resynced)
+        rx = delta.index("/if/rx")
+        before = delta.get("/if/rx")[self.pg0.sw_if_index][0]
+        self.assertEqual(before, self.rx_packets())
+
+        self.send(5)
+        delta.sync()
+
+        # applied from the records, not copied again
+        self.assertFalse(delta.resynced)
+        self.assertIn((rx, self.pg0.sw_if_index), delta.changes)
+        after = delta.get("/if/rx")[self.pg0.sw_if_index][0]
+        self.assertEqual(after, before + 5)
+        self.assertEqual(after, self.rx_packets())
+
+        # nothing changed, no record for the counter
+        self.sleep(0.2)
+        delta.sync()
+        self.assertNotIn((rx, self.pg0.sw_if_index), delta.changes)
+
+    def test_delta_ring_lap(self):
+        """Delta export reader lapped by the collector"""
+        delta = self.statistics.delta()
+        delta.sync()
+        before = delta.get("/if/rx")[self.pg0.sw_if_index][0]
+
+        self.send(7)
+
+        # the gauges change on each update, wait for the ring to wrap
+        for _ in range(200):
+            n_pending, n_records = delta.pending()
+            if n_pending > n_records:
+                break
+            self.send(1)
+        self.assertGreater(n_pending, n_records)
+
+        # the records are lost, the snapshot is copied again
+        delta.sync()
+        self.assertTrue(delta.resynced)
+        self.assertEqual(delta.changes, [])
+        after = delta.get("/if/rx")[self.pg0.sw_if_index][0]
+        self.assertGreaterEqual(after, before + 7)
+        self.assertEqual(after, self.rx_packets())
+
+        # and the records apply again after that
+        self.send(3)
+        delta.sync()
+        self.assertFalse(delta.resynced)
+        self.assertEqual(delta.get("/if/rx")[self.pg0.sw_if_index][0], after + 3)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -326,5 +326,69 @@ class TestVlibFrameLeak(VppTestCase):
             self.assertEqual(frame_allocated[key], alloc)
 
 
+class TestVlibFrameQueue(VppTestCase):
+    """Vlib Frame Queue Test Cases"""
+
+    vpp_worker_count = 3
+
+    def test_frame_queue_throughput(self):
+        """Frame queue handoff throughput"""
+
+        r = self.vapi.cli("test frame-queue throughput time 0.5 sweep")
+        self.logger.info(r)
+
+        fq_index = int(r.split()[1])
+        lines = [l for l in r.splitlines() if l.startswith("producers")]
+        self.assertEqual(len(lines), 2)
+
+        # every buffer handed off must reach the consumer
+        for l in lines:
+            spl = l.split()
+            self.assertGreater(float(spl[7]), 0)
+            self.assertEqual(spl[7], spl[10])
+
+        # the queue is sampled in the stats segment
+        prefix = "/sys/frame-queue/%u/" % fq_index
+        drops = self.statistics.get_counter(prefix + "congestion-drops")
+        occupancy = self.statistics.get_counter(prefix + "occupancy")
+        self.assertEqual(len(occupancy[0]), 8)
+        self.assertGreater(sum(sum(t) for t in occupancy), 0)
+        self.assertEqual(len(drops[0]), self.vpp_worker_count + 1)
+
+
+class TestVlibAdaptiveMode(VppTestCase):
+    """Vlib Adaptive Mode Test Cases"""
+
+    def test_adaptive_mode_params(self):
+        """Adaptive mode parameters"""
+
+        r = self.vapi.cli("show node adaptive-mode")
+        self.assertIn(
+            "poll-threshold 10 interrupt-threshold 5 busy-poll-usec 50", r
+        )
+
+        self.vapi.cli(
+            "set node adaptive-mode poll-threshold 32 interrupt-threshold 2 "
+            "busy-poll-usec 200 weight-log2 2"
+        )
+        r = self.vapi.cli("show node adaptive-mode")
+        self.assertIn(
+            "poll-threshold 32 interrupt-threshold 2 busy-poll-usec 200 "
+            "weight-log2 2",
+            r,
+        )
+
+        # thresholds must leave a hysteresis
+        r = self.vapi.cli_return_response(
+            "set node adaptive-mode poll-threshold 2 interrupt-threshold 2"
+        )
+        self.assertNotEqual(r.retval, 0)
+
+        self.vapi.cli(
+            "set node adaptive-mode poll-threshold 10 interrupt-threshold 5 "
+            "busy-poll-usec 50 weight-log2 3"
+        )
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+import ctypes
+import os
+import struct
+import unittest
+from framework import VppTestCase
+from vm_vpp_interfaces import (
+    TestSelector,
+    TestVPPInterfacesQemu,
+    generate_vpp_interface_tests,
+)
+from asfframework import VppTestRunner
+from vm_test_config import test_config
+
+IORING_FEAT_EXT_ARG = 1 << 8
+NR_IO_URING_SETUP = 425
+
+
+def io_uring_has_ext_arg():
+    """Whether the kernel io_uring waits with EXT_ARG, as VPP needs (5.11+)"""
+    # struct io_uring_params, features is the sixth u32
+    params = ctypes.create_string_buffer(120)
+    libc = ctypes.CDLL(None, use_errno=True)
+    fd = libc.syscall(NR_IO_URING_SETUP, 1, params)
+    if fd < 0:
+        return False
+    os.close(fd)
+    return bool(struct.unpack_from("I", params, 20)[0] & IORING_FEAT_EXT_ARG)
+
+
+@unittest.skipUnless(io_uring_has_ext_arg(), "io_uring lacks IORING_FEAT_EXT_ARG")
+class TestVPPInterfacesQemuTapIoUringL2(TestVPPInterfacesQemu, VppTestCase):
+    """Test VPP tap interfaces in L2 mode for IPv4/v6 with io_uring polling."""
+
+    # Set test_id(s) to run from vm_test_config
+    # The expansion of these numbers are included in the test docstring
+    tests_to_run = "1"
+
+    extra_vpp_config = ["unix", "{", "poll-io-uring", "}"]
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVPPInterfacesQemuTapIoUringL2, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestVPPInterfacesQemuTapIoUringL2, cls).tearDownClass()
+
+    def tearDown(self):
+        super(TestVPPInterfacesQemuTapIoUringL2, self).tearDown()
+
+    def test_io_uring_enabled(self):
+        """Files are polled through io_uring"""
+        reply = self.vapi.cli("show files")
+        self.assertIn("thread 0 io_uring:", reply)
+
+
+SELECTED_TESTS = TestVPPInterfacesQemuTapIoUringL2.tests_to_run
+tests = filter(TestSelector(SELECTED_TESTS).filter_tests, test_config["tests"])
+generate_vpp_interface_tests(tests, TestVPPInterfacesQemuTapIoUringL2)
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
@@ -2806,9 +2806,8 @@ class WireguardHandoffTests(TestWg):
 
     vpp_worker_count = 2
 
-    def test_wg_peer_init(self):
-        """Handoff"""
-
+    def _test_wg_handoff_tmpl(self, is_async):
+        self.vapi.wg_set_async_mode(is_async)
         port = 12383
 
         # Create interfaces
@@ -2901,9 +2900,36 @@ class WireguardHandoffTests(TestWg):
 
         peer_1.validate_encapped(rxs, pe)
 
+        # an unknown receiver index is dropped, whichever worker it
+        # arrives on
+        p = peer_1.mk_tunnel_header(self.pg1) / (
+            Wireguard(message_type=4, reserved_zero=0)
+            / WireguardTransport(
+                receiver_index=peer_1.sender + 1,
+                counter=256,
+                encrypted_encapsulated_packet=d,
+            )
+        )
+        self.pg_send(self.pg1, [p] * 3, worker=1)
+        for i in self.pg_interfaces:
+            i.assert_nothing_captured(timeout=0.1)
+        self.assertEqual(
+            self.base_peer4_in_err + 3,
+            self.statistics.get_err_counter(self.peer4_in_err),
+        )
+
         r1.remove_vpp_config()
         peer_1.remove_vpp_config()
         wg0.remove_vpp_config()
+        self.vapi.wg_set_async_mode(False)
+
+    def test_wg_peer_init(self):
+        """Handoff"""
+        self._test_wg_handoff_tmpl(is_async=False)
+
+    def test_wg_peer_init_async(self):
+        """Handoff (async)"""
+        self._test_wg_handoff_tmpl(is_async=True)
 
     @unittest.skip("test disabled")
     def test_wg_multi_interface(self):